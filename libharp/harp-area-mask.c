@@ -37,6 +37,9 @@
 #include <stdio.h>
 #include <string.h>
 
+/* maximum number of vectors used for overlapping fraction calculations for which a buffer on the stack is used */
+#define MAX_STACK_VECTORS 128
+
 int harp_area_mask_new(harp_area_mask **new_area_mask)
 {
     harp_area_mask *area_mask;
@@ -51,6 +54,9 @@ int harp_area_mask_new(harp_area_mask **new_area_mask)
 
     area_mask->num_polygons = 0;
     area_mask->polygon = NULL;
+    area_mask->bounding_box = NULL;
+    area_mask->polygon_vectors = NULL;
+    area_mask->max_numberofpoints = 0;
 
     *new_area_mask = area_mask;
     return 0;
@@ -71,6 +77,21 @@ void harp_area_mask_delete(harp_area_mask *area_mask)
 
             free(area_mask->polygon);
         }
+        if (area_mask->bounding_box != NULL)
+        {
+            free(area_mask->bounding_box);
+        }
+        if (area_mask->polygon_vectors != NULL)
+        {
+            long i;
+
+            for (i = 0; i < area_mask->num_polygons; i++)
+            {
+                free(area_mask->polygon_vectors[i].vertex);
+            }
+
+            free(area_mask->polygon_vectors);
+        }
 
         free(area_mask);
     }
@@ -78,6 +99,8 @@ void harp_area_mask_delete(harp_area_mask *area_mask)
 
 int harp_area_mask_add_polygon(harp_area_mask *area_mask, harp_spherical_polygon *polygon)
 {
+    harp_vector3d *vertex;
+
     if (harp_spherical_polygon_check(polygon) != 0)
     {
         return -1;
@@ -86,6 +109,8 @@ int harp_area_mask_add_polygon(harp_area_mask *area_mask, harp_spherical_polygon
     if (area_mask->num_polygons % BLOCK_SIZE == 0)
     {
         harp_spherical_polygon **new_polygon = NULL;
+        harp_spherical_bounding_box *new_bounding_box = NULL;
+        harp_spherical_polygon_vectors *new_polygon_vectors = NULL;
 
         new_polygon = realloc(area_mask->polygon, (area_mask->num_polygons + BLOCK_SIZE)
                               * sizeof(harp_spherical_polygon *));
@@ -98,9 +123,49 @@ int harp_area_mask_add_polygon(harp_area_mask *area_mask, harp_spherical_polygon
         }
 
         area_mask->polygon = new_polygon;
+
+        new_bounding_box = realloc(area_mask->bounding_box, (area_mask->num_polygons + BLOCK_SIZE)
+                                   * sizeof(harp_spherical_bounding_box));
+        if (new_bounding_box == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           (area_mask->num_polygons + BLOCK_SIZE) * sizeof(harp_spherical_bounding_box),
+                           __FILE__, __LINE__);
+            return -1;
+        }
+
+        area_mask->bounding_box = new_bounding_box;
+
+        new_polygon_vectors = realloc(area_mask->polygon_vectors, (area_mask->num_polygons + BLOCK_SIZE)
+                                      * sizeof(harp_spherical_polygon_vectors));
+        if (new_polygon_vectors == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           (area_mask->num_polygons + BLOCK_SIZE) * sizeof(harp_spherical_polygon_vectors),
+                           __FILE__, __LINE__);
+            return -1;
+        }
+
+        area_mask->polygon_vectors = new_polygon_vectors;
+    }
+
+    vertex = malloc((size_t)polygon->numberofpoints * sizeof(harp_vector3d));
+    if (vertex == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       (size_t)polygon->numberofpoints * sizeof(harp_vector3d), __FILE__, __LINE__);
+        return -1;
+    }
+    harp_spherical_polygon_vectors_init(&area_mask->polygon_vectors[area_mask->num_polygons], polygon, vertex);
+    if (polygon->numberofpoints > area_mask->max_numberofpoints)
+    {
+        area_mask->max_numberofpoints = polygon->numberofpoints;
     }
 
     area_mask->polygon[area_mask->num_polygons] = polygon;
+    harp_spherical_polygon_get_bounding_box(polygon, &area_mask->bounding_box[area_mask->num_polygons]);
+    harp_spherical_bounding_box_expand(&area_mask->bounding_box[area_mask->num_polygons],
+                                       HARP_GEOMETRY_BOUNDING_BOX_MARGIN);
     area_mask->num_polygons++;
     return 0;
 }
@@ -112,7 +177,9 @@ int harp_area_mask_covers_point(const harp_area_mask *area_mask, const harp_sphe
 
     for (i = 0; i < area_mask->num_polygons; i++)
     {
-        if (harp_spherical_polygon_contains_point(area_mask->polygon[i], point))
+        /* only perform the exact test if the point is within the (expanded) lat/lon bounds of the polygon */
+        if (harp_spherical_bounding_box_contains_point(&area_mask->bounding_box[i], point) &&
+            harp_spherical_polygon_contains_point(area_mask->polygon[i], point))
         {
             return 1;
         }
@@ -181,25 +248,57 @@ int harp_area_mask_intersects_area(const harp_area_mask *area_mask, const harp_s
 int harp_area_mask_intersects_area_with_fraction(const harp_area_mask *area_mask, const harp_spherical_polygon *area,
                                                  double min_fraction)
 {
+    harp_vector3d stack_buffer[MAX_STACK_VECTORS];
+    harp_vector3d *buffer = stack_buffer;
+    harp_spherical_polygon_vectors area_vectors;
+    long num_vectors;
+    int result = 0;
     long i;
 
+    /* vertices of the given polygon + scratch buffer for clipping it against each of the mask polygons */
+    num_vectors = area->numberofpoints +
+        HARP_SPHERICAL_POLYGON_VECTORS_SCRATCH_SIZE(area->numberofpoints, area_mask->max_numberofpoints);
+    if (num_vectors > MAX_STACK_VECTORS)
+    {
+        buffer = malloc((size_t)num_vectors * sizeof(harp_vector3d));
+        if (buffer == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           (size_t)num_vectors * sizeof(harp_vector3d), __FILE__, __LINE__);
+            return -1;
+        }
+    }
+    harp_spherical_polygon_vectors_init(&area_vectors, area, buffer);
+
     for (i = 0; i < area_mask->num_polygons; i++)
     {
         int has_overlap;
         double fraction;
 
-        if (harp_spherical_polygon_overlapping_fraction(area_mask->polygon[i], area, &has_overlap, &fraction) != 0)
+        if (harp_spherical_polygon_vectors_overlapping_fraction(&area_mask->polygon_vectors[i], &area_vectors,
+                                                                &buffer[area->numberofpoints], &has_overlap,
+                                                                &fraction) != 0)
         {
-            continue;
+            /* neither polygon is convex */
+            if (harp_spherical_polygon_overlapping_fraction(area_mask->polygon[i], area, &has_overlap, &fraction) != 0)
+            {
+                continue;
+            }
         }
 
         if (has_overlap && fraction >= min_fraction)
         {
-            return 1;
+            result = 1;
+            break;
         }
     }
 
-    return 0;
+    if (buffer != stack_buffer)
+    {
+        free(buffer);
+    }
+
+    return result;
 }
 
 static int parse_polygon(const char *str, harp_spherical_polygon **polygon)
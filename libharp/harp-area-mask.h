@@ -38,6 +38,9 @@ typedef struct harp_area_mask_struct
 {
     long num_polygons;
     harp_spherical_polygon **polygon;
+    harp_spherical_bounding_box *bounding_box;  /* (expanded) lat/lon bounds of each polygon */
+    harp_spherical_polygon_vectors *polygon_vectors;    /* vector representation of each polygon */
+    int32_t max_numberofpoints; /* largest number of points of the polygons */
 } harp_area_mask;
 
 int harp_area_mask_new(harp_area_mask **new_area_mask);
@@ -33,11 +33,14 @@
 
 #include <string.h>
 
-enum latitude_band
+/* index of each of the climatology profiles (see harp_aux_afgl86_get_profile_index()) */
+enum profile_index
 {
     tropic,
-    subarctic,
-    midlat
+    midlat_summer,
+    midlat_winter,
+    subarctic_summer,
+    subarctic_winter
 };
 
 static const double altitude[] = {
@@ -3008,11 +3011,23 @@ static const double subarctic_winter_o3_number_density[] = {
     3.907000E+02
 };
 
-int harp_aux_afgl86_get_profile(const char *name, double datetime, double latitude, int *num_vertical,
-                                const double **values)
+static void set_profiles(const double **values, const double *tropic_values, const double *midlat_summer_values,
+                         const double *midlat_winter_values, const double *subarctic_summer_values,
+                         const double *subarctic_winter_values)
+{
+    values[tropic] = tropic_values;
+    values[midlat_summer] = midlat_summer_values;
+    values[midlat_winter] = midlat_winter_values;
+    values[subarctic_summer] = subarctic_summer_values;
+    values[subarctic_winter] = subarctic_winter_values;
+}
+
+/* Return the index (0 .. HARP_AUX_AFGL86_NUM_PROFILES - 1) of the climatology profile (latitude band and season) that
+ * applies to the given time and location.
+ */
+int harp_aux_afgl86_get_profile_index(double datetime, double latitude)
 {
     double fraction_of_year = harp_fraction_of_year_from_datetime(datetime);
-    enum latitude_band band;
     int summer;
 
     if (latitude >= 0.0)
@@ -3028,185 +3043,88 @@ int harp_aux_afgl86_get_profile(const char *name, double datetime, double latitu
 
     if (latitude > -30.0 && latitude < 30.0)
     {
-        band = tropic;
-    }
-    else if (latitude > 80.0 || latitude < -80.0)
-    {
-        band = subarctic;
+        return tropic;
     }
-    else
+    if (latitude > 80.0 || latitude < -80.0)
     {
-        band = midlat;
+        return summer ? subarctic_summer : subarctic_winter;
     }
+    return summer ? midlat_summer : midlat_winter;
+}
 
+/* Get all HARP_AUX_AFGL86_NUM_PROFILES climatology profiles for the given quantity.
+ * values should have room for HARP_AUX_AFGL86_NUM_PROFILES pointers; use harp_aux_afgl86_get_profile_index() to
+ * select the profile for a specific time and location. All profiles are given on the same 'altitude' grid.
+ */
+int harp_aux_afgl86_get_profiles(const char *name, int *num_vertical, const double **values)
+{
     if (strcmp(name, "altitude") == 0)
     {
-        *values = altitude;
+        set_profiles(values, altitude, altitude, altitude, altitude, altitude);
     }
     else if (strcmp(name, "pressure") == 0)
     {
-        switch (band)
-        {
-            case tropic:
-                *values = tropic_pressure;
-                break;
-            case midlat:
-                *values = summer ? midlat_summer_pressure : midlat_winter_pressure;
-                break;
-            case subarctic:
-                *values = summer ? subarctic_summer_pressure : subarctic_winter_pressure;
-                break;
-        }
+        set_profiles(values, tropic_pressure, midlat_summer_pressure,
+                     midlat_winter_pressure, subarctic_summer_pressure, subarctic_winter_pressure);
     }
     else if (strcmp(name, "temperature") == 0)
     {
-        switch (band)
-        {
-            case tropic:
-                *values = tropic_temperature;
-                break;
-            case midlat:
-                *values = summer ? midlat_summer_temperature : midlat_winter_temperature;
-                break;
-            case subarctic:
-                *values = summer ? subarctic_summer_temperature : subarctic_winter_temperature;
-                break;
-        }
+        set_profiles(values, tropic_temperature, midlat_summer_temperature,
+                     midlat_winter_temperature, subarctic_summer_temperature, subarctic_winter_temperature);
     }
     else if (strcmp(name, "number_density") == 0)
     {
-        switch (band)
-        {
-            case tropic:
-                *values = tropic_air_number_density;
-                break;
-            case midlat:
-                *values = summer ? midlat_summer_air_number_density : midlat_winter_air_number_density;
-                break;
-            case subarctic:
-                *values = summer ? subarctic_summer_air_number_density : subarctic_winter_air_number_density;
-                break;
-        }
+        set_profiles(values, tropic_air_number_density, midlat_summer_air_number_density,
+                     midlat_winter_air_number_density, subarctic_summer_air_number_density,
+                     subarctic_winter_air_number_density);
     }
     else if (strcmp(name, "CH4_number_density") == 0)
     {
-        switch (band)
-        {
-            case tropic:
-                *values = tropic_ch4_number_density;
-                break;
-            case midlat:
-                *values = summer ? midlat_summer_ch4_number_density : midlat_winter_ch4_number_density;
-                break;
-            case subarctic:
-                *values = summer ? subarctic_summer_ch4_number_density : subarctic_winter_ch4_number_density;
-                break;
-        }
+        set_profiles(values, tropic_ch4_number_density, midlat_summer_ch4_number_density,
+                     midlat_winter_ch4_number_density, subarctic_summer_ch4_number_density,
+                     subarctic_winter_ch4_number_density);
     }
     else if (strcmp(name, "CO_number_density") == 0)
     {
-        switch (band)
-        {
-            case tropic:
-                *values = tropic_co_number_density;
-                break;
-            case midlat:
-                *values = summer ? midlat_summer_co_number_density : midlat_winter_co_number_density;
-                break;
-            case subarctic:
-                *values = summer ? subarctic_summer_co_number_density : subarctic_winter_co_number_density;
-                break;
-        }
+        set_profiles(values, tropic_co_number_density, midlat_summer_co_number_density,
+                     midlat_winter_co_number_density, subarctic_summer_co_number_density,
+                     subarctic_winter_co_number_density);
     }
     else if (strcmp(name, "CO2_number_density") == 0)
     {
-        switch (band)
-        {
-            case tropic:
-                *values = tropic_co2_number_density;
-                break;
-            case midlat:
-                *values = summer ? midlat_summer_co2_number_density : midlat_winter_co2_number_density;
-                break;
-            case subarctic:
-                *values = summer ? subarctic_summer_co2_number_density : subarctic_winter_co2_number_density;
-                break;
-        }
+        set_profiles(values, tropic_co2_number_density, midlat_summer_co2_number_density,
+                     midlat_winter_co2_number_density, subarctic_summer_co2_number_density,
+                     subarctic_winter_co2_number_density);
     }
     else if (strcmp(name, "H2O_number_density") == 0)
     {
-        switch (band)
-        {
-            case tropic:
-                *values = tropic_h2o_number_density;
-                break;
-            case midlat:
-                *values = summer ? midlat_summer_h2o_number_density : midlat_winter_h2o_number_density;
-                break;
-            case subarctic:
-                *values = summer ? subarctic_summer_h2o_number_density : subarctic_winter_h2o_number_density;
-                break;
-        }
+        set_profiles(values, tropic_h2o_number_density, midlat_summer_h2o_number_density,
+                     midlat_winter_h2o_number_density, subarctic_summer_h2o_number_density,
+                     subarctic_winter_h2o_number_density);
     }
     else if (strcmp(name, "N2O_number_density") == 0)
     {
-        switch (band)
-        {
-            case tropic:
-                *values = tropic_n2o_number_density;
-                break;
-            case midlat:
-                *values = summer ? midlat_summer_n2o_number_density : midlat_winter_n2o_number_density;
-                break;
-            case subarctic:
-                *values = summer ? subarctic_summer_n2o_number_density : subarctic_winter_n2o_number_density;
-                break;
-        }
+        set_profiles(values, tropic_n2o_number_density, midlat_summer_n2o_number_density,
+                     midlat_winter_n2o_number_density, subarctic_summer_n2o_number_density,
+                     subarctic_winter_n2o_number_density);
     }
     else if (strcmp(name, "NO2_number_density") == 0)
     {
-        switch (band)
-        {
-            case tropic:
-                *values = tropic_no2_number_density;
-                break;
-            case midlat:
-                *values = summer ? midlat_summer_no2_number_density : midlat_winter_no2_number_density;
-                break;
-            case subarctic:
-                *values = summer ? subarctic_summer_no2_number_density : subarctic_winter_no2_number_density;
-                break;
-        }
+        set_profiles(values, tropic_no2_number_density, midlat_summer_no2_number_density,
+                     midlat_winter_no2_number_density, subarctic_summer_no2_number_density,
+                     subarctic_winter_no2_number_density);
     }
     else if (strcmp(name, "O2_number_density") == 0)
     {
-        switch (band)
-        {
-            case tropic:
-                *values = tropic_o2_number_density;
-                break;
-            case midlat:
-                *values = summer ? midlat_summer_o2_number_density : midlat_winter_o2_number_density;
-                break;
-            case subarctic:
-                *values = summer ? subarctic_summer_o2_number_density : subarctic_winter_o2_number_density;
-                break;
-        }
+        set_profiles(values, tropic_o2_number_density, midlat_summer_o2_number_density,
+                     midlat_winter_o2_number_density, subarctic_summer_o2_number_density,
+                     subarctic_winter_o2_number_density);
     }
     else if (strcmp(name, "O3_number_density") == 0)
     {
-        switch (band)
-        {
-            case tropic:
-                *values = tropic_o3_number_density;
-                break;
-            case midlat:
-                *values = summer ? midlat_summer_o3_number_density : midlat_winter_o3_number_density;
-                break;
-            case subarctic:
-                *values = summer ? subarctic_summer_o3_number_density : subarctic_winter_o3_number_density;
-                break;
-        }
+        set_profiles(values, tropic_o3_number_density, midlat_summer_o3_number_density,
+                     midlat_winter_o3_number_density, subarctic_summer_o3_number_density,
+                     subarctic_winter_o3_number_density);
     }
     else
     {
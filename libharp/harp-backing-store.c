@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2015-2024 S[&]T, The Netherlands.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "harp-internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(HAVE_MMAP) && defined(HAVE_UNISTD_H)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+#define HARP_USE_BACKING_STORE 1
+#endif
+
+/* Variable data is allocated on the heap until the total amount of variable data on the heap would exceed the memory
+ * limit (see harp_set_option_memory_limit()). From then on, new (and growing) data blocks are stored in memory mapped
+ * temporary files, which the operating system can page in and out as needed.
+ * Small blocks are always kept on the heap.
+ */
+
+/* minimum size (in bytes) of a data block before we consider moving it to a temporary file */
+#define BACKING_STORE_MIN_BLOCK_SIZE 65536
+
+#ifdef HARP_USE_BACKING_STORE
+typedef struct mapped_block_struct
+{
+    void *ptr;
+    size_t size;
+} mapped_block;
+
+static mapped_block *mapped_block_list = NULL;
+static long num_mapped_blocks = 0;
+#endif
+
+/* total amount of variable data (in bytes) that is currently allocated on the heap */
+static size_t heap_size = 0;
+
+/* cumulative amount of variable data (in bytes) that was allocated/released (used for profiling) */
+static uint64_t total_bytes_allocated = 0;
+static uint64_t total_bytes_freed = 0;
+
+#ifdef HARP_USE_BACKING_STORE
+static long find_mapped_block(const void *ptr)
+{
+    long i;
+
+    for (i = num_mapped_blocks - 1; i >= 0; i--)
+    {
+        if (mapped_block_list[i].ptr == ptr)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void *mapped_block_new(size_t size)
+{
+    char path[HARP_MAX_PATH_LENGTH];
+    const char *tmpdir;
+    void *ptr;
+    int fd;
+
+    if (num_mapped_blocks % BLOCK_SIZE == 0)
+    {
+        mapped_block *new_list;
+
+        new_list = realloc(mapped_block_list, (num_mapped_blocks + BLOCK_SIZE) * sizeof(mapped_block));
+        if (new_list == NULL)
+        {
+            return NULL;
+        }
+        mapped_block_list = new_list;
+    }
+
+    tmpdir = getenv("TMPDIR");
+    if (tmpdir == NULL || tmpdir[0] == '\0')
+    {
+        tmpdir = "/tmp";
+    }
+    if (strlen(tmpdir) + 13 >= HARP_MAX_PATH_LENGTH)
+    {
+        return NULL;
+    }
+    sprintf(path, "%s/harp-XXXXXX", tmpdir);
+
+    fd = mkstemp(path);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    /* the file is removed as soon as the mapping is gone */
+    unlink(path);
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    mapped_block_list[num_mapped_blocks].ptr = ptr;
+    mapped_block_list[num_mapped_blocks].size = size;
+    num_mapped_blocks++;
+
+    return ptr;
+}
+
+static void mapped_block_delete(long index)
+{
+    munmap(mapped_block_list[index].ptr, mapped_block_list[index].size);
+    num_mapped_blocks--;
+    mapped_block_list[index] = mapped_block_list[num_mapped_blocks];
+    if (num_mapped_blocks == 0)
+    {
+        free(mapped_block_list);
+        mapped_block_list = NULL;
+    }
+}
+
+/* determine whether a new block of \a size bytes should be stored in a temporary file
+ * (\a released is the amount of heap memory that gets released when the new block is created) */
+static int use_backing_store(size_t size, size_t released)
+{
+    size_t limit;
+
+    if (harp_option_memory_limit <= 0 || size < BACKING_STORE_MIN_BLOCK_SIZE)
+    {
+        return 0;
+    }
+    limit = (size_t)harp_option_memory_limit * 1024 * 1024;
+
+    return heap_size - (heap_size < released ? heap_size : released) + size > limit;
+}
+#endif
+
+static void *data_alloc(size_t size, int zero)
+{
+    void *ptr;
+
+#ifdef HARP_USE_BACKING_STORE
+    if (use_backing_store(size, 0))
+    {
+        /* a new temporary file is zero filled */
+        ptr = mapped_block_new(size);
+        if (ptr != NULL)
+        {
+            return ptr;
+        }
+        /* fall back to the heap if we can't create a temporary file */
+    }
+#endif
+    ptr = malloc(size);
+    if (ptr != NULL)
+    {
+        if (zero)
+        {
+            memset(ptr, 0, size);
+        }
+        heap_size += size;
+    }
+
+    return ptr;
+}
+
+static void data_free(void *ptr, size_t size)
+{
+#ifdef HARP_USE_BACKING_STORE
+    if (num_mapped_blocks > 0)
+    {
+        long index = find_mapped_block(ptr);
+
+        if (index >= 0)
+        {
+            mapped_block_delete(index);
+            return;
+        }
+    }
+#endif
+
+    free(ptr);
+    heap_size -= (heap_size < size ? heap_size : size);
+}
+
+/* Allocate a block of memory for variable data.
+ * Memory allocated with this function should be released using harp_data_free() (or resized using
+ * harp_data_realloc()). Returns NULL if the memory could not be allocated (no error is set).
+ */
+void *harp_data_malloc(size_t size)
+{
+    void *ptr;
+
+    ptr = data_alloc(size, 0);
+    if (ptr != NULL)
+    {
+        total_bytes_allocated += size;
+    }
+
+    return ptr;
+}
+
+/* Same as harp_data_malloc(), but initializes the memory to zero. */
+void *harp_data_calloc(size_t size)
+{
+    void *ptr;
+
+    ptr = data_alloc(size, 1);
+    if (ptr != NULL)
+    {
+        total_bytes_allocated += size;
+    }
+
+    return ptr;
+}
+
+/* Resize a block of variable data from \a old_size to \a new_size bytes (similar to realloc()).
+ * The content of the block up to the smallest of the two sizes is retained.
+ * Returns NULL if the memory could not be allocated (the original block is then left untouched and no error is set).
+ */
+void *harp_data_realloc(void *ptr, size_t old_size, size_t new_size)
+{
+    void *new_ptr;
+
+    if (ptr == NULL)
+    {
+        return harp_data_malloc(new_size);
+    }
+
+    /* a resize is accounted for as a release of the old block and an allocation of the new block */
+#ifdef HARP_USE_BACKING_STORE
+    if (num_mapped_blocks > 0)
+    {
+        long index = find_mapped_block(ptr);
+
+        if (index >= 0)
+        {
+            if (new_size <= mapped_block_list[index].size)
+            {
+                /* keep the mapping when shrinking the block; unused pages will just not be touched anymore */
+                total_bytes_allocated += new_size;
+                total_bytes_freed += old_size;
+                return ptr;
+            }
+            new_ptr = data_alloc(new_size, 0);
+            if (new_ptr == NULL)
+            {
+                return NULL;
+            }
+            memcpy(new_ptr, ptr, old_size);
+            mapped_block_delete(index);
+            total_bytes_allocated += new_size;
+            total_bytes_freed += old_size;
+            return new_ptr;
+        }
+    }
+    if (new_size > old_size && use_backing_store(new_size, old_size))
+    {
+        /* move the block out of the heap */
+        new_ptr = mapped_block_new(new_size);
+        if (new_ptr != NULL)
+        {
+            memcpy(new_ptr, ptr, old_size);
+            data_free(ptr, old_size);
+            total_bytes_allocated += new_size;
+            total_bytes_freed += old_size;
+            return new_ptr;
+        }
+    }
+#endif
+
+    new_ptr = realloc(ptr, new_size);
+    if (new_ptr != NULL)
+    {
+        heap_size = heap_size - (heap_size < old_size ? heap_size : old_size) + new_size;
+        total_bytes_allocated += new_size;
+        total_bytes_freed += old_size;
+    }
+
+    return new_ptr;
+}
+
+/* Release a block of variable data of \a size bytes that was allocated using harp_data_malloc(),
+ * harp_data_calloc() or harp_data_realloc().
+ */
+void harp_data_free(void *ptr, size_t size)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+    data_free(ptr, size);
+    total_bytes_freed += size;
+}
+
+/* Retrieve the cumulative amount of variable data (in bytes) that was allocated and released since the start of the
+ * program. Both the heap and the memory mapped temporary files are included.
+ */
+void harp_data_get_allocation_totals(uint64_t *bytes_allocated, uint64_t *bytes_freed)
+{
+    *bytes_allocated = total_bytes_allocated;
+    *bytes_freed = total_bytes_freed;
+}
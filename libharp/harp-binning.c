@@ -695,30 +695,60 @@ static void make_2d_polygon(long *num_elements, double *latitude, double *longit
     (*num_elements)++;
 }
 
-static int add_cell_index(long cell_index, long *cumsum_index, long **latlon_cell_index, double **latlon_weight)
+/* make sure the latlon_cell_index and latlon_weight arrays can hold 'num_cells' entries */
+static int reserve_cell_indices(long num_cells, long *capacity, long **latlon_cell_index, double **latlon_weight)
 {
-    if ((*cumsum_index) % LATLON_BLOCK_SIZE == 0)
+    long new_capacity;
+
+    if (num_cells <= *capacity)
+    {
+        return 0;
+    }
+
+    /* grow geometrically to keep the amount of copying linear in the final size */
+    new_capacity = *capacity < LATLON_BLOCK_SIZE ? LATLON_BLOCK_SIZE : 2 * (*capacity);
+    while (new_capacity < num_cells)
+    {
+        new_capacity *= 2;
+    }
+    if (latlon_cell_index != NULL)
     {
         long *new_latlon_cell_index;
-        double *new_latlon_weight;
 
-        new_latlon_cell_index = realloc(*latlon_cell_index, ((*cumsum_index) + LATLON_BLOCK_SIZE) * sizeof(long));
+        new_latlon_cell_index = realloc(*latlon_cell_index, new_capacity * sizeof(long));
         if (new_latlon_cell_index == NULL)
         {
             harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                           ((*cumsum_index) + LATLON_BLOCK_SIZE) * sizeof(long), __FILE__, __LINE__);
+                           new_capacity * sizeof(long), __FILE__, __LINE__);
             return -1;
         }
         *latlon_cell_index = new_latlon_cell_index;
-        new_latlon_weight = realloc(*latlon_weight, ((*cumsum_index) + LATLON_BLOCK_SIZE) * sizeof(double));
+    }
+    if (latlon_weight != NULL)
+    {
+        double *new_latlon_weight;
+
+        new_latlon_weight = realloc(*latlon_weight, new_capacity * sizeof(double));
         if (new_latlon_weight == NULL)
         {
             harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                           ((*cumsum_index) + LATLON_BLOCK_SIZE) * sizeof(double), __FILE__, __LINE__);
+                           new_capacity * sizeof(double), __FILE__, __LINE__);
             return -1;
         }
         *latlon_weight = new_latlon_weight;
     }
+    *capacity = new_capacity;
+
+    return 0;
+}
+
+static int add_cell_index(long cell_index, long *cumsum_index, long *capacity, long **latlon_cell_index,
+                          double **latlon_weight)
+{
+    if (reserve_cell_indices((*cumsum_index) + 1, capacity, latlon_cell_index, latlon_weight) != 0)
+    {
+        return -1;
+    }
     (*latlon_cell_index)[(*cumsum_index)] = cell_index;
     (*latlon_weight)[(*cumsum_index)] = 1.0;    /* initialize with default weight */
     (*cumsum_index)++;
@@ -726,6 +756,14 @@ static int add_cell_index(long cell_index, long *cumsum_index, long **latlon_cel
     return 0;
 }
 
+static int compare_long(const void *a, const void *b)
+{
+    long value_a = *(const long *)a;
+    long value_b = *(const long *)b;
+
+    return (value_a > value_b) - (value_a < value_b);
+}
+
 /* latitude_edges and longitude_edges should contain just 2 elements (bounds of the cell) */
 static double find_weight_for_polygon_and_cell(long num_points, double *poly_latitude, double *poly_longitude,
                                                double *temp_latitude, double *temp_longitude,
@@ -897,7 +935,10 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
     long num_longitude_cells = num_longitude_edges - 1;
     long *min_lat_id = NULL, *max_lat_id = NULL;        /* min/max grid latitude index for each longitude grid row */
     long *min_lon_id = NULL, *max_lon_id = NULL;        /* min/max grid longitude index for each latitude grid row */
+    long *boundary_cell_index = NULL;   /* sorted cell indices of the partially covered cells of a polygon */
+    long boundary_capacity = 0;
     long cumsum_index = 0;
+    long capacity = 0;
     long num_elements;
     long max_num_vertices;
     long i, j, k;
@@ -974,6 +1015,23 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
                        (num_latitude_cells + 2) * sizeof(long), __FILE__, __LINE__);
         goto error;
     }
+    /* the min/max arrays are only reset for the rows/columns that a polygon touched (see below) */
+    for (j = 0; j < num_longitude_cells + 2; j++)
+    {
+        min_lat_id[j] = num_latitude_cells;
+        max_lat_id[j] = -1;
+    }
+    for (j = 0; j < num_latitude_cells + 2; j++)
+    {
+        min_lon_id[j] = num_longitude_cells;
+        max_lon_id[j] = -1;
+    }
+
+    /* pre-size the output for (at least) one cell per polygon */
+    if (reserve_cell_indices(num_elements, &capacity, latlon_cell_index, latlon_weight) != 0)
+    {
+        goto error;
+    }
 
     for (i = 0; i < num_elements; i++)
     {
@@ -1037,7 +1095,9 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
         {
             long lat_id = -1, lon_id = -1;
             long next_lat_id, next_lon_id;
+            long first_lat_id, last_lat_id, first_lon_id, last_lon_id;
             long cumsum_offset = cumsum_index;
+            long num_boundary_cells;
 
             if (loop == 1)
             {
@@ -1054,17 +1114,6 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
                 continue;
             }
 
-            for (j = 0; j < num_longitude_cells + 2; j++)
-            {
-                min_lat_id[j] = num_latitude_cells;
-                max_lat_id[j] = -1;
-            }
-            for (j = 0; j < num_latitude_cells + 2; j++)
-            {
-                min_lon_id[j] = num_longitude_cells;
-                max_lon_id[j] = -1;
-            }
-
             /* iterate over all line segments and determine which grid cells are crossed */
             /* we initially add each crossing cell with weight 1 */
             harp_interpolate_find_index(num_latitude_edges, latitude_edges, poly_latitude[0], &lat_id);
@@ -1079,6 +1128,12 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
             }
             next_lat_id = lat_id;
             next_lon_id = lon_id;
+            /* the cells crossed by a line segment lie between the cells of its end points, so the range of cells
+             * that the polygon touches is given by the range of cells of its vertices */
+            first_lat_id = lat_id;
+            last_lat_id = lat_id;
+            first_lon_id = lon_id;
+            last_lon_id = lon_id;
             /* add cell of starting point (if it falls within the grid) */
             if (lon_id >= 0 && lon_id < num_longitude_cells && lat_id >= 0 && lat_id < num_latitude_cells)
             {
@@ -1086,8 +1141,8 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
                     lat_id < min_lat_id[lon_id + 1] || lat_id > max_lat_id[lon_id + 1])
                 {
                     num_latlon_index[i]++;
-                    if (add_cell_index(lat_id * num_longitude_cells + lon_id, &cumsum_index, latlon_cell_index,
-                                       latlon_weight) != 0)
+                    if (add_cell_index(lat_id * num_longitude_cells + lon_id, &cumsum_index, &capacity,
+                                       latlon_cell_index, latlon_weight) != 0)
                     {
                         goto error;
                     }
@@ -1127,6 +1182,22 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
                 {
                     next_lon_id = num_longitude_cells;
                 }
+                if (next_lat_id < first_lat_id)
+                {
+                    first_lat_id = next_lat_id;
+                }
+                else if (next_lat_id > last_lat_id)
+                {
+                    last_lat_id = next_lat_id;
+                }
+                if (next_lon_id < first_lon_id)
+                {
+                    first_lon_id = next_lon_id;
+                }
+                else if (next_lon_id > last_lon_id)
+                {
+                    last_lon_id = next_lon_id;
+                }
                 while (lat_id != next_lat_id || lon_id != next_lon_id)
                 {
                     /* determine intermediate cells that the line segment crosses */
@@ -1212,8 +1283,8 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
                             lat_id < min_lat_id[lon_id + 1] || lat_id > max_lat_id[lon_id + 1])
                         {
                             num_latlon_index[i]++;
-                            if (add_cell_index(lat_id * num_longitude_cells + lon_id, &cumsum_index, latlon_cell_index,
-                                               latlon_weight) != 0)
+                            if (add_cell_index(lat_id * num_longitude_cells + lon_id, &cumsum_index, &capacity,
+                                               latlon_cell_index, latlon_weight) != 0)
                             {
                                 goto error;
                             }
@@ -1249,8 +1320,32 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
                                                                        &longitude_edges[lon_id]);
             }
 
+            /* keep a sorted copy of the partially covered cells, so we can quickly check whether a cell was already
+             * added when adding the cells that lie fully within the polygon */
+            num_boundary_cells = cumsum_index - cumsum_offset;
+            if (num_boundary_cells > boundary_capacity)
+            {
+                long *new_boundary_cell_index;
+
+                new_boundary_cell_index = realloc(boundary_cell_index, 2 * num_boundary_cells * sizeof(long));
+                if (new_boundary_cell_index == NULL)
+                {
+                    harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                                   2 * num_boundary_cells * sizeof(long), __FILE__, __LINE__);
+                    goto error;
+                }
+                boundary_cell_index = new_boundary_cell_index;
+                boundary_capacity = 2 * num_boundary_cells;
+            }
+            if (num_boundary_cells > 0)
+            {
+                memcpy(boundary_cell_index, &(*latlon_cell_index)[cumsum_offset], num_boundary_cells * sizeof(long));
+                qsort(boundary_cell_index, num_boundary_cells, sizeof(long), compare_long);
+            }
+
             /* add all grid cells that lie fully within the polygon */
-            for (j = 0; j < num_latitude_cells; j++)
+            /* only the rows that the polygon touched can contain such cells */
+            for (j = first_lat_id < 0 ? 0 : first_lat_id; j <= last_lat_id && j < num_latitude_cells; j++)
             {
                 if (min_lon_id[j + 1] < max_lon_id[j + 1])
                 {
@@ -1260,21 +1355,15 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
 
                         if (j > min_lat_id[k + 1] && j < max_lat_id[k + 1])
                         {
-                            long l;
-
                             /* check if this cell wasn't already added due to a partial overlap */
-                            for (l = cumsum_offset; l < cumsum_index; l++)
-                            {
-                                if (cell_index == (*latlon_cell_index)[l])
-                                {
-                                    break;
-                                }
-                            }
-                            if (l == cumsum_index)
+                            if (num_boundary_cells == 0 ||
+                                bsearch(&cell_index, boundary_cell_index, num_boundary_cells, sizeof(long),
+                                        compare_long) == NULL)
                             {
                                 /* add cell with full weight */
                                 num_latlon_index[i]++;
-                                if (add_cell_index(cell_index, &cumsum_index, latlon_cell_index, latlon_weight) != 0)
+                                if (add_cell_index(cell_index, &cumsum_index, &capacity, latlon_cell_index,
+                                                   latlon_weight) != 0)
                                 {
                                     goto error;
                                 }
@@ -1287,6 +1376,18 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
                     }
                 }
             }
+
+            /* reset the min/max arrays for the rows/columns that the polygon touched */
+            for (j = first_lat_id + 1; j <= last_lat_id + 1; j++)
+            {
+                min_lon_id[j] = num_longitude_cells;
+                max_lon_id[j] = -1;
+            }
+            for (j = first_lon_id + 1; j <= last_lon_id + 1; j++)
+            {
+                min_lat_id[j] = num_latitude_cells;
+                max_lat_id[j] = -1;
+            }
         }
     }
 
@@ -1298,6 +1399,10 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
     free(max_lat_id);
     free(min_lon_id);
     free(max_lon_id);
+    if (boundary_cell_index != NULL)
+    {
+        free(boundary_cell_index);
+    }
 
     return 0;
 
@@ -1334,6 +1439,10 @@ static int find_matching_cells_and_weights_for_bounds(harp_variable *latitude_bo
     {
         free(max_lon_id);
     }
+    if (boundary_cell_index != NULL)
+    {
+        free(boundary_cell_index);
+    }
 
     return -1;
 }
@@ -1349,6 +1458,17 @@ static int find_matching_cells_for_points(harp_variable *latitude, harp_variable
     long i;
 
     num_elements = latitude->dimension[0];
+    if (num_elements > 0)
+    {
+        /* each point matches at most one cell */
+        *latlon_cell_index = malloc(num_elements * sizeof(long));
+        if (*latlon_cell_index == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           num_elements * sizeof(long), __FILE__, __LINE__);
+            return -1;
+        }
+    }
     for (i = 0; i < num_elements; i++)
     {
         double wrapped_longitude;
@@ -1367,21 +1487,121 @@ static int find_matching_cells_for_points(harp_variable *latitude, harp_variable
             continue;
         }
         num_latlon_index[i] = 1;
-        if (cumsum_index % LATLON_BLOCK_SIZE == 0)
+        (*latlon_cell_index)[cumsum_index] = latitude_index * (num_longitude_edges - 1) + longitude_index;
+        cumsum_index++;
+    }
+
+    return 0;
+}
+
+static int check_spatial_edges(long num_latitude_edges, const double *latitude_edges, long num_longitude_edges,
+                               const double *longitude_edges)
+{
+    long i;
+
+    if (num_latitude_edges < 2)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "need at least 2 latitude edges to perform spatial binning");
+        return -1;
+    }
+    if (num_longitude_edges < 2)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "need at least 2 longitude edges to perform spatial binning");
+        return -1;
+    }
+    for (i = 0; i < num_latitude_edges; i++)
+    {
+        if (latitude_edges[i] < -90.0 || latitude_edges[i] > 90.0)
+        {
+            harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "latitude edge value (%lf) needs to be in the range [-90,90] "
+                           "for spatial binning", latitude_edges[i]);
+            return -1;
+        }
+    }
+    for (i = 1; i < num_latitude_edges; i++)
+    {
+        if (latitude_edges[i] <= latitude_edges[i - 1])
+        {
+            harp_set_error(HARP_ERROR_INVALID_ARGUMENT,
+                           "latitude edge values need to be in strict ascending order for spatial binning");
+            return -1;
+        }
+    }
+    for (i = 1; i < num_longitude_edges; i++)
+    {
+        if (longitude_edges[i] <= longitude_edges[i - 1])
         {
-            long *new_latlon_cell_index;
+            harp_set_error(HARP_ERROR_INVALID_ARGUMENT,
+                           "longitude edge values need to be in strict ascending order for spatial binning");
+            return -1;
+        }
+    }
+    if (longitude_edges[num_longitude_edges - 1] - longitude_edges[0] > 360)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "longitude edge range (%lf .. %lf) cannot exceed 360 degrees",
+                       latitude_edges[0], longitude_edges[num_longitude_edges - 1]);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* determine the matching lat/lon grid cells (and weights in case of area binning) for each time sample of a product */
+static int find_matching_cells_for_product(harp_product *product, long num_latitude_edges, double *latitude_edges,
+                                           long num_longitude_edges, double *longitude_edges, int *area_binning,
+                                           long *num_latlon_index, long **latlon_cell_index, double **latlon_weight)
+{
+    harp_data_type data_type = harp_type_double;
+    harp_dimension_type dimension_type[2];
+    harp_variable *latitude = NULL;
+    harp_variable *longitude = NULL;
 
-            new_latlon_cell_index = realloc(*latlon_cell_index, (cumsum_index + LATLON_BLOCK_SIZE) * sizeof(long));
-            if (new_latlon_cell_index == NULL)
+    *area_binning = 0;
+
+    dimension_type[0] = harp_dimension_time;
+    dimension_type[1] = harp_dimension_independent;
+    if (harp_product_get_derived_variable(product, "latitude_bounds", &data_type, "degree_north", 2, dimension_type,
+                                          &latitude) == 0)
+    {
+        if (harp_product_get_derived_variable(product, "longitude_bounds", &data_type, "degree_east", 2, dimension_type,
+                                              &longitude) == 0)
+        {
+            *area_binning = 1;
+            /* determine matching cells and weighting factors */
+            if (find_matching_cells_and_weights_for_bounds(latitude, longitude, num_latitude_edges, latitude_edges,
+                                                           num_longitude_edges, longitude_edges, num_latlon_index,
+                                                           latlon_cell_index, latlon_weight) != 0)
             {
-                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                               (cumsum_index + LATLON_BLOCK_SIZE) * sizeof(long), __FILE__, __LINE__);
+                harp_variable_delete(latitude);
+                harp_variable_delete(longitude);
                 return -1;
             }
-            *latlon_cell_index = new_latlon_cell_index;
+            harp_variable_delete(longitude);
         }
-        (*latlon_cell_index)[cumsum_index] = latitude_index * (num_longitude_edges - 1) + longitude_index;
-        cumsum_index++;
+        harp_variable_delete(latitude);
+    }
+    if (!*area_binning)
+    {
+        if (harp_product_get_derived_variable(product, "latitude", &data_type, "degree_north", 1, dimension_type,
+                                              &latitude) != 0)
+        {
+            return -1;
+        }
+        if (harp_product_get_derived_variable(product, "longitude", &data_type, "degree_east", 1, dimension_type,
+                                              &longitude) != 0)
+        {
+            harp_variable_delete(latitude);
+            return -1;
+        }
+        if (find_matching_cells_for_points(latitude, longitude, num_latitude_edges, latitude_edges, num_longitude_edges,
+                                           longitude_edges, num_latlon_index, latlon_cell_index) != 0)
+        {
+            harp_variable_delete(latitude);
+            harp_variable_delete(longitude);
+            return -1;
+        }
+        harp_variable_delete(latitude);
+        harp_variable_delete(longitude);
     }
 
     return 0;
@@ -1439,6 +1659,7 @@ LIBHARP_API int harp_product_bin(harp_product *product, long num_bins, long num_
     int32_t *count = NULL;
     float *weight = NULL;
     long *index = NULL;
+    harp_rearrange_plan *plan = NULL;
     long i, j, k;
     int result;
 
@@ -1873,7 +2094,7 @@ LIBHARP_API int harp_product_bin(harp_product *product, long num_bins, long num_
         }
     }
 
-    /* resample variables */
+    /* resample variables (all variables share the same resampling of the time dimension) */
     for (k = 0; k < product->num_variables; k++)
     {
         if (bintype[k] == binning_skip || bintype[k] == binning_remove)
@@ -1881,13 +2102,26 @@ LIBHARP_API int harp_product_bin(harp_product *product, long num_bins, long num_
             continue;
         }
 
+        if (plan == NULL)
+        {
+            if (harp_rearrange_plan_new(num_elements, num_bins, index, &plan) != 0)
+            {
+                goto error;
+            }
+        }
+
         /* resample the time dimension to the target bins */
         /* this uses the first sample for empty bins, but we invalidate these bins later */
-        if (harp_variable_rearrange_dimension(product->variable[k], 0, num_bins, index) != 0)
+        if (harp_variable_rearrange_dimension_with_plan(product->variable[k], 0, plan) != 0)
         {
             goto error;
         }
     }
+    if (plan != NULL)
+    {
+        harp_rearrange_plan_delete(plan);
+        plan = NULL;
+    }
 
     /* set all empty bins to NaN (for double) or 0 (for int32/float count/weight) */
     for (k = 0; k < product->num_variables; k++)
@@ -2094,6 +2328,10 @@ LIBHARP_API int harp_product_bin(harp_product *product, long num_bins, long num_
     {
         free(index);
     }
+    if (plan != NULL)
+    {
+        harp_rearrange_plan_delete(plan);
+    }
     return -1;
 }
 
@@ -2162,7 +2400,6 @@ LIBHARP_API int harp_product_bin_spatial(harp_product *product, long num_time_bi
                                          long num_longitude_edges, double *longitude_edges)
 {
     long spatial_block_length = (num_latitude_edges - 1) * (num_longitude_edges - 1);
-    harp_data_type data_type = harp_type_double;
     harp_dimension_type dimension_type[HARP_MAX_NUM_DIMS];
     long dimension[HARP_MAX_NUM_DIMS];
     harp_variable *latitude = NULL;
@@ -2204,51 +2441,11 @@ LIBHARP_API int harp_product_bin_spatial(harp_product *product, long num_time_bi
         }
     }
 
-    if (num_latitude_edges < 2)
-    {
-        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "need at least 2 latitude edges to perform spatial binning");
-        return -1;
-    }
-    if (num_longitude_edges < 2)
-    {
-        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "need at least 2 longitude edges to perform spatial binning");
-        return -1;
-    }
-    for (i = 0; i < num_latitude_edges; i++)
-    {
-        if (latitude_edges[i] < -90.0 || latitude_edges[i] > 90.0)
-        {
-            harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "latitude edge value (%lf) needs to be in the range [-90,90] "
-                           "for spatial binning", latitude_edges[i]);
-            return -1;
-        }
-    }
-    for (i = 1; i < num_latitude_edges; i++)
-    {
-        if (latitude_edges[i] <= latitude_edges[i - 1])
-        {
-            harp_set_error(HARP_ERROR_INVALID_ARGUMENT,
-                           "latitude edge values need to be in strict ascending order for spatial binning");
-            return -1;
-        }
-    }
-    for (i = 1; i < num_longitude_edges; i++)
-    {
-        if (longitude_edges[i] <= longitude_edges[i - 1])
-        {
-            harp_set_error(HARP_ERROR_INVALID_ARGUMENT,
-                           "longitude edge values need to be in strict ascending order for spatial binning");
-            return -1;
-        }
-    }
-    if (longitude_edges[num_longitude_edges - 1] - longitude_edges[0] > 360)
+    if (check_spatial_edges(num_latitude_edges, latitude_edges, num_longitude_edges, longitude_edges) != 0)
     {
-        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "longitude edge range (%lf .. %lf) cannot exceed 360 degrees",
-                       latitude_edges[0], longitude_edges[num_longitude_edges - 1]);
         return -1;
     }
 
-
     num_latlon_index = malloc(num_time_elements * sizeof(long));
     if (num_latlon_index == NULL)
     {
@@ -2257,49 +2454,11 @@ LIBHARP_API int harp_product_bin_spatial(harp_product *product, long num_time_bi
         goto error;
     }
 
-    dimension_type[0] = harp_dimension_time;
-    dimension_type[1] = harp_dimension_independent;
-    if (harp_product_get_derived_variable(product, "latitude_bounds", &data_type, "degree_north", 2, dimension_type,
-                                          &latitude) == 0)
+    if (find_matching_cells_for_product(product, num_latitude_edges, latitude_edges, num_longitude_edges,
+                                        longitude_edges, &area_binning, num_latlon_index, &latlon_cell_index,
+                                        &latlon_weight) != 0)
     {
-        if (harp_product_get_derived_variable(product, "longitude_bounds", &data_type, "degree_east", 2, dimension_type,
-                                              &longitude) == 0)
-        {
-            area_binning = 1;
-            /* determine matching cells and weighting factors */
-            if (find_matching_cells_and_weights_for_bounds(latitude, longitude, num_latitude_edges, latitude_edges,
-                                                           num_longitude_edges, longitude_edges, num_latlon_index,
-                                                           &latlon_cell_index, &latlon_weight) != 0)
-            {
-                harp_variable_delete(latitude);
-                harp_variable_delete(longitude);
-                goto error;
-            }
-            harp_variable_delete(longitude);
-        }
-        harp_variable_delete(latitude);
-    }
-    if (!area_binning)
-    {
-        if (harp_product_get_derived_variable(product, "latitude", &data_type, "degree_north", 1, dimension_type,
-                                              &latitude) != 0)
-        {
-            goto error;
-        }
-        if (harp_product_get_derived_variable(product, "longitude", &data_type, "degree_east", 1, dimension_type,
-                                              &longitude) != 0)
-        {
-            goto error;
-        }
-        if (find_matching_cells_for_points(latitude, longitude, num_latitude_edges, latitude_edges, num_longitude_edges,
-                                           longitude_edges, num_latlon_index, &latlon_cell_index) != 0)
-        {
-            harp_variable_delete(latitude);
-            harp_variable_delete(longitude);
-            goto error;
-        }
-        harp_variable_delete(latitude);
-        harp_variable_delete(longitude);
+        goto error;
     }
 
     /* make 'bintype' big enough to also store any count/weight variables that we may want to add (i.e. 2 + factor 2) */
@@ -2927,10 +3086,9 @@ int harp_product_bin_with_collocated_dataset(harp_product *product, harp_colloca
     {
         for (j = 0; j < num_bins; j++)
         {
-            if (filtered_collocation_result->pair[index[j]]->product_index_b ==
-                filtered_collocation_result->pair[i]->product_index_b &&
-                filtered_collocation_result->pair[index[j]]->sample_index_b ==
-                filtered_collocation_result->pair[i]->sample_index_b)
+            if (filtered_collocation_result->product_index_b[index[j]] ==
+                filtered_collocation_result->product_index_b[i] &&
+                filtered_collocation_result->sample_index_b[index[j]] == filtered_collocation_result->sample_index_b[i])
             {
                 break;
             }
@@ -2984,6 +3142,193 @@ int harp_product_bin_with_collocated_dataset(harp_product *product, harp_colloca
     return 0;
 }
 
+/* hash value for a sample, based on the combination of values of the binning variables for that sample
+ * NaN values all get the same hash and -0.0 gets the same hash as 0.0 (consistent with bin_samples_are_equal())
+ */
+static uint64_t bin_sample_hash(int num_variables, harp_variable **variable, long i)
+{
+    uint64_t hash = 0;
+    int k;
+
+    for (k = 0; k < num_variables; k++)
+    {
+        uint64_t value = 0;
+
+        switch (variable[k]->data_type)
+        {
+            case harp_type_int8:
+                value = (uint64_t)(int64_t)variable[k]->data.int8_data[i];
+                break;
+            case harp_type_int16:
+                value = (uint64_t)(int64_t)variable[k]->data.int16_data[i];
+                break;
+            case harp_type_int32:
+                value = (uint64_t)(int64_t)variable[k]->data.int32_data[i];
+                break;
+            case harp_type_float:
+            case harp_type_double:
+                {
+                    double double_value;
+
+                    if (variable[k]->data_type == harp_type_float)
+                    {
+                        double_value = variable[k]->data.float_data[i];
+                    }
+                    else
+                    {
+                        double_value = variable[k]->data.double_data[i];
+                    }
+                    if (harp_isnan(double_value))
+                    {
+                        value = 0x7FF8000000000000;
+                    }
+                    else
+                    {
+                        /* adding 0.0 turns -0.0 into 0.0 */
+                        double_value += 0.0;
+                        memcpy(&value, &double_value, sizeof(double));
+                    }
+                }
+                break;
+            case harp_type_string:
+                {
+                    const unsigned char *c = (unsigned char *)variable[k]->data.string_data[i];
+
+                    if (c == NULL)
+                    {
+                        value = 0xFFFFFFFFFFFFFFFF;
+                    }
+                    else
+                    {
+                        while (*c != '\0')
+                        {
+                            /* we use value = value * 1000003 ^ char */
+                            value = (value * 0xF4243) ^ *c++;
+                        }
+                    }
+                }
+                break;
+        }
+        hash = (hash ^ value) * 0x9E3779B97F4A7C15;
+        hash ^= hash >> 29;
+    }
+
+    return hash;
+}
+
+/* returns whether samples a and b have the same combination of values for all binning variables */
+static int bin_samples_are_equal(int num_variables, harp_variable **variable, long a, long b)
+{
+    int k;
+
+    for (k = 0; k < num_variables; k++)
+    {
+        switch (variable[k]->data_type)
+        {
+            case harp_type_int8:
+                if (variable[k]->data.int8_data[a] != variable[k]->data.int8_data[b])
+                {
+                    return 0;
+                }
+                break;
+            case harp_type_int16:
+                if (variable[k]->data.int16_data[a] != variable[k]->data.int16_data[b])
+                {
+                    return 0;
+                }
+                break;
+            case harp_type_int32:
+                if (variable[k]->data.int32_data[a] != variable[k]->data.int32_data[b])
+                {
+                    return 0;
+                }
+                break;
+            case harp_type_float:
+                if (harp_isnan(variable[k]->data.float_data[a]) || harp_isnan(variable[k]->data.float_data[b]))
+                {
+                    if (!harp_isnan(variable[k]->data.float_data[a]) || !harp_isnan(variable[k]->data.float_data[b]))
+                    {
+                        return 0;
+                    }
+                }
+                else if (variable[k]->data.float_data[a] != variable[k]->data.float_data[b])
+                {
+                    return 0;
+                }
+                break;
+            case harp_type_double:
+                if (harp_isnan(variable[k]->data.double_data[a]) || harp_isnan(variable[k]->data.double_data[b]))
+                {
+                    if (!harp_isnan(variable[k]->data.double_data[a]) || !harp_isnan(variable[k]->data.double_data[b]))
+                    {
+                        return 0;
+                    }
+                }
+                else if (variable[k]->data.double_data[a] != variable[k]->data.double_data[b])
+                {
+                    return 0;
+                }
+                break;
+            case harp_type_string:
+                if (variable[k]->data.string_data[a] == NULL || variable[k]->data.string_data[b] == NULL)
+                {
+                    if (variable[k]->data.string_data[a] != variable[k]->data.string_data[b])
+                    {
+                        return 0;
+                    }
+                }
+                else if (strcmp(variable[k]->data.string_data[a], variable[k]->data.string_data[b]) != 0)
+                {
+                    return 0;
+                }
+                break;
+        }
+    }
+
+    return 1;
+}
+
+/* (re)create the open addressing table that maps a sample hash to a bin
+ * table entries contain the bin index or -1 for empty slots
+ */
+static int bin_table_resize(long **bin_table, long *table_size, long new_table_size, long num_bins,
+                            const uint64_t *bin_hash)
+{
+    long *new_bin_table;
+    long j;
+
+    new_bin_table = malloc(new_table_size * sizeof(long));
+    if (new_bin_table == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       new_table_size * sizeof(long), __FILE__, __LINE__);
+        return -1;
+    }
+    for (j = 0; j < new_table_size; j++)
+    {
+        new_bin_table[j] = -1;
+    }
+    for (j = 0; j < num_bins; j++)
+    {
+        long slot = (long)(bin_hash[j] & (uint64_t)(new_table_size - 1));
+
+        while (new_bin_table[slot] != -1)
+        {
+            slot = (slot + 1) & (new_table_size - 1);
+        }
+        new_bin_table[slot] = j;
+    }
+
+    if (*bin_table != NULL)
+    {
+        free(*bin_table);
+    }
+    *bin_table = new_bin_table;
+    *table_size = new_table_size;
+
+    return 0;
+}
+
 /** Bin the product's variables such that all samples that have the same combination of values from the given variables
  * are averaged together.
  *
@@ -2999,12 +3344,14 @@ int harp_product_bin_with_variable(harp_product *product, int num_variables, con
 {
     harp_variable **variable = NULL;
     harp_variable **variable_copy = NULL;
-    int *check_nan = NULL;
     long *index = NULL; /* contains index of first sample for each bin */
     long *bin_index = NULL;
+    uint64_t *bin_hash = NULL;  /* contains the hash of the first sample for each bin */
+    long *bin_table = NULL;
+    long table_size = 0;
     long num_elements;
     long num_bins;
-    long i, j, k;
+    long i, k;
 
     if (num_variables < 1)
     {
@@ -3063,104 +3410,61 @@ int harp_product_bin_with_variable(harp_product *product, int num_variables, con
         goto error;
     }
 
-    check_nan = malloc(num_variables * sizeof(int));
-    if (check_nan == NULL)
+    bin_hash = malloc(num_elements * sizeof(uint64_t));
+    if (bin_hash == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       num_variables * sizeof(int), __FILE__, __LINE__);
+                       num_elements * sizeof(uint64_t), __FILE__, __LINE__);
+        goto error;
+    }
+    if (bin_table_resize(&bin_table, &table_size, 1024, 0, bin_hash) != 0)
+    {
         goto error;
     }
 
+    /* group samples using a hash table on the combination of values; bins are numbered in order of first occurrence */
     num_bins = 0;
     for (i = 0; i < num_elements; i++)
     {
-        for (k = 0; k < num_variables; k++)
+        uint64_t hash = bin_sample_hash(num_variables, variable, i);
+        long slot = (long)(hash & (uint64_t)(table_size - 1));
+
+        while (bin_table[slot] != -1)
         {
-            check_nan[k] = 0;
-            if (variable[k]->data_type == harp_type_float)
-            {
-                check_nan[k] = harp_isnan(variable[k]->data.float_data[i]);
-            }
-            else if (variable[k]->data_type == harp_type_double)
+            long j = bin_table[slot];
+
+            if (bin_hash[j] == hash && bin_samples_are_equal(num_variables, variable, index[j], i))
             {
-                check_nan[k] = harp_isnan(variable[k]->data.double_data[i]);
+                break;
             }
+            slot = (slot + 1) & (table_size - 1);
         }
-        for (j = 0; j < num_bins; j++)
+        if (bin_table[slot] == -1)
         {
-            for (k = 0; k < num_variables; k++)
+            /* add new bin */
+            index[num_bins] = i;
+            bin_hash[num_bins] = hash;
+            bin_table[slot] = num_bins;
+            num_bins++;
+            if (2 * num_bins > table_size)
             {
-                int equal = 1;
-
-                switch (variable[k]->data_type)
-                {
-                    case harp_type_int8:
-                        equal = variable[k]->data.int8_data[index[j]] == variable[k]->data.int8_data[i];
-                        break;
-                    case harp_type_int16:
-                        equal = variable[k]->data.int16_data[index[j]] == variable[k]->data.int16_data[i];
-                        break;
-                    case harp_type_int32:
-                        equal = variable[k]->data.int32_data[index[j]] == variable[k]->data.int32_data[i];
-                        break;
-                    case harp_type_float:
-                        if (check_nan)
-                        {
-                            equal = harp_isnan(variable[k]->data.float_data[index[j]]);
-                        }
-                        else
-                        {
-                            equal = variable[k]->data.float_data[index[j]] == variable[k]->data.float_data[i];
-                        }
-                        break;
-                    case harp_type_double:
-                        if (check_nan)
-                        {
-                            equal = harp_isnan(variable[k]->data.double_data[index[j]]);
-                        }
-                        else
-                        {
-                            equal = variable[k]->data.double_data[index[j]] == variable[k]->data.double_data[i];
-                        }
-                        break;
-                    case harp_type_string:
-                        if (variable[k]->data.string_data[i] == NULL)
-                        {
-                            equal = variable[k]->data.string_data[index[j]] == NULL;
-                        }
-                        else if (variable[k]->data.string_data[index[j]] == NULL)
-                        {
-                            equal = 0;
-                        }
-                        else
-                        {
-                            equal = strcmp(variable[k]->data.string_data[index[j]],
-                                           variable[k]->data.string_data[i]) == 0;
-                        }
-                        break;
-                }
-                if (!equal)
+                if (bin_table_resize(&bin_table, &table_size, 2 * table_size, num_bins, bin_hash) != 0)
                 {
-                    break;
+                    goto error;
                 }
             }
-            if (k == num_variables)
-            {
-                /* equal bin */
-                break;
-            }
+            bin_index[i] = num_bins - 1;
         }
-        if (j == num_bins)
+        else
         {
-            /* add new value to bin */
-            index[num_bins] = i;
-            num_bins++;
+            bin_index[i] = bin_table[slot];
         }
-        bin_index[i] = j;
     }
 
-    free(check_nan);
-    check_nan = NULL;
+    free(bin_table);
+    bin_table = NULL;
+    free(bin_hash);
+    bin_hash = NULL;
 
     for (k = 0; k < num_variables; k++)
     {
@@ -3205,9 +3509,13 @@ int harp_product_bin_with_variable(harp_product *product, int num_variables, con
     return 0;
 
   error:
-    if (check_nan != NULL)
+    if (bin_table != NULL)
     {
-        free(check_nan);
+        free(bin_table);
+    }
+    if (bin_hash != NULL)
+    {
+        free(bin_hash);
     }
     if (index != NULL)
     {
@@ -3285,3 +3593,1122 @@ int harp_product_bin_spatial_full(harp_product *product, long num_latitude_edges
     free(bin_index);
     return 0;
 }
+
+/* persistent state for spatial binning of a sequence of products into a single time bin */
+struct harp_spatial_accumulator_struct
+{
+    long num_latitude_edges;
+    double *latitude_edges;
+    long num_longitude_edges;
+    double *longitude_edges;
+    int initialized;    /* set once the first (non-empty) product has been added */
+    char *history;      /* history of the first product */
+    long dimension[HARP_NUM_DIM_TYPES]; /* length of the non-spatial dimensions of the accumulated variables */
+    int num_variables;
+    binning_type *bintype;
+    harp_data_type *data_type;  /* original data type of each variable (from the first product) */
+    harp_variable **variable;   /* running sums [1,latitude,longitude,...] or running values [1] for datetime */
+    harp_variable **variable_weight;    /* running sum of weights per element of a running sum (NULL for datetime) */
+    int *store_weight_variable;
+    int32_t count;      /* number of contributing samples */
+    float *weight;      /* running sum of weights per latlon cell [num_latitude_edges-1, num_longitude_edges-1] */
+};
+
+/* remove all accumulated state (but keep the grid definition) */
+static void accumulator_clear(harp_spatial_accumulator *accumulator)
+{
+    int j;
+
+    if (accumulator->history != NULL)
+    {
+        free(accumulator->history);
+        accumulator->history = NULL;
+    }
+    if (accumulator->bintype != NULL)
+    {
+        free(accumulator->bintype);
+        accumulator->bintype = NULL;
+    }
+    if (accumulator->data_type != NULL)
+    {
+        free(accumulator->data_type);
+        accumulator->data_type = NULL;
+    }
+    if (accumulator->variable != NULL)
+    {
+        for (j = 0; j < accumulator->num_variables; j++)
+        {
+            harp_variable_delete(accumulator->variable[j]);
+        }
+        free(accumulator->variable);
+        accumulator->variable = NULL;
+    }
+    if (accumulator->variable_weight != NULL)
+    {
+        for (j = 0; j < accumulator->num_variables; j++)
+        {
+            harp_variable_delete(accumulator->variable_weight[j]);
+        }
+        free(accumulator->variable_weight);
+        accumulator->variable_weight = NULL;
+    }
+    if (accumulator->store_weight_variable != NULL)
+    {
+        free(accumulator->store_weight_variable);
+        accumulator->store_weight_variable = NULL;
+    }
+    if (accumulator->weight != NULL)
+    {
+        free(accumulator->weight);
+        accumulator->weight = NULL;
+    }
+    accumulator->num_variables = 0;
+    accumulator->count = 0;
+    accumulator->initialized = 0;
+}
+
+static int accumulator_get_variable_index(harp_spatial_accumulator *accumulator, const char *name)
+{
+    int j;
+
+    for (j = 0; j < accumulator->num_variables; j++)
+    {
+        if (strcmp(accumulator->variable[j]->name, name) == 0)
+        {
+            return j;
+        }
+    }
+
+    return -1;
+}
+
+/* resize a non-spatial dimension of all running sums; new elements do not contribute to any bin */
+static int accumulator_resize_dimension(harp_spatial_accumulator *accumulator, harp_dimension_type dimension_type,
+                                        long length)
+{
+    int j;
+
+    for (j = 0; j < accumulator->num_variables; j++)
+    {
+        harp_variable *variable = accumulator->variable[j];
+        harp_variable *weight_variable = accumulator->variable_weight[j];
+        int resized = 0;
+        long i;
+        int k;
+
+        if (weight_variable == NULL)
+        {
+            continue;
+        }
+        for (k = 3; k < variable->num_dimensions; k++)
+        {
+            if (variable->dimension_type[k] == dimension_type)
+            {
+                if (harp_variable_resize_dimension(variable, k, length) != 0)
+                {
+                    return -1;
+                }
+                resized = 1;
+            }
+        }
+        for (k = 3; k < weight_variable->num_dimensions; k++)
+        {
+            if (weight_variable->dimension_type[k] == dimension_type)
+            {
+                if (harp_variable_resize_dimension(weight_variable, k, length) != 0)
+                {
+                    return -1;
+                }
+            }
+        }
+        if (resized)
+        {
+            long spatial_block_length = (accumulator->num_latitude_edges - 1) *
+                (accumulator->num_longitude_edges - 1);
+            long num_sub_elements = weight_variable->num_elements / spatial_block_length;
+            int is_integer = accumulator->data_type[j] != harp_type_float &&
+                accumulator->data_type[j] != harp_type_double;
+
+            /* the new elements take the role of the fill values that a merge would have introduced for all samples
+             * that were already added: NaN for floating point (ignored) and 0 for integer data (contributing) */
+            for (i = 0; i < weight_variable->num_elements; i++)
+            {
+                if (harp_isnan(weight_variable->data.float_data[i]))
+                {
+                    weight_variable->data.float_data[i] = is_integer ? accumulator->weight[i / num_sub_elements] : 0;
+                    if (accumulator->bintype[j] == binning_angle)
+                    {
+                        /* a value of 0 is the vector [1,0] */
+                        variable->data.double_data[2 * i] = weight_variable->data.float_data[i];
+                        variable->data.double_data[2 * i + 1] = 0;
+                    }
+                    else
+                    {
+                        variable->data.double_data[i] = 0;
+                    }
+                }
+            }
+            if (!is_integer && accumulator->count > 0)
+            {
+                accumulator->store_weight_variable[j] = 1;
+            }
+        }
+    }
+    accumulator->dimension[dimension_type] = length;
+
+    return 0;
+}
+
+/* determine the variables to accumulate from the first product */
+static int accumulator_init_variables(harp_spatial_accumulator *accumulator, harp_product *product,
+                                      binning_type *bintype, harp_variable **source)
+{
+    int num_variables = 0;
+    int k;
+
+    for (k = 0; k < product->num_variables; k++)
+    {
+        if (bintype[k] != binning_skip && bintype[k] != binning_remove)
+        {
+            int num_dimensions = product->variable[k]->num_dimensions + (bintype[k] == binning_angle ? 1 : 0);
+
+            /* we need to be able to include the lat/lon dimensions (and the vector dimension for angles) */
+            if (bintype[k] != binning_time_min && bintype[k] != binning_time_max &&
+                bintype[k] != binning_time_average && num_dimensions + 2 >= HARP_MAX_NUM_DIMS)
+            {
+                harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "too many dimensions (%d) for variables %s to perform "
+                               "spatial binning", product->variable[k]->num_dimensions, product->variable[k]->name);
+                return -1;
+            }
+            source[num_variables] = product->variable[k];
+            num_variables++;
+        }
+    }
+
+    accumulator->bintype = malloc(num_variables * sizeof(binning_type));
+    if (accumulator->bintype == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_variables * sizeof(binning_type), __FILE__, __LINE__);
+        return -1;
+    }
+    accumulator->data_type = malloc(num_variables * sizeof(harp_data_type));
+    if (accumulator->data_type == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_variables * sizeof(harp_data_type), __FILE__, __LINE__);
+        return -1;
+    }
+    accumulator->variable = malloc(num_variables * sizeof(harp_variable *));
+    if (accumulator->variable == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_variables * sizeof(harp_variable *), __FILE__, __LINE__);
+        return -1;
+    }
+    accumulator->variable_weight = malloc(num_variables * sizeof(harp_variable *));
+    if (accumulator->variable_weight == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_variables * sizeof(harp_variable *), __FILE__, __LINE__);
+        return -1;
+    }
+    accumulator->store_weight_variable = malloc(num_variables * sizeof(int));
+    if (accumulator->store_weight_variable == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_variables * sizeof(int), __FILE__, __LINE__);
+        return -1;
+    }
+    num_variables = 0;
+    for (k = 0; k < product->num_variables; k++)
+    {
+        if (bintype[k] != binning_skip && bintype[k] != binning_remove)
+        {
+            accumulator->bintype[num_variables] = bintype[k];
+            accumulator->data_type[num_variables] = product->variable[k]->data_type;
+            accumulator->variable[num_variables] = NULL;
+            accumulator->variable_weight[num_variables] = NULL;
+            accumulator->store_weight_variable[num_variables] = 0;
+            num_variables++;
+        }
+    }
+    accumulator->num_variables = num_variables;
+
+    for (k = 0; k < HARP_NUM_DIM_TYPES; k++)
+    {
+        accumulator->dimension[k] = product->dimension[k];
+    }
+    accumulator->dimension[harp_dimension_time] = 1;
+
+    if (product->history != NULL)
+    {
+        accumulator->history = strdup(product->history);
+        if (accumulator->history == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not duplicate string) (%s:%u)", __FILE__,
+                           __LINE__);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* match the variables of a subsequent product against the accumulated variables and align the dimensions */
+static int accumulator_match_variables(harp_spatial_accumulator *accumulator, harp_product *product,
+                                       binning_type *bintype, harp_variable **source)
+{
+    harp_dimension_type dimension_type;
+    int j, k;
+
+    for (k = 0; k < product->num_variables; k++)
+    {
+        if (bintype[k] != binning_skip && bintype[k] != binning_remove)
+        {
+            j = accumulator_get_variable_index(accumulator, product->variable[k]->name);
+            if (j < 0)
+            {
+                harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "products don't both have variable '%s'",
+                               product->variable[k]->name);
+                return -1;
+            }
+            if (bintype[k] != accumulator->bintype[j])
+            {
+                harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "variable '%s' can not be binned in the same way for "
+                               "all products", product->variable[k]->name);
+                return -1;
+            }
+        }
+    }
+    for (j = 0; j < accumulator->num_variables; j++)
+    {
+        if (harp_product_get_variable_by_name(product, accumulator->variable[j]->name, &source[j]) != 0)
+        {
+            harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "products don't both have variable '%s'",
+                           accumulator->variable[j]->name);
+            return -1;
+        }
+    }
+
+    /* align size of all non-time dimensions (similar to harp_product_append) */
+    for (dimension_type = 0; dimension_type < HARP_NUM_DIM_TYPES; dimension_type++)
+    {
+        if (dimension_type != harp_dimension_time)
+        {
+            if (accumulator->dimension[dimension_type] > product->dimension[dimension_type])
+            {
+                if (harp_product_resize_dimension(product, dimension_type, accumulator->dimension[dimension_type]) !=
+                    0)
+                {
+                    return -1;
+                }
+            }
+            else if (accumulator->dimension[dimension_type] < product->dimension[dimension_type])
+            {
+                if (accumulator_resize_dimension(accumulator, dimension_type, product->dimension[dimension_type]) !=
+                    0)
+                {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    for (j = 0; j < accumulator->num_variables; j++)
+    {
+        harp_variable *variable = accumulator->variable[j];
+        int num_dimensions;
+
+        if (!harp_variable_has_unit(source[j], variable->unit))
+        {
+            if (harp_variable_convert_unit(source[j], variable->unit) != 0)
+            {
+                return -1;
+            }
+        }
+        if (accumulator->variable_weight[j] == NULL)
+        {
+            /* datetime variables are one dimensional */
+            continue;
+        }
+        num_dimensions = accumulator->variable_weight[j]->num_dimensions;
+        if (source[j]->num_dimensions + 2 != num_dimensions)
+        {
+            harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "variable '%s' has inconsistent dimensions",
+                           variable->name);
+            return -1;
+        }
+        for (k = 1; k < source[j]->num_dimensions; k++)
+        {
+            if (source[j]->dimension_type[k] != variable->dimension_type[k + 2] ||
+                source[j]->dimension[k] != variable->dimension[k + 2])
+            {
+                harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "variable '%s' has inconsistent dimensions",
+                               variable->name);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* create the running sums using the (pre-processed) variables of the first product */
+static int accumulator_init_sums(harp_spatial_accumulator *accumulator, harp_variable **source)
+{
+    harp_dimension_type dimension_type[HARP_MAX_NUM_DIMS];
+    long dimension[HARP_MAX_NUM_DIMS];
+    int j, i;
+
+    accumulator->weight = calloc((accumulator->num_latitude_edges - 1) * (accumulator->num_longitude_edges - 1),
+                                 sizeof(float));
+    if (accumulator->weight == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       (accumulator->num_latitude_edges - 1) * (accumulator->num_longitude_edges - 1) * sizeof(float),
+                       __FILE__, __LINE__);
+        return -1;
+    }
+
+    for (j = 0; j < accumulator->num_variables; j++)
+    {
+        harp_variable *variable = source[j];
+
+        dimension_type[0] = harp_dimension_time;
+        dimension[0] = 1;
+        if (accumulator->bintype[j] == binning_time_max || accumulator->bintype[j] == binning_time_min ||
+            accumulator->bintype[j] == binning_time_average)
+        {
+            if (harp_variable_new(variable->name, harp_type_double, 1, dimension_type, dimension,
+                                  &accumulator->variable[j]) != 0)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            int num_weight_dimensions = variable->num_dimensions + 2;
+
+            dimension_type[1] = harp_dimension_latitude;
+            dimension[1] = accumulator->num_latitude_edges - 1;
+            dimension_type[2] = harp_dimension_longitude;
+            dimension[2] = accumulator->num_longitude_edges - 1;
+            for (i = 1; i < variable->num_dimensions; i++)
+            {
+                dimension_type[i + 2] = variable->dimension_type[i];
+                dimension[i + 2] = variable->dimension[i];
+            }
+            if (harp_variable_new(variable->name, harp_type_double, variable->num_dimensions + 2, dimension_type,
+                                  dimension, &accumulator->variable[j]) != 0)
+            {
+                return -1;
+            }
+            if (accumulator->bintype[j] == binning_angle)
+            {
+                /* for angle variables we use one weight element per vector pair */
+                num_weight_dimensions--;
+            }
+            if (harp_variable_new(variable->name, harp_type_float, num_weight_dimensions, dimension_type, dimension,
+                                  &accumulator->variable_weight[j]) != 0)
+            {
+                return -1;
+            }
+        }
+        if (harp_variable_copy_attributes(variable, accumulator->variable[j]) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int accumulator_add_samples(harp_spatial_accumulator *accumulator, harp_variable **source,
+                                   long num_time_elements, const long *num_latlon_index, const long *latlon_cell_index,
+                                   const double *latlon_weight)
+{
+    long cumsum_index;
+    int32_t count = 0;
+    long i, j, l;
+    int k;
+
+    for (k = 0; k < accumulator->num_variables; k++)
+    {
+        double *sum = accumulator->variable[k]->data.double_data;
+        double *data = source[k]->data.double_data;
+        binning_type bintype = accumulator->bintype[k];
+
+        if (bintype == binning_time_max || bintype == binning_time_min || bintype == binning_time_average)
+        {
+            /* the first contributing sample (of all products) provides the initial value */
+            int initialized = accumulator->count > 0;
+
+            for (i = 0; i < num_time_elements; i++)
+            {
+                if (num_latlon_index[i] > 0)
+                {
+                    if (!initialized)
+                    {
+                        sum[0] = data[i];
+                        initialized = 1;
+                    }
+                    else if (bintype == binning_time_min)
+                    {
+                        if (data[i] < sum[0])
+                        {
+                            sum[0] = data[i];
+                        }
+                    }
+                    else if (bintype == binning_time_max)
+                    {
+                        if (data[i] > sum[0])
+                        {
+                            sum[0] = data[i];
+                        }
+                    }
+                    else
+                    {
+                        /* we don't perform NaN filtering for datetime values (these should not be NaN) */
+                        sum[0] += data[i];
+                    }
+                }
+            }
+        }
+        else
+        {
+            float *weight = accumulator->variable_weight[k]->data.float_data;
+            long num_sub_elements = source[k]->num_elements / num_time_elements;
+
+            cumsum_index = 0;
+            for (i = 0; i < num_time_elements; i++)
+            {
+                for (l = 0; l < num_latlon_index[i]; l++)
+                {
+                    long target_index = latlon_cell_index[cumsum_index];
+                    double multiplication_factor = 1;
+                    double sample_weight = 1;
+
+                    if (latlon_weight != NULL)
+                    {
+                        sample_weight = latlon_weight[cumsum_index];
+                        multiplication_factor = sample_weight;
+                        if (bintype == binning_uncertainty)
+                        {
+                            multiplication_factor *= sample_weight;
+                        }
+                    }
+                    if (bintype == binning_angle)
+                    {
+                        for (j = 0; j < num_sub_elements; j += 2)
+                        {
+                            if (!harp_isnan(data[i * num_sub_elements + j]))
+                            {
+                                weight[(target_index * num_sub_elements + j) / 2] += sample_weight;
+                                sum[target_index * num_sub_elements + j] +=
+                                    multiplication_factor * data[i * num_sub_elements + j];
+                                sum[target_index * num_sub_elements + j + 1] +=
+                                    multiplication_factor * data[i * num_sub_elements + j + 1];
+                            }
+                        }
+                    }
+                    else
+                    {
+                        for (j = 0; j < num_sub_elements; j++)
+                        {
+                            if (!harp_isnan(data[i * num_sub_elements + j]))
+                            {
+                                weight[target_index * num_sub_elements + j] += sample_weight;
+                                sum[target_index * num_sub_elements + j] +=
+                                    multiplication_factor * data[i * num_sub_elements + j];
+                            }
+                            else
+                            {
+                                accumulator->store_weight_variable[k] = 1;
+                            }
+                        }
+                    }
+                    cumsum_index++;
+                }
+            }
+        }
+    }
+
+    /* update global count and weight */
+    cumsum_index = 0;
+    for (i = 0; i < num_time_elements; i++)
+    {
+        if (num_latlon_index[i] > 0)
+        {
+            count++;
+        }
+        for (l = 0; l < num_latlon_index[i]; l++)
+        {
+            accumulator->weight[latlon_cell_index[cumsum_index]] += latlon_weight != NULL ?
+                latlon_weight[cumsum_index] : 1;
+            cumsum_index++;
+        }
+    }
+    accumulator->count += count;
+
+    return 0;
+}
+
+/** \addtogroup harp_product
+ * @{
+ */
+
+/** Create a new spatial binning accumulator.
+ * An accumulator allows spatial binning of a sequence of products into a single time bin without having to merge
+ * the products first. Only the running sums for the latitude/longitude grid are kept in memory.
+ * The result is the same as merging all products (see #harp_product_append) and performing a spatial binning on the
+ * merged product with all samples ending up in a single time bin (i.e. the 'bin_spatial()' operation with only two
+ * time edges).
+ *
+ * The latitude_edges and longitude_edges arrays provide the boundaries of the grid cells in degrees and need to follow
+ * the same constraints as for #harp_product_bin_spatial.
+ *
+ * \param num_latitude_edges Number of edges for the latitude grid (number of latitude rows = num_latitude_edges - 1)
+ * \param latitude_edges latitude grid edge vales
+ * \param num_longitude_edges Number of edges for the longitude grid
+ *        (number of longitude columns = num_longitude_edges - 1)
+ * \param longitude_edges longitude grid edge vales
+ * \param new_accumulator Pointer to the C variable where the new accumulator will be stored.
+ *
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_spatial_accumulator_new(long num_latitude_edges, const double *latitude_edges,
+                                             long num_longitude_edges, const double *longitude_edges,
+                                             harp_spatial_accumulator **new_accumulator)
+{
+    harp_spatial_accumulator *accumulator;
+
+    if (check_spatial_edges(num_latitude_edges, latitude_edges, num_longitude_edges, longitude_edges) != 0)
+    {
+        return -1;
+    }
+
+    accumulator = malloc(sizeof(harp_spatial_accumulator));
+    if (accumulator == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       sizeof(harp_spatial_accumulator), __FILE__, __LINE__);
+        return -1;
+    }
+    accumulator->num_latitude_edges = num_latitude_edges;
+    accumulator->latitude_edges = NULL;
+    accumulator->num_longitude_edges = num_longitude_edges;
+    accumulator->longitude_edges = NULL;
+    accumulator->initialized = 0;
+    accumulator->history = NULL;
+    memset(accumulator->dimension, 0, HARP_NUM_DIM_TYPES * sizeof(long));
+    accumulator->num_variables = 0;
+    accumulator->bintype = NULL;
+    accumulator->data_type = NULL;
+    accumulator->variable = NULL;
+    accumulator->variable_weight = NULL;
+    accumulator->store_weight_variable = NULL;
+    accumulator->count = 0;
+    accumulator->weight = NULL;
+
+    accumulator->latitude_edges = malloc(num_latitude_edges * sizeof(double));
+    if (accumulator->latitude_edges == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_latitude_edges * sizeof(double), __FILE__, __LINE__);
+        harp_spatial_accumulator_delete(accumulator);
+        return -1;
+    }
+    memcpy(accumulator->latitude_edges, latitude_edges, num_latitude_edges * sizeof(double));
+    accumulator->longitude_edges = malloc(num_longitude_edges * sizeof(double));
+    if (accumulator->longitude_edges == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_longitude_edges * sizeof(double), __FILE__, __LINE__);
+        harp_spatial_accumulator_delete(accumulator);
+        return -1;
+    }
+    memcpy(accumulator->longitude_edges, longitude_edges, num_longitude_edges * sizeof(double));
+
+    *new_accumulator = accumulator;
+    return 0;
+}
+
+/** Delete a spatial binning accumulator.
+ * \param accumulator Accumulator to delete.
+ */
+LIBHARP_API void harp_spatial_accumulator_delete(harp_spatial_accumulator *accumulator)
+{
+    if (accumulator == NULL)
+    {
+        return;
+    }
+    if (accumulator->latitude_edges != NULL)
+    {
+        free(accumulator->latitude_edges);
+    }
+    if (accumulator->longitude_edges != NULL)
+    {
+        free(accumulator->longitude_edges);
+    }
+    accumulator_clear(accumulator);
+    free(accumulator);
+}
+
+/** Add the samples of a product to a spatial binning accumulator.
+ * The product should not have a latitude or longitude dimension and should contain either latitude_bounds and
+ * longitude_bounds variables (for area binning) or latitude and longitude variables (for point binning).
+ * The set of variables that will be binned is determined by the first product that is added. All subsequent products
+ * should provide these same variables with compatible dimensions (as would be required for #harp_product_append).
+ *
+ * The product is used as workspace and will be modified in the process (the caller remains the owner and should still
+ * delete the product afterwards).
+ *
+ * \param accumulator Spatial binning accumulator.
+ * \param product Product whose samples should be added.
+ *
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_spatial_accumulator_add_product(harp_spatial_accumulator *accumulator, harp_product *product)
+{
+    binning_type *bintype = NULL;
+    harp_variable **source = NULL;      /* product variable for each accumulated variable */
+    long *num_latlon_index = NULL;      /* number of matching latlon cells for each sample [num_time_elements] */
+    long *latlon_cell_index = NULL;     /* flat latlon cell index for each matching cell for each sample */
+    double *latlon_weight = NULL;       /* weight for each matching cell for each sample */
+    long num_time_elements;
+    int area_binning = 0;
+    int j, k;
+
+    if (harp_product_is_empty(product))
+    {
+        /* nothing to do */
+        return 0;
+    }
+    if (product->dimension[harp_dimension_latitude] > 0 || product->dimension[harp_dimension_longitude] > 0)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "spatial binning cannot be performed on products that already "
+                       "have a latitude and/or longitude dimension");
+        return -1;
+    }
+
+    /* treat the product as if it was the result of a merge */
+    if (harp_product_append(product, NULL) != 0)
+    {
+        return -1;
+    }
+    num_time_elements = product->dimension[harp_dimension_time];
+
+    num_latlon_index = malloc(num_time_elements * sizeof(long));
+    if (num_latlon_index == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_time_elements * sizeof(long), __FILE__, __LINE__);
+        goto error;
+    }
+    if (find_matching_cells_for_product(product, accumulator->num_latitude_edges, accumulator->latitude_edges,
+                                        accumulator->num_longitude_edges, accumulator->longitude_edges, &area_binning,
+                                        num_latlon_index, &latlon_cell_index, &latlon_weight) != 0)
+    {
+        goto error;
+    }
+
+    bintype = malloc(product->num_variables * sizeof(binning_type));
+    if (bintype == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       product->num_variables * sizeof(binning_type), __FILE__, __LINE__);
+        goto error;
+    }
+    for (k = 0; k < product->num_variables; k++)
+    {
+        bintype[k] = get_spatial_binning_type(product->variable[k]);
+    }
+    source = malloc(product->num_variables * sizeof(harp_variable *));
+    if (source == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       product->num_variables * sizeof(harp_variable *), __FILE__, __LINE__);
+        goto error;
+    }
+
+    if (!accumulator->initialized)
+    {
+        if (accumulator_init_variables(accumulator, product, bintype, source) != 0)
+        {
+            goto error;
+        }
+    }
+    else if (accumulator_match_variables(accumulator, product, bintype, source) != 0)
+    {
+        goto error;
+    }
+
+    /* pre-process all variables (same as for harp_product_bin_spatial) */
+    for (j = 0; j < accumulator->num_variables; j++)
+    {
+        harp_variable *variable = source[j];
+        long i;
+
+        if (harp_variable_convert_data_type(variable, harp_type_double) != 0)
+        {
+            goto error;
+        }
+
+        if (accumulator->bintype[j] == binning_angle)
+        {
+            /* convert all angles to 2D vectors [cos(x),sin(x)] */
+            if (harp_convert_unit(variable->unit, "rad", variable->num_elements, variable->data.double_data) != 0)
+            {
+                goto error;
+            }
+            if (harp_variable_add_dimension(variable, variable->num_dimensions, harp_dimension_independent, 2) != 0)
+            {
+                goto error;
+            }
+            for (i = 0; i < variable->num_elements; i += 2)
+            {
+                variable->data.double_data[i] = cos(variable->data.double_data[i]);
+                variable->data.double_data[i + 1] = sin(variable->data.double_data[i + 1]);
+            }
+        }
+
+        if (accumulator->bintype[j] == binning_uncertainty)
+        {
+            /* square the uncertainties */
+            for (i = 0; i < variable->num_elements; i++)
+            {
+                variable->data.double_data[i] *= variable->data.double_data[i];
+            }
+        }
+    }
+
+    if (!accumulator->initialized)
+    {
+        if (accumulator_init_sums(accumulator, source) != 0)
+        {
+            goto error;
+        }
+        accumulator->initialized = 1;
+    }
+
+    if (accumulator_add_samples(accumulator, source, num_time_elements, num_latlon_index, latlon_cell_index,
+                                area_binning ? latlon_weight : NULL) != 0)
+    {
+        goto error;
+    }
+
+    free(source);
+    free(bintype);
+    free(num_latlon_index);
+    if (latlon_cell_index != NULL)
+    {
+        free(latlon_cell_index);
+    }
+    if (latlon_weight != NULL)
+    {
+        free(latlon_weight);
+    }
+
+    return 0;
+
+  error:
+    if (!accumulator->initialized)
+    {
+        /* don't keep a partially initialized state */
+        accumulator_clear(accumulator);
+    }
+    if (source != NULL)
+    {
+        free(source);
+    }
+    if (bintype != NULL)
+    {
+        free(bintype);
+    }
+    if (num_latlon_index != NULL)
+    {
+        free(num_latlon_index);
+    }
+    if (latlon_cell_index != NULL)
+    {
+        free(latlon_cell_index);
+    }
+    if (latlon_weight != NULL)
+    {
+        free(latlon_weight);
+    }
+    return -1;
+}
+
+/** Retrieve the spatially binned product from a spatial binning accumulator.
+ * The resulting product will have a time dimension of length 1 and latitude/longitude dimensions according to the
+ * grid of the accumulator. The variables are the same as those that #harp_product_bin_spatial would have produced.
+ * If no (non-empty) product was added to the accumulator then the resulting product will be empty.
+ *
+ * The accumulator itself is not modified, so more products can still be added afterwards.
+ *
+ * \param accumulator Spatial binning accumulator.
+ * \param product Pointer to the C variable where the new product will be stored.
+ *
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_spatial_accumulator_get_product(harp_spatial_accumulator *accumulator, harp_product **product)
+{
+    harp_dimension_type dimension_type[HARP_MAX_NUM_DIMS];
+    long dimension[HARP_MAX_NUM_DIMS];
+    harp_variable **weight_variable = NULL;
+    harp_product *new_product = NULL;
+    harp_variable *variable = NULL;
+    double nan_value = harp_nan();
+    long i;
+    int j;
+
+    if (harp_product_new(&new_product) != 0)
+    {
+        return -1;
+    }
+    if (!accumulator->initialized)
+    {
+        *product = new_product;
+        return 0;
+    }
+    if (harp_product_set_history(new_product, accumulator->history) != 0)
+    {
+        goto error;
+    }
+
+    if (accumulator->num_variables > 0)
+    {
+        weight_variable = malloc(accumulator->num_variables * sizeof(harp_variable *));
+        if (weight_variable == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           accumulator->num_variables * sizeof(harp_variable *), __FILE__, __LINE__);
+            goto error;
+        }
+        for (j = 0; j < accumulator->num_variables; j++)
+        {
+            weight_variable[j] = NULL;
+        }
+    }
+
+    /* post-process copies of the running sums */
+    for (j = 0; j < accumulator->num_variables; j++)
+    {
+        binning_type bintype = accumulator->bintype[j];
+        float *weight;
+
+        if (harp_variable_copy(accumulator->variable[j], &variable) != 0)
+        {
+            goto error;
+        }
+        if (bintype == binning_time_max || bintype == binning_time_min || bintype == binning_time_average)
+        {
+            if (accumulator->count == 0)
+            {
+                variable->data.double_data[0] = nan_value;
+            }
+            else if (bintype == binning_time_average)
+            {
+                variable->data.double_data[0] /= accumulator->count;
+            }
+        }
+        else
+        {
+            char weight_variable_name[MAX_NAME_LENGTH];
+
+            if (harp_variable_copy(accumulator->variable_weight[j], &weight_variable[j]) != 0)
+            {
+                goto error;
+            }
+            snprintf(weight_variable_name, MAX_NAME_LENGTH, "%s_weight", variable->name);
+            if (harp_variable_rename(weight_variable[j], weight_variable_name) != 0)
+            {
+                goto error;
+            }
+            weight = weight_variable[j]->data.float_data;
+
+            if (bintype == binning_angle)
+            {
+                /* convert angle variables back from 2D vectors to angles */
+                for (i = 0; i < variable->num_elements; i += 2)
+                {
+                    if (weight[i / 2] == 0)
+                    {
+                        variable->data.double_data[i] = nan_value;
+                    }
+                    else
+                    {
+                        double x = variable->data.double_data[i];
+                        double y = variable->data.double_data[i + 1];
+
+                        weight[i / 2] = sqrt(x * x + y * y);
+                        variable->data.double_data[i] = atan2(y, x);
+                    }
+                }
+                if (harp_variable_remove_dimension(variable, variable->num_dimensions - 1, 0) != 0)
+                {
+                    goto error;
+                }
+                /* convert all angles back to the original unit */
+                if (harp_convert_unit("rad", variable->unit, variable->num_elements, variable->data.double_data) != 0)
+                {
+                    goto error;
+                }
+            }
+            else
+            {
+                /* take square root of the sum before dividing by the sum of the weights */
+                if (bintype == binning_uncertainty)
+                {
+                    for (i = 0; i < variable->num_elements; i++)
+                    {
+                        variable->data.double_data[i] = sqrt(variable->data.double_data[i]);
+                    }
+                }
+
+                for (i = 0; i < variable->num_elements; i++)
+                {
+                    if (weight[i] == 0)
+                    {
+                        variable->data.double_data[i] = nan_value;
+                    }
+                    else
+                    {
+                        /* divide by the sum of the weights */
+                        variable->data.double_data[i] /= weight[i];
+                    }
+                }
+                if (!accumulator->store_weight_variable[j])
+                {
+                    harp_variable_delete(weight_variable[j]);
+                    weight_variable[j] = NULL;
+                }
+            }
+        }
+        if (harp_product_add_variable(new_product, variable) != 0)
+        {
+            goto error;
+        }
+        variable = NULL;
+    }
+
+    /* add global count and weight variables */
+    dimension_type[0] = harp_dimension_time;
+    dimension[0] = 1;
+    if (harp_variable_new("count", harp_type_int32, 1, dimension_type, dimension, &variable) != 0)
+    {
+        goto error;
+    }
+    variable->data.int32_data[0] = accumulator->count;
+    if (harp_product_add_variable(new_product, variable) != 0)
+    {
+        goto error;
+    }
+    variable = NULL;
+    dimension_type[1] = harp_dimension_latitude;
+    dimension[1] = accumulator->num_latitude_edges - 1;
+    dimension_type[2] = harp_dimension_longitude;
+    dimension[2] = accumulator->num_longitude_edges - 1;
+    if (harp_variable_new("weight", harp_type_float, 3, dimension_type, dimension, &variable) != 0)
+    {
+        goto error;
+    }
+    memcpy(variable->data.float_data, accumulator->weight, variable->num_elements * sizeof(float));
+    if (harp_product_add_variable(new_product, variable) != 0)
+    {
+        goto error;
+    }
+    variable = NULL;
+
+    for (j = 0; j < accumulator->num_variables; j++)
+    {
+        if (weight_variable[j] != NULL)
+        {
+            if (harp_product_add_variable(new_product, weight_variable[j]) != 0)
+            {
+                goto error;
+            }
+            weight_variable[j] = NULL;
+        }
+    }
+
+    /* add latitude_bounds and longitude_bounds variables */
+    dimension_type[0] = harp_dimension_latitude;
+    dimension[0] = accumulator->num_latitude_edges - 1;
+    dimension_type[1] = harp_dimension_independent;
+    dimension[1] = 2;
+    if (harp_variable_new("latitude_bounds", harp_type_double, 2, dimension_type, dimension, &variable) != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < dimension[0]; i++)
+    {
+        variable->data.double_data[2 * i] = accumulator->latitude_edges[i];
+        variable->data.double_data[2 * i + 1] = accumulator->latitude_edges[i + 1];
+    }
+    if (harp_variable_set_unit(variable, HARP_UNIT_LATITUDE) != 0)
+    {
+        goto error;
+    }
+    if (harp_product_add_variable(new_product, variable) != 0)
+    {
+        goto error;
+    }
+    variable = NULL;
+    dimension_type[0] = harp_dimension_longitude;
+    dimension[0] = accumulator->num_longitude_edges - 1;
+    if (harp_variable_new("longitude_bounds", harp_type_double, 2, dimension_type, dimension, &variable) != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < dimension[0]; i++)
+    {
+        variable->data.double_data[2 * i] = accumulator->longitude_edges[i];
+        variable->data.double_data[2 * i + 1] = accumulator->longitude_edges[i + 1];
+    }
+    if (harp_variable_set_unit(variable, HARP_UNIT_LONGITUDE) != 0)
+    {
+        goto error;
+    }
+    if (harp_product_add_variable(new_product, variable) != 0)
+    {
+        goto error;
+    }
+    variable = NULL;
+
+    if (weight_variable != NULL)
+    {
+        free(weight_variable);
+    }
+
+    *product = new_product;
+    return 0;
+
+  error:
+    if (variable != NULL)
+    {
+        harp_variable_delete(variable);
+    }
+    if (weight_variable != NULL)
+    {
+        for (j = 0; j < accumulator->num_variables; j++)
+        {
+            harp_variable_delete(weight_variable[j]);
+        }
+        free(weight_variable);
+    }
+    harp_product_delete(new_product);
+    return -1;
+}
+
+/**
+ * @}
+ */
@@ -38,6 +38,8 @@
 #include <string.h>
 
 #define COLLOCATION_RESULT_BLOCK_SIZE 1024
+#define COLLOCATION_RADIX_BITS 11
+#define COLLOCATION_RADIX_MASK ((1 << COLLOCATION_RADIX_BITS) - 1)
 
 /** \defgroup harp_collocation HARP Collocation
  * The HARP Collocation module contains the functionality that deals with collocation two datasets
@@ -46,77 +48,399 @@
  * (using the source product name and measurement index within that product) and a measurement from dataset B.
  * Each collocation pair also gets a unique collocation_index sequence number.
  * For each collocation criteria used in the matchup the actual difference is stored as part of the pair as well.
+ * The pairs are stored column wise in the collocation result (i.e. there is a separate array for each pair property
+ * and a [num_pairs, num_differences] array for the differences). For backward compatibility the collocation result
+ * also provides a 'pair' array with a harp_collocation_pair entry for each pair, which is kept in sync with the columns
+ * by all collocation result functions (the difference field of these entries points into the difference column).
  * Collocation results can be written to and read from a csv file.
  */
 
-static void collocation_pair_swap_datasets(harp_collocation_pair *pair)
+/* number of pairs for which space is allocated in the collocation result columns for a given number of pairs */
+static long get_allocated_num_pairs(long num_pairs)
 {
-    long index_a = pair->product_index_a;
-    long sample_a = pair->sample_index_a;
+    return ((num_pairs + COLLOCATION_RESULT_BLOCK_SIZE - 1) / COLLOCATION_RESULT_BLOCK_SIZE) *
+        COLLOCATION_RESULT_BLOCK_SIZE;
+}
+
+static int resize_long_column(long **column, long num_pairs)
+{
+    long *new_column;
+
+    new_column = realloc(*column, num_pairs * sizeof(long));
+    if (new_column == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_pairs * sizeof(long), __FILE__, __LINE__);
+        return -1;
+    }
+    *column = new_column;
+
+    return 0;
+}
+
+static void fill_pair(const harp_collocation_result *collocation_result, long index, harp_collocation_pair *pair)
+{
+    pair->collocation_index = collocation_result->collocation_index[index];
+    pair->product_index_a = collocation_result->product_index_a[index];
+    pair->sample_index_a = collocation_result->sample_index_a[index];
+    pair->product_index_b = collocation_result->product_index_b[index];
+    pair->sample_index_b = collocation_result->sample_index_b[index];
+    pair->num_differences = collocation_result->num_differences;
+    pair->difference = NULL;
+    if (collocation_result->num_differences > 0)
+    {
+        pair->difference = &collocation_result->difference[index * collocation_result->num_differences];
+    }
+}
+
+/* Update the 'pair' array of the collocation result for all pairs starting at first_index.
+ * The pair array is kept for backward compatibility and provides a harp_collocation_pair view on the columns.
+ * It should be updated by every function that modifies the columns.
+ */
+static void collocation_result_update_pairs(harp_collocation_result *collocation_result, long first_index)
+{
+    long i;
+
+    for (i = first_index; i < collocation_result->num_pairs; i++)
+    {
+        fill_pair(collocation_result, i, collocation_result->pair[i]);
+    }
+}
 
-    pair->product_index_a = pair->product_index_b;
-    pair->sample_index_a = pair->sample_index_b;
-    pair->product_index_b = index_a;
-    pair->sample_index_b = sample_a;
+/* (re)allocate the pair array; the harp_collocation_pair entries are stored in the same memory block, directly after
+ * the pointers, such that a single free() of the pair array releases everything
+ */
+static int resize_pair_array(harp_collocation_result *collocation_result, long num_pairs)
+{
+    harp_collocation_pair **new_pair;
+    harp_collocation_pair *pair_data;
+    long i;
+
+    new_pair = realloc(collocation_result->pair,
+                       num_pairs * (sizeof(harp_collocation_pair *) + sizeof(harp_collocation_pair)));
+    if (new_pair == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_pairs * (sizeof(harp_collocation_pair *) + sizeof(harp_collocation_pair)), __FILE__,
+                       __LINE__);
+        return -1;
+    }
+    collocation_result->pair = new_pair;
+
+    pair_data = (harp_collocation_pair *)&new_pair[num_pairs];
+    for (i = 0; i < num_pairs; i++)
+    {
+        new_pair[i] = &pair_data[i];
+    }
+
+    return 0;
 }
 
-static void collocation_pair_delete(harp_collocation_pair *pair)
+/* make sure that the collocation result columns can hold (at least) num_pairs pairs */
+static int collocation_result_resize(harp_collocation_result *collocation_result, long num_pairs)
 {
-    if (pair != NULL)
+    long allocated_num_pairs = get_allocated_num_pairs(num_pairs);
+
+    if (allocated_num_pairs == 0)
+    {
+        allocated_num_pairs = COLLOCATION_RESULT_BLOCK_SIZE;
+    }
+    if (resize_long_column(&collocation_result->collocation_index, allocated_num_pairs) != 0)
+    {
+        return -1;
+    }
+    if (resize_long_column(&collocation_result->product_index_a, allocated_num_pairs) != 0)
+    {
+        return -1;
+    }
+    if (resize_long_column(&collocation_result->sample_index_a, allocated_num_pairs) != 0)
+    {
+        return -1;
+    }
+    if (resize_long_column(&collocation_result->product_index_b, allocated_num_pairs) != 0)
     {
-        if (pair->difference != NULL)
+        return -1;
+    }
+    if (resize_long_column(&collocation_result->sample_index_b, allocated_num_pairs) != 0)
+    {
+        return -1;
+    }
+    if (collocation_result->num_differences > 0)
+    {
+        double *new_difference;
+
+        new_difference = realloc(collocation_result->difference,
+                                 allocated_num_pairs * collocation_result->num_differences * sizeof(double));
+        if (new_difference == NULL)
         {
-            free(pair->difference);
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           allocated_num_pairs * collocation_result->num_differences * sizeof(double), __FILE__,
+                           __LINE__);
+            return -1;
         }
+        collocation_result->difference = new_difference;
+    }
+    if (resize_pair_array(collocation_result, allocated_num_pairs) != 0)
+    {
+        return -1;
+    }
+    collocation_result_update_pairs(collocation_result, 0);
+
+    return 0;
+}
 
-        free(pair);
+/* reorder the pairs such that pair i becomes the pair that was at index order[i]
+ * order should contain num_pairs entries, but does not have to be a full permutation (i.e. it can also be used to
+ * select a subset of pairs and/or duplicate pairs); the number of pairs in the result will be set to num_pairs
+ */
+static int collocation_result_gather(harp_collocation_result *collocation_result, long num_pairs, const long *order)
+{
+    long *column[5];
+    long *buffer;
+    long i;
+    int k;
+
+    if (num_pairs > collocation_result->num_pairs &&
+        get_allocated_num_pairs(num_pairs) > get_allocated_num_pairs(collocation_result->num_pairs))
+    {
+        if (collocation_result_resize(collocation_result, num_pairs) != 0)
+        {
+            return -1;
+        }
     }
+
+    if (num_pairs > 0)
+    {
+        buffer = malloc(num_pairs * sizeof(long));
+        if (buffer == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           num_pairs * sizeof(long), __FILE__, __LINE__);
+            return -1;
+        }
+
+        column[0] = collocation_result->collocation_index;
+        column[1] = collocation_result->product_index_a;
+        column[2] = collocation_result->sample_index_a;
+        column[3] = collocation_result->product_index_b;
+        column[4] = collocation_result->sample_index_b;
+        for (k = 0; k < 5; k++)
+        {
+            for (i = 0; i < num_pairs; i++)
+            {
+                buffer[i] = column[k][order[i]];
+            }
+            memcpy(column[k], buffer, num_pairs * sizeof(long));
+        }
+        free(buffer);
+
+        if (collocation_result->num_differences > 0)
+        {
+            int num_differences = collocation_result->num_differences;
+            double *difference_buffer;
+
+            difference_buffer = malloc(num_pairs * num_differences * sizeof(double));
+            if (difference_buffer == NULL)
+            {
+                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                               num_pairs * num_differences * sizeof(double), __FILE__, __LINE__);
+                return -1;
+            }
+            for (i = 0; i < num_pairs; i++)
+            {
+                memcpy(&difference_buffer[i * num_differences],
+                       &collocation_result->difference[order[i] * num_differences], num_differences * sizeof(double));
+            }
+            memcpy(collocation_result->difference, difference_buffer, num_pairs * num_differences * sizeof(double));
+            free(difference_buffer);
+        }
+    }
+
+    collocation_result->num_pairs = num_pairs;
+    collocation_result_update_pairs(collocation_result, 0);
+
+    return 0;
 }
 
-static int collocation_pair_new(long collocation_index, long product_index_a, long sample_index_a, long product_index_b,
-                                long sample_index_b, int num_differences, const double *difference,
-                                harp_collocation_pair **new_pair)
+/* stable LSD radix sort of the pair indices in 'order' using the key value key[order[i]] (or map[key[order[i]]] if
+ * map is not NULL); buffer should have room for num_pairs indices
+ */
+static void radix_sort_by_key(long num_pairs, const long *key, const long *map, long *order, long *buffer)
 {
-    harp_collocation_pair *pair;
-    int i;
+    long count[1 << COLLOCATION_RADIX_BITS];
+    long *source = order;
+    long *target = buffer;
+    unsigned long range;
+    long min_value;
+    long max_value;
+    long i;
+    int shift;
+
+    if (num_pairs < 2)
+    {
+        return;
+    }
+
+    min_value = map != NULL ? map[key[0]] : key[0];
+    max_value = min_value;
+    for (i = 1; i < num_pairs; i++)
+    {
+        long value = map != NULL ? map[key[i]] : key[i];
+
+        if (value < min_value)
+        {
+            min_value = value;
+        }
+        else if (value > max_value)
+        {
+            max_value = value;
+        }
+    }
+
+    range = (unsigned long)max_value - (unsigned long)min_value;
 
-    pair = (harp_collocation_pair *)malloc(sizeof(harp_collocation_pair));
-    if (pair == NULL)
+    for (shift = 0; shift < (int)(8 * sizeof(long)) && (range >> shift) > 0; shift += COLLOCATION_RADIX_BITS)
+    {
+        long *swap;
+        long sum = 0;
+
+        memset(count, 0, sizeof(count));
+        for (i = 0; i < num_pairs; i++)
+        {
+            long value = map != NULL ? map[key[source[i]]] : key[source[i]];
+
+            count[(((unsigned long)value - (unsigned long)min_value) >> shift) & COLLOCATION_RADIX_MASK]++;
+        }
+        for (i = 0; i < (1 << COLLOCATION_RADIX_BITS); i++)
+        {
+            long bucket_size = count[i];
+
+            count[i] = sum;
+            sum += bucket_size;
+        }
+        for (i = 0; i < num_pairs; i++)
+        {
+            long value = map != NULL ? map[key[source[i]]] : key[source[i]];
+
+            target[count[(((unsigned long)value - (unsigned long)min_value) >> shift) & COLLOCATION_RADIX_MASK]++] =
+                source[i];
+        }
+        swap = source;
+        source = target;
+        target = swap;
+    }
+
+    if (source != order)
+    {
+        memcpy(order, source, num_pairs * sizeof(long));
+    }
+}
+
+/* determine for each product in the dataset its position when sorting the products by source product name */
+static int get_source_product_rank(harp_dataset *dataset, long **rank)
+{
+    long *product_rank;
+    long i;
+
+    product_rank = malloc((dataset->num_products > 0 ? dataset->num_products : 1) * sizeof(long));
+    if (product_rank == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       sizeof(harp_collocation_pair), __FILE__, __LINE__);
+                       dataset->num_products * sizeof(long), __FILE__, __LINE__);
         return -1;
     }
+    for (i = 0; i < dataset->num_products; i++)
+    {
+        product_rank[dataset->sorted_index[i]] = i;
+    }
 
-    pair->collocation_index = collocation_index;
-
-    pair->product_index_a = product_index_a;
-    pair->sample_index_a = sample_index_a;
+    *rank = product_rank;
+    return 0;
+}
 
-    pair->product_index_b = product_index_b;
-    pair->sample_index_b = sample_index_b;
+/* sort the pairs using the given keys (the first key is the most significant one) */
+static int sort_by_keys(harp_collocation_result *collocation_result, int num_keys, const long **key, const long **map)
+{
+    long *order;
+    long *buffer;
+    long i;
+    int k;
 
-    pair->num_differences = num_differences;
-    pair->difference = NULL;
+    if (collocation_result->num_pairs < 2)
+    {
+        return 0;
+    }
 
-    pair->difference = malloc(num_differences * sizeof(double));
-    if (pair->difference == NULL)
+    order = malloc(2 * collocation_result->num_pairs * sizeof(long));
+    if (order == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       sizeof(harp_collocation_pair), __FILE__, __LINE__);
-        collocation_pair_delete(pair);
+                       2 * collocation_result->num_pairs * sizeof(long), __FILE__, __LINE__);
         return -1;
     }
+    buffer = &order[collocation_result->num_pairs];
+    for (i = 0; i < collocation_result->num_pairs; i++)
+    {
+        order[i] = i;
+    }
+
+    /* sort by the least significant key first; since each pass is stable this results in a lexicographic order */
+    for (k = num_keys - 1; k >= 0; k--)
+    {
+        radix_sort_by_key(collocation_result->num_pairs, key[k], map[k], order, buffer);
+    }
 
-    for (i = 0; i < num_differences; i++)
+    if (collocation_result_gather(collocation_result, collocation_result->num_pairs, order) != 0)
     {
-        pair->difference[i] = difference[i];
+        free(order);
+        return -1;
     }
 
-    *new_pair = pair;
+    free(order);
     return 0;
 }
 
+/* sort the pairs by product/sample of the first dataset and then by product/sample of the second dataset */
+static int sort_by_datasets(harp_collocation_result *collocation_result, int b_first)
+{
+    const long *key[4];
+    const long *map[4];
+    long *rank_a = NULL;
+    long *rank_b = NULL;
+    int result;
+
+    if (collocation_result->num_pairs < 2)
+    {
+        return 0;
+    }
+
+    if (get_source_product_rank(collocation_result->dataset_a, &rank_a) != 0)
+    {
+        return -1;
+    }
+    if (get_source_product_rank(collocation_result->dataset_b, &rank_b) != 0)
+    {
+        free(rank_a);
+        return -1;
+    }
+
+    key[b_first ? 2 : 0] = collocation_result->product_index_a;
+    map[b_first ? 2 : 0] = rank_a;
+    key[b_first ? 3 : 1] = collocation_result->sample_index_a;
+    map[b_first ? 3 : 1] = NULL;
+    key[b_first ? 0 : 2] = collocation_result->product_index_b;
+    map[b_first ? 0 : 2] = rank_b;
+    key[b_first ? 1 : 3] = collocation_result->sample_index_b;
+    map[b_first ? 1 : 3] = NULL;
+
+    result = sort_by_keys(collocation_result, 4, key, map);
+
+    free(rank_a);
+    free(rank_b);
+
+    return result;
+}
+
 /** \addtogroup harp_collocation
  * @{
  */
@@ -152,6 +476,12 @@ LIBHARP_API int harp_collocation_result_new(harp_collocation_result **new_colloc
     collocation_result->difference_unit = NULL;
     collocation_result->num_pairs = 0;
     collocation_result->pair = NULL;
+    collocation_result->collocation_index = NULL;
+    collocation_result->product_index_a = NULL;
+    collocation_result->sample_index_a = NULL;
+    collocation_result->product_index_b = NULL;
+    collocation_result->sample_index_b = NULL;
+    collocation_result->difference = NULL;
 
     if (harp_dataset_new(&collocation_result->dataset_a) != 0)
     {
@@ -190,6 +520,7 @@ LIBHARP_API int harp_collocation_result_new(harp_collocation_result **new_colloc
         {
             collocation_result->difference_unit[i] = NULL;
         }
+        collocation_result->num_differences = num_differences;
         if (difference_variable_name != NULL)
         {
             for (i = 0; i < num_differences; i++)
@@ -269,16 +600,34 @@ LIBHARP_API void harp_collocation_result_delete(harp_collocation_result *colloca
         free(collocation_result->difference_unit);
     }
 
-    if (collocation_result->pair)
+    if (collocation_result->pair != NULL)
     {
-        long i;
-
-        for (i = 0; i < collocation_result->num_pairs; i++)
-        {
-            collocation_pair_delete(collocation_result->pair[i]);
-        }
         free(collocation_result->pair);
     }
+    if (collocation_result->collocation_index != NULL)
+    {
+        free(collocation_result->collocation_index);
+    }
+    if (collocation_result->product_index_a != NULL)
+    {
+        free(collocation_result->product_index_a);
+    }
+    if (collocation_result->sample_index_a != NULL)
+    {
+        free(collocation_result->sample_index_a);
+    }
+    if (collocation_result->product_index_b != NULL)
+    {
+        free(collocation_result->product_index_b);
+    }
+    if (collocation_result->sample_index_b != NULL)
+    {
+        free(collocation_result->sample_index_b);
+    }
+    if (collocation_result->difference != NULL)
+    {
+        free(collocation_result->difference);
+    }
 
     free(collocation_result);
 }
@@ -313,10 +662,42 @@ int harp_collocation_result_add_difference(harp_collocation_result *collocation_
     }
     collocation_result->difference_unit = new_string_array;
 
+    if (collocation_result->num_pairs > 0)
+    {
+        /* add a column (initialized with NaN) to the difference array of the existing pairs */
+        long allocated_num_pairs = get_allocated_num_pairs(collocation_result->num_pairs);
+        int num_differences = collocation_result->num_differences;
+        double *new_difference;
+        long i;
+
+        new_difference = malloc(allocated_num_pairs * (num_differences + 1) * sizeof(double));
+        if (new_difference == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           allocated_num_pairs * (num_differences + 1) * sizeof(double), __FILE__, __LINE__);
+            return -1;
+        }
+        for (i = 0; i < collocation_result->num_pairs; i++)
+        {
+            if (num_differences > 0)
+            {
+                memcpy(&new_difference[i * (num_differences + 1)],
+                       &collocation_result->difference[i * num_differences], num_differences * sizeof(double));
+            }
+            new_difference[i * (num_differences + 1) + num_differences] = harp_nan();
+        }
+        if (collocation_result->difference != NULL)
+        {
+            free(collocation_result->difference);
+        }
+        collocation_result->difference = new_difference;
+    }
+
     index = collocation_result->num_differences;
     collocation_result->difference_variable_name[index] = NULL;
     collocation_result->difference_unit[index] = NULL;
     collocation_result->num_differences++;
+    collocation_result_update_pairs(collocation_result, 0);
 
     collocation_result->difference_variable_name[index] = strdup(difference_variable_name);
     if (collocation_result->difference_variable_name[index] == NULL)
@@ -336,100 +717,6 @@ int harp_collocation_result_add_difference(harp_collocation_result *collocation_
     return 0;
 }
 
-static harp_dataset *sort_dataset_a = NULL;
-static harp_dataset *sort_dataset_b = NULL;
-
-static int compare_by_a(const void *a, const void *b)
-{
-    harp_collocation_pair *pair_a = *(harp_collocation_pair **)a;
-    harp_collocation_pair *pair_b = *(harp_collocation_pair **)b;
-
-    if (pair_a->product_index_a != pair_b->product_index_a)
-    {
-        return strcmp(sort_dataset_a->source_product[pair_a->product_index_a],
-                      sort_dataset_a->source_product[pair_b->product_index_a]);
-    }
-    if (pair_a->sample_index_a < pair_b->sample_index_a)
-    {
-        return -1;
-    }
-    if (pair_a->sample_index_a > pair_b->sample_index_a)
-    {
-        return 1;
-    }
-
-    /* If a is equal, then further sort by b to get a fixed ordering. */
-    if (pair_a->product_index_b != pair_b->product_index_b)
-    {
-        return strcmp(sort_dataset_b->source_product[pair_a->product_index_b],
-                      sort_dataset_b->source_product[pair_b->product_index_b]);
-    }
-    if (pair_a->sample_index_b < pair_b->sample_index_b)
-    {
-        return -1;
-    }
-    if (pair_a->sample_index_b > pair_b->sample_index_b)
-    {
-        return 1;
-    }
-
-    return 0;
-}
-
-static int compare_by_b(const void *a, const void *b)
-{
-    harp_collocation_pair *pair_a = *(harp_collocation_pair **)a;
-    harp_collocation_pair *pair_b = *(harp_collocation_pair **)b;
-
-    if (pair_a->product_index_b != pair_b->product_index_b)
-    {
-        return strcmp(sort_dataset_b->source_product[pair_a->product_index_b],
-                      sort_dataset_b->source_product[pair_b->product_index_b]);
-    }
-    if (pair_a->sample_index_b < pair_b->sample_index_b)
-    {
-        return -1;
-    }
-    if (pair_a->sample_index_b > pair_b->sample_index_b)
-    {
-        return 1;
-    }
-
-    /* If b is equal, then further sort by a to get a fixed ordering. */
-    if (pair_a->product_index_a != pair_b->product_index_a)
-    {
-        return strcmp(sort_dataset_a->source_product[pair_a->product_index_a],
-                      sort_dataset_a->source_product[pair_b->product_index_a]);
-    }
-    if (pair_a->sample_index_a < pair_b->sample_index_a)
-    {
-        return -1;
-    }
-    if (pair_a->sample_index_a > pair_b->sample_index_a)
-    {
-        return 1;
-    }
-
-    return 0;
-}
-
-static int compare_by_collocation_index(const void *a, const void *b)
-{
-    harp_collocation_pair *pair_a = *(harp_collocation_pair **)a;
-    harp_collocation_pair *pair_b = *(harp_collocation_pair **)b;
-
-    if (pair_a->collocation_index < pair_b->collocation_index)
-    {
-        return -1;
-    }
-    if (pair_a->collocation_index > pair_b->collocation_index)
-    {
-        return 1;
-    }
-
-    return 0;
-}
-
 /** \addtogroup harp_collocation
  * @{
  */
@@ -443,12 +730,7 @@ static int compare_by_collocation_index(const void *a, const void *b)
  */
 LIBHARP_API int harp_collocation_result_sort_by_a(harp_collocation_result *collocation_result)
 {
-    sort_dataset_a = collocation_result->dataset_a;
-    sort_dataset_b = collocation_result->dataset_b;
-    qsort(collocation_result->pair, collocation_result->num_pairs, sizeof(harp_collocation_pair *), compare_by_a);
-    sort_dataset_a = NULL;
-    sort_dataset_b = NULL;
-    return 0;
+    return sort_by_datasets(collocation_result, 0);
 }
 
 /** Sort the collocation result pairs by dataset B
@@ -460,12 +742,7 @@ LIBHARP_API int harp_collocation_result_sort_by_a(harp_collocation_result *collo
  */
 LIBHARP_API int harp_collocation_result_sort_by_b(harp_collocation_result *collocation_result)
 {
-    sort_dataset_a = collocation_result->dataset_a;
-    sort_dataset_b = collocation_result->dataset_b;
-    qsort(collocation_result->pair, collocation_result->num_pairs, sizeof(harp_collocation_pair *), compare_by_b);
-    sort_dataset_a = NULL;
-    sort_dataset_b = NULL;
-    return 0;
+    return sort_by_datasets(collocation_result, 1);
 }
 
 /** Sort the collocation result pairs by collocation index
@@ -476,9 +753,13 @@ LIBHARP_API int harp_collocation_result_sort_by_b(harp_collocation_result *collo
  */
 LIBHARP_API int harp_collocation_result_sort_by_collocation_index(harp_collocation_result *collocation_result)
 {
-    qsort(collocation_result->pair, collocation_result->num_pairs, sizeof(harp_collocation_pair *),
-          compare_by_collocation_index);
-    return 0;
+    const long *key[1];
+    const long *map[1];
+
+    key[0] = collocation_result->collocation_index;
+    map[0] = NULL;
+
+    return sort_by_keys(collocation_result, 1, key, map);
 }
 
 /** Filter collocation result set for a specific product from dataset A
@@ -493,24 +774,35 @@ LIBHARP_API int harp_collocation_result_filter_for_source_product_a(harp_colloca
                                                                     const char *source_product)
 {
     long product_index;
-    long i, j;
+    uint8_t *mask;
+    long i;
 
     if (harp_dataset_get_index_from_source_product(collocation_result->dataset_a, source_product, &product_index) != 0)
     {
         return -1;
     }
-    for (i = collocation_result->num_pairs - 1; i >= 0; i--)
+    if (collocation_result->num_pairs == 0)
     {
-        if (collocation_result->pair[i]->product_index_a != product_index)
-        {
-            collocation_pair_delete(collocation_result->pair[i]);
-            for (j = i + 1; j < collocation_result->num_pairs; j++)
-            {
-                collocation_result->pair[j - 1] = collocation_result->pair[j];
-            }
-            collocation_result->num_pairs--;
-        }
+        return 0;
     }
+    mask = malloc(collocation_result->num_pairs * sizeof(uint8_t));
+    if (mask == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       collocation_result->num_pairs * sizeof(uint8_t), __FILE__, __LINE__);
+        return -1;
+    }
+    for (i = 0; i < collocation_result->num_pairs; i++)
+    {
+        mask[i] = collocation_result->product_index_a[i] == product_index;
+    }
+    if (harp_collocation_result_filter(collocation_result, mask) != 0)
+    {
+        free(mask);
+        return -1;
+    }
+    free(mask);
+
     return 0;
 }
 
@@ -526,24 +818,35 @@ LIBHARP_API int harp_collocation_result_filter_for_source_product_b(harp_colloca
                                                                     const char *source_product)
 {
     long product_index;
-    long i, j;
+    uint8_t *mask;
+    long i;
 
     if (harp_dataset_get_index_from_source_product(collocation_result->dataset_b, source_product, &product_index) != 0)
     {
         return -1;
     }
-    for (i = collocation_result->num_pairs - 1; i >= 0; i--)
+    if (collocation_result->num_pairs == 0)
     {
-        if (collocation_result->pair[i]->product_index_b != product_index)
-        {
-            collocation_pair_delete(collocation_result->pair[i]);
-            for (j = i + 1; j < collocation_result->num_pairs; j++)
-            {
-                collocation_result->pair[j - 1] = collocation_result->pair[j];
-            }
-            collocation_result->num_pairs--;
-        }
+        return 0;
     }
+    mask = malloc(collocation_result->num_pairs * sizeof(uint8_t));
+    if (mask == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       collocation_result->num_pairs * sizeof(uint8_t), __FILE__, __LINE__);
+        return -1;
+    }
+    for (i = 0; i < collocation_result->num_pairs; i++)
+    {
+        mask[i] = collocation_result->product_index_b[i] == product_index;
+    }
+    if (harp_collocation_result_filter(collocation_result, mask) != 0)
+    {
+        free(mask);
+        return -1;
+    }
+    free(mask);
+
     return 0;
 }
 
@@ -567,14 +870,14 @@ static int find_collocation_pair_for_collocation_index(harp_collocation_result *
         long pivot_index = lower_index + ((upper_index - lower_index) / 2);
 
         /* If the pivot equals the key, terminate early. */
-        if (collocation_result->pair[pivot_index]->collocation_index == collocation_index)
+        if (collocation_result->collocation_index[pivot_index] == collocation_index)
         {
             *index = pivot_index;
             return 0;
         }
 
         /* If the pivot is smaller than the key, search the upper sub array, otherwise search the lower sub array. */
-        if (collocation_result->pair[pivot_index]->collocation_index < collocation_index)
+        if (collocation_result->collocation_index[pivot_index] < collocation_index)
         {
             lower_index = pivot_index + 1;
         }
@@ -606,8 +909,8 @@ static int find_collocation_pair_for_collocation_index(harp_collocation_result *
 LIBHARP_API int harp_collocation_result_filter_for_collocation_indices(harp_collocation_result *collocation_result,
                                                                        long num_indices, int32_t *collocation_index)
 {
-    harp_collocation_pair **pair = NULL;
-    long num_pairs = 0;
+    uint8_t *used = NULL;
+    long *order = NULL;
     long i;
 
     if (harp_collocation_result_sort_by_collocation_index(collocation_result) != 0)
@@ -615,51 +918,60 @@ LIBHARP_API int harp_collocation_result_filter_for_collocation_indices(harp_coll
         return -1;
     }
 
-    /* create a temporary array to store all pairs */
-    pair = malloc(collocation_result->num_pairs * sizeof(harp_collocation_pair *));
-    if (!pair)
+    if (num_indices == 0)
+    {
+        collocation_result->num_pairs = 0;
+        return 0;
+    }
+
+    order = malloc(num_indices * sizeof(long));
+    if (order == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       collocation_result->num_pairs * sizeof(harp_collocation_pair *), __FILE__, __LINE__);
+                       num_indices * sizeof(long), __FILE__, __LINE__);
+        return -1;
+    }
+    used = calloc(collocation_result->num_pairs > 0 ? collocation_result->num_pairs : 1, sizeof(uint8_t));
+    if (used == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       collocation_result->num_pairs * sizeof(uint8_t), __FILE__, __LINE__);
+        free(order);
         return -1;
     }
 
     for (i = 0; i < num_indices; i++)
     {
         long index;
-        long j;
 
         if (find_collocation_pair_for_collocation_index(collocation_result, collocation_index[i], &index) != 0)
         {
-            goto error;
+            free(used);
+            free(order);
+            return -1;
         }
-        pair[num_pairs] = collocation_result->pair[index];
-        num_pairs++;
-        for (j = index + 1; j < collocation_result->num_pairs; j++)
+        if (used[index])
         {
-            collocation_result->pair[j - 1] = collocation_result->pair[j];
+            /* each pair can only be selected once */
+            harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "cannot find collocation index %ld in collocation results",
+                           (long)collocation_index[i]);
+            free(used);
+            free(order);
+            return -1;
         }
-        collocation_result->num_pairs--;
+        used[index] = 1;
+        order[i] = index;
     }
+    free(used);
 
-    for (i = 0; i < collocation_result->num_pairs; i++)
+    if (collocation_result_gather(collocation_result, num_indices, order) != 0)
     {
-        collocation_pair_delete(collocation_result->pair[i]);
+        free(order);
+        return -1;
     }
-    free(collocation_result->pair);
-    collocation_result->pair = pair;
-    collocation_result->num_pairs = num_pairs;
+    free(order);
 
     return 0;
-
-  error:
-    for (i = 0; i < num_pairs; i++)
-    {
-        collocation_pair_delete(pair[i]);
-    }
-    free(pair);
-
-    return -1;
 }
 
 /** Add collocation result entry to a result set
@@ -682,8 +994,8 @@ LIBHARP_API int harp_collocation_result_add_pair(harp_collocation_result *colloc
                                                  const char *source_product_b, long index_b, int num_differences,
                                                  const double *difference)
 {
-    harp_collocation_pair *pair;
     long product_index_a, product_index_b;
+    long index;
 
     if (num_differences != collocation_result->num_differences)
     {
@@ -713,32 +1025,28 @@ LIBHARP_API int harp_collocation_result_add_pair(harp_collocation_result *colloc
     {
         return -1;
     }
-    if (collocation_pair_new(collocation_index, product_index_a, index_a, product_index_b, index_b, num_differences,
-                             difference, &pair) != 0)
-    {
-        return -1;
-    }
 
     if (collocation_result->num_pairs % COLLOCATION_RESULT_BLOCK_SIZE == 0)
     {
-        harp_collocation_pair **new_pair = NULL;
-
-        new_pair = realloc(collocation_result->pair, (collocation_result->num_pairs + COLLOCATION_RESULT_BLOCK_SIZE) *
-                           sizeof(harp_collocation_pair *));
-        if (new_pair == NULL)
+        if (collocation_result_resize(collocation_result, collocation_result->num_pairs + 1) != 0)
         {
-            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                           (long)(collocation_result->num_pairs + COLLOCATION_RESULT_BLOCK_SIZE) *
-                           sizeof(harp_collocation_pair *), __FILE__, __LINE__);
-            collocation_pair_delete(pair);
             return -1;
         }
-
-        collocation_result->pair = new_pair;
     }
 
-    collocation_result->pair[collocation_result->num_pairs] = pair;
+    index = collocation_result->num_pairs;
+    collocation_result->collocation_index[index] = collocation_index;
+    collocation_result->product_index_a[index] = product_index_a;
+    collocation_result->sample_index_a[index] = index_a;
+    collocation_result->product_index_b[index] = product_index_b;
+    collocation_result->sample_index_b[index] = index_b;
+    if (num_differences > 0)
+    {
+        memcpy(&collocation_result->difference[index * num_differences], difference, num_differences * sizeof(double));
+    }
     collocation_result->num_pairs++;
+    collocation_result_update_pairs(collocation_result, index);
+
     return 0;
 }
 
@@ -751,7 +1059,7 @@ LIBHARP_API int harp_collocation_result_add_pair(harp_collocation_result *colloc
  */
 LIBHARP_API int harp_collocation_result_remove_pair_at_index(harp_collocation_result *collocation_result, long index)
 {
-    long i;
+    long num_trailing_pairs;
 
     if (index < 0 || index >= collocation_result->num_pairs)
     {
@@ -760,12 +1068,98 @@ LIBHARP_API int harp_collocation_result_remove_pair_at_index(harp_collocation_re
         return -1;
     }
 
-    collocation_pair_delete(collocation_result->pair[index]);
-    for (i = index + 1; i < collocation_result->num_pairs; i++)
+    num_trailing_pairs = collocation_result->num_pairs - index - 1;
+    if (num_trailing_pairs > 0)
     {
-        collocation_result->pair[i - 1] = collocation_result->pair[i];
+        int num_differences = collocation_result->num_differences;
+
+        memmove(&collocation_result->collocation_index[index], &collocation_result->collocation_index[index + 1],
+                num_trailing_pairs * sizeof(long));
+        memmove(&collocation_result->product_index_a[index], &collocation_result->product_index_a[index + 1],
+                num_trailing_pairs * sizeof(long));
+        memmove(&collocation_result->sample_index_a[index], &collocation_result->sample_index_a[index + 1],
+                num_trailing_pairs * sizeof(long));
+        memmove(&collocation_result->product_index_b[index], &collocation_result->product_index_b[index + 1],
+                num_trailing_pairs * sizeof(long));
+        memmove(&collocation_result->sample_index_b[index], &collocation_result->sample_index_b[index + 1],
+                num_trailing_pairs * sizeof(long));
+        if (num_differences > 0)
+        {
+            memmove(&collocation_result->difference[index * num_differences],
+                    &collocation_result->difference[(index + 1) * num_differences],
+                    num_trailing_pairs * num_differences * sizeof(double));
+        }
     }
     collocation_result->num_pairs--;
+    collocation_result_update_pairs(collocation_result, index);
+
+    return 0;
+}
+
+/** Remove collocation result entries from a result set based on a mask
+ * All pairs for which the mask value is zero are removed from the collocation result. The remaining pairs keep their
+ * relative order. This is considerably faster than removing pairs one by one using
+ * harp_collocation_result_remove_pair_at_index().
+ * \param collocation_result Result set from which to remove the entries
+ * \param mask Array of num_pairs values; pair i is kept if mask[i] is non-zero
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_collocation_result_filter(harp_collocation_result *collocation_result, const uint8_t *mask)
+{
+    int num_differences = collocation_result->num_differences;
+    long num_pairs = 0;
+    long i;
+
+    for (i = 0; i < collocation_result->num_pairs; i++)
+    {
+        if (mask[i])
+        {
+            if (num_pairs != i)
+            {
+                collocation_result->collocation_index[num_pairs] = collocation_result->collocation_index[i];
+                collocation_result->product_index_a[num_pairs] = collocation_result->product_index_a[i];
+                collocation_result->sample_index_a[num_pairs] = collocation_result->sample_index_a[i];
+                collocation_result->product_index_b[num_pairs] = collocation_result->product_index_b[i];
+                collocation_result->sample_index_b[num_pairs] = collocation_result->sample_index_b[i];
+                if (num_differences > 0)
+                {
+                    memcpy(&collocation_result->difference[num_pairs * num_differences],
+                           &collocation_result->difference[i * num_differences], num_differences * sizeof(double));
+                }
+            }
+            num_pairs++;
+        }
+    }
+    collocation_result->num_pairs = num_pairs;
+    collocation_result_update_pairs(collocation_result, 0);
+
+    return 0;
+}
+
+/** Retrieve a collocation result entry
+ * This fills the \a pair structure with the properties of the pair at the given index. The difference field of the
+ * pair will point to the differences as stored within the collocation result (i.e. it should not be freed and it
+ * remains valid only as long as the collocation result is not modified).
+ * \param collocation_result Result set from which to retrieve the entry
+ * \param index Zero-based index in the collocation result set of the entry
+ * \param pair Pointer to the pair structure that will be filled
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_collocation_result_get_pair(const harp_collocation_result *collocation_result, long index,
+                                                 harp_collocation_pair *pair)
+{
+    if (index < 0 || index >= collocation_result->num_pairs)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "index (%ld) is not in the range of collocation results [0,%ld)",
+                       index, collocation_result->num_pairs);
+        return -1;
+    }
+
+    fill_pair(collocation_result, index, pair);
 
     return 0;
 }
@@ -1095,24 +1489,21 @@ static void write_header(FILE *file, const harp_collocation_result *collocation_
 
 static void write_pair(FILE *file, const harp_collocation_result *collocation_result, long index)
 {
-    harp_collocation_pair *pair;
     int i;
 
-    assert(collocation_result->pair != NULL);
     assert(index >= 0 && index < collocation_result->num_pairs);
-    assert(collocation_result->pair[index] != NULL);
-
-    pair = collocation_result->pair[index];
 
     /* Write filenames and measurement indices */
-    fprintf(file, "%ld,%s,%ld,%s,%ld", pair->collocation_index,
-            collocation_result->dataset_a->source_product[pair->product_index_a], pair->sample_index_a,
-            collocation_result->dataset_b->source_product[pair->product_index_b], pair->sample_index_b);
+    fprintf(file, "%ld,%s,%ld,%s,%ld", collocation_result->collocation_index[index],
+            collocation_result->dataset_a->source_product[collocation_result->product_index_a[index]],
+            collocation_result->sample_index_a[index],
+            collocation_result->dataset_b->source_product[collocation_result->product_index_b[index]],
+            collocation_result->sample_index_b[index]);
 
     /* Write differences */
-    for (i = 0; i < pair->num_differences; i++)
+    for (i = 0; i < collocation_result->num_differences; i++)
     {
-        fprintf(file, ",%.8g", pair->difference[i]);
+        fprintf(file, ",%.8g", collocation_result->difference[index * collocation_result->num_differences + i]);
     }
     fprintf(file, "\n");
 }
@@ -1176,18 +1567,22 @@ LIBHARP_API int harp_collocation_result_write(const char *collocation_result_fil
  */
 LIBHARP_API void harp_collocation_result_swap_datasets(harp_collocation_result *collocation_result)
 {
-    long i;
     harp_dataset *data_a;
+    long *column;
 
-    for (i = 0; i < collocation_result->num_pairs; i++)
-    {
-        collocation_pair_swap_datasets(collocation_result->pair[i]);
-    }
+    column = collocation_result->product_index_a;
+    collocation_result->product_index_a = collocation_result->product_index_b;
+    collocation_result->product_index_b = column;
+    column = collocation_result->sample_index_a;
+    collocation_result->sample_index_a = collocation_result->sample_index_b;
+    collocation_result->sample_index_b = column;
 
     data_a = collocation_result->dataset_a;
 
     collocation_result->dataset_a = collocation_result->dataset_b;
     collocation_result->dataset_b = data_a;
+
+    collocation_result_update_pairs(collocation_result, 0);
 }
 
 /**
@@ -1199,7 +1594,8 @@ int harp_collocation_result_shallow_copy(const harp_collocation_result *collocat
                                          harp_collocation_result **new_result)
 {
     harp_collocation_result *result = NULL;
-    long i;
+    long num_pairs = collocation_result->num_pairs;
+    int num_differences = collocation_result->num_differences;
 
     /* allocate memory for the result struct */
     result = (harp_collocation_result *)malloc(sizeof(harp_collocation_result));
@@ -1211,37 +1607,38 @@ int harp_collocation_result_shallow_copy(const harp_collocation_result *collocat
     }
     result->dataset_a = collocation_result->dataset_a;
     result->dataset_b = collocation_result->dataset_b;
-    result->num_differences = collocation_result->num_differences;
+    result->num_differences = num_differences;
     result->difference_variable_name = collocation_result->difference_variable_name;
     result->difference_unit = collocation_result->difference_unit;
-    result->num_pairs = collocation_result->num_pairs;
+    result->num_pairs = 0;
     result->pair = NULL;
+    result->collocation_index = NULL;
+    result->product_index_a = NULL;
+    result->sample_index_a = NULL;
+    result->product_index_b = NULL;
+    result->sample_index_b = NULL;
+    result->difference = NULL;
 
-    result->pair = malloc(collocation_result->num_pairs * sizeof(harp_collocation_pair *));
-    if (result->pair == NULL)
+    if (collocation_result_resize(result, num_pairs) != 0)
     {
-        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       collocation_result->num_pairs * sizeof(harp_collocation_pair *), __FILE__, __LINE__);
         harp_collocation_result_shallow_delete(result);
         return -1;
     }
-    for (i = 0; i < collocation_result->num_pairs; i++)
+    result->num_pairs = num_pairs;
+    if (num_pairs > 0)
     {
-        result->pair[i] = NULL;
-    }
-
-    for (i = 0; i < collocation_result->num_pairs; i++)
-    {
-        harp_collocation_pair *pair = collocation_result->pair[i];
-
-        if (collocation_pair_new(pair->collocation_index, pair->product_index_a, pair->sample_index_a,
-                                 pair->product_index_b, pair->sample_index_b, pair->num_differences, pair->difference,
-                                 &result->pair[i]) != 0)
+        memcpy(result->collocation_index, collocation_result->collocation_index, num_pairs * sizeof(long));
+        memcpy(result->product_index_a, collocation_result->product_index_a, num_pairs * sizeof(long));
+        memcpy(result->sample_index_a, collocation_result->sample_index_a, num_pairs * sizeof(long));
+        memcpy(result->product_index_b, collocation_result->product_index_b, num_pairs * sizeof(long));
+        memcpy(result->sample_index_b, collocation_result->sample_index_b, num_pairs * sizeof(long));
+        if (num_differences > 0)
         {
-            harp_collocation_result_shallow_delete(result);
-            return -1;
+            memcpy(result->difference, collocation_result->difference,
+                   num_pairs * num_differences * sizeof(double));
         }
     }
+    collocation_result_update_pairs(result, 0);
 
     *new_result = result;
 
@@ -1254,16 +1651,32 @@ void harp_collocation_result_shallow_delete(harp_collocation_result *collocation
     {
         if (collocation_result->pair != NULL)
         {
-            long i;
-
-            for (i = 0; i < collocation_result->num_pairs; i++)
-            {
-                collocation_pair_delete(collocation_result->pair[i]);
-            }
-
             free(collocation_result->pair);
         }
-
+        if (collocation_result->collocation_index != NULL)
+        {
+            free(collocation_result->collocation_index);
+        }
+        if (collocation_result->product_index_a != NULL)
+        {
+            free(collocation_result->product_index_a);
+        }
+        if (collocation_result->sample_index_a != NULL)
+        {
+            free(collocation_result->sample_index_a);
+        }
+        if (collocation_result->product_index_b != NULL)
+        {
+            free(collocation_result->product_index_b);
+        }
+        if (collocation_result->sample_index_b != NULL)
+        {
+            free(collocation_result->sample_index_b);
+        }
+        if (collocation_result->difference != NULL)
+        {
+            free(collocation_result->difference);
+        }
         free(collocation_result);
     }
 }
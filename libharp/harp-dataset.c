@@ -1083,6 +1083,11 @@ LIBHARP_API int harp_dataset_prefilter(harp_dataset *dataset, const char *operat
     {
         return -1;
     }
+    if (harp_program_optimize(program, NULL, NULL) != 0)
+    {
+        harp_program_delete(program);
+        return -1;
+    }
 
     mask = malloc(dataset->num_products);
     if (mask == NULL)
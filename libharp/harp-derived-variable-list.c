@@ -111,7 +111,6 @@ static int get_angstrom_exponent_from_aod(harp_variable *variable, const harp_va
 static int get_area(harp_variable *variable, const harp_variable **source_variable)
 {
     long num_vertices;
-    long i;
 
     num_vertices = source_variable[0]->dimension[source_variable[0]->num_dimensions - 1];
     if (source_variable[1]->dimension[source_variable[1]->num_dimensions - 1] != num_vertices)
@@ -121,70 +120,95 @@ static int get_area(harp_variable *variable, const harp_variable **source_variab
         return -1;
     }
 
-    for (i = 0; i < variable->num_elements; i++)
-    {
-        if (harp_geometry_get_area(num_vertices, &source_variable[0]->data.double_data[i * num_vertices],
-                                   &source_variable[1]->data.double_data[i * num_vertices],
-                                   &variable->data.double_data[i]) != 0)
-        {
-            return -1;
-        }
-    }
-
-    return 0;
+    return harp_geometry_get_area_array(variable->num_elements, num_vertices, source_variable[0]->data.double_data,
+                                        source_variable[1]->data.double_data, variable->data.double_data);
 }
 
 /* area from latitude_bounds {latitude,2} and longitude_bounds {longitude,2} */
 static int get_area_gridded(harp_variable *variable, const harp_variable **source_variable)
 {
-    long num_latitude, num_longitude;
-    long i, j;
-
-    num_latitude = source_variable[0]->dimension[0];
-    num_longitude = source_variable[1]->dimension[0];
-
-    for (i = 0; i < num_latitude; i++)
-    {
-        for (j = 0; j < num_longitude; j++)
-        {
-            if (harp_geometry_get_area(2, &source_variable[0]->data.double_data[i * 2],
-                                       &source_variable[1]->data.double_data[j * 2],
-                                       &variable->data.double_data[i * num_longitude + j]) != 0)
-            {
-                return -1;
-            }
-        }
-    }
-
-    return 0;
+    return harp_geometry_get_area_gridded(source_variable[0]->dimension[0], source_variable[0]->data.double_data,
+                                          source_variable[1]->dimension[0], source_variable[1]->data.double_data,
+                                          variable->data.double_data);
 }
 
 static int get_aux_variable_afgl86(harp_variable *variable, const harp_variable **source_variable)
 {
+    const double *altitude[HARP_AUX_AFGL86_NUM_PROFILES];
+    const double *values[HARP_AUX_AFGL86_NUM_PROFILES];
+    const double *prev_altitude_grid = NULL;
+    long profile_sample[HARP_AUX_AFGL86_NUM_PROFILES];
+    long num_levels = variable->dimension[1];
+    int num_levels_afgl86;
+    double *weight;
+    long *index;
     long i;
+    int k;
+
+    /* all profiles share the same altitude grid, so we only need to resolve the profiles once */
+    if (harp_aux_afgl86_get_profiles("altitude", &num_levels_afgl86, altitude) != 0)
+    {
+        return -1;
+    }
+    if (harp_aux_afgl86_get_profiles(variable->name, &num_levels_afgl86, values) != 0)
+    {
+        return -1;
+    }
+
+    index = malloc((size_t)num_levels * sizeof(long));
+    if (index == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       (size_t)num_levels * sizeof(long), __FILE__, __LINE__);
+        return -1;
+    }
+    weight = malloc((size_t)num_levels * sizeof(double));
+    if (weight == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       (size_t)num_levels * sizeof(double), __FILE__, __LINE__);
+        free(index);
+        return -1;
+    }
 
     for (i = 0; i < variable->dimension[0]; i++)
     {
-        long num_levels = variable->dimension[1];
-        int num_levels_afgl86;
-        const double *altitude;
-        const double *values;
+        const double *altitude_grid = &source_variable[2]->data.double_data[i * num_levels];
+        double *target = &variable->data.double_data[i * num_levels];
 
-        if (harp_aux_afgl86_get_profile("altitude", source_variable[0]->data.double_data[i],
-                                        source_variable[1]->data.double_data[i], &num_levels_afgl86, &altitude) != 0)
+        if (prev_altitude_grid == NULL ||
+            memcmp(prev_altitude_grid, altitude_grid, (size_t)num_levels * sizeof(double)) != 0)
         {
-            return -1;
+            /* the interpolation weights only depend on the altitude grid, so they are shared by all profiles and
+             * by consecutive samples that have an identical altitude grid
+             */
+            harp_interpolate_linear_weights(num_levels_afgl86, altitude[0], num_levels, altitude_grid, index, weight);
+            prev_altitude_grid = altitude_grid;
+            /* for each profile, keep track of the sample that was interpolated using the current weights */
+            for (k = 0; k < HARP_AUX_AFGL86_NUM_PROFILES; k++)
+            {
+                profile_sample[k] = -1;
+            }
         }
-        if (harp_aux_afgl86_get_profile(variable->name, source_variable[0]->data.double_data[i],
-                                        source_variable[1]->data.double_data[i], &num_levels_afgl86, &values) != 0)
+
+        k = harp_aux_afgl86_get_profile_index(source_variable[0]->data.double_data[i],
+                                              source_variable[1]->data.double_data[i]);
+        if (profile_sample[k] >= 0)
         {
-            return -1;
+            /* same profile on the same altitude grid as an earlier sample */
+            memcpy(target, &variable->data.double_data[profile_sample[k] * num_levels],
+                   (size_t)num_levels * sizeof(double));
+        }
+        else
+        {
+            harp_interpolate_array_linear_with_weights(num_levels, index, weight, values[k], target);
+            profile_sample[k] = i;
         }
-        harp_interpolate_array_linear(num_levels_afgl86, altitude, values, num_levels,
-                                      &source_variable[2]->data.double_data[i * num_levels], 0,
-                                      &variable->data.double_data[i * num_levels]);
     }
 
+    free(weight);
+    free(index);
+
     return 0;
 }
 
@@ -193,6 +217,7 @@ static int get_aux_variable_usstd76(harp_variable *variable, const harp_variable
     int num_levels_usstd76;
     const double *altitude;
     const double *values;
+    long num_levels = variable->dimension[1];
     long i;
 
     if (harp_aux_usstd76_get_profile("altitude", &num_levels_usstd76, &altitude) != 0)
@@ -206,11 +231,20 @@ static int get_aux_variable_usstd76(harp_variable *variable, const harp_variable
 
     for (i = 0; i < variable->dimension[0]; i++)
     {
-        long num_levels = variable->dimension[1];
+        const double *altitude_grid = &source_variable[0]->data.double_data[i * num_levels];
 
-        harp_interpolate_array_linear(num_levels_usstd76, altitude, values, num_levels,
-                                      &source_variable[0]->data.double_data[i * num_levels], 0,
-                                      &variable->data.double_data[i * num_levels]);
+        if (i > 0 && memcmp(&source_variable[0]->data.double_data[(i - 1) * num_levels], altitude_grid,
+                            (size_t)num_levels * sizeof(double)) == 0)
+        {
+            /* same altitude grid as the previous sample, so the result is also the same */
+            memcpy(&variable->data.double_data[i * num_levels], &variable->data.double_data[(i - 1) * num_levels],
+                   (size_t)num_levels * sizeof(double));
+        }
+        else
+        {
+            harp_interpolate_array_linear(num_levels_usstd76, altitude, values, num_levels, altitude_grid, 0,
+                                          &variable->data.double_data[i * num_levels]);
+        }
     }
 
     return 0;
@@ -739,7 +773,6 @@ static int get_latitude_bounds_from_midpoints(harp_variable *variable, const har
 static int get_latitude_from_latlon_bounds(harp_variable *variable, const harp_variable **source_variable)
 {
     long num_vertices;
-    long i;
 
     num_vertices = source_variable[0]->dimension[source_variable[0]->num_dimensions - 1];
     if (source_variable[1]->dimension[source_variable[1]->num_dimensions - 1] != num_vertices)
@@ -749,21 +782,10 @@ static int get_latitude_from_latlon_bounds(harp_variable *variable, const harp_v
         return -1;
     }
 
-    for (i = 0; i < variable->num_elements; i++)
-    {
-        double latitude, longitude;
-
-        if (harp_geographic_center_from_bounds(num_vertices, &source_variable[0]->data.double_data[i * num_vertices],
-                                               &source_variable[1]->data.double_data[i * num_vertices], &latitude,
-                                               &longitude) != 0)
-        {
-            return -1;
-        }
-
-        variable->data.double_data[i] = latitude;
-    }
-
-    return 0;
+    return harp_geographic_center_from_bounds_array(variable->num_elements, num_vertices,
+                                                    source_variable[0]->data.double_data,
+                                                    source_variable[1]->data.double_data, variable->data.double_data,
+                                                    NULL);
 }
 
 static int get_length_from_begin_and_end(harp_variable *variable, const harp_variable **source_variable)
@@ -821,7 +843,6 @@ static int get_longitude_bounds_from_midpoints(harp_variable *variable, const ha
 static int get_longitude_from_latlon_bounds(harp_variable *variable, const harp_variable **source_variable)
 {
     long num_vertices;
-    long i;
 
     num_vertices = source_variable[0]->dimension[source_variable[0]->num_dimensions - 1];
     if (source_variable[1]->dimension[source_variable[1]->num_dimensions - 1] != num_vertices)
@@ -831,21 +852,10 @@ static int get_longitude_from_latlon_bounds(harp_variable *variable, const harp_
         return -1;
     }
 
-    for (i = 0; i < variable->num_elements; i++)
-    {
-        double latitude, longitude;
-
-        if (harp_geographic_center_from_bounds(num_vertices, &source_variable[0]->data.double_data[i * num_vertices],
-                                               &source_variable[1]->data.double_data[i * num_vertices], &latitude,
-                                               &longitude) != 0)
-        {
-            return -1;
-        }
-
-        variable->data.double_data[i] = longitude;
-    }
-
-    return 0;
+    return harp_geographic_center_from_bounds_array(variable->num_elements, num_vertices,
+                                                    source_variable[0]->data.double_data,
+                                                    source_variable[1]->data.double_data, NULL,
+                                                    variable->data.double_data);
 }
 
 static int get_midpoint_from_begin_and_end(harp_variable *variable, const harp_variable **source_variable)
@@ -36,10 +36,161 @@
 #include <stdlib.h>
 #include <string.h>
 
+static int popcount64(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/* Index of the lowest set bit; word should not be zero. */
+static int count_trailing_zeros64(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    return popcount64((word & (~word + 1)) - 1);
+#endif
+}
+
+/* Mask for the bits of the last word of a row that are in use. */
+static uint64_t last_word_mask(long num_elements)
+{
+    if ((num_elements & 63) == 0)
+    {
+        return ~(uint64_t)0;
+    }
+    return ((uint64_t)1 << (num_elements & 63)) - 1;
+}
+
+/* Set the first num_elements entries of a row to the given value and clear the unused bits at the end of the row. */
+static void fill_row(long num_elements, uint64_t *mask, int value)
+{
+    long num_words = HARP_MASK_NUM_WORDS(num_elements);
+
+    if (num_words == 0)
+    {
+        return;
+    }
+    memset(mask, value ? 0xFF : 0, num_words * sizeof(uint64_t));
+    mask[num_words - 1] &= last_word_mask(num_elements);
+}
+
+/* Returns 1 if any of the entries in the row is set, 0 otherwise. */
+static int row_has_any(long num_elements, const uint64_t *mask)
+{
+    long num_words = HARP_MASK_NUM_WORDS(num_elements);
+    long i;
+
+    for (i = 0; i < num_words; i++)
+    {
+        if (mask[i] != 0)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/** Return the number of set entries in a (1-D) mask using population counts on whole words. */
+long harp_mask_count(long num_elements, const uint64_t *mask)
+{
+    long num_words = HARP_MASK_NUM_WORDS(num_elements);
+    long count = 0;
+    long i;
+
+    if (num_words == 0)
+    {
+        return 0;
+    }
+    for (i = 0; i < num_words - 1; i++)
+    {
+        count += popcount64(mask[i]);
+    }
+    count += popcount64(mask[num_words - 1] & last_word_mask(num_elements));
+
+    return count;
+}
+
+/** Return the number of runs of consecutive set entries in a (1-D) mask. */
+long harp_mask_count_runs(long num_elements, const uint64_t *mask)
+{
+    long num_words = HARP_MASK_NUM_WORDS(num_elements);
+    uint64_t carry = 0;
+    long count = 0;
+    long i;
+
+    for (i = 0; i < num_words; i++)
+    {
+        uint64_t word = mask[i];
+
+        if (i == num_words - 1)
+        {
+            word &= last_word_mask(num_elements);
+        }
+        /* a run starts at each set bit for which the preceding bit is not set */
+        count += popcount64(word & ~((word << 1) | carry));
+        carry = word >> 63;
+    }
+
+    return count;
+}
+
+static long find_next(long num_elements, const uint64_t *mask, long index, uint64_t invert)
+{
+    long word_index;
+    uint64_t word;
+
+    if (index >= num_elements)
+    {
+        return num_elements;
+    }
+
+    word_index = index >> 6;
+    word = (mask[word_index] ^ invert) & (~(uint64_t)0 << (index & 63));
+    while (word == 0)
+    {
+        word_index++;
+        if ((word_index << 6) >= num_elements)
+        {
+            return num_elements;
+        }
+        word = mask[word_index] ^ invert;
+    }
+
+    index = (word_index << 6) + count_trailing_zeros64(word);
+
+    return index < num_elements ? index : num_elements;
+}
+
+/** Return the index of the first set mask entry at or after \a index (or \a num_elements if there is none).
+ * Fully unset words are skipped as a whole.
+ */
+long harp_mask_find_next_set(long num_elements, const uint64_t *mask, long index)
+{
+    return find_next(num_elements, mask, index, 0);
+}
+
+/** Return the index of the first unset mask entry at or after \a index (or \a num_elements if there is none).
+ * Fully set words are skipped as a whole.
+ */
+long harp_mask_find_next_unset(long num_elements, const uint64_t *mask, long index)
+{
+    return find_next(num_elements, mask, index, ~(uint64_t)0);
+}
+
 int harp_dimension_mask_new(int num_dimensions, const long *dimension, harp_dimension_mask **new_dimension_mask)
 {
     int i;
     harp_dimension_mask *dimension_mask;
+    long num_rows;
+    long num_words;
 
     dimension_mask = (harp_dimension_mask *)malloc(sizeof(harp_dimension_mask));
     if (dimension_mask == NULL)
@@ -58,21 +209,22 @@ int harp_dimension_mask_new(int num_dimensions, const long *dimension, harp_dime
         dimension_mask->dimension[i] = dimension[i];
         dimension_mask->num_elements *= dimension[i];
     }
+    dimension_mask->row_num_words = HARP_MASK_NUM_WORDS(num_dimensions == 0 ? 1 : dimension[num_dimensions - 1]);
+    num_rows = (num_dimensions <= 1 ? 1 : dimension[0]);
+    num_words = num_rows * dimension_mask->row_num_words;
 
-    dimension_mask->mask = malloc((size_t)dimension_mask->num_elements * sizeof(uint8_t));
+    /* always allocate at least one word, such that the mask pointer is never NULL */
+    dimension_mask->mask = (uint64_t *)malloc((size_t)(num_words > 0 ? num_words : 1) * sizeof(uint64_t));
     if (dimension_mask->mask == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       dimension_mask->num_elements * sizeof(uint8_t), __FILE__, __LINE__);
+                       (num_words > 0 ? num_words : 1) * sizeof(uint64_t), __FILE__, __LINE__);
         harp_dimension_mask_delete(dimension_mask);
         return -1;
     }
 
     /* Initialize the mask to all 1's. */
-    for (i = 0; i < dimension_mask->num_elements; i++)
-    {
-        dimension_mask->mask[i] = 1;
-    }
+    harp_dimension_mask_fill_true(dimension_mask);
 
     *new_dimension_mask = dimension_mask;
     return 0;
@@ -91,9 +243,35 @@ void harp_dimension_mask_delete(harp_dimension_mask *dimension_mask)
     }
 }
 
+static long get_num_rows(const harp_dimension_mask *dimension_mask)
+{
+    return dimension_mask->num_dimensions <= 1 ? 1 : dimension_mask->dimension[0];
+}
+
+static long get_row_length(const harp_dimension_mask *dimension_mask)
+{
+    return dimension_mask->num_dimensions == 0 ? 1 : dimension_mask->dimension[dimension_mask->num_dimensions - 1];
+}
+
+/* Returns the total number of set entries in the mask. */
+static long count_all(const harp_dimension_mask *dimension_mask)
+{
+    long num_rows = get_num_rows(dimension_mask);
+    long count = 0;
+    long i;
+
+    for (i = 0; i < num_rows; i++)
+    {
+        count += harp_mask_count(get_row_length(dimension_mask), harp_dimension_mask_get_row(dimension_mask, i));
+    }
+
+    return count;
+}
+
 int harp_dimension_mask_copy(const harp_dimension_mask *other_dimension_mask, harp_dimension_mask **new_dimension_mask)
 {
     harp_dimension_mask *dimension_mask;
+    long num_words;
     int i;
 
     assert(other_dimension_mask != NULL);
@@ -113,18 +291,21 @@ int harp_dimension_mask_copy(const harp_dimension_mask *other_dimension_mask, ha
         dimension_mask->dimension[i] = other_dimension_mask->dimension[i];
     }
     dimension_mask->num_elements = other_dimension_mask->num_elements;
+    dimension_mask->row_num_words = other_dimension_mask->row_num_words;
     dimension_mask->masked_dimension_length = other_dimension_mask->masked_dimension_length;
     dimension_mask->mask = NULL;
 
-    dimension_mask->mask = (uint8_t *)malloc(dimension_mask->num_elements * sizeof(uint8_t));
+    num_words = get_num_rows(dimension_mask) * dimension_mask->row_num_words;
+    dimension_mask->mask = (uint64_t *)malloc((size_t)(num_words > 0 ? num_words : 1) * sizeof(uint64_t));
     if (dimension_mask->mask == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       dimension_mask->num_elements * sizeof(uint8_t), __FILE__, __LINE__);
+                       (num_words > 0 ? num_words : 1) * sizeof(uint64_t), __FILE__, __LINE__);
+        harp_dimension_mask_delete(dimension_mask);
         return -1;
     }
 
-    memcpy(dimension_mask->mask, other_dimension_mask->mask, dimension_mask->num_elements * sizeof(uint8_t));
+    memcpy(dimension_mask->mask, other_dimension_mask->mask, num_words * sizeof(uint64_t));
 
     *new_dimension_mask = dimension_mask;
     return 0;
@@ -167,67 +348,68 @@ void harp_dimension_mask_set_delete(harp_dimension_mask_set *dimension_mask_set)
     }
 }
 
+/** Return a pointer to the first mask word of the given row (i.e. index on the outer dimension) of a 2-D mask.
+ * For 1-D masks, \a row_index should be 0.
+ */
+uint64_t *harp_dimension_mask_get_row(const harp_dimension_mask *dimension_mask, long row_index)
+{
+    assert(row_index >= 0 && row_index < get_num_rows(dimension_mask));
+
+    return dimension_mask->mask + row_index * dimension_mask->row_num_words;
+}
+
 int harp_dimension_mask_fill_true(harp_dimension_mask *dimension_mask)
 {
-    assert(dimension_mask != NULL && dimension_mask->num_elements > 0 && dimension_mask->mask != NULL);
+    long num_rows;
+    long i;
 
-    memset(dimension_mask->mask, 1, dimension_mask->num_elements);
+    assert(dimension_mask != NULL && dimension_mask->mask != NULL);
 
-    dimension_mask->masked_dimension_length = 1;
-    if (dimension_mask->num_elements > 0)
+    num_rows = get_num_rows(dimension_mask);
+    for (i = 0; i < num_rows; i++)
     {
-        dimension_mask->masked_dimension_length *= dimension_mask->dimension[dimension_mask->num_dimensions - 1];
+        fill_row(get_row_length(dimension_mask), harp_dimension_mask_get_row(dimension_mask, i), 1);
     }
 
+    dimension_mask->masked_dimension_length = dimension_mask->num_elements > 0 ? get_row_length(dimension_mask) : 0;
+
     return 0;
 }
 
 int harp_dimension_mask_fill_false(harp_dimension_mask *dimension_mask)
 {
-    assert(dimension_mask != NULL && dimension_mask->num_elements > 0 && dimension_mask->mask != NULL);
+    assert(dimension_mask != NULL && dimension_mask->mask != NULL);
 
-    memset(dimension_mask->mask, 0, dimension_mask->num_elements * sizeof(uint8_t));
+    memset(dimension_mask->mask, 0, get_num_rows(dimension_mask) * dimension_mask->row_num_words * sizeof(uint64_t));
     dimension_mask->masked_dimension_length = 0;
 
     return 0;
 }
 
-static long count(long num_elements, const uint8_t *mask)
-{
-    const uint8_t *mask_end;
-    long count;
-
-    count = 0;
-    for (mask_end = mask + num_elements; mask != mask_end; mask++)
-    {
-        if (*mask)
-        {
-            count++;
-        }
-    }
-
-    return count;
-}
-
+/** Recompute the masked dimension length (i.e. the maximum number of set entries in a row) from the mask itself. */
 int harp_dimension_mask_update_masked_length(harp_dimension_mask *dimension_mask)
 {
-    long num_blocks;
-    long num_block_elements;
+    long num_rows;
     long max_masked_length;
     long i;
 
     assert(dimension_mask != NULL);
     assert(dimension_mask->num_elements == 0 || dimension_mask->mask != NULL);
 
-    num_blocks = (dimension_mask->num_dimensions <= 1 ? 1 : dimension_mask->dimension[0]);
-    num_block_elements = dimension_mask->num_elements / num_blocks;
+    if (dimension_mask->num_elements == 0)
+    {
+        dimension_mask->masked_dimension_length = 0;
+        return 0;
+    }
+
+    num_rows = get_num_rows(dimension_mask);
 
     max_masked_length = 0;
-    for (i = 0; i < num_blocks; i++)
+    for (i = 0; i < num_rows; i++)
     {
         long masked_length;
 
-        masked_length = count(num_block_elements, &dimension_mask->mask[i * num_block_elements]);
+        masked_length = harp_mask_count(get_row_length(dimension_mask), harp_dimension_mask_get_row(dimension_mask, i));
         if (masked_length > max_masked_length)
         {
             max_masked_length = masked_length;
@@ -242,61 +424,44 @@ int harp_dimension_mask_outer_product(const harp_dimension_mask *row_mask, const
                                       harp_dimension_mask **new_dimension_mask)
 {
     harp_dimension_mask *dimension_mask;
+    long dimension[2];
     long i;
 
     assert(row_mask != NULL && row_mask->num_dimensions == 1 && row_mask->mask != NULL);
     assert(col_mask != NULL && col_mask->num_dimensions == 1 && col_mask->mask != NULL);
     assert(new_dimension_mask != NULL);
 
-    dimension_mask = (harp_dimension_mask *)malloc(sizeof(harp_dimension_mask));
-    if (dimension_mask == NULL)
-    {
-        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       sizeof(harp_dimension_mask), __FILE__, __LINE__);
-        return -1;
-    }
-
-    dimension_mask->num_dimensions = 2;
-    dimension_mask->dimension[0] = row_mask->num_elements;
-    dimension_mask->dimension[1] = col_mask->num_elements;
-    dimension_mask->num_elements = dimension_mask->dimension[0] * dimension_mask->dimension[1];
-
-    if (row_mask->masked_dimension_length != 0)
-    {
-        dimension_mask->masked_dimension_length = col_mask->masked_dimension_length;
-    }
-
-    dimension_mask->mask = malloc(dimension_mask->num_elements * sizeof(uint8_t));
-    if (dimension_mask->mask == NULL)
+    dimension[0] = row_mask->num_elements;
+    dimension[1] = col_mask->num_elements;
+    if (harp_dimension_mask_new(2, dimension, &dimension_mask) != 0)
     {
-        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       dimension_mask->num_elements * sizeof(uint8_t), __FILE__, __LINE__);
-        harp_dimension_mask_delete(dimension_mask);
         return -1;
     }
 
     for (i = 0; i < row_mask->num_elements; i++)
     {
-        if (row_mask->mask[i])
+        if (HARP_MASK_GET(row_mask->mask, i))
         {
-            memcpy(dimension_mask->mask + i * dimension_mask->dimension[1], col_mask->mask,
-                   dimension_mask->dimension[1] * sizeof(uint8_t));
+            memcpy(harp_dimension_mask_get_row(dimension_mask, i), col_mask->mask,
+                   dimension_mask->row_num_words * sizeof(uint64_t));
         }
         else
         {
-            memset(dimension_mask->mask + i * dimension_mask->dimension[1], 0,
-                   dimension_mask->dimension[1] * sizeof(uint8_t));
+            memset(harp_dimension_mask_get_row(dimension_mask, i), 0, dimension_mask->row_num_words * sizeof(uint64_t));
         }
     }
 
+    dimension_mask->masked_dimension_length = (row_mask->masked_dimension_length != 0 ?
+                                               col_mask->masked_dimension_length : 0);
+
     *new_dimension_mask = dimension_mask;
     return 0;
 }
 
 int harp_dimension_mask_prepend_dimension(harp_dimension_mask *dimension_mask, long length)
 {
-    uint8_t *mask;
-    long new_num_elements;
+    uint64_t *mask;
+    long row_num_words;
     long i;
 
     assert(dimension_mask != NULL);
@@ -304,23 +469,23 @@ int harp_dimension_mask_prepend_dimension(harp_dimension_mask *dimension_mask, l
     assert(dimension_mask->num_dimensions < 2);
     assert(dimension_mask->num_elements > 0);
 
-    new_num_elements = dimension_mask->num_elements * length;
-    mask = (uint8_t *)realloc((void *)dimension_mask->mask, new_num_elements * sizeof(uint8_t));
+    /* the existing mask becomes a row of the new mask and is repeated for each index of the new dimension */
+    row_num_words = dimension_mask->row_num_words;
+    mask = (uint64_t *)realloc((void *)dimension_mask->mask, length * row_num_words * sizeof(uint64_t));
     if (mask == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       new_num_elements * sizeof(uint8_t), __FILE__, __LINE__);
+                       length * row_num_words * sizeof(uint64_t), __FILE__, __LINE__);
         return -1;
     }
     dimension_mask->mask = mask;
 
     for (i = 1; i < length; i++)
     {
-        memcpy(dimension_mask->mask + i * dimension_mask->num_elements, dimension_mask->mask,
-               dimension_mask->num_elements * sizeof(uint8_t));
+        memcpy(dimension_mask->mask + i * row_num_words, dimension_mask->mask, row_num_words * sizeof(uint64_t));
     }
 
-    dimension_mask->num_elements = new_num_elements;
+    dimension_mask->num_elements *= length;
     dimension_mask->num_dimensions++;
     for (i = dimension_mask->num_dimensions - 1; i > 0; i--)
     {
@@ -334,8 +499,9 @@ int harp_dimension_mask_prepend_dimension(harp_dimension_mask *dimension_mask, l
 
 int harp_dimension_mask_append_dimension(harp_dimension_mask *dimension_mask, long length)
 {
-    uint8_t *mask;
-    long new_num_elements;
+    uint64_t *mask;
+    long num_rows;
+    long row_num_words;
     long i;
 
     assert(dimension_mask != NULL);
@@ -344,28 +510,26 @@ int harp_dimension_mask_append_dimension(harp_dimension_mask *dimension_mask, lo
     assert(dimension_mask->num_elements > 0);
     assert(dimension_mask->mask != NULL);
 
-    new_num_elements = dimension_mask->num_elements * length;
-
-    mask = (uint8_t *)realloc((void *)dimension_mask->mask, new_num_elements * sizeof(uint8_t));
+    /* each entry of the existing mask becomes a row of the new mask that is either fully set or fully unset */
+    num_rows = dimension_mask->num_elements;
+    row_num_words = HARP_MASK_NUM_WORDS(length);
+    mask = (uint64_t *)malloc(num_rows * row_num_words * sizeof(uint64_t));
     if (mask == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       new_num_elements * sizeof(uint8_t), __FILE__, __LINE__);
+                       num_rows * row_num_words * sizeof(uint64_t), __FILE__, __LINE__);
         return -1;
     }
-    dimension_mask->mask = mask;
 
-    for (i = dimension_mask->num_elements - 1; i >= 0; i--)
+    for (i = 0; i < num_rows; i++)
     {
-        long j;
-
-        for (j = 0; j < length; j++)
-        {
-            dimension_mask->mask[i * length + j] = dimension_mask->mask[i];
-        }
+        fill_row(length, mask + i * row_num_words, HARP_MASK_GET(dimension_mask->mask, i));
     }
 
-    dimension_mask->num_elements = new_num_elements;
+    free(dimension_mask->mask);
+    dimension_mask->mask = mask;
+    dimension_mask->row_num_words = row_num_words;
+    dimension_mask->num_elements = num_rows * length;
     dimension_mask->dimension[dimension_mask->num_dimensions] = length;
     dimension_mask->num_dimensions++;
 
@@ -387,86 +551,55 @@ int harp_dimension_mask_reduce(const harp_dimension_mask *dimension_mask, int di
                                harp_dimension_mask **new_dimension_mask)
 {
     harp_dimension_mask *reduced_dimension_mask;
-    long num_groups;
+    long num_rows;
+    long row_length;
     long num_blocks;
-    long num_block_elements;
     long i;
 
     assert(dimension_mask != NULL && dimension_mask->num_elements != 0 && dimension_mask->mask != NULL);
     assert(dim_index >= 0 && dim_index < dimension_mask->num_dimensions);
 
-    /* The mask is split into three parts:
-     *     num_elements = num_groups * num_blocks * num_block_elements.
-     *
-     * Here, num_groups is the product of dimensions [0, dim_index), num_blocks is dimension[dim_index],
-     * and num_block_elements is the product of dimensions (dim_index, num_dimensions).
-     */
-
-    /* Calculate the number of times we have to filter the indices (i.e. the product of the higher dimensions) */
-    num_groups = 1;
-    for (i = 0; i < dim_index; i++)
-    {
-        num_groups *= dimension_mask->dimension[i];
-    }
-
-    /* Calculate the number of blocks. */
-    num_blocks = dimension_mask->dimension[dim_index];
-
-    /* Calculate the number of elements per block. */
-    num_block_elements = dimension_mask->num_elements / (num_groups * num_blocks);
+    num_rows = get_num_rows(dimension_mask);
+    row_length = get_row_length(dimension_mask);
 
     /* Allocate the reduced mask. */
+    num_blocks = dimension_mask->dimension[dim_index];
     if (harp_dimension_mask_new(1, &num_blocks, &reduced_dimension_mask) != 0)
     {
         return -1;
     }
 
-    /* Initialize the mask to false (harp_dimension_mask_new() initializes to true). */
-    if (harp_dimension_mask_fill_false(reduced_dimension_mask) != 0)
-    {
-        harp_dimension_mask_delete(reduced_dimension_mask);
-        return -1;
-    }
-
-    /* Reduce the mask along the specified dimension. For each index on the specified dimension, if any value in the
-     * sub mask corresponding to this index is set to true, set the corresponding value in the reduced mask to true and
-     * move to the next index.
-     */
-    for (i = 0; i < num_blocks; i++)
+    if (dim_index == dimension_mask->num_dimensions - 1)
     {
-        long j;
-
-        for (j = 0; j < num_groups; j++)
+        /* Reduce along the inner dimension: an index is kept if it is set in any of the rows, which amounts to a
+         * word-wise OR of all rows.
+         */
+        memset(reduced_dimension_mask->mask, 0, reduced_dimension_mask->row_num_words * sizeof(uint64_t));
+        for (i = 0; i < num_rows; i++)
         {
-            const uint8_t *block_ptr;
-            const uint8_t *block_end_ptr;
-
-            block_ptr = dimension_mask->mask + (j * num_blocks + i) * num_block_elements;
-            block_end_ptr = block_ptr + num_block_elements;
+            const uint64_t *row = harp_dimension_mask_get_row(dimension_mask, i);
+            long j;
 
-            for (; block_ptr != block_end_ptr; block_ptr++)
+            for (j = 0; j < dimension_mask->row_num_words; j++)
             {
-                if (*block_ptr)
-                {
-                    break;
-                }
+                reduced_dimension_mask->mask[j] |= row[j];
             }
-
-            if (block_ptr != block_end_ptr)
+        }
+    }
+    else
+    {
+        /* Reduce along the outer dimension: an index is kept if any entry in the corresponding row is set. */
+        assert(dim_index == 0 && dimension_mask->num_dimensions == 2);
+        for (i = 0; i < num_rows; i++)
+        {
+            if (!row_has_any(row_length, harp_dimension_mask_get_row(dimension_mask, i)))
             {
-                /* If any value in the block is set to true, the loop above will exit early, and therefore block_ptr
-                 * will not equal block_end_ptr. In this case, the corresponding value in the reduced mask can be set
-                 * to true and no additional blocks related to this index need to be examined.
-                 */
-                reduced_dimension_mask->mask[i] = 1;
-                reduced_dimension_mask->masked_dimension_length++;
-                break;
+                HARP_MASK_CLEAR(reduced_dimension_mask->mask, i);
             }
         }
     }
 
-    assert(count(reduced_dimension_mask->num_elements, reduced_dimension_mask->mask)
-           == reduced_dimension_mask->masked_dimension_length);
+    reduced_dimension_mask->masked_dimension_length = harp_mask_count(num_blocks, reduced_dimension_mask->mask);
 
     *new_dimension_mask = reduced_dimension_mask;
     return 0;
@@ -480,6 +613,7 @@ int harp_dimension_mask_reduce(const harp_dimension_mask *dimension_mask, int di
  * be ignored, or \p dimension_mask should be one-dimensional, and \p merged_dimension_mask should have more two or more
  * dimensions. In the latter case, \p dim_index determines the dimension of \p merged_dimension_mask along which
  * \p dimension_mask is to be applied.
+ * The intersection is computed a mask word (64 entries) at a time.
  *
  * \param  dimension_mask        Dimension mask to be merged into \p merged_dimension_mask.
  * \param  dim_index             Dimension along which \p dimension_mask should be applied; ignored if \p dimension_mask
@@ -493,6 +627,7 @@ int harp_dimension_mask_reduce(const harp_dimension_mask *dimension_mask, int di
 int harp_dimension_mask_merge(const harp_dimension_mask *dimension_mask, int dim_index,
                               harp_dimension_mask *merged_dimension_mask)
 {
+    long num_rows;
     long i;
 
     assert(dimension_mask != NULL);
@@ -500,63 +635,49 @@ int harp_dimension_mask_merge(const harp_dimension_mask *dimension_mask, int dim
     assert(merged_dimension_mask != NULL);
     assert(merged_dimension_mask->num_elements == 0 || merged_dimension_mask->mask != NULL);
 
+    num_rows = get_num_rows(merged_dimension_mask);
+
     if (dimension_mask->num_dimensions == merged_dimension_mask->num_dimensions)
     {
+        long num_words = num_rows * merged_dimension_mask->row_num_words;
+
         assert(dimension_mask->num_elements == merged_dimension_mask->num_elements);
+        assert(dimension_mask->row_num_words == merged_dimension_mask->row_num_words);
 
-        for (i = 0; i < merged_dimension_mask->num_elements; i++)
+        for (i = 0; i < num_words; i++)
         {
-            merged_dimension_mask->mask[i] = dimension_mask->mask[i] && merged_dimension_mask->mask[i];
+            merged_dimension_mask->mask[i] &= dimension_mask->mask[i];
         }
     }
     else
     {
-        long num_groups;
-        long num_blocks;
-        long num_block_elements;
-
         assert(dimension_mask->num_dimensions == 1);
-        assert(merged_dimension_mask->num_dimensions > 1);
+        assert(merged_dimension_mask->num_dimensions == 2);
         assert(dim_index >= 0 && dim_index < merged_dimension_mask->num_dimensions);
         assert(merged_dimension_mask->dimension[dim_index] == dimension_mask->num_elements);
 
-        /* The mask is split into three parts:
-         *     num_elements = num_groups * num_blocks * num_block_elements.
-         *
-         * Here, num_groups is the product of dimensions [0, dim_index), num_blocks is dimension[dim_index],
-         * and num_block_elements is the product of dimensions (dim_index, num_dimensions).
-         */
-
-        /* Calculate the number of times we have to filter the indices (i.e. the product of the higher dimensions) */
-        num_groups = 1;
-        for (i = 0; i < dim_index; i++)
+        if (dim_index == 0)
         {
-            num_groups *= merged_dimension_mask->dimension[i];
+            /* Clear all rows for which the corresponding entry in the 1-D mask is not set. */
+            for (i = harp_mask_find_next_unset(num_rows, dimension_mask->mask, 0); i < num_rows;
+                 i = harp_mask_find_next_unset(num_rows, dimension_mask->mask, i + 1))
+            {
+                memset(harp_dimension_mask_get_row(merged_dimension_mask, i), 0,
+                       merged_dimension_mask->row_num_words * sizeof(uint64_t));
+            }
         }
-
-        /* Calculate the number of blocks. */
-        num_blocks = merged_dimension_mask->dimension[dim_index];
-
-        /* Calculate the number of elements per block. */
-        num_block_elements = merged_dimension_mask->num_elements / (num_groups * num_blocks);
-
-        /* Reduce the mask along the specified dimension. For each index on the specified dimension, if any value in the
-         * sub mask corresponding to this index is set to true, set the corresponding value in the reduced mask to true and
-         * move to the next index.
-         */
-        for (i = 0; i < num_blocks; i++)
+        else
         {
-            long j;
-
-            if (dimension_mask->mask[i])
+            /* Intersect each row with the 1-D mask. */
+            for (i = 0; i < num_rows; i++)
             {
-                continue;
-            }
+                uint64_t *row = harp_dimension_mask_get_row(merged_dimension_mask, i);
+                long j;
 
-            for (j = 0; j < num_groups; j++)
-            {
-                memset(merged_dimension_mask->mask + (j * num_blocks + i) * num_block_elements, 0,
-                       num_block_elements * sizeof(uint8_t));
+                for (j = 0; j < merged_dimension_mask->row_num_words; j++)
+                {
+                    row[j] &= dimension_mask->mask[j];
+                }
             }
         }
     }
@@ -637,7 +758,7 @@ int harp_dimension_mask_set_simplify(harp_dimension_mask_set *dimension_mask_set
         }
         assert(dimension_mask->mask != NULL || dimension_mask->num_elements == 0);
 
-        if (count(dimension_mask->num_elements, dimension_mask->mask) == dimension_mask->num_elements)
+        if (count_all(dimension_mask) == dimension_mask->num_elements)
         {
             harp_dimension_mask_delete(dimension_mask);
             dimension_mask_set[i] = NULL;
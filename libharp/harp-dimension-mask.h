@@ -37,17 +37,40 @@
 /** Maximum number of dimensions of a dimension mask. */
 #define HARP_MAX_MASK_NUM_DIMS  2
 
+/* Dimension masks are stored as bit sets, using 64-bit words. Each row of a 2-D mask (i.e. each index of the outer
+ * dimension) starts at a word boundary, such that a row can be used as a 1-D bit mask by itself. Unused bits at the end
+ * of a row are always zero.
+ */
+
+/** Number of mask words needed to store \a num_elements mask entries. */
+#define HARP_MASK_NUM_WORDS(num_elements) (((num_elements) + 63) >> 6)
+
+/** Value (0 or 1) of the mask entry at \a index. */
+#define HARP_MASK_GET(mask, index) ((int)(((mask)[(index) >> 6] >> ((index) & 63)) & 1))
+
+/** Set the mask entry at \a index to 1. */
+#define HARP_MASK_SET(mask, index) ((mask)[(index) >> 6] |= ((uint64_t)1 << ((index) & 63)))
+
+/** Set the mask entry at \a index to 0. */
+#define HARP_MASK_CLEAR(mask, index) ((mask)[(index) >> 6] &= ~((uint64_t)1 << ((index) & 63)))
+
 typedef struct harp_dimension_mask_struct
 {
     int num_dimensions;
     long dimension[HARP_MAX_MASK_NUM_DIMS];
     long num_elements;
+    long row_num_words;                 /* number of mask words per row (i.e. for the inner dimension) */
     long masked_dimension_length;
-    uint8_t *mask;
+    uint64_t *mask;
 } harp_dimension_mask;
 
 typedef harp_dimension_mask *harp_dimension_mask_set;
 
+long harp_mask_count(long num_elements, const uint64_t *mask);
+long harp_mask_count_runs(long num_elements, const uint64_t *mask);
+long harp_mask_find_next_set(long num_elements, const uint64_t *mask, long index);
+long harp_mask_find_next_unset(long num_elements, const uint64_t *mask, long index);
+
 int harp_dimension_mask_new(int num_dimensions, const long *dimension, harp_dimension_mask **new_dimension_mask);
 void harp_dimension_mask_delete(harp_dimension_mask *dimension_mask);
 int harp_dimension_mask_copy(const harp_dimension_mask *other_dimension_mask, harp_dimension_mask **new_dimension_mask);
@@ -55,6 +78,8 @@ int harp_dimension_mask_copy(const harp_dimension_mask *other_dimension_mask, ha
 int harp_dimension_mask_set_new(harp_dimension_mask_set **new_dimension_mask_set);
 void harp_dimension_mask_set_delete(harp_dimension_mask_set *dimension_mask_set);
 
+uint64_t *harp_dimension_mask_get_row(const harp_dimension_mask *dimension_mask, long row_index);
+
 int harp_dimension_mask_fill_true(harp_dimension_mask *dimension_mask);
 int harp_dimension_mask_fill_false(harp_dimension_mask *dimension_mask);
 
@@ -31,13 +31,30 @@
 
 #include "harp-filter-collocation.h"
 #include "harp-dimension-mask.h"
+#include "harp-filter.h"
 
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define COLLOCATION_MASK_BLOCK_SIZE 1024
 
+/* cache of imported (unfiltered) products from the collocated dataset, ordered from most to least recently used */
+typedef struct product_cache_entry_struct
+{
+    char *filename;
+    off_t file_size;
+    time_t modification_time;
+    size_t num_bytes;
+    harp_product *product;
+    struct product_cache_entry_struct *next;
+} product_cache_entry;
+
+static product_cache_entry *product_cache = NULL;
+static size_t product_cache_num_bytes = 0;
+
 static int compare_by_index(const void *a, const void *b)
 {
     harp_collocation_index_pair *pair_a = (harp_collocation_index_pair *)a;
@@ -207,20 +224,22 @@ static int collocation_mask_from_result(const harp_collocation_result *collocati
     /* if product_index is -1, no match will be found */
     for (i = 0; i < collocation_result->num_pairs && product_index >= 0; i++)
     {
-        const harp_collocation_pair *pair;
-        double datetime_diff;
+        double datetime_diff = harp_nan();
 
-        pair = collocation_result->pair[i];
-        datetime_diff = datetime_diff_index >= 0 ? pair->difference[datetime_diff_index] : harp_nan();
+        if (datetime_diff_index >= 0)
+        {
+            datetime_diff = collocation_result->difference[i * collocation_result->num_differences +
+                                                           datetime_diff_index];
+        }
         if (filter_type == harp_collocation_left)
         {
-            if (pair->product_index_a != product_index)
+            if (collocation_result->product_index_a[i] != product_index)
             {
                 continue;
             }
 
-            if (collocation_mask_add_index_pair(mask, pair->collocation_index, pair->sample_index_a, -datetime_diff) !=
-                0)
+            if (collocation_mask_add_index_pair(mask, collocation_result->collocation_index[i],
+                                                collocation_result->sample_index_a[i], -datetime_diff) != 0)
             {
                 harp_collocation_mask_delete(mask);
                 return -1;
@@ -228,13 +247,13 @@ static int collocation_mask_from_result(const harp_collocation_result *collocati
         }
         else
         {
-            if (pair->product_index_b != product_index)
+            if (collocation_result->product_index_b[i] != product_index)
             {
                 continue;
             }
 
-            if (collocation_mask_add_index_pair(mask, pair->collocation_index, pair->sample_index_b, datetime_diff) !=
-                0)
+            if (collocation_mask_add_index_pair(mask, collocation_result->collocation_index[i],
+                                                collocation_result->sample_index_b[i], datetime_diff) != 0)
             {
                 harp_collocation_mask_delete(mask);
                 return -1;
@@ -355,14 +374,14 @@ static int filter_collocation_index(const harp_variable *collocation_index, harp
 
     for (i = 0; i < collocation_index->num_elements; i++)
     {
-        if (dimension_mask->mask[i])
+        if (HARP_MASK_GET(dimension_mask->mask, i))
         {
             long index;
 
             if (!find_collocation_pair_for_collocation_index(collocation_mask, collocation_index->data.int32_data[i],
                                                              &index))
             {
-                dimension_mask->mask[i] = 0;
+                HARP_MASK_CLEAR(dimension_mask->mask, i);
                 dimension_mask->masked_dimension_length--;
             }
         }
@@ -394,7 +413,7 @@ int harp_product_apply_collocation_mask(harp_product *product, harp_collocation_
 
     if (harp_product_get_variable_by_name(product, "collocation_index", &collocation_index) == 0)
     {
-        harp_dimension_mask *dimension_mask;
+        harp_dimension_mask_set *dimension_mask_set;
         long dimension;
 
         if (collocation_index->data_type != harp_type_int32)
@@ -417,23 +436,31 @@ int harp_product_apply_collocation_mask(harp_product *product, harp_collocation_
             return -1;
         }
 
+        if (harp_dimension_mask_set_new(&dimension_mask_set) != 0)
+        {
+            return -1;
+        }
+
         dimension = product->dimension[harp_dimension_time];
-        if (harp_dimension_mask_new(1, &dimension, &dimension_mask) != 0)
+        if (harp_dimension_mask_new(1, &dimension, &dimension_mask_set[harp_dimension_time]) != 0)
         {
+            harp_dimension_mask_set_delete(dimension_mask_set);
             return -1;
         }
 
-        if (filter_collocation_index(collocation_index, collocation_mask, dimension_mask) != 0)
+        if (filter_collocation_index(collocation_index, collocation_mask, dimension_mask_set[harp_dimension_time]) != 0)
         {
-            harp_dimension_mask_delete(dimension_mask);
+            harp_dimension_mask_set_delete(dimension_mask_set);
             return -1;
         }
 
-        if (harp_product_filter_dimension(product, harp_dimension_time, dimension_mask->mask) != 0)
+        if (harp_product_filter(product, dimension_mask_set) != 0)
         {
-            harp_dimension_mask_delete(dimension_mask);
+            harp_dimension_mask_set_delete(dimension_mask_set);
             return -1;
         }
+
+        harp_dimension_mask_set_delete(dimension_mask_set);
     }
     else
     {
@@ -604,13 +631,166 @@ int harp_product_apply_collocation_mask(harp_product *product, harp_collocation_
     return 0;
 }
 
+static size_t get_product_num_bytes(const harp_product *product)
+{
+    size_t num_bytes = 0;
+    int i;
+
+    for (i = 0; i < product->num_variables; i++)
+    {
+        const harp_variable *variable = product->variable[i];
+
+        num_bytes += (size_t)variable->num_elements * harp_get_size_for_type(variable->data_type);
+        if (variable->data_type == harp_type_string)
+        {
+            long j;
+
+            for (j = 0; j < variable->num_elements; j++)
+            {
+                if (variable->data.string_data[j] != NULL)
+                {
+                    num_bytes += strlen(variable->data.string_data[j]) + 1;
+                }
+            }
+        }
+    }
+
+    return num_bytes;
+}
+
+static void product_cache_entry_delete(product_cache_entry *entry)
+{
+    product_cache_num_bytes -= entry->num_bytes;
+    if (entry->filename != NULL)
+    {
+        free(entry->filename);
+    }
+    if (entry->product != NULL)
+    {
+        harp_product_delete(entry->product);
+    }
+    free(entry);
+}
+
+/* remove least recently used entries until an additional 'num_bytes' fits within 'limit' */
+static void product_cache_make_room(size_t num_bytes, size_t limit)
+{
+    while (product_cache != NULL && product_cache_num_bytes + num_bytes > limit)
+    {
+        product_cache_entry **last = &product_cache;
+
+        while ((*last)->next != NULL)
+        {
+            last = &(*last)->next;
+        }
+        product_cache_entry_delete(*last);
+        *last = NULL;
+    }
+}
+
+/* import a product from the collocated dataset, reusing a previously imported version of the file if possible */
+static int import_collocated_product(const char *filename, harp_product **product)
+{
+    product_cache_entry **entry_ptr;
+    product_cache_entry *entry;
+    struct stat statbuf;
+    harp_product *cached_product;
+    size_t limit;
+    size_t num_bytes;
+
+    limit = (size_t)harp_option_collocation_cache_size * 1024 * 1024;
+    if (limit == 0 || stat(filename, &statbuf) != 0)
+    {
+        product_cache_make_room(0, limit);
+        return harp_import(filename, NULL, NULL, product);
+    }
+
+    entry_ptr = &product_cache;
+    while (*entry_ptr != NULL)
+    {
+        entry = *entry_ptr;
+        if (strcmp(entry->filename, filename) == 0)
+        {
+            /* unlink the entry; it is either stale or will be moved to the front */
+            *entry_ptr = entry->next;
+            if (entry->file_size != statbuf.st_size || entry->modification_time != statbuf.st_mtime)
+            {
+                product_cache_entry_delete(entry);
+                break;
+            }
+            if (harp_product_copy(entry->product, product) != 0)
+            {
+                product_cache_entry_delete(entry);
+                return -1;
+            }
+            entry->next = product_cache;
+            product_cache = entry;
+            return 0;
+        }
+        entry_ptr = &entry->next;
+    }
+
+    if (harp_import(filename, NULL, NULL, &cached_product) != 0)
+    {
+        return -1;
+    }
+    num_bytes = get_product_num_bytes(cached_product);
+    if (num_bytes > limit)
+    {
+        /* too large to keep around */
+        *product = cached_product;
+        return 0;
+    }
+    entry = (product_cache_entry *)malloc(sizeof(product_cache_entry));
+    if (entry == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       sizeof(product_cache_entry), __FILE__, __LINE__);
+        harp_product_delete(cached_product);
+        return -1;
+    }
+    entry->filename = strdup(filename);
+    if (entry->filename == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not duplicate string) (%s:%u)", __FILE__,
+                       __LINE__);
+        free(entry);
+        harp_product_delete(cached_product);
+        return -1;
+    }
+    if (harp_product_copy(cached_product, product) != 0)
+    {
+        free(entry->filename);
+        free(entry);
+        harp_product_delete(cached_product);
+        return -1;
+    }
+
+    product_cache_make_room(num_bytes, limit);
+
+    entry->file_size = statbuf.st_size;
+    entry->modification_time = statbuf.st_mtime;
+    entry->num_bytes = num_bytes;
+    entry->product = cached_product;
+    entry->next = product_cache;
+    product_cache = entry;
+    product_cache_num_bytes += num_bytes;
+
+    return 0;
+}
+
+void harp_collocation_product_cache_done(void)
+{
+    product_cache_make_room(0, 0);
+}
+
 static int get_collocated_product(harp_collocation_result *collocation_result, const char *source_product_b,
                                   harp_product **product)
 {
     harp_collocation_mask *mask;
     harp_product_metadata *product_metadata;
     harp_product *collocated_product;
-    harp_collocation_pair *pair;
+    long product_index_b;
 
     if (harp_collocation_result_filter_for_source_product_b(collocation_result, source_product_b) != 0)
     {
@@ -622,12 +802,12 @@ static int get_collocated_product(harp_collocation_result *collocation_result, c
         return 0;
     }
     /* use product b reference from first pair to find and import product */
-    pair = collocation_result->pair[0];
-    product_metadata = collocation_result->dataset_b->metadata[pair->product_index_b];
+    product_index_b = collocation_result->product_index_b[0];
+    product_metadata = collocation_result->dataset_b->metadata[product_index_b];
     if (product_metadata == NULL)
     {
         harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "missing product metadata for product %s",
-                       collocation_result->dataset_b->source_product[pair->product_index_b]);
+                       collocation_result->dataset_b->source_product[product_index_b]);
         return -1;
     }
 
@@ -636,7 +816,7 @@ static int get_collocated_product(harp_collocation_result *collocation_result, c
         return -1;
     }
 
-    if (harp_import(product_metadata->filename, NULL, NULL, &collocated_product) != 0)
+    if (import_collocated_product(product_metadata->filename, &collocated_product) != 0)
     {
         harp_set_error(HARP_ERROR_IMPORT, "could not import file %s", product_metadata->filename);
         harp_collocation_mask_delete(mask);
@@ -47,202 +47,127 @@ static void free_string_data(char **first, char **last)
     }
 }
 
-static void filter_array_int8(long num_source_elements, const uint8_t *mask, const int8_t *source,
-                              long num_target_elements, int8_t *target)
+/* Move a contiguous run of string pointers. Source and target may overlap, but only if target <= source (which is the
+ * case when an array is compacted in place). Strings that are overwritten in the target are freed and the moved entries
+ * in the source are reset to NULL, such that each string is always owned by exactly one array entry.
+ */
+static void move_string_data(long num_elements, char **source, char **target)
 {
-    const int8_t *source_end;
-    int8_t *target_end;
-
-    target_end = target + num_target_elements;
-    for (source_end = source + num_source_elements; source != source_end; source++, mask++)
-    {
-        if (*mask)
-        {
-            *target = *source;
-            target++;
-            num_target_elements--;
-        }
-    }
-
-    for (; target != target_end; target++)
+    if (target == source || num_elements == 0)
     {
-        *target = 0;
+        return;
     }
-}
 
-static void filter_array_int16(long num_source_elements, const uint8_t *mask, const int16_t *source,
-                               long num_target_elements, int16_t *target)
-{
-    const int16_t *source_end;
-    int16_t *target_end;
-
-    target_end = target + num_target_elements;
-    for (source_end = source + num_source_elements; source != source_end; source++, mask++)
+    if (target + num_elements <= source || source + num_elements <= target)
     {
-        if (*mask)
-        {
-            *target = *source;
-            target++;
-            num_target_elements--;
-        }
+        free_string_data(target, target + num_elements);
+        memcpy(target, source, num_elements * sizeof(char *));
+        memset(source, 0, num_elements * sizeof(char *));
     }
-
-    for (; target != target_end; target++)
+    else
     {
-        *target = 0;
+        assert(target < source);
+        free_string_data(target, source);
+        memmove(target, source, num_elements * sizeof(char *));
+        memset(target + num_elements, 0, (source - target) * sizeof(char *));
     }
 }
 
-static void filter_array_int32(long num_source_elements, const uint8_t *mask, const int32_t *source,
-                               long num_target_elements, int32_t *target)
+/* Filter a 1-D array of blocks, where each block consists of block_length consecutive elements. Blocks for which the
+ * corresponding mask entry is set are copied to the target; each run of consecutive set mask entries is moved with a
+ * single memmove(), and fully unset mask words are skipped as a whole. Any remaining target blocks are set to the fill
+ * value of the data type.
+ * The source and target are allowed to refer to the same buffer (in place compaction).
+ */
+static void filter_array(harp_data_type data_type, long block_length, long num_source_blocks, const uint64_t *mask,
+                         harp_array source, long num_target_blocks, harp_array target)
 {
-    const int32_t *source_end;
-    int32_t *target_end;
+    long element_size;
+    long block_size;
+    long num_copied_blocks;
 
-    target_end = target + num_target_elements;
-    for (source_end = source + num_source_elements; source != source_end; source++, mask++)
-    {
-        if (*mask)
-        {
-            *target = *source;
-            target++;
-            num_target_elements--;
-        }
-    }
+    element_size = harp_get_size_for_type(data_type);
+    block_size = block_length * element_size;
 
-    for (; target != target_end; target++)
+    if (mask == NULL)
     {
-        *target = 0;
-    }
-}
+        assert(num_source_blocks == num_target_blocks);
 
-static void filter_array_float(long num_source_elements, const uint8_t *mask, const float *source,
-                               long num_target_elements, float *target)
-{
-    const float *source_end;
-    float *target_end;
-
-    target_end = target + num_target_elements;
-    for (source_end = source + num_source_elements; source != source_end; source++, mask++)
-    {
-        if (*mask)
+        if (data_type == harp_type_string)
+        {
+            move_string_data(num_source_blocks * block_length, source.string_data, target.string_data);
+        }
+        else if (target.ptr != source.ptr)
         {
-            *target = *source;
-            target++;
+            memmove(target.ptr, source.ptr, num_target_blocks * block_size);
         }
+        return;
     }
 
-    for (; target != target_end; target++)
+    num_copied_blocks = 0;
+    if (data_type == harp_type_string)
     {
-        *target = (float)harp_nan();
-    }
-}
-
-static void filter_array_double(long num_source_elements, const uint8_t *mask, const double *source,
-                                long num_target_elements, double *target)
-{
-    const double *source_end;
-    double *target_end;
+        long i = harp_mask_find_next_set(num_source_blocks, mask, 0);
 
-    target_end = target + num_target_elements;
-    for (source_end = source + num_source_elements; source != source_end; source++, mask++)
-    {
-        if (*mask)
+        while (i < num_source_blocks)
         {
-            *target = *source;
-            target++;
+            long run_length = harp_mask_find_next_unset(num_source_blocks, mask, i) - i;
+
+            assert(num_copied_blocks + run_length <= num_target_blocks);
+            move_string_data(run_length * block_length, &source.string_data[i * block_length],
+                             &target.string_data[num_copied_blocks * block_length]);
+            num_copied_blocks += run_length;
+            i = harp_mask_find_next_set(num_source_blocks, mask, i + run_length);
         }
-    }
 
-    for (; target != target_end; target++)
-    {
-        *target = harp_nan();
+        free_string_data(&target.string_data[num_copied_blocks * block_length],
+                         &target.string_data[num_target_blocks * block_length]);
+        return;
     }
-}
 
-static void filter_array_string(long num_source_elements, const uint8_t *mask, char **source,
-                                long num_target_elements, char **target)
-{
-    char **source_end;
-    char **target_end;
-
-    target_end = target + num_target_elements;
-    for (source_end = source + num_source_elements; source != source_end; source++, mask++)
+    if (data_type == harp_type_double && block_length == 1 && num_target_blocks > 0 &&
+        harp_mask_count_runs(num_source_blocks, mask) * 8 > num_target_blocks)
     {
-        if (*mask)
-        {
-            if (target != source)
-            {
-                if (*target != NULL)
-                {
-                    free(*target);
-                }
-
-                *target = *source;
-                *source = NULL;
-            }
+        /* Branch free stream compaction for a 1-D array of doubles with a fragmented mask (on average less than eight
+         * consecutive elements per run), for which a memmove() per run would be relatively expensive. The target index
+         * only advances for elements that are kept. We stop as soon as the target is full so we never write beyond it.
+         */
+        const double *source_data = source.double_data;
+        double *target_data = target.double_data;
+        long i;
 
-            target++;
-            num_target_elements--;
+        for (i = 0; i < num_source_blocks && num_copied_blocks < num_target_blocks; i++)
+        {
+            target_data[num_copied_blocks] = source_data[i];
+            num_copied_blocks += HARP_MASK_GET(mask, i);
         }
     }
-
-    free_string_data(target, target_end);
-}
-
-static void filter_array(harp_data_type data_type, long num_source_elements, const uint8_t *mask, harp_array source,
-                         long num_target_elements, harp_array target)
-{
-    if (mask == NULL)
+    else
     {
-        assert(num_source_elements == num_target_elements);
+        long i = harp_mask_find_next_set(num_source_blocks, mask, 0);
 
-        if (target.ptr != source.ptr)
+        while (i < num_source_blocks)
         {
-            if (data_type == harp_type_string)
-            {
-                free_string_data(target.string_data, target.string_data + num_target_elements);
-            }
-
-            memcpy(target.ptr, source.ptr, num_target_elements * harp_get_size_for_type(data_type));
+            long run_length = harp_mask_find_next_unset(num_source_blocks, mask, i) - i;
+            char *source_ptr = (char *)source.ptr + i * block_size;
+            char *target_ptr = (char *)target.ptr + num_copied_blocks * block_size;
 
-            if (data_type == harp_type_string)
+            assert(num_copied_blocks + run_length <= num_target_blocks);
+            if (target_ptr != source_ptr)
             {
-                memset(source.ptr, 0, num_source_elements * harp_get_size_for_type(data_type));
+                memmove(target_ptr, source_ptr, run_length * block_size);
             }
+            num_copied_blocks += run_length;
+            i = harp_mask_find_next_set(num_source_blocks, mask, i + run_length);
         }
     }
-    else
+
+    if (num_copied_blocks < num_target_blocks)
     {
-        switch (data_type)
-        {
-            case harp_type_int8:
-                filter_array_int8(num_source_elements, mask, source.int8_data, num_target_elements, target.int8_data);
-                break;
-            case harp_type_int16:
-                filter_array_int16(num_source_elements, mask, source.int16_data, num_target_elements,
-                                   target.int16_data);
-                break;
-            case harp_type_int32:
-                filter_array_int32(num_source_elements, mask, source.int32_data, num_target_elements,
-                                   target.int32_data);
-                break;
-            case harp_type_float:
-                filter_array_float(num_source_elements, mask, source.float_data, num_target_elements,
-                                   target.float_data);
-                break;
-            case harp_type_double:
-                filter_array_double(num_source_elements, mask, source.double_data, num_target_elements,
-                                    target.double_data);
-                break;
-            case harp_type_string:
-                filter_array_string(num_source_elements, mask, source.string_data, num_target_elements,
-                                    target.string_data);
-                break;
-            default:
-                assert(0);
-                exit(1);
-        }
+        harp_array fill;
+
+        fill.ptr = (void *)((char *)target.ptr + num_copied_blocks * block_size);
+        harp_array_null(data_type, (num_target_blocks - num_copied_blocks) * block_length, fill);
     }
 }
 
@@ -250,6 +175,7 @@ static void filter_array(harp_data_type data_type, long num_source_elements, con
  * Filter the source array by copying elements to the target array for which the corresponding entry in the source mask
  * evaluates to true. The length of the source array is allowed to be larger than the length of the target array, as
  * long as the total number of elements that will be copied is smaller than or equal to the length of the target array.
+ * Source and target may refer to the same buffer, in which case the array is compacted in place.
  * \param data_type           Data type of source and target arrays
  * \param num_dimensions      Number of dimensions of source and target arrays
  * \param source_dimension    Dimension length for each source dimension
@@ -260,56 +186,92 @@ static void filter_array(harp_data_type data_type, long num_source_elements, con
  * \param target              Target array.
  */
 void harp_array_filter(harp_data_type data_type, int num_dimensions, const long *source_dimension,
-                       const uint8_t **source_mask, harp_array source, const long *target_dimension, harp_array target)
+                       const uint64_t **source_mask, harp_array source, const long *target_dimension, harp_array target)
 {
-    long data_type_size;
+    long folded_source_dimension[HARP_MAX_NUM_DIMS];
+    long folded_target_dimension[HARP_MAX_NUM_DIMS];
+    const uint64_t *folded_mask[HARP_MAX_NUM_DIMS];
+    long element_size;
+    long block_length;
     long source_stride[HARP_MAX_NUM_DIMS];
     long target_stride[HARP_MAX_NUM_DIMS];
     long source_index[HARP_MAX_NUM_DIMS] = { 0 };
     long target_index[HARP_MAX_NUM_DIMS] = { 0 };
+    int num_folded_dimensions;
     int dimension_index;
     int i;
 
-    /* Special case for scalars. */
-    if (num_dimensions == 0)
+    /* Trailing dimensions without a mask are copied as a whole, so fold them into the length of the blocks that are
+     * copied by the innermost loop.
+     */
+    block_length = 1;
+    for (i = num_dimensions; i > 0 && source_mask[i - 1] == NULL; i--)
+    {
+        assert(source_dimension[i - 1] == target_dimension[i - 1]);
+        block_length *= source_dimension[i - 1];
+    }
+
+    /* Fold consecutive dimensions without a mask into a single dimension. */
+    num_folded_dimensions = 0;
+    for (dimension_index = 0; dimension_index < i; dimension_index++)
+    {
+        if (num_folded_dimensions > 0 && source_mask[dimension_index] == NULL &&
+            folded_mask[num_folded_dimensions - 1] == NULL)
+        {
+            assert(source_dimension[dimension_index] == target_dimension[dimension_index]);
+            folded_source_dimension[num_folded_dimensions - 1] *= source_dimension[dimension_index];
+            folded_target_dimension[num_folded_dimensions - 1] *= target_dimension[dimension_index];
+        }
+        else
+        {
+            folded_source_dimension[num_folded_dimensions] = source_dimension[dimension_index];
+            folded_target_dimension[num_folded_dimensions] = target_dimension[dimension_index];
+            folded_mask[num_folded_dimensions] = source_mask[dimension_index];
+            num_folded_dimensions++;
+        }
+    }
+
+    if (num_folded_dimensions == 0)
     {
-        filter_array(data_type, 1, NULL, source, 1, target);
+        /* Special case for scalars and for arrays without any masks. */
+        filter_array(data_type, block_length, 1, NULL, source, 1, target);
         return;
     }
 
-    if (num_dimensions == 1)
+    if (num_folded_dimensions == 1)
     {
-        /* Special case for 1-D arrays. */
-        filter_array(data_type, *source_dimension, *source_mask, source, *target_dimension, target);
+        /* Special case for a single masked dimension. */
+        filter_array(data_type, block_length, folded_source_dimension[0], folded_mask[0], source,
+                     folded_target_dimension[0], target);
         return;
     }
 
-    /* TODO: Consecutive dimensions for which the corresponding masks are NULL can be folded. */
-    data_type_size = harp_get_size_for_type(data_type);
-    source_stride[num_dimensions - 1] = target_stride[num_dimensions - 1] = data_type_size;
-    for (i = num_dimensions - 1; i > 0; i--)
+    element_size = harp_get_size_for_type(data_type);
+    source_stride[num_folded_dimensions - 1] = target_stride[num_folded_dimensions - 1] = block_length * element_size;
+    for (i = num_folded_dimensions - 1; i > 0; i--)
     {
-        source_stride[i - 1] = source_stride[i] * source_dimension[i];
-        target_stride[i - 1] = target_stride[i] * target_dimension[i];
+        source_stride[i - 1] = source_stride[i] * folded_source_dimension[i];
+        target_stride[i - 1] = target_stride[i] * folded_target_dimension[i];
     }
 
     dimension_index = 0;
     while (dimension_index >= 0)
     {
-        while (dimension_index >= 0 && dimension_index < num_dimensions - 1)
+        while (dimension_index >= 0 && dimension_index < num_folded_dimensions - 1)
         {
-            if (source_mask[dimension_index] != NULL)
+            if (folded_mask[dimension_index] != NULL)
             {
                 /* Skip indices on the current dimension that should be discarded according to the mask. */
-                while (source_index[dimension_index] < source_dimension[dimension_index]
-                       && !source_mask[dimension_index][source_index[dimension_index]])
-                {
-                    source_index[dimension_index]++;
-                    source.ptr = (void *)(((char *)source.ptr) + source_stride[dimension_index]);
-                }
+                long num_skipped = harp_mask_find_next_set(folded_source_dimension[dimension_index],
+                                                           folded_mask[dimension_index],
+                                                           source_index[dimension_index]) -
+                    source_index[dimension_index];
+
+                source_index[dimension_index] += num_skipped;
+                source.ptr = (void *)(((char *)source.ptr) + num_skipped * source_stride[dimension_index]);
             }
 
-            if (source_index[dimension_index] < source_dimension[dimension_index])
+            if (source_index[dimension_index] < folded_source_dimension[dimension_index])
             {
                 /* This index on the current dimension should be kept. Move to the next dimension. */
                 dimension_index++;
@@ -319,12 +281,12 @@ void harp_array_filter(harp_data_type data_type, int num_dimensions, const long
                 /* Set any remaining blocks on the current dimension of the target array to null. */
                 long num_blocks;
 
-                num_blocks = target_dimension[dimension_index] - target_index[dimension_index];
+                num_blocks = folded_target_dimension[dimension_index] - target_index[dimension_index];
                 assert(num_blocks >= 0);
 
                 if (num_blocks > 0)
                 {
-                    harp_array_null(data_type, num_blocks * target_stride[dimension_index] / data_type_size, target);
+                    harp_array_null(data_type, num_blocks * target_stride[dimension_index] / element_size, target);
                     target.ptr = (void *)(((char *)target.ptr) + num_blocks * target_stride[dimension_index]);
                 }
 
@@ -345,9 +307,9 @@ void harp_array_filter(harp_data_type data_type, int num_dimensions, const long
 
         if (dimension_index > 0)
         {
-            /* Filter the fastest running dimension. */
-            filter_array(data_type, source_dimension[dimension_index], source_mask[dimension_index], source,
-                         target_dimension[dimension_index], target);
+            /* Filter the fastest running (masked) dimension. */
+            filter_array(data_type, block_length, folded_source_dimension[dimension_index],
+                         folded_mask[dimension_index], source, folded_target_dimension[dimension_index], target);
 
             /* Move to the next index on the previous dimension. */
             source_index[dimension_index] = 0;
@@ -364,7 +326,7 @@ void harp_array_filter(harp_data_type data_type, int num_dimensions, const long
 
 int harp_variable_filter(harp_variable *variable, const harp_dimension_mask_set *dimension_mask_set)
 {
-    const uint8_t *mask[HARP_MAX_NUM_DIMS] = { 0 };
+    const uint64_t *mask[HARP_MAX_NUM_DIMS] = { 0 };
     long new_dimension[HARP_MAX_NUM_DIMS];
     long new_num_elements;
     int has_masks = 0;
@@ -449,7 +411,8 @@ int harp_variable_filter(harp_variable *variable, const harp_dimension_mask_set
     }
     else
     {
-        harp_array source = variable->data;
+        const uint64_t *row_mask[HARP_MAX_NUM_DIMS] = { 0 };
+        harp_array source;
         harp_array target = variable->data;
         long source_stride;
         long target_stride;
@@ -465,51 +428,34 @@ int harp_variable_filter(harp_variable *variable, const harp_dimension_mask_set
         source_stride = (variable->num_elements / variable->dimension[0]) * harp_get_size_for_type(variable->data_type);
         target_stride = (new_num_elements / new_dimension[0]) * harp_get_size_for_type(variable->data_type);
 
-        for (i = 0; i < variable->num_dimensions; i++)
+        /* Each row of a 2-D mask starts at a word boundary, so the stride between rows is given in mask words. */
+        for (i = 1; i < variable->num_dimensions; i++)
         {
             harp_dimension_type dimension_type = variable->dimension_type[i];
 
-            if (dimension_type != harp_dimension_independent)
+            if (dimension_type != harp_dimension_independent && dimension_mask_set[dimension_type] != NULL &&
+                dimension_mask_set[dimension_type]->num_dimensions == 2)
             {
-                const harp_dimension_mask *dimension_mask = dimension_mask_set[dimension_type];
-
-                if (dimension_mask == NULL)
-                {
-                    continue;
-                }
-
-                if (i == 0)
-                {
-                    assert(dimension_mask->num_dimensions == 1);
-                    mask_stride[i] = 1;
-                }
-                else if (dimension_mask->num_dimensions == 2)
-                {
-                    assert(dimension_type != harp_dimension_time);
-                    mask_stride[i] = dimension_mask->dimension[1];
-                }
+                assert(dimension_type != harp_dimension_time);
+                mask_stride[i] = dimension_mask_set[dimension_type]->row_num_words;
             }
         }
 
-        for (j = 0; j < variable->dimension[0]; j++)
+        /* Iterate over the time indices that are kept, skipping fully masked out parts of the time mask. */
+        j = (mask[0] == NULL ? 0 : harp_mask_find_next_set(variable->dimension[0], mask[0], 0));
+        while (j < variable->dimension[0])
         {
-            if (mask[0] == NULL || *mask[0])
+            for (i = 1; i < variable->num_dimensions; i++)
             {
-                harp_array_filter(variable->data_type, variable->num_dimensions - 1, &variable->dimension[1], &mask[1],
-                                  source, &new_dimension[1], target);
-
-                target.ptr = (void *)(((char *)target.ptr) + target_stride);
+                row_mask[i] = (mask[i] == NULL ? NULL : mask[i] + j * mask_stride[i]);
             }
 
-            for (i = 0; i < variable->num_dimensions; i++)
-            {
-                if (mask[i] != NULL)
-                {
-                    mask[i] += mask_stride[i];
-                }
-            }
+            source.ptr = (void *)(((char *)variable->data.ptr) + j * source_stride);
+            harp_array_filter(variable->data_type, variable->num_dimensions - 1, &variable->dimension[1], &row_mask[1],
+                              source, &new_dimension[1], target);
+            target.ptr = (void *)(((char *)target.ptr) + target_stride);
 
-            source.ptr = (void *)(((char *)source.ptr) + source_stride);
+            j = (mask[0] == NULL ? j + 1 : harp_mask_find_next_set(variable->dimension[0], mask[0], j + 1));
         }
     }
 
@@ -525,7 +471,9 @@ int harp_variable_filter(harp_variable *variable, const harp_dimension_mask_set
     {
         void *new_data;
 
-        new_data = realloc(variable->data.ptr, new_num_elements * harp_get_size_for_type(variable->data_type));
+        new_data = harp_data_realloc(variable->data.ptr,
+                                     (size_t)variable->num_elements * harp_get_size_for_type(variable->data_type),
+                                     (size_t)new_num_elements * harp_get_size_for_type(variable->data_type));
         if (new_data == NULL)
         {
             harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %u bytes) (%s:%u)",
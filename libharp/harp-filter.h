@@ -36,7 +36,7 @@
 #include "harp-operation.h"
 
 void harp_array_filter(harp_data_type data_type, int num_dimensions,
-                       const long *source_dimension, const uint8_t **source_mask, harp_array source,
+                       const long *source_dimension, const uint64_t **source_mask, harp_array source,
                        const long *target_dimension, harp_array target);
 
 int harp_variable_filter(harp_variable *variable, const harp_dimension_mask_set *dimension_mask_set);
@@ -226,6 +226,75 @@ double harp_spherical_point_distance(const harp_spherical_point *pointp, const h
     }
 }
 
+/* Determine the lat/lon bounds of a spherical cap (all points within a given angular distance [rad] of a center point)
+ * The center point is expected to be normalized (see harp_spherical_point_check()).
+ */
+void harp_spherical_bounding_box_from_cap(harp_spherical_bounding_box *box, const harp_spherical_point *center,
+                                          double radius)
+{
+    box->lat_min = center->lat - radius;
+    box->lat_max = center->lat + radius;
+    if (box->lat_min <= -M_PI_2 || box->lat_max >= M_PI_2)
+    {
+        /* the cap covers a pole */
+        box->lat_min = box->lat_min < -M_PI_2 ? -M_PI_2 : box->lat_min;
+        box->lat_max = box->lat_max > M_PI_2 ? M_PI_2 : box->lat_max;
+        box->lon_min = -2.0 * M_PI;
+        box->lon_max = 2.0 * M_PI;
+    }
+    else
+    {
+        /* maximum longitude difference for points on the cap */
+        double delta_lon = asin(sin(radius) / cos(center->lat));
+
+        box->lon_min = center->lon - delta_lon;
+        box->lon_max = center->lon + delta_lon;
+    }
+}
+
+/* Enlarge a bounding box by a margin [rad]
+ * Close to the poles small distances can correspond to large longitude differences, so for boxes that come near a pole
+ * the longitude range is not restricted.
+ */
+void harp_spherical_bounding_box_expand(harp_spherical_bounding_box *box, double margin)
+{
+    if (box->lat_min > box->lat_max)
+    {
+        /* empty box */
+        return;
+    }
+
+    box->lat_min -= margin;
+    box->lat_max += margin;
+    box->lon_min -= margin;
+    box->lon_max += margin;
+    if (box->lat_min <= -M_PI_2 + 1.0E-3 || box->lat_max >= M_PI_2 - 1.0E-3 ||
+        box->lon_max - box->lon_min >= 2.0 * M_PI)
+    {
+        box->lon_min = -2.0 * M_PI;
+        box->lon_max = 2.0 * M_PI;
+    }
+}
+
+/* Check whether a (normalized) point is inside a bounding box */
+int harp_spherical_bounding_box_contains_point(const harp_spherical_bounding_box *box,
+                                               const harp_spherical_point *point)
+{
+    double lon = point->lon;
+
+    if (lon < box->lon_min)
+    {
+        lon += 2.0 * M_PI;
+    }
+    else if (lon > box->lon_max)
+    {
+        lon -= 2.0 * M_PI;
+    }
+
+    return HARP_GEOMETRY_FPle(box->lat_min, point->lat) && HARP_GEOMETRY_FPle(point->lat, box->lat_max) &&
+        HARP_GEOMETRY_FPle(box->lon_min, lon) && HARP_GEOMETRY_FPle(lon, box->lon_max);
+}
+
 
 /** Calculate the distance between two points on the surface of the Earth in meters
  * \ingroup harp_geometry
@@ -37,24 +37,33 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* maximum number of points (of both polygons together) for which overlap calculations use buffers on the stack */
+#define MAX_STACK_POLYGON_POINTS 32
+
 /* the haversine function */
 static double hav(double x)
 {
     return (1 - cos(x)) / 2;
 }
 
-/* check whether a point is within the lat/lon bounds of a polygon */
-static int spherical_polygon_bounds_contains_any_points(const harp_spherical_polygon *polygon, int num_points,
-                                                        const harp_spherical_point *point)
+/* Determine the lat/lon bounds of a polygon.
+ * Longitudes of the bounding box can extend outside [0,2pi] for polygons that cross the dateline.
+ * Polygons without points get an empty bounding box.
+ */
+void harp_spherical_polygon_get_bounding_box(const harp_spherical_polygon *polygon, harp_spherical_bounding_box *box)
 {
     double min_lat, max_lat, lat;
     double min_lon, max_lon, lon;
     double ref_lon;
     int i;
 
-    if (polygon->numberofpoints == 0 || num_points == 0)
+    if (polygon->numberofpoints == 0)
     {
-        return 0;
+        box->lat_min = M_PI;
+        box->lat_max = -M_PI;
+        box->lon_min = M_PI;
+        box->lon_max = -M_PI;
+        return;
     }
 
     /* We have two special cases to deal with: boundaries that cross the dateline and boundaries that cover a pole.
@@ -152,22 +161,28 @@ static int spherical_polygon_bounds_contains_any_points(const harp_spherical_pol
         min_lat = -asin(1 / sqrt(x * x + 1));
     }
 
-    for (i = 0; i < num_points; i++)
-    {
-        lon = point[i].lon;
-        lat = point[i].lat;
+    box->lat_min = min_lat;
+    box->lat_max = max_lat;
+    box->lon_min = min_lon;
+    box->lon_max = max_lon;
+}
 
-        if (lon < min_lon)
-        {
-            lon += 2.0 * M_PI;
-        }
-        else if (lon > max_lon)
-        {
-            lon -= 2.0 * M_PI;
-        }
+/* check whether a point is within the lat/lon bounds of a polygon */
+static int spherical_polygon_bounds_contains_any_points(const harp_spherical_polygon *polygon, int num_points,
+                                                        const harp_spherical_point *point)
+{
+    harp_spherical_bounding_box box;
+    int i;
+
+    if (polygon->numberofpoints == 0 || num_points == 0)
+    {
+        return 0;
+    }
 
-        if (HARP_GEOMETRY_FPle(min_lat, lat) && HARP_GEOMETRY_FPle(lat, max_lat) &&
-            HARP_GEOMETRY_FPle(min_lon, lon) && HARP_GEOMETRY_FPle(lon, max_lon))
+    harp_spherical_polygon_get_bounding_box(polygon, &box);
+    for (i = 0; i < num_points; i++)
+    {
+        if (harp_spherical_bounding_box_contains_point(&box, &point[i]))
         {
             return 1;
         }
@@ -860,10 +875,10 @@ static int spherical_polygon_get_surface_area(const harp_spherical_polygon *poly
 }
 
 /* Determine whether two polygons overlap, and if so
- * calculate the overlapping fraction of the two polygons */
-int harp_spherical_polygon_overlapping_fraction(const harp_spherical_polygon *polygon_a,
-                                                const harp_spherical_polygon *polygon_b,
-                                                int *polygons_are_overlapping, double *overlapping_fraction)
+ * calculate the overlapping fraction of the two polygons (works for both convex and non-convex polygons) */
+static int spherical_polygon_overlapping_fraction_generic(const harp_spherical_polygon *polygon_a,
+                                                          const harp_spherical_polygon *polygon_b,
+                                                          int *polygons_are_overlapping, double *overlapping_fraction)
 {
     int8_t relationship;
 
@@ -1046,6 +1061,7 @@ int harp_spherical_polygon_overlapping_fraction(const harp_spherical_polygon *po
         if (harp_spherical_polygon_check(polygon_intersect) != 0)
         {
             harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "invalid intersection polygon");
+            harp_spherical_polygon_delete(polygon_intersect);
             return -1;
         }
 
@@ -1085,6 +1101,389 @@ int harp_spherical_polygon_overlapping_fraction(const harp_spherical_polygon *po
     return 0;
 }
 
+/* Signed surface area (in [rad2]) of the spherical triangle (a, b, c), which is positive if the triangle is
+ * counterclockwise. This uses the formula from A. Van Oosterom and J. Strackee, "The Solid Angle of a Plane
+ * Triangle", IEEE Trans. Biomed. Eng. BME-30(2), 1983. */
+static double spherical_triangle_signed_area(const harp_vector3d *a, const harp_vector3d *b, const harp_vector3d *c)
+{
+    harp_vector3d b_cross_c;
+    double numerator;
+    double denominator;
+
+    harp_vector3d_crossproduct(&b_cross_c, b, c);
+    numerator = harp_vector3d_dotproduct(a, &b_cross_c);
+    denominator = 1 + harp_vector3d_dotproduct(a, b) + harp_vector3d_dotproduct(b, c) + harp_vector3d_dotproduct(c, a);
+
+    return 2 * atan2(numerator, denominator);
+}
+
+/* Surface area (in [rad2]) of a polygon given by unit vectors (the polygon does not need to be convex) */
+static double spherical_polygon_vectors_get_surface_area(int32_t numberofpoints, const harp_vector3d *vertex)
+{
+    double area = 0;
+    int32_t i;
+
+    for (i = 1; i < numberofpoints - 1; i++)
+    {
+        area += spherical_triangle_signed_area(&vertex[0], &vertex[i], &vertex[i + 1]);
+    }
+
+    return fabs(area);
+}
+
+/* Initialize the vector representation of a polygon.
+ * vertex should have room for polygon->numberofpoints vectors and should remain available as long as vectors is used.
+ */
+void harp_spherical_polygon_vectors_init(harp_spherical_polygon_vectors *vectors,
+                                         const harp_spherical_polygon *polygon, harp_vector3d *vertex)
+{
+    int32_t numberofpoints = polygon->numberofpoints;
+    int32_t num_left_turns = 0;
+    int32_t num_right_turns = 0;
+    double norm;
+    int32_t i;
+
+    vectors->numberofpoints = numberofpoints;
+    vectors->vertex = vertex;
+    vectors->cap_centre.x = 0;
+    vectors->cap_centre.y = 0;
+    vectors->cap_centre.z = 0;
+    for (i = 0; i < numberofpoints; i++)
+    {
+        harp_vector3d_from_spherical_point(&vertex[i], &polygon->point[i]);
+        vectors->cap_centre.x += vertex[i].x;
+        vectors->cap_centre.y += vertex[i].y;
+        vectors->cap_centre.z += vertex[i].z;
+    }
+
+    /* the polygon is convex if all turns at the vertices go in the same direction */
+    for (i = 0; i < numberofpoints; i++)
+    {
+        harp_vector3d edge_normal;
+        double turn;
+
+        harp_vector3d_crossproduct(&edge_normal, &vertex[i == 0 ? numberofpoints - 1 : i - 1], &vertex[i]);
+        turn = harp_vector3d_dotproduct(&edge_normal, &vertex[i == numberofpoints - 1 ? 0 : i + 1]);
+        if (turn > HARP_GEOMETRY_EPSILON)
+        {
+            num_left_turns++;
+        }
+        else if (turn < -HARP_GEOMETRY_EPSILON)
+        {
+            num_right_turns++;
+        }
+    }
+    vectors->orientation = 0;
+    if (numberofpoints >= 3)
+    {
+        if (num_left_turns > 0 && num_right_turns == 0)
+        {
+            vectors->orientation = 1;
+        }
+        else if (num_right_turns > 0 && num_left_turns == 0)
+        {
+            vectors->orientation = -1;
+        }
+    }
+
+    /* the bounding cap is only used if it is smaller than a hemisphere; such a cap is convex, so if it contains all
+     * vertices it also contains the edges and the inside of the polygon */
+    vectors->cap_radius = M_PI;
+    norm = harp_vector3d_norm(&vectors->cap_centre);
+    if (norm > 0)
+    {
+        double min_cos_distance = 1;
+
+        vectors->cap_centre.x /= norm;
+        vectors->cap_centre.y /= norm;
+        vectors->cap_centre.z /= norm;
+        for (i = 0; i < numberofpoints; i++)
+        {
+            double cos_distance = harp_vector3d_dotproduct(&vectors->cap_centre, &vertex[i]);
+
+            if (cos_distance < min_cos_distance)
+            {
+                min_cos_distance = cos_distance;
+            }
+        }
+        if (min_cos_distance > 0)
+        {
+            vectors->cap_radius = acos(min_cos_distance);
+        }
+    }
+
+    vectors->area = spherical_polygon_vectors_get_surface_area(numberofpoints, vertex);
+}
+
+/* Point on the great circle segment p-q where it crosses the plane with distances dp and dq for p and q */
+static void spherical_segment_plane_intersection(harp_vector3d *intersection, const harp_vector3d *p, double dp,
+                                                 const harp_vector3d *q, double dq)
+{
+    double norm;
+
+    /* one of the points is outside (negative distance) and the other point is inside (or on) the plane */
+    if (dp < 0 && dq < 0)
+    {
+        /* the inside point is within the tolerance of the plane */
+        if (dp > dq)
+        {
+            *intersection = *p;
+        }
+        else
+        {
+            *intersection = *q;
+        }
+        return;
+    }
+    intersection->x = dp * q->x - dq * p->x;
+    intersection->y = dp * q->y - dq * p->y;
+    intersection->z = dp * q->z - dq * p->z;
+    norm = harp_vector3d_norm(intersection);
+    if (dp < dq)
+    {
+        norm = -norm;
+    }
+    intersection->x /= norm;
+    intersection->y /= norm;
+    intersection->z /= norm;
+}
+
+/* Clip the subject polygon against the convex clip polygon using the Sutherland-Hodgman algorithm.
+ * buffer should have room for HARP_SPHERICAL_POLYGON_VECTORS_SCRATCH_SIZE(num_subject, clip->numberofpoints) vectors.
+ * On return, result points to the vertices of the clipped polygon (inside buffer or equal to subject) and
+ * subject_inside is set to 1 if no part of the subject polygon was outside the clip polygon.
+ * Returns the number of vertices of the clipped polygon, or -1 if the buffer was too small (which can only happen if
+ * the subject polygon is not convex).
+ */
+static int32_t spherical_polygon_vectors_clip(int32_t num_subject, const harp_vector3d *subject,
+                                              const harp_spherical_polygon_vectors *clip, harp_vector3d *buffer,
+                                              const harp_vector3d **result, int *subject_inside)
+{
+    int32_t max_points = num_subject + clip->numberofpoints;
+    const harp_vector3d *input = subject;
+    harp_vector3d *output = buffer;
+    int32_t num_input = num_subject;
+    int32_t k;
+
+    *subject_inside = 1;
+    for (k = 0; k < clip->numberofpoints && num_input > 0; k++)
+    {
+        harp_vector3d normal;
+        const harp_vector3d *p;
+        int32_t num_output = 0;
+        double norm;
+        double dp;
+        int32_t i;
+
+        /* the normal of the edge plane points towards the inside of the clip polygon */
+        harp_vector3d_crossproduct(&normal, &clip->vertex[k],
+                                   &clip->vertex[k == clip->numberofpoints - 1 ? 0 : k + 1]);
+        norm = harp_vector3d_norm(&normal);
+        if (HARP_GEOMETRY_FPzero(norm))
+        {
+            /* skip duplicate points */
+            continue;
+        }
+        norm *= clip->orientation;
+        normal.x /= norm;
+        normal.y /= norm;
+        normal.z /= norm;
+
+        p = &input[num_input - 1];
+        dp = harp_vector3d_dotproduct(&normal, p);
+        for (i = 0; i < num_input; i++)
+        {
+            const harp_vector3d *q = &input[i];
+            double dq = harp_vector3d_dotproduct(&normal, q);
+
+            if (dq >= -HARP_GEOMETRY_EPSILON)
+            {
+                if (dp < -HARP_GEOMETRY_EPSILON)
+                {
+                    if (num_output == max_points)
+                    {
+                        return -1;
+                    }
+                    spherical_segment_plane_intersection(&output[num_output], p, dp, q, dq);
+                    num_output++;
+                }
+                if (num_output == max_points)
+                {
+                    return -1;
+                }
+                output[num_output] = *q;
+                num_output++;
+            }
+            else
+            {
+                *subject_inside = 0;
+                if (dp >= -HARP_GEOMETRY_EPSILON)
+                {
+                    if (num_output == max_points)
+                    {
+                        return -1;
+                    }
+                    spherical_segment_plane_intersection(&output[num_output], p, dp, q, dq);
+                    num_output++;
+                }
+            }
+            p = q;
+            dp = dq;
+        }
+
+        input = output;
+        num_input = num_output;
+        output = (output == buffer) ? &buffer[max_points] : buffer;
+    }
+
+    *result = input;
+    return num_input;
+}
+
+/* Returns 1 if all vertices of polygon_a are inside the convex polygon_b */
+static int spherical_polygon_vectors_inside(const harp_spherical_polygon_vectors *polygon_a,
+                                            const harp_spherical_polygon_vectors *polygon_b)
+{
+    int32_t i, k;
+
+    for (k = 0; k < polygon_b->numberofpoints; k++)
+    {
+        harp_vector3d normal;
+
+        harp_vector3d_crossproduct(&normal, &polygon_b->vertex[k],
+                                   &polygon_b->vertex[k == polygon_b->numberofpoints - 1 ? 0 : k + 1]);
+        for (i = 0; i < polygon_a->numberofpoints; i++)
+        {
+            if (polygon_b->orientation * harp_vector3d_dotproduct(&normal, &polygon_a->vertex[i]) <
+                -HARP_GEOMETRY_EPSILON)
+            {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* Determine whether two polygons overlap, and if so calculate the overlapping fraction of the two polygons.
+ * This is an allocation free alternative to harp_spherical_polygon_overlapping_fraction() for polygons that have
+ * been converted using harp_spherical_polygon_vectors_init(). It first compares the bounding caps of the polygons and
+ * then clips one polygon against the other, which requires that at least one of the polygons is convex.
+ * The scratch buffer should have room for HARP_SPHERICAL_POLYGON_VECTORS_SCRATCH_SIZE(na, nb) vectors.
+ * Returns 0 on success, or 1 if the fraction cannot be determined this way (neither polygon is convex), in which case
+ * harp_spherical_polygon_overlapping_fraction() should be used.
+ */
+int harp_spherical_polygon_vectors_overlapping_fraction(const harp_spherical_polygon_vectors *polygon_a,
+                                                        const harp_spherical_polygon_vectors *polygon_b,
+                                                        harp_vector3d *scratch, int *polygons_are_overlapping,
+                                                        double *overlapping_fraction)
+{
+    const harp_spherical_polygon_vectors *subject;
+    const harp_spherical_polygon_vectors *clip;
+    const harp_vector3d *intersection;
+    double cos_distance;
+    double min_area;
+    double fraction;
+    int32_t num_intersection_points;
+    int subject_inside;
+
+    if (polygon_a->orientation == 0 && polygon_b->orientation == 0)
+    {
+        return 1;
+    }
+
+    *polygons_are_overlapping = 0;
+    *overlapping_fraction = 0.0;
+
+    /* polygons can not overlap if their bounding caps are separate */
+    cos_distance = harp_vector3d_dotproduct(&polygon_a->cap_centre, &polygon_b->cap_centre);
+    HARP_CLAMP(cos_distance, -1.0, 1.0);
+    if (acos(cos_distance) > polygon_a->cap_radius + polygon_b->cap_radius + HARP_GEOMETRY_EPSILON)
+    {
+        return 0;
+    }
+
+    if (polygon_b->orientation != 0)
+    {
+        subject = polygon_a;
+        clip = polygon_b;
+    }
+    else
+    {
+        subject = polygon_b;
+        clip = polygon_a;
+    }
+    num_intersection_points = spherical_polygon_vectors_clip(subject->numberofpoints, subject->vertex, clip, scratch,
+                                                             &intersection, &subject_inside);
+    if (num_intersection_points < 0)
+    {
+        return 1;
+    }
+    if (num_intersection_points < 3)
+    {
+        /* No overlap */
+        return 0;
+    }
+
+    if (subject_inside || (subject->orientation != 0 && spherical_polygon_vectors_inside(clip, subject)))
+    {
+        /* one polygon contains the other */
+        *polygons_are_overlapping = 1;
+        *overlapping_fraction = 1.0;
+        return 0;
+    }
+
+    /* Overlapping fraction = areaAB / min(areaA, areaB) */
+    min_area = (polygon_a->area < polygon_b->area ? polygon_a->area : polygon_b->area);
+    if (HARP_GEOMETRY_FPzero(CONST_EARTH_RADIUS_WGS84_SPHERE * CONST_EARTH_RADIUS_WGS84_SPHERE * min_area))
+    {
+        /* just set to 1 if area_a/area_b is too small */
+        *polygons_are_overlapping = 1;
+        *overlapping_fraction = 1.0;
+        return 0;
+    }
+
+    fraction = spherical_polygon_vectors_get_surface_area(num_intersection_points, intersection) / min_area;
+    if (HARP_GEOMETRY_FPzero(fraction))
+    {
+        /* the polygons only touch (shared edge or vertex) */
+        return 0;
+    }
+
+    *polygons_are_overlapping = 1;
+    *overlapping_fraction = (fraction > 1.0 ? 1.0 : fraction);
+
+    return 0;
+}
+
+/* Determine whether two polygons overlap, and if so
+ * calculate the overlapping fraction of the two polygons */
+int harp_spherical_polygon_overlapping_fraction(const harp_spherical_polygon *polygon_a,
+                                                const harp_spherical_polygon *polygon_b,
+                                                int *polygons_are_overlapping, double *overlapping_fraction)
+{
+    int32_t num_points = polygon_a->numberofpoints + polygon_b->numberofpoints;
+
+    if (num_points <= MAX_STACK_POLYGON_POINTS)
+    {
+        /* use the (allocation free) vector based calculation if one of the polygons is convex */
+        harp_vector3d buffer[3 * MAX_STACK_POLYGON_POINTS];   /* vertices of both polygons + scratch buffer */
+        harp_spherical_polygon_vectors vectors_a;
+        harp_spherical_polygon_vectors vectors_b;
+
+        harp_spherical_polygon_vectors_init(&vectors_a, polygon_a, buffer);
+        harp_spherical_polygon_vectors_init(&vectors_b, polygon_b, &buffer[polygon_a->numberofpoints]);
+        if (harp_spherical_polygon_vectors_overlapping_fraction(&vectors_a, &vectors_b, &buffer[num_points],
+                                                                polygons_are_overlapping, overlapping_fraction) == 0)
+        {
+            return 0;
+        }
+    }
+
+    return spherical_polygon_overlapping_fraction_generic(polygon_a, polygon_b, polygons_are_overlapping,
+                                                          overlapping_fraction);
+}
+
 /* Given number of vertex points, return empty
  * spherical polygon data structure with points (lat,lon) in  [rad] */
 int harp_spherical_polygon_new(int32_t numberofpoints, harp_spherical_polygon **polygon)
@@ -1128,19 +1527,20 @@ static int spherical_polygon_begin_end_point_equal(long measurement_id, long num
     return harp_spherical_point_equal(&p_begin, &p_end);
 }
 
-/* Obtain spherical polygon from two double arrays with latitude_bounds [degree_north] and
+/* Set the points of an existing spherical polygon from two double arrays with latitude_bounds [degree_north] and
  * longitude_bounds [degree_east]
  *
  * The latitude/longitude bounds can be either vertices of a polygon (num_vertices>=3),
  * or represent corner points that define a bounding rect (num_vertices==2).
  *
- * The function discards the end point if was equal to the begin point
+ * The function discards the end point if was equal to the begin point.
+ * The polygon should have been created with room for at least max(num_vertices, 4) points.
+ * This allows the same polygon to be reused when processing the bounds of many measurements.
  */
-int harp_spherical_polygon_from_latitude_longitude_bounds(long measurement_id, long num_vertices,
-                                                          const double *latitude_bounds, const double *longitude_bounds,
-                                                          int check_polygon, harp_spherical_polygon **new_polygon)
+int harp_spherical_polygon_set_from_latitude_longitude_bounds(harp_spherical_polygon *polygon, long measurement_id,
+                                                              long num_vertices, const double *latitude_bounds,
+                                                              const double *longitude_bounds, int check_polygon)
 {
-    harp_spherical_polygon *polygon = NULL;
     double deg2rad = (double)(CONST_DEG2RAD);
     int32_t num_points = (int32_t)num_vertices; /* Start with num_vertices */
     int32_t i;
@@ -1150,13 +1550,7 @@ int harp_spherical_polygon_from_latitude_longitude_bounds(long measurement_id, l
         /* If we only have two vertices then these are the corner points of a bounding box.
          * In that case we construct a 4-point bounding box from these two corner coordinates.
          */
-
-        /* Create the polygon */
-        if (harp_spherical_polygon_new(4, &polygon) != 0)
-        {
-            return -1;
-        }
-
+        polygon->numberofpoints = 4;
         polygon->point[0].lat = latitude_bounds[measurement_id * 2] * deg2rad;
         polygon->point[0].lon = longitude_bounds[measurement_id * 2] * deg2rad;
         polygon->point[1].lat = latitude_bounds[measurement_id * 2] * deg2rad;
@@ -1174,11 +1568,9 @@ int harp_spherical_polygon_from_latitude_longitude_bounds(long measurement_id, l
         if (polygon->point[0].lat == polygon->point[2].lat || polygon->point[0].lon == polygon->point[2].lon)
         {
             harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "invalid polygon (line segments overlap)");
-            harp_spherical_polygon_delete(polygon);
             return -1;
         }
 
-        *new_polygon = polygon;
         return 0;
     }
 
@@ -1194,12 +1586,7 @@ int harp_spherical_polygon_from_latitude_longitude_bounds(long measurement_id, l
         return -1;
     }
 
-    /* Create the polygon */
-    if (harp_spherical_polygon_new(num_points, &polygon) != 0)
-    {
-        return -1;
-    }
-
+    polygon->numberofpoints = num_points;
     for (i = 0; i < num_points; i++)
     {
         polygon->point[i].lat = latitude_bounds[measurement_id * num_vertices + i] * deg2rad;
@@ -1212,11 +1599,39 @@ int harp_spherical_polygon_from_latitude_longitude_bounds(long measurement_id, l
         /* Check the polygon */
         if (harp_spherical_polygon_check(polygon) != 0)
         {
-            harp_spherical_polygon_delete(polygon);
             return -1;
         }
     }
 
+    return 0;
+}
+
+/* Obtain spherical polygon from two double arrays with latitude_bounds [degree_north] and
+ * longitude_bounds [degree_east]
+ *
+ * The latitude/longitude bounds can be either vertices of a polygon (num_vertices>=3),
+ * or represent corner points that define a bounding rect (num_vertices==2).
+ *
+ * The function discards the end point if was equal to the begin point
+ */
+int harp_spherical_polygon_from_latitude_longitude_bounds(long measurement_id, long num_vertices,
+                                                          const double *latitude_bounds, const double *longitude_bounds,
+                                                          int check_polygon, harp_spherical_polygon **new_polygon)
+{
+    harp_spherical_polygon *polygon = NULL;
+
+    if (harp_spherical_polygon_new(num_vertices == 2 ? 4 : (int32_t)num_vertices, &polygon) != 0)
+    {
+        return -1;
+    }
+    if (harp_spherical_polygon_set_from_latitude_longitude_bounds(polygon, measurement_id, num_vertices,
+                                                                  latitude_bounds, longitude_bounds,
+                                                                  check_polygon) != 0)
+    {
+        harp_spherical_polygon_delete(polygon);
+        return -1;
+    }
+
     *new_polygon = polygon;
     return 0;
 }
@@ -1363,3 +1778,89 @@ LIBHARP_API int harp_geometry_get_area(int num_vertices, double *latitude_bounds
 
     return 0;
 }
+
+/* Calculate the area size (in [m2]) for each of num_samples polygons on the surface of the Earth
+ * latitude_bounds and longitude_bounds are [num_samples, num_vertices] arrays.
+ * The latitude/longitude bounds can be either vertices of a polygon (num_vertices>=3),
+ * or represent corner points that define a bounding rect (num_vertices==2).
+ * A single polygon is used for all samples, so there is no allocation per sample.
+ */
+int harp_geometry_get_area_array(long num_samples, long num_vertices, const double *latitude_bounds,
+                                 const double *longitude_bounds, double *area)
+{
+    harp_spherical_polygon *polygon = NULL;
+    long i;
+
+    if (harp_spherical_polygon_new(num_vertices == 2 ? 4 : (int32_t)num_vertices, &polygon) != 0)
+    {
+        return -1;
+    }
+    for (i = 0; i < num_samples; i++)
+    {
+        if (harp_spherical_polygon_set_from_latitude_longitude_bounds(polygon, i, num_vertices, latitude_bounds,
+                                                                      longitude_bounds, 1) != 0)
+        {
+            harp_spherical_polygon_delete(polygon);
+            return -1;
+        }
+        if (spherical_polygon_get_surface_area(polygon, &area[i]) != 0)
+        {
+            harp_spherical_polygon_delete(polygon);
+            return -1;
+        }
+    }
+
+    harp_spherical_polygon_delete(polygon);
+
+    return 0;
+}
+
+/* Calculate the area size (in [m2]) for each cell of a separable latitude/longitude grid
+ * latitude_bounds is a [num_latitude, 2] array and longitude_bounds is a [num_longitude, 2] array.
+ * The result is stored in area as a [num_latitude, num_longitude] array.
+ * Since the area of a cell does not change when it is rotated around the polar axis, the area is only calculated for
+ * the first cell of a sequence of columns with the same longitude width. All other cells of that sequence in the
+ * same latitude row get the same area.
+ */
+int harp_geometry_get_area_gridded(long num_latitude, const double *latitude_bounds, long num_longitude,
+                                   const double *longitude_bounds, double *area)
+{
+    harp_spherical_polygon *polygon = NULL;
+    long i, j;
+
+    if (harp_spherical_polygon_new(4, &polygon) != 0)
+    {
+        return -1;
+    }
+    for (i = 0; i < num_latitude; i++)
+    {
+        long j_ref = -1;
+
+        for (j = 0; j < num_longitude; j++)
+        {
+            double width = longitude_bounds[j * 2 + 1] - longitude_bounds[j * 2];
+
+            if (j_ref >= 0 && width == longitude_bounds[j_ref * 2 + 1] - longitude_bounds[j_ref * 2])
+            {
+                area[i * num_longitude + j] = area[i * num_longitude + j_ref];
+                continue;
+            }
+            if (harp_spherical_polygon_set_from_latitude_longitude_bounds(polygon, 0, 2, &latitude_bounds[i * 2],
+                                                                          &longitude_bounds[j * 2], 1) != 0)
+            {
+                harp_spherical_polygon_delete(polygon);
+                return -1;
+            }
+            if (spherical_polygon_get_surface_area(polygon, &area[i * num_longitude + j]) != 0)
+            {
+                harp_spherical_polygon_delete(polygon);
+                return -1;
+            }
+            j_ref = j;
+        }
+    }
+
+    harp_spherical_polygon_delete(polygon);
+
+    return 0;
+}
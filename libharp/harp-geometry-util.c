@@ -309,6 +309,57 @@ int harp_geographic_center_from_bounds(long num_vertices, const double *latitude
     return 0;
 }
 
+/* Calculate the center for each of num_samples polygons
+ * latitude_bounds and longitude_bounds are [num_samples, num_vertices] arrays.
+ * Either center_latitude or center_longitude can be NULL if that part of the result is not needed.
+ * A single polygon is used for all samples, so there is no allocation per sample.
+ */
+int harp_geographic_center_from_bounds_array(long num_samples, long num_vertices, const double *latitude_bounds,
+                                             const double *longitude_bounds, double *center_latitude,
+                                             double *center_longitude)
+{
+    harp_spherical_polygon *polygon = NULL;
+    harp_vector3d vector_center;
+    harp_spherical_point point;
+    long i;
+
+    if (harp_spherical_polygon_new(num_vertices == 2 ? 4 : (int32_t)num_vertices, &polygon) != 0)
+    {
+        return -1;
+    }
+
+    for (i = 0; i < num_samples; i++)
+    {
+        if (harp_spherical_polygon_set_from_latitude_longitude_bounds(polygon, i, num_vertices, latitude_bounds,
+                                                                      longitude_bounds, 0) != 0)
+        {
+            harp_spherical_polygon_delete(polygon);
+            return -1;
+        }
+        if (harp_spherical_polygon_centre(&vector_center, polygon) != 0)
+        {
+            harp_spherical_polygon_delete(polygon);
+            return -1;
+        }
+
+        harp_spherical_point_from_vector3d(&point, &vector_center);
+        harp_spherical_point_check(&point);
+        harp_spherical_point_deg_from_rad(&point);
+        if (center_latitude != NULL)
+        {
+            center_latitude[i] = point.lat;
+        }
+        if (center_longitude != NULL)
+        {
+            center_longitude[i] = point.lon;
+        }
+    }
+
+    harp_spherical_polygon_delete(polygon);
+
+    return 0;
+}
+
 /** Calculate grid cell corner coordinates from a grid of center coordinates
  *
  * This routine will calculate grid cell corner coordinates from center points through interpolation and extrapolation (at the boundaries).
@@ -61,6 +61,9 @@
 #define HARP_GEOMETRY_FPgt(A, B) ((A) - (B) > HARP_GEOMETRY_EPSILON)
 #define HARP_GEOMETRY_FPge(A, B) ((B) - (A) <= HARP_GEOMETRY_EPSILON)
 
+/* margin [rad] that is added to bounding boxes that are used to pre-reject points before performing an exact test */
+#define HARP_GEOMETRY_BOUNDING_BOX_MARGIN (1.0E-6)
+
 #define HARP_GEOMETRY_NUM_PLANE_COEFFICIENTS 4
 #define HARP_GEOMETRY_NUM_MATRIX_3X3_ELEMENTS 9
 
@@ -68,6 +71,7 @@
  * Define geometric data structures:
  *
  *   harp_spherical_point
+ *   harp_spherical_bounding_box
  *   harp_spherical_line
  *   harp_spherical_polygon
  *   harp_spherical_polygon_array
@@ -92,6 +96,16 @@ typedef struct harp_spherical_point_struct
     double lat; /* in [rad] */
 } harp_spherical_point;
 
+/* Define a latitude/longitude box on a sphere */
+/* Longitudes can extend outside [0,2pi] for boxes that cross the dateline */
+typedef struct harp_spherical_bounding_box_struct
+{
+    double lat_min;     /* in [rad] */
+    double lat_max;     /* in [rad] */
+    double lon_min;     /* in [rad] */
+    double lon_max;     /* in [rad] */
+} harp_spherical_bounding_box;
+
 /* Define line on sphere. It is defined by an
  * Euler transformation and a length.
  * The "untransformed" line starts on the equator at (0,0) and ends at (length, 0).
@@ -116,6 +130,20 @@ typedef struct harp_spherical_polygon_struct
     harp_spherical_point point[1];      /* variable length array of "spherical_point"s */
 } harp_spherical_polygon;
 
+/* Define polygon on a sphere using unit vectors for its vertices.
+ * This representation is used for fast (allocation free) calculation of overlapping fractions.
+ * The storage for the vertex vectors is provided (and owned) by the caller.
+ */
+typedef struct harp_spherical_polygon_vectors_struct
+{
+    int32_t numberofpoints;     /* count of points */
+    harp_vector3d *vertex;      /* unit vectors of the polygon points */
+    harp_vector3d cap_centre;   /* centre of the bounding cap of the polygon */
+    double cap_radius;  /* angular radius of the bounding cap in [rad] */
+    double area;        /* surface area of the polygon in [rad2] */
+    int orientation;    /* 1 if the polygon is convex and counterclockwise, -1 if convex and clockwise, 0 otherwise */
+} harp_spherical_polygon_vectors;
+
 /* Define an array of points on a sphere */
 typedef struct harp_spherical_point_array_struct
 {
@@ -170,6 +198,13 @@ void harp_spherical_point_rad_from_deg(harp_spherical_point *point);
 void harp_spherical_point_deg_from_rad(harp_spherical_point *point);
 double harp_spherical_point_distance(const harp_spherical_point *pointp, const harp_spherical_point *pointq);
 
+/* Spherical bounding box functions */
+void harp_spherical_bounding_box_from_cap(harp_spherical_bounding_box *box, const harp_spherical_point *center,
+                                          double radius);
+void harp_spherical_bounding_box_expand(harp_spherical_bounding_box *box, double margin);
+int harp_spherical_bounding_box_contains_point(const harp_spherical_bounding_box *box,
+                                               const harp_spherical_point *point);
+
 /* Spherical line functions */
 void harp_spherical_line_begin(harp_spherical_point *point, const harp_spherical_line *line);
 void harp_spherical_line_end(harp_spherical_point *point, const harp_spherical_line *line);
@@ -209,7 +244,11 @@ void harp_spherical_polygon_delete(harp_spherical_polygon *polygon);
 int harp_spherical_polygon_from_latitude_longitude_bounds(long measurement_id, long num_vertices,
                                                           const double *latitude_bounds, const double *longitude_bounds,
                                                           int check_polygon, harp_spherical_polygon **new_polygon);
+int harp_spherical_polygon_set_from_latitude_longitude_bounds(harp_spherical_polygon *polygon, long measurement_id,
+                                                              long num_vertices, const double *latitude_bounds,
+                                                              const double *longitude_bounds, int check_polygon);
 int harp_spherical_polygon_centre(harp_vector3d *vector_centre, const harp_spherical_polygon *polygon);
+void harp_spherical_polygon_get_bounding_box(const harp_spherical_polygon *polygon, harp_spherical_bounding_box *box);
 int harp_spherical_polygon_contains_point(const harp_spherical_polygon *polygon, const harp_spherical_point *point);
 int8_t harp_spherical_polygon_spherical_line_relationship(const harp_spherical_polygon *polygon,
                                                           const harp_spherical_line *line);
@@ -227,6 +266,21 @@ int harp_spherical_polygon_overlapping_fraction(const harp_spherical_polygon *po
                                                 const harp_spherical_polygon *polygonb,
                                                 int *polygons_are_overlapping, double *overlapping_fraction);
 
+/* Calculate the overlapping fraction of two areas given as vectors (without allocating memory) */
+#define HARP_SPHERICAL_POLYGON_VECTORS_SCRATCH_SIZE(na, nb) (2 * ((na) + (nb)))
+void harp_spherical_polygon_vectors_init(harp_spherical_polygon_vectors *vectors,
+                                         const harp_spherical_polygon *polygon, harp_vector3d *vertex);
+int harp_spherical_polygon_vectors_overlapping_fraction(const harp_spherical_polygon_vectors *polygon_a,
+                                                        const harp_spherical_polygon_vectors *polygon_b,
+                                                        harp_vector3d *scratch, int *polygons_are_overlapping,
+                                                        double *overlapping_fraction);
+
+/* Calculate the area of many polygons/grid cells at once */
+int harp_geometry_get_area_array(long num_samples, long num_vertices, const double *latitude_bounds,
+                                 const double *longitude_bounds, double *area);
+int harp_geometry_get_area_gridded(long num_latitude, const double *latitude_bounds, long num_longitude,
+                                   const double *longitude_bounds, double *area);
+
 void harp_geographic_average(double latitude_p, double longitude_p, double latitude_q, double longitude_q,
                              double *average_latitude, double *average_longitude);
 void harp_geographic_intersection(double latitude_p1, double longitude_p1, double latitude_p2, double longitude_p2,
@@ -238,6 +292,9 @@ void harp_geographic_extrapolation(double latitude_p, double longitude_p, double
 int harp_geographic_center_from_bounds(long num_vertices, const double *latitude_bounds,
                                        const double *longitude_bounds, double *center_latitude,
                                        double *center_longitude);
+int harp_geographic_center_from_bounds_array(long num_samples, long num_vertices, const double *latitude_bounds,
+                                             const double *longitude_bounds, double *center_latitude,
+                                             double *center_longitude);
 
 void harp_get_grid_corner_coordinates(long num_x, long num_y, const double *longitude, const double *latitude,
                                       double *longitude_edge, double *latitude_edge);
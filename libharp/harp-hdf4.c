@@ -389,11 +389,70 @@ static int read_dimensions(int32 sds_id, int *num_dimensions, hdf4_dimension_typ
     return 0;
 }
 
-static int read_variable(harp_product *product, int32 sds_id)
+static int read_variable_data(int32 sds_id, harp_variable *variable, int32 hdf4_num_dimensions,
+                              int32 *hdf4_dimension)
+{
+    int32 hdf4_start[MAX_HDF4_VAR_DIMS] = { 0 };
+
+    if (variable->data_type == harp_type_string)
+    {
+        char *buffer = NULL;
+        long length = hdf4_dimension[hdf4_num_dimensions - 1];
+        long i;
+
+        buffer = malloc(variable->num_elements * length * sizeof(char));
+        if (buffer == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           variable->num_elements * length * sizeof(char), __FILE__, __LINE__);
+            return -1;
+        }
+
+        if (SDreaddata(sds_id, hdf4_start, NULL, hdf4_dimension, buffer) != 0)
+        {
+            harp_set_error(HARP_ERROR_HDF4, NULL);
+            free(buffer);
+            return -1;
+        }
+
+        for (i = 0; i < variable->num_elements; i++)
+        {
+            char *str;
+
+            str = malloc((length + 1) * sizeof(char));
+            if (str == NULL)
+            {
+                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                               (length + 1) * sizeof(char), __FILE__, __LINE__);
+                free(buffer);
+                return -1;
+            }
+
+            memcpy(str, &buffer[i * length], length);
+            str[length] = '\0';
+            variable->data.string_data[i] = str;
+        }
+
+        free(buffer);
+    }
+    else
+    {
+        if (SDreaddata(sds_id, hdf4_start, NULL, hdf4_dimension, variable->data.ptr) != 0)
+        {
+            harp_set_error(HARP_ERROR_HDF4, NULL);
+            return -1;
+        }
+    }
+
+
+    return 0;
+}
+
+static int read_variable(harp_product *product, int32 sds_id, int schema_only, int num_selected_variables,
+                         char **selected_variable_name)
 {
     char hdf4_name[MAX_HDF4_NAME_LENGTH + 1];
     int32 hdf4_dimension[MAX_HDF4_VAR_DIMS];
-    int32 hdf4_start[MAX_HDF4_VAR_DIMS] = { 0 };
     int32 hdf4_data_type;
     int32 hdf4_num_dimensions;
     int32 hdf4_dont_care;
@@ -414,6 +473,12 @@ static int read_variable(harp_product *product, int32 sds_id)
     }
     assert(hdf4_num_dimensions > 0);
 
+    if (selected_variable_name != NULL &&
+        !harp_match_wildcard_list(num_selected_variables, selected_variable_name, hdf4_name))
+    {
+        return 0;
+    }
+
     /* Determine HARP data type. */
     if (get_harp_type(hdf4_data_type, &data_type) != 0)
     {
@@ -501,7 +566,15 @@ static int read_variable(harp_product *product, int32 sds_id)
     }
 
     /* Create HARP variable. */
-    if (harp_variable_new(hdf4_name, data_type, num_dimensions, dimension_type, dimension, &variable) != 0)
+    if (schema_only)
+    {
+        if (harp_variable_new_without_data(hdf4_name, data_type, num_dimensions, dimension_type, dimension,
+                                           &variable) != 0)
+        {
+            return -1;
+        }
+    }
+    else if (harp_variable_new(hdf4_name, data_type, num_dimensions, dimension_type, dimension, &variable) != 0)
     {
         return -1;
     }
@@ -512,52 +585,10 @@ static int read_variable(harp_product *product, int32 sds_id)
         return -1;
     }
 
-    /* Read data. */
-    if (data_type == harp_type_string)
+    if (!schema_only)
     {
-        char *buffer = NULL;
-        long length = hdf4_dimension[hdf4_num_dimensions - 1];
-
-        buffer = malloc(variable->num_elements * length * sizeof(char));
-        if (buffer == NULL)
+        if (read_variable_data(sds_id, variable, hdf4_num_dimensions, hdf4_dimension) != 0)
         {
-            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                           variable->num_elements * length * sizeof(char), __FILE__, __LINE__);
-            return -1;
-        }
-
-        if (SDreaddata(sds_id, hdf4_start, NULL, hdf4_dimension, buffer) != 0)
-        {
-            harp_set_error(HARP_ERROR_HDF4, NULL);
-            free(buffer);
-            return -1;
-        }
-
-        for (i = 0; i < variable->num_elements; i++)
-        {
-            char *str;
-
-            str = malloc((length + 1) * sizeof(char));
-            if (str == NULL)
-            {
-                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                               (length + 1) * sizeof(char), __FILE__, __LINE__);
-                free(buffer);
-                return -1;
-            }
-
-            memcpy(str, &buffer[i * length], length);
-            str[length] = '\0';
-            variable->data.string_data[i] = str;
-        }
-
-        free(buffer);
-    }
-    else
-    {
-        if (SDreaddata(sds_id, hdf4_start, NULL, hdf4_dimension, variable->data.ptr) != 0)
-        {
-            harp_set_error(HARP_ERROR_HDF4, NULL);
             return -1;
         }
     }
@@ -643,7 +674,8 @@ static int read_variable(harp_product *product, int32 sds_id)
     return 0;
 }
 
-static int read_product(harp_product *product, int32 sd_id)
+static int read_product(harp_product *product, int32 sd_id, int schema_only, int num_selected_variables,
+                        char **selected_variable_name)
 {
     int32 num_sds;
     int32 hdf4_num_attributes;
@@ -668,7 +700,7 @@ static int read_product(harp_product *product, int32 sd_id)
             return -1;
         }
 
-        if (read_variable(product, sds_id) != 0)
+        if (read_variable(product, sds_id, schema_only, num_selected_variables, selected_variable_name) != 0)
         {
             SDendaccess(sds_id);
             return -1;
@@ -731,7 +763,8 @@ static int verify_product(int32 sd_id)
     return -1;
 }
 
-int harp_import_hdf4(const char *filename, harp_product **product)
+static int import_hdf4(const char *filename, int schema_only, int num_selected_variables,
+                       char **selected_variable_name, harp_product **product)
 {
     harp_product *new_product;
     int32 sd_id;
@@ -756,7 +789,7 @@ int harp_import_hdf4(const char *filename, harp_product **product)
         return -1;
     }
 
-    if (read_product(new_product, sd_id) != 0)
+    if (read_product(new_product, sd_id, schema_only, num_selected_variables, selected_variable_name) != 0)
     {
         harp_add_error_message(" (%s)", filename);
         harp_product_delete(new_product);
@@ -770,6 +803,17 @@ int harp_import_hdf4(const char *filename, harp_product **product)
     return 0;
 }
 
+int harp_import_hdf4(const char *filename, int num_variables, char **variable_name, harp_product **product)
+{
+    return import_hdf4(filename, 0, num_variables, variable_name, product);
+}
+
+/* Import only the structure of the product (variables, dimensions, and attributes); variable data is not read. */
+int harp_import_schema_hdf4(const char *filename, harp_product **product)
+{
+    return import_hdf4(filename, 1, 0, NULL, product);
+}
+
 static int update_dimensions_with_variable(long dimension[], int32 sds_id)
 {
     char hdf4_name[MAX_HDF4_NAME_LENGTH + 1];
@@ -378,18 +378,29 @@ static int set_compression(hid_t plist_id, harp_variable *variable)
     if (level > 0 && variable->num_dimensions > 0)
     {
         long max_length = 4294967295;
+        long chunk_size = harp_get_option_hdf5_chunk_size();
         hsize_t dimension[HARP_MAX_NUM_DIMS];
+        long num_elements = 1;
         int i;
 
         /* set chunk configuration (we need chunking to enable compression) */
-        /* we want to use the largest block possible while staying within the 2^32-1 elements per chunk limit */
+        /* by default we want to use the largest block possible while staying within the 2^32-1 elements per chunk
+         * limit; if a chunk size is set, time dependent variables are chunked per block of time samples instead */
         for (i = 0; i < variable->num_dimensions; i++)
         {
             dimension[i] = variable->dimension[i];
         }
-        if (variable->num_elements > max_length)
+        if (chunk_size > 0 && variable->dimension_type[0] == harp_dimension_time &&
+            variable->dimension[0] > chunk_size)
+        {
+            dimension[0] = chunk_size;
+        }
+        for (i = 0; i < variable->num_dimensions; i++)
+        {
+            num_elements *= (long)dimension[i];
+        }
+        if (num_elements > max_length)
         {
-            long num_elements = variable->num_elements;
             int i = 0;
 
             while (i < variable->num_dimensions - 1)
@@ -414,6 +425,15 @@ static int set_compression(hid_t plist_id, harp_variable *variable)
             harp_set_error(HARP_ERROR_HDF5, NULL);
             return -1;
         }
+        if (variable->data_type != harp_type_string && harp_get_size_for_type(variable->data_type) > 1)
+        {
+            /* group the bytes of the elements by significance, which makes the data compress much better */
+            if (H5Pset_shuffle(plist_id) < 0)
+            {
+                harp_set_error(HARP_ERROR_HDF5, NULL);
+                return -1;
+            }
+        }
         if (H5Pset_deflate(plist_id, level) < 0)
         {
             harp_set_error(HARP_ERROR_HDF5, NULL);
@@ -781,44 +801,8 @@ static int read_variable_dimensions(const char *variable_name, hid_t dataset_id,
     return 0;
 }
 
-static int read_variable(hid_t dataset_id, const char *name, const hdf5_dimension_ids *dimension_ids,
-                         harp_product *product)
+static int read_variable_data(hid_t dataset_id, harp_variable *variable)
 {
-    const char *variable_name;
-    harp_variable *variable;
-    harp_dimension_type dimension_type[HARP_MAX_NUM_DIMS];
-    long dimension[HARP_MAX_NUM_DIMS];
-    harp_data_type data_type;
-    int num_dimensions;
-    herr_t result;
-
-    if (read_variable_data_type(dataset_id, &data_type) != 0)
-    {
-        return -1;
-    }
-
-    if (read_variable_dimensions(name, dataset_id, dimension_ids, &num_dimensions, dimension_type, dimension) != 0)
-    {
-        return -1;
-    }
-
-    variable_name = name;
-    if (strncmp(name, "_nc4_non_coord_", 15) == 0)
-    {
-        variable_name = &name[15];
-    }
-    if (harp_variable_new(variable_name, data_type, num_dimensions, dimension_type, dimension, &variable) != 0)
-    {
-        return -1;
-    }
-
-    if (harp_product_add_variable(product, variable) != 0)
-    {
-        harp_variable_delete(variable);
-        return -1;
-    }
-
-    /* Read variable data. */
     if (variable->data_type == harp_type_string)
     {
         char *buffer;
@@ -914,6 +898,69 @@ static int read_variable(hid_t dataset_id, const char *name, const hdf5_dimensio
         }
     }
 
+
+    return 0;
+}
+
+static int read_variable(hid_t dataset_id, const char *name, const hdf5_dimension_ids *dimension_ids,
+                         int schema_only, int num_selected_variables, char **selected_variable_name,
+                         harp_product *product)
+{
+    const char *variable_name;
+    harp_variable *variable;
+    harp_dimension_type dimension_type[HARP_MAX_NUM_DIMS];
+    long dimension[HARP_MAX_NUM_DIMS];
+    harp_data_type data_type;
+    int num_dimensions;
+    herr_t result;
+
+    variable_name = name;
+    if (strncmp(name, "_nc4_non_coord_", 15) == 0)
+    {
+        variable_name = &name[15];
+    }
+    if (selected_variable_name != NULL &&
+        !harp_match_wildcard_list(num_selected_variables, selected_variable_name, variable_name))
+    {
+        return 0;
+    }
+
+    if (read_variable_data_type(dataset_id, &data_type) != 0)
+    {
+        return -1;
+    }
+
+    if (read_variable_dimensions(name, dataset_id, dimension_ids, &num_dimensions, dimension_type, dimension) != 0)
+    {
+        return -1;
+    }
+    if (schema_only)
+    {
+        if (harp_variable_new_without_data(variable_name, data_type, num_dimensions, dimension_type, dimension,
+                                           &variable) != 0)
+        {
+            return -1;
+        }
+    }
+    else if (harp_variable_new(variable_name, data_type, num_dimensions, dimension_type, dimension, &variable) != 0)
+    {
+        return -1;
+    }
+
+    if (harp_product_add_variable(product, variable) != 0)
+    {
+        harp_variable_delete(variable);
+        return -1;
+    }
+
+    if (!schema_only)
+    {
+        if (read_variable_data(dataset_id, variable) != 0)
+        {
+            return -1;
+        }
+    }
+
     /* Read variable attributes. */
     result = H5Aexists(dataset_id, "description");
     if (result > 0)
@@ -1142,6 +1189,9 @@ static int find_dimensions(hid_t group_id, hdf5_dimension_ids *dimension_ids)
 typedef struct hdf5_read_variable_func_args_struct
 {
     hdf5_dimension_ids *dimension_ids;
+    int schema_only;
+    int num_selected_variables;
+    char **selected_variable_name;
     harp_product *product;
 } hdf5_read_variable_func_args;
 
@@ -1203,7 +1253,8 @@ static herr_t hdf5_read_variable_func(hid_t group_id, const char *name, const H5
         }
     }
 
-    if (read_variable(dataset_id, name, args->dimension_ids, args->product) != 0)
+    if (read_variable(dataset_id, name, args->dimension_ids, args->schema_only, args->num_selected_variables,
+                      args->selected_variable_name, args->product) != 0)
     {
         H5Dclose(dataset_id);
         return 1;
@@ -1214,7 +1265,8 @@ static herr_t hdf5_read_variable_func(hid_t group_id, const char *name, const H5
     return 0;
 }
 
-static int read_variables(hid_t group_id, hdf5_dimension_ids *dimension_ids, harp_product *product)
+static int read_variables(hid_t group_id, hdf5_dimension_ids *dimension_ids, int schema_only,
+                          int num_selected_variables, char **selected_variable_name, harp_product *product)
 {
     hdf5_read_variable_func_args args;
     H5_index_t index_type;
@@ -1225,6 +1277,9 @@ static int read_variables(hid_t group_id, hdf5_dimension_ids *dimension_ids, har
     }
 
     args.dimension_ids = dimension_ids;
+    args.schema_only = schema_only;
+    args.num_selected_variables = num_selected_variables;
+    args.selected_variable_name = selected_variable_name;
     args.product = product;
 
     return (H5Literate(group_id, index_type, H5_ITER_INC, NULL, hdf5_read_variable_func, &args) != 0 ? -1 : 0);
@@ -1265,7 +1320,8 @@ static int read_attributes(hid_t group_id, harp_product *product)
     return 0;
 }
 
-static int read_product(hid_t file_id, harp_product *product)
+static int read_product(hid_t file_id, int schema_only, int num_selected_variables, char **selected_variable_name,
+                        harp_product *product)
 {
     hdf5_dimension_ids dimension_ids = { {0}, {{0, 0}}, {0} };
     hid_t root_id;
@@ -1285,7 +1341,8 @@ static int read_product(hid_t file_id, harp_product *product)
     }
 
     /* Read variables. */
-    if (read_variables(root_id, &dimension_ids, product) != 0)
+    if (read_variables(root_id, &dimension_ids, schema_only, num_selected_variables, selected_variable_name,
+                       product) != 0)
     {
         H5Gclose(root_id);
         return -1;
@@ -1335,7 +1392,8 @@ static int verify_product(hid_t file_id)
     return -1;
 }
 
-int harp_import_hdf5(const char *filename, harp_product **product)
+static int import_hdf5(const char *filename, int schema_only, int num_selected_variables,
+                       char **selected_variable_name, harp_product **product)
 {
     harp_product *new_product;
     hid_t file_id;
@@ -1360,7 +1418,7 @@ int harp_import_hdf5(const char *filename, harp_product **product)
         return -1;
     }
 
-    if (read_product(file_id, new_product) != 0)
+    if (read_product(file_id, schema_only, num_selected_variables, selected_variable_name, new_product) != 0)
     {
         harp_add_error_message(" (%s)", filename);
         harp_product_delete(new_product);
@@ -1375,6 +1433,17 @@ int harp_import_hdf5(const char *filename, harp_product **product)
     return 0;
 }
 
+int harp_import_hdf5(const char *filename, int num_variables, char **variable_name, harp_product **product)
+{
+    return import_hdf5(filename, 0, num_variables, variable_name, product);
+}
+
+/* Import only the structure of the product (variables, dimensions, and attributes); variable data is not read. */
+int harp_import_schema_hdf5(const char *filename, harp_product **product)
+{
+    return import_hdf5(filename, 1, 0, NULL, product);
+}
+
 int harp_import_metadata_hdf5(const char *filename, harp_product_metadata *metadata)
 {
     hdf5_dimension_ids dimension_ids = { {0}, {{0, 0}}, {0} };
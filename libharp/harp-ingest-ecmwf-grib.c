@@ -300,6 +300,8 @@ typedef struct ingest_info_struct
 
     int has_parameter[NUM_GRIB_PARAMETERS];
     long *grid_data_index;      /* [NUM_GRIB_PARAMETERS, num_levels] */
+
+    float *grid_buffer; /* [num_levels, num_longitudes], used for reading 3D grid data */
 } ingest_info;
 
 
@@ -934,20 +936,29 @@ static int read_2d_grid_data(ingest_info *info, grib_parameter parameter, long i
 
 static int read_3d_grid_data(ingest_info *info, grib_parameter parameter, long index, harp_array data)
 {
-    long dimension_transpose[2];
+    harp_array grid;
     long i;
 
     assert(info->has_parameter[parameter]);
 
-    dimension_transpose[0] = info->num_levels;
-    dimension_transpose[1] = info->num_longitudes;
+    if (info->grid_buffer == NULL)
+    {
+        info->grid_buffer = malloc(info->num_levels * info->num_longitudes * sizeof(float));
+        if (info->grid_buffer == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           info->num_levels * info->num_longitudes * sizeof(float), __FILE__, __LINE__);
+            return -1;
+        }
+    }
+    grid.float_data = info->grid_buffer;
 
     /* we read the data as [vertical,longitude] */
     for (i = 0; i < info->num_levels; i++)
     {
         harp_array subgrid;
 
-        subgrid.float_data = &data.float_data[i * info->num_longitudes];
+        subgrid.float_data = &grid.float_data[i * info->num_longitudes];
         /* invert the loop because level 0 = TOA */
         if (read_grid_data(info, info->grid_data_index[(parameter + 1) * info->num_levels - 1 - i], index, subgrid) !=
             0)
@@ -956,10 +967,7 @@ static int read_3d_grid_data(ingest_info *info, grib_parameter parameter, long i
         }
     }
     /* and then reorder dimensions from [vertical,longitude] to [longitude,vertical] */
-    if (harp_array_transpose(harp_type_float, 2, dimension_transpose, NULL, data) != 0)
-    {
-        return -1;
-    }
+    harp_array_transpose_2d(harp_type_float, info->num_levels, info->num_longitudes, grid, data);
 
     return 0;
 }
@@ -2798,6 +2806,10 @@ static void ingest_info_delete(ingest_info *info)
         {
             free(info->grid_data_index);
         }
+        if (info->grid_buffer != NULL)
+        {
+            free(info->grid_buffer);
+        }
         free(info);
     }
 }
@@ -2844,6 +2856,7 @@ static int ingest_info_new(coda_product *product, ingest_info **new_info)
     info->coordinate_values = NULL;
     info->num_wavelengths = 0;
     info->grid_data_index = NULL;
+    info->grid_buffer = NULL;
 
     for (i = 0; i < NUM_GRIB_PARAMETERS; i++)
     {
@@ -793,7 +793,7 @@ LIBHARP_API int harp_doc_export_ingestion_definitions(const char *path)
         return -1;
     }
 
-    if (harp_ingestion_init() != 0)
+    if (harp_ingestion_init_all_modules() != 0)
     {
         return -1;
     }
@@ -110,75 +110,87 @@ int harp_ingestion_module_tes_l2_init(void);
 /* Module initialization functions. */
 typedef int (module_init_func_t) (void);
 
-static module_init_func_t *module_init_func[] = {
-    harp_ingestion_module_ace_fts_l2_init,
-    harp_ingestion_module_aeolus_l1b_init,
-    harp_ingestion_module_aeolus_l2a_init,
-    harp_ingestion_module_aeolus_l2b_init,
-    harp_ingestion_module_calipso_l2_init,
-    harp_ingestion_module_cci_l2_aerosol_init,
-    harp_ingestion_module_cci_l2_ghg_init,
-    harp_ingestion_module_cci_l2_o3_lp_init,
-    harp_ingestion_module_cci_l2_o3_np_init,
-    harp_ingestion_module_cci_l2_o3_tc_init,
-    harp_ingestion_module_cci_l3_aerosol_init,
-    harp_ingestion_module_cci_l3_cloud_init,
-    harp_ingestion_module_cci_l3_ghg_init,
-    harp_ingestion_module_cci_l3_o3_lntoc_init,
-    harp_ingestion_module_cci_l3_o3_lp_init,
-    harp_ingestion_module_cci_l3_o3_np_init,
-    harp_ingestion_module_cci_l3_o3_tc_init,
-    harp_ingestion_module_cci_l3_o3_ttoc_init,
-    harp_ingestion_module_cci_l4_o3_np_init,
-    harp_ingestion_module_cloudnet_init,
-    harp_ingestion_module_earlinet_init,
-    harp_ingestion_module_earthcare_l2_init,
-    harp_ingestion_module_ecmwf_grib_init,
-    harp_ingestion_module_geoms_ftir_init,
-    harp_ingestion_module_geoms_mwr_init,
-    harp_ingestion_module_geoms_lidar_init,
-    harp_ingestion_module_geoms_pandora_init,
-    harp_ingestion_module_geoms_sonde_init,
-    harp_ingestion_module_geoms_tccon_init,
-    harp_ingestion_module_geoms_uvvis_brewer_init,
-    harp_ingestion_module_geoms_uvvis_doas_init,
-    harp_ingestion_module_geoms_uvvis_dobson_init,
-    harp_ingestion_module_gome_l1_init,
-    harp_ingestion_module_gome_l2_init,
-    harp_ingestion_module_gome2_l1_init,
-    harp_ingestion_module_gome2_l2_init,
-    harp_ingestion_module_gomos_l1_init,
-    harp_ingestion_module_gomos_l2_init,
-    harp_ingestion_module_gosat_fts_l1b_init,
-    harp_ingestion_module_gosat_fts_l2_init,
-    harp_ingestion_module_hirdls_l2_init,
-    harp_ingestion_module_iasi_l1_init,
-    harp_ingestion_module_iasi_l2_init,
-    harp_ingestion_module_mipas_l1_init,
-    harp_ingestion_module_mipas_l2_init,
-    harp_ingestion_module_mls_l2_init,
-    harp_ingestion_module_npp_suomi_crimss_l2_init,
-    harp_ingestion_module_npp_suomi_omps_profiles_l2_init,
-    harp_ingestion_module_npp_suomi_omps_totals_l2_init,
-    harp_ingestion_module_npp_suomi_viirs_l2_init,
-    harp_ingestion_module_oco_l3co2_init,
-    harp_ingestion_module_oco_ltco2_init,
-    harp_ingestion_module_oco_ltsif_init,
-    harp_ingestion_module_omi_l2_init,
-    harp_ingestion_module_omi_l3_init,
-    harp_ingestion_module_osiris_l2_init,
-    harp_ingestion_module_pal_s5p_l2_init,
-    harp_ingestion_module_qa4ecv_init,
-    harp_ingestion_module_sciamachy_l1_init,
-    harp_ingestion_module_sciamachy_l2_init,
-    harp_ingestion_module_s5p_l1b_init,
-    harp_ingestion_module_s5p_l2_init,
-    harp_ingestion_module_smr_l2_init,
-    harp_ingestion_module_temis_init,
-    harp_ingestion_module_tes_l2_init
+/* Each initialization function registers modules for a single product class. Modules are only initialized once a
+ * product of their product class is encountered (or when all modules are requested, e.g. for documentation).
+ */
+typedef struct module_init_entry_struct
+{
+    const char *product_class;
+    module_init_func_t *init;
+} module_init_entry;
+
+static module_init_entry module_init[] = {
+    {"ACE_FTS", harp_ingestion_module_ace_fts_l2_init},
+    {"AEOLUS", harp_ingestion_module_aeolus_l1b_init},
+    {"AEOLUS", harp_ingestion_module_aeolus_l2a_init},
+    {"AEOLUS", harp_ingestion_module_aeolus_l2b_init},
+    {"CALIPSO", harp_ingestion_module_calipso_l2_init},
+    {"ESACCI_AEROSOL", harp_ingestion_module_cci_l2_aerosol_init},
+    {"ESACCI_GHG", harp_ingestion_module_cci_l2_ghg_init},
+    {"ESACCI_OZONE", harp_ingestion_module_cci_l2_o3_lp_init},
+    {"ESACCI_OZONE", harp_ingestion_module_cci_l2_o3_np_init},
+    {"ESACCI_OZONE", harp_ingestion_module_cci_l2_o3_tc_init},
+    {"ESACCI_AEROSOL", harp_ingestion_module_cci_l3_aerosol_init},
+    {"ESACCI_CLOUD", harp_ingestion_module_cci_l3_cloud_init},
+    {"ESACCI_GHG", harp_ingestion_module_cci_l3_ghg_init},
+    {"ESACCI_OZONE", harp_ingestion_module_cci_l3_o3_lntoc_init},
+    {"ESACCI_OZONE", harp_ingestion_module_cci_l3_o3_lp_init},
+    {"ESACCI_OZONE", harp_ingestion_module_cci_l3_o3_np_init},
+    {"ESACCI_OZONE", harp_ingestion_module_cci_l3_o3_tc_init},
+    {"ESACCI_OZONE", harp_ingestion_module_cci_l3_o3_ttoc_init},
+    {"ESACCI_OZONE", harp_ingestion_module_cci_l4_o3_np_init},
+    {"CLOUDNET", harp_ingestion_module_cloudnet_init},
+    {"EARLINET", harp_ingestion_module_earlinet_init},
+    {"EARTHCARE", harp_ingestion_module_earthcare_l2_init},
+    {"ECMWF", harp_ingestion_module_ecmwf_grib_init},
+    {"GEOMS", harp_ingestion_module_geoms_ftir_init},
+    {"GEOMS", harp_ingestion_module_geoms_mwr_init},
+    {"GEOMS", harp_ingestion_module_geoms_lidar_init},
+    {"GEOMS", harp_ingestion_module_geoms_pandora_init},
+    {"GEOMS", harp_ingestion_module_geoms_sonde_init},
+    {"GEOMS", harp_ingestion_module_geoms_tccon_init},
+    {"GEOMS", harp_ingestion_module_geoms_uvvis_brewer_init},
+    {"GEOMS", harp_ingestion_module_geoms_uvvis_doas_init},
+    {"GEOMS", harp_ingestion_module_geoms_uvvis_dobson_init},
+    {"ERS_GOME", harp_ingestion_module_gome_l1_init},
+    {"ERS_GOME", harp_ingestion_module_gome_l2_init},
+    {"EPS", harp_ingestion_module_gome2_l1_init},
+    {"ACSAF", harp_ingestion_module_gome2_l2_init},
+    {"ENVISAT_GOMOS", harp_ingestion_module_gomos_l1_init},
+    {"ENVISAT_GOMOS", harp_ingestion_module_gomos_l2_init},
+    {"GOSAT", harp_ingestion_module_gosat_fts_l1b_init},
+    {"GOSAT", harp_ingestion_module_gosat_fts_l2_init},
+    {"AURA_HIRDLS", harp_ingestion_module_hirdls_l2_init},
+    {"EPS", harp_ingestion_module_iasi_l1_init},
+    {"EPS", harp_ingestion_module_iasi_l2_init},
+    {"ENVISAT_MIPAS", harp_ingestion_module_mipas_l1_init},
+    {"ENVISAT_MIPAS", harp_ingestion_module_mipas_l2_init},
+    {"AURA_MLS", harp_ingestion_module_mls_l2_init},
+    {"NPP_SUOMI", harp_ingestion_module_npp_suomi_crimss_l2_init},
+    {"NPP_SUOMI", harp_ingestion_module_npp_suomi_omps_profiles_l2_init},
+    {"NPP_SUOMI", harp_ingestion_module_npp_suomi_omps_totals_l2_init},
+    {"NPP_SUOMI", harp_ingestion_module_npp_suomi_viirs_l2_init},
+    {"OCO", harp_ingestion_module_oco_l3co2_init},
+    {"OCO", harp_ingestion_module_oco_ltco2_init},
+    {"OCO", harp_ingestion_module_oco_ltsif_init},
+    {"AURA_OMI", harp_ingestion_module_omi_l2_init},
+    {"AURA_OMI", harp_ingestion_module_omi_l3_init},
+    {"ODIN_OSIRIS", harp_ingestion_module_osiris_l2_init},
+    {"S5P_PAL", harp_ingestion_module_pal_s5p_l2_init},
+    {"QA4ECV", harp_ingestion_module_qa4ecv_init},
+    {"ENVISAT_SCIAMACHY", harp_ingestion_module_sciamachy_l1_init},
+    {"ENVISAT_SCIAMACHY", harp_ingestion_module_sciamachy_l2_init},
+    {"Sentinel5P", harp_ingestion_module_s5p_l1b_init},
+    {"Sentinel5P", harp_ingestion_module_s5p_l2_init},
+    {"ODIN_SMR", harp_ingestion_module_smr_l2_init},
+    {"TEMIS", harp_ingestion_module_temis_init},
+    {"AURA_TES", harp_ingestion_module_tes_l2_init}
 };
 
-#define NUM_INGESTION_MODULES ((long)(sizeof(module_init_func)/sizeof(module_init_func[0])))
+#define NUM_INGESTION_MODULES ((long)(sizeof(module_init)/sizeof(module_init[0])))
+
+/* Which entries of module_init[] have been initialized. */
+static uint8_t module_initialized[NUM_INGESTION_MODULES];
 
 /* Forward declarations. */
 static void ingestion_option_definition_delete(harp_ingestion_option_definition *ingestion_option_definition);
@@ -1199,6 +1211,58 @@ int harp_ingestion_module_validate_options(harp_ingestion_module *module, const
     return 0;
 }
 
+/* Initialize all modules for the given product class that have not been initialized yet.
+ * If product_class is NULL then all remaining modules will be initialized.
+ */
+static int init_modules(const char *product_class)
+{
+    int first_new_module = module_register->num_ingestion_modules;
+    long i;
+
+    for (i = 0; i < NUM_INGESTION_MODULES; i++)
+    {
+        if (module_initialized[i])
+        {
+            continue;
+        }
+        if (product_class != NULL && strcmp(module_init[i].product_class, product_class) != 0)
+        {
+            continue;
+        }
+        if (module_init[i].init() != 0)
+        {
+            return -1;
+        }
+        module_initialized[i] = 1;
+    }
+
+    /* Add the variable index {time} to all new product definitions of which at least one variable depends on the time
+     * dimension.
+     */
+    for (i = first_new_module; i < module_register->num_ingestion_modules; i++)
+    {
+        harp_ingestion_module *module = module_register->ingestion_module[i];
+        int j;
+
+        assert(product_class == NULL || strcmp(module->product_class, product_class) == 0);
+
+        for (j = 0; j < module->num_product_definitions; j++)
+        {
+            harp_product_definition *product_definition = module->product_definition[j];
+
+            if (harp_product_definition_has_dimension_type(product_definition, harp_dimension_time))
+            {
+                harp_dimension_type dimension_type[1] = { harp_dimension_time };
+                harp_ingestion_register_variable_block_read(product_definition, "index", harp_type_int32, 1,
+                                                            dimension_type, NULL, "zero-based index of the sample "
+                                                            "within the source product", NULL, NULL, read_index);
+            }
+        }
+    }
+
+    return 0;
+}
+
 int harp_ingestion_find_module(const char *filename, harp_ingestion_module **module, coda_product **cproduct)
 {
     coda_product *product;
@@ -1242,6 +1306,13 @@ int harp_ingestion_find_module(const char *filename, harp_ingestion_module **mod
         /* Look for a compatible ingestion module by comparing product_class and product_type. */
         if (product_class != NULL && product_type != NULL)
         {
+            /* make sure the modules for this product class are available */
+            if (init_modules(product_class) != 0)
+            {
+                coda_close(product);
+                return -1;
+            }
+
             for (i = 0; i < module_register->num_ingestion_modules; i++)
             {
                 harp_ingestion_module *ingestion_module;
@@ -1288,10 +1359,12 @@ int harp_ingestion_find_module(const char *filename, harp_ingestion_module **mod
     return -1;
 }
 
+/* Initialize the ingestion module register.
+ * Ingestion modules themselves are initialized on demand by harp_ingestion_find_module() (only the modules for the
+ * product class of the product). Use harp_ingestion_init_all_modules() if all modules are needed.
+ */
 int harp_ingestion_init(void)
 {
-    int i;
-
     if (module_register != NULL)
     {
         /* Already initialized. */
@@ -1313,6 +1386,7 @@ int harp_ingestion_init(void)
     }
     module_register->num_ingestion_modules = 0;
     module_register->ingestion_module = NULL;
+    memset(module_initialized, 0, sizeof(module_initialized));
 
     /* Make sure that udunits gets initialized as well (so we can use asserts later on) */
     if (!harp_unit_is_valid(""))
@@ -1320,37 +1394,18 @@ int harp_ingestion_init(void)
         return -1;
     }
 
-    for (i = 0; i < NUM_INGESTION_MODULES; i++)
-    {
-        if (module_init_func[i] () != 0)
-        {
-            return -1;
-        }
-    }
+    return 0;
+}
 
-    /* Add the variable index {time} to all product definitions of which at least one variable depends on the time
-     * dimension.
-     */
-    for (i = 0; i < module_register->num_ingestion_modules; i++)
+/* Initialize the ingestion module register including all ingestion modules (e.g. for generating documentation). */
+int harp_ingestion_init_all_modules(void)
+{
+    if (harp_ingestion_init() != 0)
     {
-        harp_ingestion_module *module = module_register->ingestion_module[i];
-        int j;
-
-        for (j = 0; j < module->num_product_definitions; j++)
-        {
-            harp_product_definition *product_definition = module->product_definition[j];
-
-            if (harp_product_definition_has_dimension_type(product_definition, harp_dimension_time))
-            {
-                harp_dimension_type dimension_type[1] = { harp_dimension_time };
-                harp_ingestion_register_variable_block_read(product_definition, "index", harp_type_int32, 1,
-                                                            dimension_type, NULL, "zero-based index of the sample "
-                                                            "within the source product", NULL, NULL, read_index);
-            }
-        }
+        return -1;
     }
 
-    return 0;
+    return init_modules(NULL);
 }
 
 void harp_ingestion_done(void)
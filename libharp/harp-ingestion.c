@@ -41,9 +41,15 @@
 #include "harp-program.h"
 
 #include <assert.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 typedef struct read_buffer_struct
 {
@@ -68,6 +74,7 @@ typedef struct ingest_info_struct
 
     const char *basename;       /* product basename */
     harp_product *product;      /* resulting HARP product */
+    int schema_only;    /* only create the variables without reading any data */
 
     read_buffer *block_buffer;  /* buffer used for storing results from 'read_all' and 'read_range' */
     int (*block_buffer_read_all)(void *user_data, harp_array data);     /* 'read_all' that was used to fill buffer */
@@ -225,6 +232,7 @@ static int ingestion_init(ingest_info **new_info)
     info->variable_mask = NULL;
     info->basename = NULL;
     info->product = NULL;
+    info->schema_only = 0;
     info->block_buffer = NULL;
     info->block_buffer_read_all = NULL;
 
@@ -437,6 +445,45 @@ static int read_block(ingest_info *info, const harp_variable_definition *variabl
     return 0;
 }
 
+static int copy_variable_attributes(const harp_variable_definition *variable_def, harp_variable *variable)
+{
+    if (variable_def->description != NULL)
+    {
+        variable->description = strdup(variable_def->description);
+        if (variable->description == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not duplicate string) (%s:%u)", __FILE__,
+                           __LINE__);
+            return -1;
+        }
+    }
+
+    if (variable_def->unit != NULL)
+    {
+        variable->unit = strdup(variable_def->unit);
+        if (variable->unit == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not duplicate string) (%s:%u)", __FILE__,
+                           __LINE__);
+            return -1;
+        }
+    }
+
+    variable->valid_min = variable_def->valid_min;
+    variable->valid_max = variable_def->valid_max;
+
+    if (variable_def->num_enum_values > 0)
+    {
+        if (harp_variable_set_enumeration_values(variable, variable_def->num_enum_values,
+                                                 (const char **)variable_def->enum_name) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 static int get_variable(ingest_info *info, const harp_variable_definition *variable_def,
                         const harp_dimension_mask_set *dimension_mask_set, harp_variable **new_variable)
 {
@@ -515,8 +562,9 @@ static int get_variable(ingest_info *info, const harp_variable_definition *varia
          * the variable is expanded by adding the time dimension */
         if (has_2D_masks && variable_def->dimension_type[0] != harp_dimension_time)
         {
-            const uint8_t *mask[HARP_MAX_NUM_DIMS];
-            long mask_stride[HARP_MAX_NUM_DIMS - 1];
+            const uint64_t *mask[HARP_MAX_NUM_DIMS];
+            const uint64_t *row_mask[HARP_MAX_NUM_DIMS];
+            long mask_stride[HARP_MAX_NUM_DIMS];
             read_buffer *buffer;
             harp_array block;
             long num_buffer_elements;
@@ -577,7 +625,7 @@ static int get_variable(ingest_info *info, const harp_variable_definition *varia
                     mask[i] = dimension_mask[i]->mask;
                     if (dimension_mask[i]->num_dimensions == 2)
                     {
-                        mask_stride[i] = dimension_mask[i]->dimension[1];
+                        mask_stride[i] = dimension_mask[i]->row_num_words;
                     }
                     else
                     {
@@ -591,23 +639,21 @@ static int get_variable(ingest_info *info, const harp_variable_definition *varia
             block_stride = harp_get_size_for_type(variable->data_type) * (variable->num_elements /
                                                                           variable->dimension[0]);
 
-            for (i = 0; i < dimension[0]; i++)
+            /* only visit the time samples that are kept, skipping masked out parts of the time mask word-wise */
+            i = (mask[0] == NULL ? 0 : harp_mask_find_next_set(dimension[0], mask[0], 0));
+            while (i < dimension[0])
             {
-                if (dimension_mask[0] == NULL || dimension_mask[0]->mask[i])
+                for (j = 1; j < num_dimensions; j++)
                 {
-                    harp_array_filter(variable->data_type, num_dimensions - 1, &dimension[1], &mask[1], buffer->data,
-                                      &masked_dimension[1], block);
-
-                    block.ptr = (void *)(((char *)block.ptr) + block_stride);
+                    row_mask[j] = (mask[j] == NULL ? NULL : mask[j] + i * mask_stride[j]);
                 }
 
-                for (j = 1; j < variable->num_dimensions; j++)
-                {
-                    if (mask[j] != NULL)
-                    {
-                        mask[j] += mask_stride[j];
-                    }
-                }
+                harp_array_filter(variable->data_type, num_dimensions - 1, &dimension[1], &row_mask[1], buffer->data,
+                                  &masked_dimension[1], block);
+
+                block.ptr = (void *)(((char *)block.ptr) + block_stride);
+
+                i = (mask[0] == NULL ? i + 1 : harp_mask_find_next_set(dimension[0], mask[0], i + 1));
             }
 
             read_buffer_delete(buffer);
@@ -632,8 +678,9 @@ static int get_variable(ingest_info *info, const harp_variable_definition *varia
 
                 if (has_secondary_masks)
                 {
-                    const uint8_t *mask[HARP_MAX_NUM_DIMS];
-                    long mask_stride[HARP_MAX_NUM_DIMS - 1];
+                    const uint64_t *mask[HARP_MAX_NUM_DIMS];
+                    const uint64_t *row_mask[HARP_MAX_NUM_DIMS];
+                    long mask_stride[HARP_MAX_NUM_DIMS];
                     long num_buffer_elements;
                     read_buffer *buffer;
 
@@ -656,7 +703,7 @@ static int get_variable(ingest_info *info, const harp_variable_definition *varia
                             if (dimension_mask[i]->num_dimensions == 2)
                             {
                                 assert(i != 0);
-                                mask_stride[i] = dimension_mask[i]->dimension[1];
+                                mask_stride[i] = dimension_mask[i]->row_num_words;
                             }
                             else
                             {
@@ -666,31 +713,28 @@ static int get_variable(ingest_info *info, const harp_variable_definition *varia
                         }
                     }
 
-                    for (i = 0; i < dimension[0]; i++)
+                    i = (mask[0] == NULL ? 0 : harp_mask_find_next_set(dimension[0], mask[0], 0));
+                    while (i < dimension[0])
                     {
-                        if (mask[0] == NULL || mask[0][i])
+                        if (read_block(info, variable_def, i, buffer->data) != 0)
                         {
-                            if (read_block(info, variable_def, i, buffer->data) != 0)
-                            {
-                                read_buffer_delete(buffer);
-                                harp_variable_delete(variable);
-                                return -1;
-                            }
-
-                            harp_array_filter(variable->data_type, variable_def->num_dimensions - 1, &dimension[1],
-                                              &mask[1], buffer->data, &masked_dimension[1], block);
-                            read_buffer_free_string_data(buffer);
-
-                            block.ptr = (void *)(((char *)block.ptr) + block_stride);
+                            read_buffer_delete(buffer);
+                            harp_variable_delete(variable);
+                            return -1;
                         }
 
                         for (j = 1; j < variable->num_dimensions; j++)
                         {
-                            if (mask[j] != NULL)
-                            {
-                                mask[j] += mask_stride[j];
-                            }
+                            row_mask[j] = (mask[j] == NULL ? NULL : mask[j] + i * mask_stride[j]);
                         }
+
+                        harp_array_filter(variable->data_type, variable_def->num_dimensions - 1, &dimension[1],
+                                          &row_mask[1], buffer->data, &masked_dimension[1], block);
+                        read_buffer_free_string_data(buffer);
+
+                        block.ptr = (void *)(((char *)block.ptr) + block_stride);
+
+                        i = (mask[0] == NULL ? i + 1 : harp_mask_find_next_set(dimension[0], mask[0], i + 1));
                     }
 
                     read_buffer_delete(buffer);
@@ -699,12 +743,9 @@ static int get_variable(ingest_info *info, const harp_variable_definition *varia
                 {
                     /* we can read directly into the variable */
                     assert(dimension_mask[0] != NULL);
-                    for (i = 0; i < dimension[0]; i++)
+                    for (i = harp_mask_find_next_set(dimension[0], dimension_mask[0]->mask, 0); i < dimension[0];
+                         i = harp_mask_find_next_set(dimension[0], dimension_mask[0]->mask, i + 1))
                     {
-                        if (!dimension_mask[0]->mask[i])
-                        {
-                            continue;
-                        }
                         if (read_block(info, variable_def, i, block) != 0)
                         {
                             harp_variable_delete(variable);
@@ -725,42 +766,53 @@ static int get_variable(ingest_info *info, const harp_variable_definition *varia
         }
     }
 
-    /* copy variable attributes */
-    if (variable_def->description != NULL)
+    if (copy_variable_attributes(variable_def, variable) != 0)
     {
-        variable->description = strdup(variable_def->description);
-        if (variable->description == NULL)
-        {
-            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not duplicate string) (%s:%u)", __FILE__,
-                           __LINE__);
-            harp_variable_delete(variable);
-            return -1;
-        }
+        harp_variable_delete(variable);
+        return -1;
     }
 
-    if (variable_def->unit != NULL)
+    *new_variable = variable;
+    return 0;
+}
+
+/* create a variable with the type, dimensions, and attributes of the variable definition without reading any data */
+static int get_variable_schema(ingest_info *info, const harp_variable_definition *variable_def,
+                               harp_variable **new_variable)
+{
+    harp_variable *variable;
+    long dimension[HARP_MAX_NUM_DIMS];
+    int i;
+
+    if (!harp_variable_definition_include(variable_def, info->user_data))
     {
-        variable->unit = strdup(variable_def->unit);
-        if (variable->unit == NULL)
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "cannot read variable '%s' (variable unavailable)",
+                       variable_def->name);
+        return -1;
+    }
+
+    for (i = 0; i < variable_def->num_dimensions; i++)
+    {
+        if (variable_def->dimension_type[i] == harp_dimension_independent)
         {
-            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not duplicate string) (%s:%u)", __FILE__,
-                           __LINE__);
-            harp_variable_delete(variable);
-            return -1;
+            dimension[i] = variable_def->dimension[i];
+        }
+        else
+        {
+            dimension[i] = info->dimension[variable_def->dimension_type[i]];
         }
     }
 
-    variable->valid_min = variable_def->valid_min;
-    variable->valid_max = variable_def->valid_max;
+    if (harp_variable_new_without_data(variable_def->name, variable_def->data_type, variable_def->num_dimensions,
+                                       variable_def->dimension_type, dimension, &variable) != 0)
+    {
+        return -1;
+    }
 
-    if (variable_def->num_enum_values > 0)
+    if (copy_variable_attributes(variable_def, variable) != 0)
     {
-        if (harp_variable_set_enumeration_values(variable, variable_def->num_enum_values,
-                                                 (const char **)variable_def->enum_name) != 0)
-        {
-            harp_variable_delete(variable);
-            return -1;
-        }
+        harp_variable_delete(variable);
+        return -1;
     }
 
     *new_variable = variable;
@@ -786,6 +838,22 @@ static int find_variable_definition(ingest_info *info, const char *name, harp_va
     return 0;
 }
 
+/* variable lookup function for harp_program_optimize() */
+static int lookup_variable_definition(void *user_data, const char *name, int *num_dimensions,
+                                      harp_dimension_type *dimension_type)
+{
+    harp_variable_definition *variable_def;
+
+    if (find_variable_definition((ingest_info *)user_data, name, &variable_def) != 0)
+    {
+        return 0;
+    }
+    *num_dimensions = variable_def->num_dimensions;
+    memcpy(dimension_type, variable_def->dimension_type, variable_def->num_dimensions * sizeof(harp_dimension_type));
+
+    return 1;
+}
+
 static int init_product_dimensions(ingest_info *info)
 {
     memset(info->dimension, 0, HARP_NUM_DIM_TYPES * sizeof(long));
@@ -885,8 +953,7 @@ static int execute_value_filter(ingest_info *info, harp_program *program)
     read_buffer *buffer;
     const char *variable_name;
     int num_operations = 1;
-    int data_type_size;
-    long i, j;
+    long i;
     int k;
 
     if (info->product_mask == 0)
@@ -905,7 +972,6 @@ static int execute_value_filter(ingest_info *info, harp_program *program)
         harp_set_error(HARP_ERROR_OPERATION, "cannot filter on non-existent variable %s", variable_name);
         return -1;
     }
-    data_type_size = harp_get_size_for_type(variable_def->data_type);
 
     /* if the next operations are also value filters on the same variable then include them */
     while (program->current_index + num_operations < program->num_operations)
@@ -935,12 +1001,10 @@ static int execute_value_filter(ingest_info *info, harp_program *program)
         {
             return -1;
         }
-        if (variable_def->unit != NULL)
+        if (harp_operation_compile_value_filter(program->operation[program->current_index + k], variable_def->unit)
+            != 0)
         {
-            if (harp_operation_set_value_unit(program->operation[program->current_index + k], variable_def->unit) != 0)
-            {
-                return -1;
-            }
+            return -1;
         }
     }
 
@@ -1013,7 +1077,7 @@ static int execute_value_filter(ingest_info *info, harp_program *program)
             }
         }
 
-        if (read_buffer_new(variable_def->data_type, 1, &buffer) != 0)
+        if (read_buffer_new(variable_def->data_type, info->dimension[dimension_type], &buffer) != 0)
         {
             if (info->dimension_mask_set[dimension_type]->num_dimensions == 2)
             {
@@ -1022,61 +1086,44 @@ static int execute_value_filter(ingest_info *info, harp_program *program)
             return -1;
         }
 
-        for (i = 0; i < info->dimension[dimension_type]; i++)
+        /* only read the elements that are still included (each element is stored at its own position in the buffer)
+         * and then evaluate the compiled filters for the whole dimension at once
+         */
+        for (i = harp_mask_find_next_set(info->dimension[dimension_type], dimension_mask->mask, 0);
+             i < info->dimension[dimension_type];
+             i = harp_mask_find_next_set(info->dimension[dimension_type], dimension_mask->mask, i + 1))
         {
-            if (dimension_mask->mask[i])
+            harp_array element;
+
+            element.ptr = &buffer->data.int8_data[i * harp_get_size_for_type(variable_def->data_type)];
+            if (read_block(info, variable_def, i, element) != 0)
             {
-                if (read_block(info, variable_def, i, buffer->data) != 0)
+                if (info->dimension_mask_set[dimension_type]->num_dimensions == 2)
                 {
-                    if (info->dimension_mask_set[dimension_type]->num_dimensions == 2)
-                    {
-                        harp_dimension_mask_delete(dimension_mask);
-                    }
-                    read_buffer_delete(buffer);
-                    return -1;
+                    harp_dimension_mask_delete(dimension_mask);
                 }
+                read_buffer_delete(buffer);
+                return -1;
+            }
+        }
 
-                for (k = 0; k < num_operations; k++)
-                {
-                    if (dimension_mask->mask[i])
-                    {
-                        int result;
-
-                        if (harp_operation_is_string_value_filter(program->operation[program->current_index + k]))
-                        {
-                            harp_operation_string_value_filter *operation;
-
-                            operation =
-                                (harp_operation_string_value_filter *)program->operation[program->current_index + k];
-                            result = operation->eval(operation, variable_def->num_enum_values, variable_def->enum_name,
-                                                     variable_def->data_type, buffer->data.int8_data);
-                        }
-                        else
-                        {
-                            harp_operation_numeric_value_filter *operation;
-
-                            operation =
-                                (harp_operation_numeric_value_filter *)program->operation[program->current_index + k];
-                            result = operation->eval(operation, variable_def->data_type, buffer->data.int8_data);
-                        }
-                        if (result < 0)
-                        {
-                            if (info->dimension_mask_set[dimension_type]->num_dimensions == 2)
-                            {
-                                harp_dimension_mask_delete(dimension_mask);
-                            }
-                            read_buffer_delete(buffer);
-                            return -1;
-                        }
-                        dimension_mask->mask[i] = result;
-                    }
-                }
-                if (!dimension_mask->mask[i])
+        for (k = 0; k < num_operations; k++)
+        {
+            if (harp_operation_eval_value_filter(program->operation[program->current_index + k],
+                                                 variable_def->num_enum_values, variable_def->enum_name,
+                                                 variable_def->data_type, info->dimension[dimension_type],
+                                                 buffer->data.ptr, dimension_mask->mask) != 0)
+            {
+                if (info->dimension_mask_set[dimension_type]->num_dimensions == 2)
                 {
-                    dimension_mask->masked_dimension_length--;
+                    harp_dimension_mask_delete(dimension_mask);
                 }
+                read_buffer_delete(buffer);
+                return -1;
             }
         }
+        dimension_mask->masked_dimension_length = harp_mask_count(info->dimension[dimension_type],
+                                                                  dimension_mask->mask);
 
         read_buffer_delete(buffer);
 
@@ -1098,7 +1145,6 @@ static int execute_value_filter(ingest_info *info, harp_program *program)
         harp_dimension_type dimension_type;
         harp_dimension_mask *time_mask;
         harp_dimension_mask *dimension_mask;
-        long index = 0;
 
         dimension_type = variable_def->dimension_type[1];
 
@@ -1142,77 +1188,42 @@ static int execute_value_filter(ingest_info *info, harp_program *program)
         }
 
         dimension_mask->masked_dimension_length = 0;
-        for (i = 0; i < info->dimension[harp_dimension_time]; i++)
+        for (i = harp_mask_find_next_set(info->dimension[harp_dimension_time], time_mask->mask, 0);
+             i < info->dimension[harp_dimension_time];
+             i = harp_mask_find_next_set(info->dimension[harp_dimension_time], time_mask->mask, i + 1))
         {
-            if (time_mask->mask[i])
+            uint64_t *row_mask = harp_dimension_mask_get_row(dimension_mask, i);
+            long new_dimension_length;
+
+            if (read_block(info, variable_def, i, buffer->data) != 0)
             {
-                long new_dimension_length = 0;
+                read_buffer_delete(buffer);
+                return -1;
+            }
 
-                if (read_block(info, variable_def, i, buffer->data) != 0)
+            for (k = 0; k < num_operations; k++)
+            {
+                if (harp_operation_eval_value_filter(program->operation[program->current_index + k],
+                                                     variable_def->num_enum_values, variable_def->enum_name,
+                                                     variable_def->data_type, info->dimension[dimension_type],
+                                                     buffer->data.ptr, row_mask) != 0)
                 {
                     read_buffer_delete(buffer);
                     return -1;
                 }
+            }
 
-                for (j = 0; j < info->dimension[dimension_type]; j++)
-                {
-                    if (dimension_mask->mask[index])
-                    {
-                        for (k = 0; k < num_operations; k++)
-                        {
-                            if (dimension_mask->mask[index])
-                            {
-                                harp_operation *operation = program->operation[program->current_index + k];
-                                int result;
-
-                                if (harp_operation_is_string_value_filter(operation))
-                                {
-                                    harp_operation_string_value_filter *string_operation;
-
-                                    string_operation = (harp_operation_string_value_filter *)operation;
-                                    result = string_operation->eval(string_operation, variable_def->num_enum_values,
-                                                                    variable_def->enum_name, variable_def->data_type,
-                                                                    &buffer->data.int8_data[j * data_type_size]);
-                                }
-                                else
-                                {
-                                    harp_operation_numeric_value_filter *numeric_operation;
-
-                                    numeric_operation = (harp_operation_numeric_value_filter *)operation;
-                                    result = numeric_operation->eval(numeric_operation, variable_def->data_type,
-                                                                     &buffer->data.int8_data[j * data_type_size]);
-                                }
-                                if (result < 0)
-                                {
-                                    read_buffer_delete(buffer);
-                                    return -1;
-                                }
-                                dimension_mask->mask[index] = result;
-                            }
-                        }
-                        if (dimension_mask->mask[index])
-                        {
-                            new_dimension_length++;
-                        }
-                    }
-                    index++;
-                }
-
-                read_buffer_free_string_data(buffer);
+            read_buffer_free_string_data(buffer);
 
-                if (new_dimension_length == 0)
-                {
-                    time_mask->mask[i] = 0;
-                    time_mask->masked_dimension_length--;
-                }
-                else if (new_dimension_length > dimension_mask->masked_dimension_length)
-                {
-                    dimension_mask->masked_dimension_length = new_dimension_length;
-                }
+            new_dimension_length = harp_mask_count(info->dimension[dimension_type], row_mask);
+            if (new_dimension_length == 0)
+            {
+                HARP_MASK_CLEAR(time_mask->mask, i);
+                time_mask->masked_dimension_length--;
             }
-            else
+            else if (new_dimension_length > dimension_mask->masked_dimension_length)
             {
-                index += info->dimension[dimension_type];
+                dimension_mask->masked_dimension_length = new_dimension_length;
             }
         }
 
@@ -1268,7 +1279,7 @@ static int execute_index_filter(ingest_info *info, harp_program *program)
     index = 0;
     for (i = 0; i < dimension; i++)
     {
-        if (dimension_mask->mask[i])
+        if (HARP_MASK_GET(dimension_mask->mask, i))
         {
             int result;
 
@@ -1277,9 +1288,9 @@ static int execute_index_filter(ingest_info *info, harp_program *program)
             {
                 return -1;
             }
-            dimension_mask->mask[i] = result;
-            if (!dimension_mask->mask[i])
+            if (!result)
             {
+                HARP_MASK_CLEAR(dimension_mask->mask, i);
                 dimension_mask->masked_dimension_length--;
             }
             index++;
@@ -1300,7 +1311,7 @@ static int execute_point_filter(ingest_info *info, harp_program *program)
     harp_variable_definition *longitude_def;
     harp_variable *latitude;
     harp_variable *longitude;
-    uint8_t *mask;
+    uint64_t *mask;
     int num_operations = 1;
     long num_points;
     long i;
@@ -1402,7 +1413,7 @@ static int execute_point_filter(ingest_info *info, harp_program *program)
 
     for (i = 0; i < num_points; i++)
     {
-        if (mask[i])
+        if (HARP_MASK_GET(mask, i))
         {
             harp_spherical_point point;
 
@@ -1413,7 +1424,7 @@ static int execute_point_filter(ingest_info *info, harp_program *program)
 
             for (k = 0; k < num_operations; k++)
             {
-                if (mask[i])
+                if (HARP_MASK_GET(mask, i))
                 {
                     harp_operation_point_filter *operation;
                     int result;
@@ -1426,13 +1437,13 @@ static int execute_point_filter(ingest_info *info, harp_program *program)
                         harp_variable_delete(longitude);
                         return -1;
                     }
-                    mask[i] = result;
+                    if (!result)
+                    {
+                        HARP_MASK_CLEAR(mask, i);
+                        info->dimension_mask_set[harp_dimension_time]->masked_dimension_length--;
+                    }
                 }
             }
-            if (!mask[i])
-            {
-                info->dimension_mask_set[harp_dimension_time]->masked_dimension_length--;
-            }
         }
     }
 
@@ -1456,7 +1467,7 @@ static int execute_polygon_filter(ingest_info *info, harp_program *program)
     harp_variable_definition *longitude_bounds_def;
     harp_variable *latitude_bounds;
     harp_variable *longitude_bounds;
-    uint8_t *mask;
+    uint64_t *mask;
     int num_operations = 1;
     long num_areas;
     long num_points;
@@ -1580,7 +1591,7 @@ static int execute_polygon_filter(ingest_info *info, harp_program *program)
 
     for (i = 0; i < num_areas; i++)
     {
-        if (mask[i])
+        if (HARP_MASK_GET(mask, i))
         {
             harp_spherical_polygon *area;
 
@@ -1599,7 +1610,7 @@ static int execute_polygon_filter(ingest_info *info, harp_program *program)
             {
                 for (k = 0; k < num_operations; k++)
                 {
-                    if (mask[i])
+                    if (HARP_MASK_GET(mask, i))
                     {
                         harp_operation_polygon_filter *operation;
                         int result;
@@ -1613,13 +1624,13 @@ static int execute_polygon_filter(ingest_info *info, harp_program *program)
                             harp_spherical_polygon_delete(area);
                             return -1;
                         }
-                        mask[i] = result;
+                        if (!result)
+                        {
+                            HARP_MASK_CLEAR(mask, i);
+                            info->dimension_mask_set[harp_dimension_time]->masked_dimension_length--;
+                        }
                     }
                 }
-                if (!mask[i])
-                {
-                    info->dimension_mask_set[harp_dimension_time]->masked_dimension_length--;
-                }
             }
             harp_spherical_polygon_delete(area);
         }
@@ -1705,6 +1716,53 @@ static int execute_keep_variable(ingest_info *info, harp_operation_keep_variable
     return 0;
 }
 
+/* total number of elements of all variables that would be ingested given the current variable and dimension masks
+ * (used for profiling) */
+static long get_num_elements(ingest_info *info)
+{
+    long num_elements = 0;
+    int i;
+
+    if (info->product_mask == 0)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < info->product_definition->num_variable_definitions; i++)
+    {
+        const harp_variable_definition *variable_def;
+        long variable_num_elements = 1;
+        int j;
+
+        if (!info->variable_mask[i])
+        {
+            continue;
+        }
+
+        variable_def = info->product_definition->variable_definition[i];
+        for (j = 0; j < variable_def->num_dimensions; j++)
+        {
+            harp_dimension_type dimension_type = variable_def->dimension_type[j];
+
+            if (dimension_type == harp_dimension_independent)
+            {
+                variable_num_elements *= variable_def->dimension[j];
+            }
+            else if (info->dimension_mask_set[dimension_type] != NULL)
+            {
+                variable_num_elements *= info->dimension_mask_set[dimension_type]->masked_dimension_length;
+            }
+            else
+            {
+                variable_num_elements *= info->dimension[dimension_type];
+            }
+        }
+        num_elements += variable_num_elements;
+    }
+
+    return num_elements;
+}
+
 /* Perform performance optimized execution of filtering operations during ingestion.
  * This only performs the filters/includes/excludes that can be executed during the ingest.
  */
@@ -1713,6 +1771,12 @@ static int evaluate_ingestion_mask(ingest_info *info, harp_program *program)
     while (program->current_index < program->num_operations)
     {
         harp_operation *operation = program->operation[program->current_index];
+        harp_profile_mark profile_mark;
+
+        if (harp_option_profiling)
+        {
+            harp_profile_start(program, get_num_elements(info), &profile_mark);
+        }
 
         /* note that some consecutive filter operations can be executed together for optimization purposes */
         /* so the filter functions below may increase program->current_index itself */
@@ -1764,6 +1828,13 @@ static int evaluate_ingestion_mask(ingest_info *info, harp_program *program)
                 {
                     return -1;
                 }
+                if (harp_option_profiling)
+                {
+                    if (harp_profile_stop(&profile_mark, program, 1, get_num_elements(info)) != 0)
+                    {
+                        return -1;
+                    }
+                }
                 /* we only performed the prefilter phase, so don't increase the current_index and just stop here */
                 /* the remaining program will be executed on the in-memory product */
                 return 0;
@@ -1803,6 +1874,14 @@ static int evaluate_ingestion_mask(ingest_info *info, harp_program *program)
                 return 0;
         }
 
+        if (harp_option_profiling)
+        {
+            if (harp_profile_stop(&profile_mark, program, 1, get_num_elements(info)) != 0)
+            {
+                return -1;
+            }
+        }
+
         program->current_index++;
 
         if (info->product_mask == 0)
@@ -1856,6 +1935,11 @@ static int get_product(ingest_info *info, harp_program *program)
         return 0;
     }
 
+    if (harp_program_optimize(program, lookup_variable_definition, info) != 0)
+    {
+        return -1;
+    }
+
     if (evaluate_ingestion_mask(info, program))
     {
         return -1;
@@ -1876,8 +1960,15 @@ static int get_product(ingest_info *info, harp_program *program)
             continue;
         }
 
-        if (get_variable(info, info->product_definition->variable_definition[i], info->dimension_mask_set,
-                         &variable) != 0)
+        if (info->schema_only)
+        {
+            if (get_variable_schema(info, info->product_definition->variable_definition[i], &variable) != 0)
+            {
+                return -1;
+            }
+        }
+        else if (get_variable(info, info->product_definition->variable_definition[i], info->dimension_mask_set,
+                              &variable) != 0)
         {
             return -1;
         }
@@ -1889,8 +1980,8 @@ static int get_product(ingest_info *info, harp_program *program)
         }
     }
 
-    /* verify ingested product */
-    if (harp_product_verify(info->product) != 0)
+    /* verify ingested product (a schema-only product has no data to verify) */
+    if (!info->schema_only && harp_product_verify(info->product) != 0)
     {
         return -1;
     }
@@ -1905,7 +1996,7 @@ static int get_product(ingest_info *info, harp_program *program)
 }
 
 static int ingest(const char *filename, harp_program *program, const harp_ingestion_options *option_list,
-                  harp_product **product)
+                  int schema_only, harp_product **product)
 {
     ingest_info *info;
 
@@ -1932,6 +2023,7 @@ static int ingest(const char *filename, harp_program *program, const harp_ingest
     assert(info->product_definition != NULL);
 
     info->basename = harp_basename(filename);
+    info->schema_only = schema_only;
 
     /* ingest the product */
     if (get_product(info, program) != 0)
@@ -1948,7 +2040,8 @@ static int ingest(const char *filename, harp_program *program, const harp_ingest
     return 0;
 }
 
-int harp_ingest(const char *filename, const char *operations, const char *options, harp_product **product)
+static int ingest_product(const char *filename, const char *operations, const char *options, int schema_only,
+                          harp_product **product)
 {
     harp_program *program;
     harp_ingestion_options *option_list;
@@ -1988,11 +2081,19 @@ int harp_ingest(const char *filename, const char *operations, const char *option
         }
     }
 
-    if (options == NULL)
+    if (schema_only && !harp_program_is_schema_only(program))
     {
-        if (harp_ingestion_options_new(&option_list) != 0)
-        {
-            harp_program_delete(program);
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "operations can not be applied without reading variable data "
+                       "(%s:%u)", __FILE__, __LINE__);
+        harp_program_delete(program);
+        return -1;
+    }
+
+    if (options == NULL)
+    {
+        if (harp_ingestion_options_new(&option_list) != 0)
+        {
+            harp_program_delete(program);
             return -1;
         }
     }
@@ -2014,7 +2115,7 @@ int harp_ingest(const char *filename, const char *operations, const char *option
     perform_boundary_checks = coda_get_option_perform_boundary_checks();
     coda_set_option_perform_boundary_checks(0);
 
-    status = ingest(filename, program, option_list, product);
+    status = ingest(filename, program, option_list, schema_only, product);
 
     /* set the libcoda options back to their original values */
     coda_set_option_perform_boundary_checks(perform_boundary_checks);
@@ -2025,6 +2126,20 @@ int harp_ingest(const char *filename, const char *operations, const char *option
     return status;
 }
 
+int harp_ingest(const char *filename, const char *operations, const char *options, harp_product **product)
+{
+    return ingest_product(filename, operations, options, 0, product);
+}
+
+/* Ingest only the structure of the product: the resulting variables have all their attributes and dimensions set, but
+ * no data (data.ptr is NULL). Only operations that do not depend on variable data are allowed (see
+ * harp_program_is_schema_only()).
+ */
+int harp_ingest_schema(const char *filename, const char *operations, const char *options, harp_product **product)
+{
+    return ingest_product(filename, operations, options, 1, product);
+}
+
 static int ingest_metadata(const char *filename, const harp_ingestion_options *option_list,
                            harp_product_metadata *metadata)
 {
@@ -2214,17 +2329,476 @@ int harp_ingest_metadata(const char *filename, const char *options, harp_product
     return 0;
 }
 
-/** returns:
+/* Test the ingestion for the combination of ingestion options in option_list (option_choice contains the index of the
+ * chosen value for each option or -1 if the option is not set).
+ * returns:
+ * -1 = initialization problem, harp_errno will be set
+ * 0 = no problems
+ * 1 = product ingestion resulted in an error, error is already printed
+ */
+static int ingest_test_options(const char *filename, harp_ingestion_module *module, coda_product *product,
+                               harp_program *program, const harp_ingestion_options *option_list,
+                               const int *option_choice, int definitions_only, int (*print)(const char *, ...))
+{
+    ingest_info *info;
+    int result = 0;
+    int status;
+    int i;
+
+    if (ingestion_init(&info) != 0)
+    {
+        return -1;
+    }
+    info->cproduct = product;
+    info->basename = harp_basename(filename);
+    info->module = module;
+    info->schema_only = definitions_only;
+
+    print("ingestion:");
+    for (i = 0; i < module->num_option_definitions; i++)
+    {
+        if (i > 0)
+        {
+            print(",");
+        }
+        print(" %s ", module->option_definition[i]->name);
+        if (option_choice[i] >= 0)
+        {
+            print("= %s", module->option_definition[i]->allowed_value[option_choice[i]]);
+        }
+        else
+        {
+            print("unset");
+        }
+    }
+    fflush(stdout);
+
+    status = info->module->ingestion_init(info->module, info->cproduct, option_list, &info->product_definition,
+                                          &info->user_data);
+    if (status == 0)
+    {
+        assert(info->product_definition != NULL);
+        if (module->num_option_definitions > 0)
+        {
+            print(" =>");
+        }
+        print(" %s", info->product_definition->name);
+        fflush(stdout);
+
+        status = get_product(info, program);
+    }
+    if (status == 0)
+    {
+        print(" (%d variables", info->product->num_variables);
+        for (i = 0; i < HARP_NUM_DIM_TYPES; i++)
+        {
+            if (info->product->dimension[i] > 0)
+            {
+                print(", %s=%ld", harp_get_dimension_type_name(i), info->product->dimension[i]);
+            }
+        }
+        print(") [OK]\n");
+    }
+    else
+    {
+        print(" [FAIL]\n");
+        print("ERROR: %s\n", harp_errno_to_string(harp_errno));
+        result = 1;
+    }
+
+    info->cproduct = NULL;
+    ingestion_done(info);
+
+    return result;
+}
+
+/* Advance option_choice and option_list to the next combination of ingestion options (depth first).
+ * returns:
+ * -1 = error, harp_errno will be set
+ * 0 = all combinations have been enumerated (option_choice and option_list are back at their initial state)
+ * 1 = option_choice and option_list contain the next combination
+ */
+static int next_option_combination(const harp_ingestion_module *module, int *option_choice,
+                                   harp_ingestion_options *option_list)
+{
+    int depth;
+
+    for (depth = module->num_option_definitions - 1; depth >= 0; depth--)
+    {
+        const harp_ingestion_option_definition *option_definition = module->option_definition[depth];
+
+        if (option_choice[depth] < option_definition->num_allowed_values - 1)
+        {
+            option_choice[depth]++;
+            if (harp_ingestion_options_set_option(option_list, option_definition->name,
+                                                  option_definition->allowed_value[option_choice[depth]]) != 0)
+            {
+                return -1;
+            }
+            return 1;
+        }
+        option_choice[depth] = -1;
+        if (harp_ingestion_options_remove_option(option_list, option_definition->name) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Test all combinations of ingestion options, starting with the combination in option_list/option_choice */
+static int ingest_test_all_options(const char *filename, harp_ingestion_module *module, coda_product *product,
+                                   harp_program *program, harp_ingestion_options *option_list, int *option_choice,
+                                   int definitions_only, int (*print)(const char *, ...))
+{
+    int result = 0;
+    int status = 1;
+
+    while (status == 1)
+    {
+        status = ingest_test_options(filename, module, product, program, option_list, option_choice,
+                                     definitions_only, print);
+        if (status < 0)
+        {
+            /* no sense to try other options */
+            return -1;
+        }
+        if (status > 0)
+        {
+            result = 1;
+        }
+        status = next_option_combination(module, option_choice, option_list);
+        if (status < 0)
+        {
+            return -1;
+        }
+    }
+
+    return result;
+}
+
+#ifndef WIN32
+/* output of the option combination that is being tested by a worker process (see buffer_print()) */
+static char *worker_output = NULL;
+static long worker_output_length = 0;
+static long worker_output_size = 0;
+
+/* printf compatible function that appends to the worker_output buffer */
+static int buffer_print(const char *format, ...)
+{
+    va_list ap;
+    int length;
+
+    va_start(ap, format);
+    length = vsnprintf(NULL, 0, format, ap);
+    va_end(ap);
+    if (length < 0)
+    {
+        return length;
+    }
+    if (worker_output_length + length + 1 > worker_output_size)
+    {
+        long new_size = worker_output_size > 0 ? 2 * worker_output_size : 1024;
+        char *new_output;
+
+        while (worker_output_length + length + 1 > new_size)
+        {
+            new_size *= 2;
+        }
+        new_output = realloc(worker_output, new_size);
+        if (new_output == NULL)
+        {
+            return -1;
+        }
+        worker_output = new_output;
+        worker_output_size = new_size;
+    }
+    va_start(ap, format);
+    vsnprintf(&worker_output[worker_output_length], length + 1, format, ap);
+    va_end(ap);
+    worker_output_length += length;
+
+    return length;
+}
+
+static int write_to_pipe(int fd, const void *buffer, size_t size)
+{
+    const char *data = (const char *)buffer;
+
+    while (size > 0)
+    {
+        ssize_t result = write(fd, data, size);
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        data += result;
+        size -= result;
+    }
+
+    return 0;
+}
+
+static int read_from_pipe(int fd, void *buffer, size_t size)
+{
+    char *data = (char *)buffer;
+
+    while (size > 0)
+    {
+        ssize_t result = read(fd, data, size);
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            harp_set_error(HARP_ERROR_FILE_READ, "could not read result from worker process (%s)", strerror(errno));
+            return -1;
+        }
+        if (result == 0)
+        {
+            harp_set_error(HARP_ERROR_FILE_READ, "worker process terminated unexpectedly");
+            return -1;
+        }
+        data += result;
+        size -= result;
+    }
+
+    return 0;
+}
+
+static int write_string_to_pipe(int fd, const char *str, long length)
+{
+    if (write_to_pipe(fd, &length, sizeof(long)) != 0)
+    {
+        return -1;
+    }
+    return write_to_pipe(fd, str, length);
+}
+
+/* read a string written by write_string_to_pipe(); the returned string should be freed by the caller */
+static int read_string_from_pipe(int fd, char **str)
+{
+    long length;
+
+    if (read_from_pipe(fd, &length, sizeof(long)) != 0)
+    {
+        return -1;
+    }
+    *str = malloc(length + 1);
+    if (*str == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       (size_t)(length + 1), __FILE__, __LINE__);
+        return -1;
+    }
+    if (read_from_pipe(fd, *str, length) != 0)
+    {
+        free(*str);
+        return -1;
+    }
+    (*str)[length] = '\0';
+
+    return 0;
+}
+
+/* Worker process: test every num_workers-th combination of ingestion options, starting with combination worker_index.
+ * The worker opens the product itself, since open files can not be shared safely between processes.
+ * For each tested combination the status (see ingest_test_options()) and the printed output are written to the pipe,
+ * followed by the error code and message if the status is -1 (in which case the worker stops).
+ */
+static void run_test_worker(const char *filename, harp_program *program, harp_ingestion_options *option_list,
+                            int *option_choice, int definitions_only, long worker_index, long num_workers, int fd)
+{
+    harp_ingestion_module *module = NULL;
+    coda_product *product = NULL;
+    long index = 0;
+    int status = 0;
+
+    if (harp_ingestion_find_module(filename, &module, &product) != 0)
+    {
+        status = -1;
+    }
+
+    do
+    {
+        if (index % num_workers == worker_index)
+        {
+            worker_output_length = 0;
+            if (status >= 0)
+            {
+                status = ingest_test_options(filename, module, product, program, option_list, option_choice,
+                                             definitions_only, buffer_print);
+            }
+            if (write_to_pipe(fd, &status, sizeof(int)) != 0 ||
+                write_string_to_pipe(fd, worker_output, worker_output_length) != 0)
+            {
+                break;
+            }
+            if (status < 0)
+            {
+                const char *message = harp_errno_to_string(harp_errno);
+
+                if (write_to_pipe(fd, &harp_errno, sizeof(int)) == 0)
+                {
+                    write_string_to_pipe(fd, message, (long)strlen(message));
+                }
+                break;
+            }
+        }
+        index++;
+    } while (next_option_combination(module, option_choice, option_list) == 1);
+    close(fd);
+
+    /* don't run exit handlers or flush stdio buffers that are shared with the parent process */
+    _exit(0);
+}
+
+/* Test the num_combinations combinations of ingestion options using num_workers worker processes.
+ * The output of the workers is printed in the order in which the combinations are enumerated.
+ * Separate processes are used (instead of threads) since the HARP library and the libraries it uses for reading
+ * products are not thread-safe.
+ */
+static int ingest_test_with_workers(const char *filename, harp_program *program, harp_ingestion_options *option_list,
+                                    int *option_choice, int definitions_only, long num_combinations, long num_workers,
+                                    int (*print)(const char *, ...))
+{
+    pid_t *pid;
+    int *fd;
+    int result = 0;
+    long index;
+    long i;
+
+    pid = malloc(num_workers * sizeof(pid_t));
+    if (pid == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_workers * sizeof(pid_t), __FILE__, __LINE__);
+        return -1;
+    }
+    fd = malloc(num_workers * sizeof(int));
+    if (fd == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_workers * sizeof(int), __FILE__, __LINE__);
+        free(pid);
+        return -1;
+    }
+
+    /* make sure buffered output does not get written by each of the worker processes */
+    fflush(NULL);
+
+    for (i = 0; i < num_workers; i++)
+    {
+        int pipe_fd[2];
+
+        if (pipe(pipe_fd) != 0)
+        {
+            harp_set_error(HARP_ERROR_FILE_OPEN, "could not create pipe (%s)", strerror(errno));
+            result = -1;
+            break;
+        }
+        pid[i] = fork();
+        if (pid[i] < 0)
+        {
+            harp_set_error(HARP_ERROR_OPERATION, "could not create worker process (%s)", strerror(errno));
+            close(pipe_fd[0]);
+            close(pipe_fd[1]);
+            result = -1;
+            break;
+        }
+        if (pid[i] == 0)
+        {
+            long j;
+
+            /* don't keep the read ends of the pipes of the other workers open */
+            for (j = 0; j < i; j++)
+            {
+                close(fd[j]);
+            }
+            close(pipe_fd[0]);
+            run_test_worker(filename, program, option_list, option_choice, definitions_only, i, num_workers,
+                            pipe_fd[1]);
+        }
+        close(pipe_fd[1]);
+        fd[i] = pipe_fd[0];
+    }
+    num_workers = i;
+
+    /* each worker writes the results of its combinations in enumeration order, so reading the results round robin
+     * gives the results of all combinations in enumeration order */
+    for (index = 0; result >= 0 && index < num_combinations; index++)
+    {
+        char *output;
+        int status;
+
+        if (read_from_pipe(fd[index % num_workers], &status, sizeof(int)) != 0)
+        {
+            result = -1;
+            break;
+        }
+        if (read_string_from_pipe(fd[index % num_workers], &output) != 0)
+        {
+            result = -1;
+            break;
+        }
+        print("%s", output);
+        fflush(stdout);
+        free(output);
+        if (status < 0)
+        {
+            char *message;
+            int error;
+
+            if (read_from_pipe(fd[index % num_workers], &error, sizeof(int)) == 0 &&
+                read_string_from_pipe(fd[index % num_workers], &message) == 0)
+            {
+                harp_set_error(error, "%s", message);
+                free(message);
+            }
+            result = -1;
+        }
+        else if (status > 0)
+        {
+            result = 1;
+        }
+    }
+
+    for (i = 0; i < num_workers; i++)
+    {
+        close(fd[i]);
+        waitpid(pid[i], NULL, 0);
+    }
+
+    free(fd);
+    free(pid);
+
+    return result;
+}
+#endif
+
+/** Test the ingestion of a product for all combinations of ingestion options.
+ * If definitions_only is set, only the product definition and dimensions are determined for each combination and no
+ * variable data is read (i.e. the product is ingested using the same path as harp_ingest_schema()).
+ * If num_jobs is larger than 1 the combinations are distributed over num_jobs worker processes (not supported on
+ * Windows); the output is still printed in the order in which the combinations are enumerated.
+ * returns:
  * -1 = initialization problem (e.g. harp initialization, file could not be opened, ...)
  *      harp_errno will be set
  * 0 = no problems
  * 1 = product ingestion results in errors for at least one set of options
  *     error is already printed, harp_errno should be ignored
  */
-int harp_ingest_test(const char *filename, int (*print)(const char *, ...))
+int harp_ingest_test(const char *filename, int definitions_only, int num_jobs, int (*print)(const char *, ...))
 {
     coda_product *product = NULL;
-    ingest_info *info;
     harp_program *program;
     harp_ingestion_options *option_list;
     harp_ingestion_module *module;
@@ -2235,9 +2809,10 @@ int harp_ingest_test(const char *filename, int (*print)(const char *, ...))
     int perform_boundary_checks;
     int num_options = 0;
     int *option_choice = NULL;
+    long num_combinations = 1;
     int version;
     int result;
-    int depth, i;
+    int i;
 
     if (filename == NULL)
     {
@@ -2298,102 +2873,31 @@ int harp_ingest_test(const char *filename, int (*print)(const char *, ...))
             for (i = 0; i < num_options; i++)
             {
                 option_choice[i] = -1;  /* -1 means that the option is not provided */
+                num_combinations *= module->option_definition[i]->num_allowed_values + 1;
             }
         }
     }
 
-    depth = num_options;
-    while (result >= 0 && depth >= 0)
+    if (result == 0)
     {
-        if (depth == num_options)
+#ifndef WIN32
+        if (num_jobs > 1 && num_combinations > 1)
         {
-            int status;
-
-            status = ingestion_init(&info);
-            if (status != 0)
-            {
-                /* no sense to try other options */
-                result = -1;
-                break;
-            }
-            info->cproduct = product;
-            info->basename = harp_basename(filename);
-            info->module = module;
-
-            print("ingestion:");
-            for (i = 0; i < num_options; i++)
-            {
-                if (i > 0)
-                {
-                    print(",");
-                }
-                print(" %s ", module->option_definition[i]->name);
-                if (option_choice[i] >= 0)
-                {
-                    print("= %s", module->option_definition[i]->allowed_value[option_choice[i]]);
-                }
-                else
-                {
-                    print("unset");
-                }
-            }
-            fflush(stdout);
-
-            status = info->module->ingestion_init(info->module, info->cproduct, option_list, &info->product_definition,
-                                                  &info->user_data);
-            if (status == 0)
-            {
-                assert(info->product_definition != NULL);
-                if (num_options > 0)
-                {
-                    print(" =>");
-                }
-                print(" %s", info->product_definition->name);
-                fflush(stdout);
-
-                status = get_product(info, program);
-            }
-            if (status == 0)
+            /* the worker processes open the product themselves */
+            coda_close(product);
+            product = NULL;
+            if (num_jobs > num_combinations)
             {
-                print(" (%d variables", info->product->num_variables);
-                for (i = 0; i < HARP_NUM_DIM_TYPES; i++)
-                {
-                    if (info->product->dimension[i] > 0)
-                    {
-                        print(", %s=%ld", harp_get_dimension_type_name(i), info->product->dimension[i]);
-                    }
-                }
-                print(") [OK]\n");
+                num_jobs = (int)num_combinations;
             }
-            else
-            {
-                print(" [FAIL]\n");
-                print("ERROR: %s\n", harp_errno_to_string(harp_errno));
-                result = 1;
-            }
-
-            info->cproduct = NULL;
-            ingestion_done(info);
-
-            depth--;
+            result = ingest_test_with_workers(filename, program, option_list, option_choice, definitions_only,
+                                              num_combinations, num_jobs, print);
         }
-        if (depth >= 0)
+        else
+#endif
         {
-            if (option_choice[depth] < module->option_definition[depth]->num_allowed_values - 1)
-            {
-                const char *value;
-
-                option_choice[depth]++;
-                value = module->option_definition[depth]->allowed_value[option_choice[depth]];
-                harp_ingestion_options_set_option(option_list, module->option_definition[depth]->name, value);
-                depth = num_options;
-            }
-            else
-            {
-                option_choice[depth] = -1;
-                harp_ingestion_options_remove_option(option_list, module->option_definition[depth]->name);
-                depth--;
-            }
+            result = ingest_test_all_options(filename, module, product, program, option_list, option_choice,
+                                             definitions_only, print);
         }
     }
 
@@ -238,5 +238,6 @@ harp_variable_definition *harp_ingestion_register_variable_block_read(harp_produ
 
 /* Initialization and clean-up. */
 int harp_ingestion_init(void);
+int harp_ingestion_init_all_modules(void);
 
 #endif
@@ -46,6 +46,7 @@
 #include "coda.h"
 
 #include <stdarg.h>
+#include <stddef.h>
 
 /* make sure that math.h on Windows also includes the defines for e.g. M_PI */
 #define _USE_MATH_DEFINES
@@ -65,8 +66,11 @@
 /* clamp function */
 #define HARP_CLAMP(var, min, max) if (var < min) var = min; if (var > max) var = max;
 
+extern int harp_option_collocation_cache_size;
 extern int harp_option_enable_aux_afgl86;
 extern int harp_option_enable_aux_usstd76;
+extern int harp_option_memory_limit;
+extern int harp_option_profiling;
 
 typedef int (*harp_conversion_function)(harp_variable *variable, const harp_variable **source_variable);
 typedef int (*harp_conversion_enabled_function)(void);
@@ -131,6 +135,7 @@ int harp_path_from_path(const char *initialpath, int is_filepath, const char *ap
 int harp_path_for_program(const char *argv0, char **location);
 int harp_is_identifier(const char *name);
 int harp_match_wildcard(const char *pattern, const char *name);
+int harp_match_wildcard_list(int num_patterns, char **pattern, const char *name);
 long harp_parse_double(const char *buffer, long buffer_length, double *dst, int ignore_trailing_bytes);
 long harp_get_max_string_length(long num_strings, char **string_data);
 int harp_get_char_array_from_string_array(long num_strings, char **string_data, long min_string_length,
@@ -142,10 +147,13 @@ void harp_array_replace_fill_value(harp_data_type data_type, long num_elements,
 int harp_array_invert(harp_data_type data_type, int dim_id, int num_dimensions, const long *dimension, harp_array data);
 int harp_array_transpose(harp_data_type data_type, int num_dimensions, const long *dimension, const int *order,
                          harp_array data);
+void harp_array_transpose_2d(harp_data_type data_type, long num_rows, long num_columns, harp_array source,
+                             harp_array data);
 
 /* Auxiliary data sources */
-int harp_aux_afgl86_get_profile(const char *name, double datetime, double latitude, int *num_vertical,
-                                const double **values);
+#define HARP_AUX_AFGL86_NUM_PROFILES 5
+int harp_aux_afgl86_get_profile_index(double datetime, double latitude);
+int harp_aux_afgl86_get_profiles(const char *name, int *num_vertical, const double **values);
 int harp_aux_usstd76_get_profile(const char *name, int *num_vertical, const double **values);
 
 /* Error messaging */
@@ -157,14 +165,30 @@ void harp_hdf5_add_error_message(void);
 #endif
 void harp_add_coda_cursor_path_to_error_message(const coda_cursor *cursor);
 
+/* Variable data storage */
+void *harp_data_malloc(size_t size);
+void *harp_data_calloc(size_t size);
+void *harp_data_realloc(void *ptr, size_t old_size, size_t new_size);
+void harp_data_free(void *ptr, size_t size);
+void harp_data_get_allocation_totals(uint64_t *bytes_allocated, uint64_t *bytes_freed);
+
 /* Variables */
+int harp_variable_new_without_data(const char *name, harp_data_type data_type, int num_dimensions,
+                                   const harp_dimension_type *dimension_type, const long *dimension,
+                                   harp_variable **new_variable);
+void harp_variable_free_data(harp_variable *variable);
 int harp_variable_get_flag_values_string(const harp_variable *variable, char **flag_values);
 int harp_variable_get_flag_meanings_string(const harp_variable *variable, char **flag_meanings);
 int harp_variable_set_enumeration_values_using_flag_meanings(harp_variable *variable, const char *flag_meanings);
 int harp_variable_add_dimension(harp_variable *variable, int dim_index, harp_dimension_type dimension_type,
                                 long length);
+typedef struct harp_rearrange_plan_struct harp_rearrange_plan;
+int harp_rearrange_plan_new(long dimension_length, long num_dim_elements, const long *dim_element_ids,
+                            harp_rearrange_plan **new_plan);
+void harp_rearrange_plan_delete(harp_rearrange_plan *plan);
 int harp_variable_rearrange_dimension(harp_variable *variable, int dim_index, long num_dim_elements,
                                       const long *dim_element_ids);
+int harp_variable_rearrange_dimension_with_plan(harp_variable *variable, int dim_index, const harp_rearrange_plan *plan);
 int harp_variable_filter_dimension(harp_variable *variable, int dim_index, const uint8_t *mask);
 int harp_variable_resize_dimension(harp_variable *variable, int dim_index, long length);
 int harp_variable_remove_dimension(harp_variable *variable, int dim_index, long index);
@@ -176,6 +200,7 @@ int harp_product_rearrange_dimension(harp_product *product, harp_dimension_type
 int harp_product_filter_by_index(harp_product *product, const char *index_variable, long num_elements, int32_t *index);
 int harp_product_filter_dimension(harp_product *product, harp_dimension_type dimension_type, const uint8_t *mask);
 int harp_product_remove_dimension(harp_product *product, harp_dimension_type dimension_type);
+int harp_product_resize_dimension(harp_product *product, harp_dimension_type dimension_type, long length);
 void harp_product_remove_all_variables(harp_product *product);
 int harp_product_get_datetime_range(const harp_product *product, double *datetime_start, double *datetime_stop);
 int harp_product_get_derived_bounds_for_grid(harp_product *product, harp_variable *grid, harp_variable **bounds);
@@ -190,13 +215,17 @@ int harp_product_clamp_dimension(harp_product *product, harp_dimension_type dime
                                  double upper_bound);
 
 /* Import */
+/* if variable_name is not NULL then only the variables that match one of the (wildcard) names are imported */
 #ifdef HAVE_HDF4
-int harp_import_hdf4(const char *filename, harp_product **product);
+int harp_import_hdf4(const char *filename, int num_variables, char **variable_name, harp_product **product);
+int harp_import_schema_hdf4(const char *filename, harp_product **product);
 #endif
 #ifdef HAVE_HDF5
-int harp_import_hdf5(const char *filename, harp_product **product);
+int harp_import_hdf5(const char *filename, int num_variables, char **variable_name, harp_product **product);
+int harp_import_schema_hdf5(const char *filename, harp_product **product);
 #endif
-int harp_import_netcdf(const char *filename, harp_product **product);
+int harp_import_netcdf(const char *filename, int num_variables, char **variable_name, harp_product **product);
+int harp_import_schema_netcdf(const char *filename, harp_product **product);
 
 #ifdef HAVE_HDF4
 int harp_export_hdf4(const char *filename, const harp_product *product);
@@ -217,7 +246,8 @@ int harp_parse_file_convention(const char *str, int *major, int *minor);
 
 /* Ingest */
 int harp_ingest(const char *filename, const char *operations, const char *options, harp_product **product);
-int harp_ingest_test(const char *filename, int (*print)(const char *, ...));
+int harp_ingest_schema(const char *filename, const char *operations, const char *options, harp_product **product);
+int harp_ingest_test(const char *filename, int definitions_only, int num_jobs, int (*print)(const char *, ...));
 int harp_ingest_metadata(const char *filename, const char *options, harp_product_metadata *metadata);
 void harp_ingestion_done(void);
 
@@ -226,6 +256,7 @@ typedef struct harp_unit_converter_struct harp_unit_converter;
 int harp_unit_converter_new(const char *from_unit, const char *to_unit, harp_unit_converter **new_unit_converter);
 void harp_unit_converter_delete(harp_unit_converter *unit_converter);
 double harp_unit_converter_convert(const harp_unit_converter *unit_converter, double value);
+void harp_unit_converter_convert_array(const harp_unit_converter *unit_converter, long num_values, double *value);
 int harp_unit_compare(const char *unit_a, const char *unit_b);
 int harp_unit_is_valid(const char *str);
 void harp_unit_done(void);
@@ -336,6 +367,10 @@ void harp_interpolate_value_linear(long source_length, const double *source_grid
 void harp_interpolate_array_linear(long source_length, const double *source_grid, const double *source_array,
                                    long target_length, const double *target_grid, int out_of_bound_flag,
                                    double *target_array);
+void harp_interpolate_linear_weights(long source_length, const double *source_grid, long target_length,
+                                     const double *target_grid, long *index, double *weight);
+void harp_interpolate_array_linear_with_weights(long target_length, const long *index, const double *weight,
+                                                const double *source_array, double *target_array);
 void harp_interpolate_value_loglinear(long source_length, const double *source_grid, const double *source_array,
                                       double target_grid_point, int out_of_bound_flag, double *target_value);
 void harp_interpolate_array_loglinear(long source_length, const double *source_grid, const double *source_array,
@@ -363,5 +398,6 @@ void harp_collocation_result_shallow_delete(harp_collocation_result *collocation
 
 int harp_collocation_result_get_filtered_product_b(harp_collocation_result *collocation_result,
                                                    const char *source_product, harp_product **product);
+void harp_collocation_product_cache_done(void);
 
 #endif
@@ -561,6 +561,73 @@ void harp_interpolate_array_linear(long source_length, const double *source_grid
     }
 }
 
+/* Determine the linear interpolation weights for interpolating from source grid to target grid
+ * Both source_grid and target_grid need to be strict monotonic.
+ * For each target point, index and weight are set such that the interpolated value equals
+ *   (1 - weight[i]) * source_array[index[i]] + weight[i] * source_array[index[i] + 1]
+ * An exact match with a source grid point is returned with weight 0 (and source_array[index[i]] should be taken as is)
+ * and a target point outside source_grid is returned with index -1 (the interpolated value will be NaN).
+ * Use harp_interpolate_array_linear_with_weights() to apply the weights to one or more source arrays that share the
+ * same source grid. The result is identical to that of harp_interpolate_array_linear() with out_of_bound_flag = 0.
+ */
+void harp_interpolate_linear_weights(long source_length, const double *source_grid, long target_length,
+                                     const double *target_grid, long *index, double *weight)
+{
+    long pos = 0;
+    long i;
+
+    assert(source_length > 1);
+
+    for (i = 0; i < target_length; i++)
+    {
+        harp_interpolate_find_index(source_length, source_grid, target_grid[i], &pos);
+
+        if (pos == -1 || pos == source_length)
+        {
+            index[i] = -1;
+            weight[i] = 0;
+        }
+        else if (target_grid[i] == source_grid[pos])
+        {
+            index[i] = pos;
+            weight[i] = 0;
+        }
+        else if (target_grid[i] == source_grid[pos + 1])
+        {
+            index[i] = pos + 1;
+            weight[i] = 0;
+        }
+        else
+        {
+            index[i] = pos;
+            weight[i] = (target_grid[i] - source_grid[pos]) / (source_grid[pos + 1] - source_grid[pos]);
+        }
+    }
+}
+
+/* Apply the linear interpolation weights as determined by harp_interpolate_linear_weights() to a source array */
+void harp_interpolate_array_linear_with_weights(long target_length, const long *index, const double *weight,
+                                                const double *source_array, double *target_array)
+{
+    long i;
+
+    for (i = 0; i < target_length; i++)
+    {
+        if (index[i] == -1)
+        {
+            target_array[i] = harp_nan();
+        }
+        else if (weight[i] == 0)
+        {
+            target_array[i] = source_array[index[i]];
+        }
+        else
+        {
+            target_array[i] = (1 - weight[i]) * source_array[index[i]] + weight[i] * source_array[index[i] + 1];
+        }
+    }
+}
+
 static void interpolate_loglinear(long source_length, const double *source_grid, const double *source_array,
                                   double target_grid_point, int out_of_bound_flag, long *pos, double *target_value)
 {
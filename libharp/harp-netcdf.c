@@ -38,6 +38,16 @@
 
 #include "netcdf.h"
 
+/* Maximum size of the blocks in which netCDF-3 files are written (the netCDF library keeps a buffer of twice this
+ * size). Products smaller than this are written using a single block of the size of the product.
+ */
+#ifndef HARP_NETCDF_WRITE_BLOCK_SIZE
+#define HARP_NETCDF_WRITE_BLOCK_SIZE 4194304
+#endif
+
+/* Minimum block size for writing (this is also the default block size of the netCDF library) */
+#define NETCDF_MIN_WRITE_BLOCK_SIZE 8192
+
 typedef enum netcdf_dimension_type_enum
 {
     netcdf_dimension_time,
@@ -425,7 +435,88 @@ static int read_numeric_attribute(int ncid, int varid, const char *name, harp_da
     return 0;
 }
 
-static int read_variable(harp_product *product, int ncid, int varid, netcdf_dimensions *dimensions)
+static int read_variable_data(int ncid, int varid, harp_variable *variable, long string_length)
+{
+    int result;
+
+    if (variable->data_type == harp_type_string)
+    {
+        char *buffer;
+        long i;
+
+        buffer = malloc(variable->num_elements * string_length * sizeof(char));
+        if (buffer == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           variable->num_elements * string_length * sizeof(char), __FILE__, __LINE__);
+            return -1;
+        }
+
+        result = nc_get_var_text(ncid, varid, buffer);
+        if (result != NC_NOERR)
+        {
+            harp_set_error(HARP_ERROR_NETCDF, "%s", nc_strerror(result));
+            free(buffer);
+            return -1;
+        }
+
+        for (i = 0; i < variable->num_elements; i++)
+        {
+            char *str;
+
+            str = malloc((string_length + 1) * sizeof(char));
+            if (str == NULL)
+            {
+                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                               (string_length + 1) * sizeof(char), __FILE__, __LINE__);
+                free(buffer);
+                return -1;
+            }
+
+            memcpy(str, &buffer[i * string_length], string_length);
+            str[string_length] = '\0';
+            variable->data.string_data[i] = str;
+        }
+
+        free(buffer);
+    }
+    else
+    {
+        switch (variable->data_type)
+        {
+            case harp_type_int8:
+                result = nc_get_var_schar(ncid, varid, variable->data.int8_data);
+                break;
+            case harp_type_int16:
+                result = nc_get_var_short(ncid, varid, variable->data.int16_data);
+                break;
+            case harp_type_int32:
+                result = nc_get_var_int(ncid, varid, variable->data.int32_data);
+                break;
+            case harp_type_float:
+                result = nc_get_var_float(ncid, varid, variable->data.float_data);
+                break;
+            case harp_type_double:
+                result = nc_get_var_double(ncid, varid, variable->data.double_data);
+                break;
+            default:
+                assert(0);
+                exit(1);
+        }
+
+        if (result != NC_NOERR)
+        {
+            harp_set_error(HARP_ERROR_NETCDF, "%s", nc_strerror(result));
+            return -1;
+        }
+    }
+
+
+    return 0;
+}
+
+static int read_variable(harp_product *product, int ncid, int varid, netcdf_dimensions *dimensions, int schema_only,
+                         int num_selected_variables, char **selected_variable_name)
 {
     harp_variable *variable;
     harp_data_type data_type;
@@ -446,6 +537,12 @@ static int read_variable(harp_product *product, int ncid, int varid, netcdf_dime
         return -1;
     }
 
+    if (selected_variable_name != NULL &&
+        !harp_match_wildcard_list(num_selected_variables, selected_variable_name, netcdf_name))
+    {
+        return 0;
+    }
+
     if (get_harp_type(netcdf_data_type, &data_type) != 0)
     {
         harp_add_error_message(" (variable '%s')", netcdf_name);
@@ -494,7 +591,15 @@ static int read_variable(harp_product *product, int ncid, int varid, netcdf_dime
         dimension[i] = dimensions->length[netcdf_dim_id[i]];
     }
 
-    if (harp_variable_new(netcdf_name, data_type, num_dimensions, dimension_type, dimension, &variable) != 0)
+    if (schema_only)
+    {
+        if (harp_variable_new_without_data(netcdf_name, data_type, num_dimensions, dimension_type, dimension,
+                                           &variable) != 0)
+        {
+            return -1;
+        }
+    }
+    else if (harp_variable_new(netcdf_name, data_type, num_dimensions, dimension_type, dimension, &variable) != 0)
     {
         return -1;
     }
@@ -505,78 +610,17 @@ static int read_variable(harp_product *product, int ncid, int varid, netcdf_dime
         return -1;
     }
 
-    /* Read data. */
-    if (data_type == harp_type_string)
+    if (!schema_only)
     {
-        char *buffer;
-        long length;
-
-        assert(netcdf_num_dimensions > 0);
-        length = dimensions->length[netcdf_dim_id[netcdf_num_dimensions - 1]];
+        long string_length = 0;
 
-        buffer = malloc(variable->num_elements * length * sizeof(char));
-        if (buffer == NULL)
+        if (data_type == harp_type_string)
         {
-            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                           variable->num_elements * length * sizeof(char), __FILE__, __LINE__);
-            return -1;
+            assert(netcdf_num_dimensions > 0);
+            string_length = dimensions->length[netcdf_dim_id[netcdf_num_dimensions - 1]];
         }
-
-        result = nc_get_var_text(ncid, varid, buffer);
-        if (result != NC_NOERR)
+        if (read_variable_data(ncid, varid, variable, string_length) != 0)
         {
-            harp_set_error(HARP_ERROR_NETCDF, "%s", nc_strerror(result));
-            free(buffer);
-            return -1;
-        }
-
-        for (i = 0; i < variable->num_elements; i++)
-        {
-            char *str;
-
-            str = malloc((length + 1) * sizeof(char));
-            if (str == NULL)
-            {
-                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                               (length + 1) * sizeof(char), __FILE__, __LINE__);
-                free(buffer);
-                return -1;
-            }
-
-            memcpy(str, &buffer[i * length], length);
-            str[length] = '\0';
-            variable->data.string_data[i] = str;
-        }
-
-        free(buffer);
-    }
-    else
-    {
-        switch (data_type)
-        {
-            case harp_type_int8:
-                result = nc_get_var_schar(ncid, varid, variable->data.int8_data);
-                break;
-            case harp_type_int16:
-                result = nc_get_var_short(ncid, varid, variable->data.int16_data);
-                break;
-            case harp_type_int32:
-                result = nc_get_var_int(ncid, varid, variable->data.int32_data);
-                break;
-            case harp_type_float:
-                result = nc_get_var_float(ncid, varid, variable->data.float_data);
-                break;
-            case harp_type_double:
-                result = nc_get_var_double(ncid, varid, variable->data.double_data);
-                break;
-            default:
-                assert(0);
-                exit(1);
-        }
-
-        if (result != NC_NOERR)
-        {
-            harp_set_error(HARP_ERROR_NETCDF, "%s", nc_strerror(result));
             return -1;
         }
     }
@@ -714,7 +758,8 @@ static int verify_product(int ncid)
     return -1;
 }
 
-static int read_product(int ncid, harp_product *product, netcdf_dimensions *dimensions)
+static int read_product(int ncid, harp_product *product, netcdf_dimensions *dimensions, int schema_only,
+                        int num_selected_variables, char **selected_variable_name)
 {
     int num_dimensions;
     int num_variables;
@@ -757,7 +802,8 @@ static int read_product(int ncid, harp_product *product, netcdf_dimensions *dime
 
     for (i = 0; i < num_variables; i++)
     {
-        if (read_variable(product, ncid, i, dimensions) != 0)
+        if (read_variable(product, ncid, i, dimensions, schema_only, num_selected_variables,
+                          selected_variable_name) != 0)
         {
             return -1;
         }
@@ -794,7 +840,8 @@ static int read_product(int ncid, harp_product *product, netcdf_dimensions *dime
     return 0;
 }
 
-int harp_import_netcdf(const char *filename, harp_product **product)
+static int import_netcdf(const char *filename, int schema_only, int num_selected_variables,
+                         char **selected_variable_name, harp_product **product)
 {
     harp_product *new_product;
     netcdf_dimensions dimensions;
@@ -828,7 +875,7 @@ int harp_import_netcdf(const char *filename, harp_product **product)
 
     dimensions_init(&dimensions);
 
-    if (read_product(ncid, new_product, &dimensions) != 0)
+    if (read_product(ncid, new_product, &dimensions, schema_only, num_selected_variables, selected_variable_name) != 0)
     {
         dimensions_done(&dimensions);
         harp_product_delete(new_product);
@@ -850,6 +897,17 @@ int harp_import_netcdf(const char *filename, harp_product **product)
     return 0;
 }
 
+int harp_import_netcdf(const char *filename, int num_variables, char **variable_name, harp_product **product)
+{
+    return import_netcdf(filename, 0, num_variables, variable_name, product);
+}
+
+/* Import only the structure of the product (variables, dimensions, and attributes); variable data is not read. */
+int harp_import_schema_netcdf(const char *filename, harp_product **product)
+{
+    return import_netcdf(filename, 1, 0, NULL, product);
+}
+
 int harp_import_metadata_netcdf(const char *filename, harp_product_metadata *metadata)
 {
     harp_scalar value;
@@ -1405,6 +1463,7 @@ static int write_product(int ncid, const harp_product *product, netcdf_dimension
 int harp_export_netcdf(const char *filename, const harp_product *product)
 {
     netcdf_dimensions dimensions;
+    size_t block_size;
     int64_t size;
     int flags = 0;
     int result;
@@ -1431,7 +1490,14 @@ int harp_export_netcdf(const char *filename, const harp_product *product)
         /* files larger than 1GB will be stored using 64-bit offsets */
         flags |= NC_64BIT_OFFSET;
     }
-    result = nc_create(filename, flags, &ncid);
+    /* write the file using large blocks (instead of the default file system block size) to reduce the number of
+     * write calls */
+    block_size = HARP_NETCDF_WRITE_BLOCK_SIZE;
+    if (size < HARP_NETCDF_WRITE_BLOCK_SIZE)
+    {
+        block_size = (size_t)(size < NETCDF_MIN_WRITE_BLOCK_SIZE ? NETCDF_MIN_WRITE_BLOCK_SIZE : size);
+    }
+    result = nc__create(filename, flags, 0, &block_size, &ncid);
     if (result != NC_NOERR)
     {
         harp_set_error(HARP_ERROR_NETCDF, "%s", nc_strerror(result));
@@ -30,6 +30,7 @@
  */
 
 #include "harp-operation.h"
+#include "harp-dimension-mask.h"
 
 #include <assert.h>
 #include <math.h>
@@ -407,6 +408,10 @@ static int eval_index_membership(harp_operation_index_membership_filter *operati
 
 static int eval_point_distance(harp_operation_point_distance_filter *operation, harp_spherical_point *point)
 {
+    if (!harp_spherical_bounding_box_contains_point(&operation->bounding_box, point))
+    {
+        return 0;
+    }
     return (harp_spherical_point_distance(&operation->point, point) * CONST_EARTH_RADIUS_WGS84_SPHERE <=
             operation->distance);
 }
@@ -570,6 +575,425 @@ static int eval_valid_range(harp_operation_valid_range_filter *operation, harp_d
     return (!harp_isnan(double_value) && double_value >= operation->valid_min && double_value <= operation->valid_max);
 }
 
+
+/* The block evaluation functions below process the data in blocks of 64 elements (one mask word per block). Each block
+ * is first widened to double (or to uint32 for bit mask filters) and then compared in a tight loop that gathers the
+ * results in a mask word without branching. Both loops are free of type and operator dispatch so the compiler can
+ * vectorize them. Blocks for which all mask entries are already unset are skipped.
+ */
+
+#define EVAL_BLOCK_SIZE 64
+
+static long get_block_length(long num_elements, long word_index)
+{
+    long block_length = num_elements - (word_index << 6);
+
+    return block_length > EVAL_BLOCK_SIZE ? EVAL_BLOCK_SIZE : block_length;
+}
+
+/* Return the values with indices [offset, offset + length) as doubles. Only non-double data is copied into buffer. */
+static const double *get_double_block(harp_data_type data_type, const void *data, long offset, long length,
+                                      double *buffer)
+{
+    long j;
+
+    switch (data_type)
+    {
+        case harp_type_int8:
+            for (j = 0; j < length; j++)
+            {
+                buffer[j] = (double)((const int8_t *)data)[offset + j];
+            }
+            break;
+        case harp_type_int16:
+            for (j = 0; j < length; j++)
+            {
+                buffer[j] = (double)((const int16_t *)data)[offset + j];
+            }
+            break;
+        case harp_type_int32:
+            for (j = 0; j < length; j++)
+            {
+                buffer[j] = (double)((const int32_t *)data)[offset + j];
+            }
+            break;
+        case harp_type_float:
+            for (j = 0; j < length; j++)
+            {
+                buffer[j] = (double)((const float *)data)[offset + j];
+            }
+            break;
+        case harp_type_double:
+            return &((const double *)data)[offset];
+        default:
+            assert(0);
+            exit(1);
+    }
+
+    return buffer;
+}
+
+/* Return the values with indices [offset, offset + length) as doubles in the given unit. */
+static const double *get_converted_double_block(harp_data_type data_type, const void *data, long offset, long length,
+                                                const harp_unit_converter *unit_converter, double *buffer)
+{
+    const double *block = get_double_block(data_type, data, offset, length, buffer);
+
+    if (block != buffer)
+    {
+        memcpy(buffer, block, length * sizeof(double));
+    }
+    harp_unit_converter_convert_array(unit_converter, length, buffer);
+
+    return buffer;
+}
+
+static int is_numeric_data_type(harp_data_type data_type)
+{
+    switch (data_type)
+    {
+        case harp_type_int8:
+        case harp_type_int16:
+        case harp_type_int32:
+        case harp_type_float:
+        case harp_type_double:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static uint64_t compare_block(harp_comparison_operator_type operator_type, long length, const double *block,
+                              double value)
+{
+    uint64_t word = 0;
+    long j;
+
+    switch (operator_type)
+    {
+        case operator_eq:
+            for (j = 0; j < length; j++)
+            {
+                word |= (uint64_t)(block[j] == value) << j;
+            }
+            break;
+        case operator_ne:
+            for (j = 0; j < length; j++)
+            {
+                word |= (uint64_t)(block[j] != value) << j;
+            }
+            break;
+        case operator_lt:
+            for (j = 0; j < length; j++)
+            {
+                word |= (uint64_t)(block[j] < value) << j;
+            }
+            break;
+        case operator_le:
+            for (j = 0; j < length; j++)
+            {
+                word |= (uint64_t)(block[j] <= value) << j;
+            }
+            break;
+        case operator_gt:
+            for (j = 0; j < length; j++)
+            {
+                word |= (uint64_t)(block[j] > value) << j;
+            }
+            break;
+        case operator_ge:
+            for (j = 0; j < length; j++)
+            {
+                word |= (uint64_t)(block[j] >= value) << j;
+            }
+            break;
+    }
+
+    return word;
+}
+
+static int eval_block_bitmask(harp_operation_bit_mask_filter *operation, harp_data_type data_type, long num_elements,
+                              const void *data, uint64_t *mask)
+{
+    uint32_t block[EVAL_BLOCK_SIZE];
+    uint32_t bit_mask = operation->bit_mask;
+    long num_words = HARP_MASK_NUM_WORDS(num_elements);
+    long word_index;
+
+    if (data_type != harp_type_int8 && data_type != harp_type_int16 && data_type != harp_type_int32)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "cannot perform bitmask filter for data type: %s",
+                       harp_get_data_type_name(data_type));
+        return -1;
+    }
+
+    for (word_index = 0; word_index < num_words; word_index++)
+    {
+        long offset = word_index << 6;
+        long length = get_block_length(num_elements, word_index);
+        uint64_t word = 0;
+        long j;
+
+        if (mask[word_index] == 0)
+        {
+            continue;
+        }
+
+        switch (data_type)
+        {
+            case harp_type_int8:
+                for (j = 0; j < length; j++)
+                {
+                    block[j] = ((const uint8_t *)data)[offset + j];
+                }
+                break;
+            case harp_type_int16:
+                for (j = 0; j < length; j++)
+                {
+                    block[j] = ((const uint16_t *)data)[offset + j];
+                }
+                break;
+            default:
+                memcpy(block, &((const uint32_t *)data)[offset], length * sizeof(uint32_t));
+                break;
+        }
+
+        switch (operation->operator_type)
+        {
+            case operator_bit_mask_all:
+                for (j = 0; j < length; j++)
+                {
+                    word |= (uint64_t)((block[j] & bit_mask) == bit_mask) << j;
+                }
+                break;
+            case operator_bit_mask_any:
+                for (j = 0; j < length; j++)
+                {
+                    word |= (uint64_t)((block[j] & bit_mask) != 0) << j;
+                }
+                break;
+            case operator_bit_mask_none:
+                for (j = 0; j < length; j++)
+                {
+                    word |= (uint64_t)((block[j] & bit_mask) == 0) << j;
+                }
+                break;
+        }
+        mask[word_index] &= word;
+    }
+
+    return 0;
+}
+
+static int eval_block_collocation(harp_operation_collocation_filter *operation, harp_data_type data_type,
+                                  long num_elements, const void *data, uint64_t *mask)
+{
+    long i;
+
+    for (i = harp_mask_find_next_set(num_elements, mask, 0); i < num_elements;
+         i = harp_mask_find_next_set(num_elements, mask, i + 1))
+    {
+        int result;
+
+        result = eval_collocation(operation, data_type, (void *)&((const int32_t *)data)[i]);
+        if (result < 0)
+        {
+            return -1;
+        }
+        if (!result)
+        {
+            HARP_MASK_CLEAR(mask, i);
+        }
+    }
+
+    return 0;
+}
+
+static int eval_block_comparison(harp_operation_comparison_filter *operation, harp_data_type data_type,
+                                 long num_elements, const void *data, uint64_t *mask)
+{
+    double buffer[EVAL_BLOCK_SIZE];
+    long num_words = HARP_MASK_NUM_WORDS(num_elements);
+    long word_index;
+
+    if (!is_numeric_data_type(data_type))
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "cannot perform numerical comparison filter for data type: %s",
+                       harp_get_data_type_name(data_type));
+        return -1;
+    }
+
+    for (word_index = 0; word_index < num_words; word_index++)
+    {
+        long offset = word_index << 6;
+        long length = get_block_length(num_elements, word_index);
+
+        if (mask[word_index] == 0)
+        {
+            continue;
+        }
+
+        if (operation->has_native_value)
+        {
+            /* compare against the threshold in the unit of the variable */
+            mask[word_index] &= compare_block(operation->operator_type, length,
+                                              get_double_block(data_type, data, offset, length, buffer),
+                                              operation->native_value);
+        }
+        else
+        {
+            /* the threshold could not be converted, so convert the values instead */
+            mask[word_index] &= compare_block(operation->operator_type, length,
+                                              get_converted_double_block(data_type, data, offset, length,
+                                                                         operation->unit_converter, buffer),
+                                              operation->value);
+        }
+    }
+
+    return 0;
+}
+
+static int eval_block_longitude_range(harp_operation_longitude_range_filter *operation, harp_data_type data_type,
+                                      long num_elements, const void *data, uint64_t *mask)
+{
+    double buffer[EVAL_BLOCK_SIZE];
+    double min = operation->min;
+    double max = operation->max;
+    long num_words = HARP_MASK_NUM_WORDS(num_elements);
+    long word_index;
+
+    if (!is_numeric_data_type(data_type))
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "cannot perform longitude range filter for data type: %s",
+                       harp_get_data_type_name(data_type));
+        return -1;
+    }
+
+    for (word_index = 0; word_index < num_words; word_index++)
+    {
+        long offset = word_index << 6;
+        long length = get_block_length(num_elements, word_index);
+        const double *block;
+        uint64_t word = 0;
+        long j;
+
+        if (mask[word_index] == 0)
+        {
+            continue;
+        }
+
+        if (operation->unit_converter != NULL)
+        {
+            block = get_converted_double_block(data_type, data, offset, length, operation->unit_converter, buffer);
+        }
+        else
+        {
+            block = get_double_block(data_type, data, offset, length, buffer);
+        }
+
+        /* map longitude to [min,min+360) and compare against max */
+        for (j = 0; j < length; j++)
+        {
+            word |= (uint64_t)(block[j] - 360.0 * floor((block[j] - min) / 360.0) <= max) << j;
+        }
+        mask[word_index] &= word;
+    }
+
+    return 0;
+}
+
+static int eval_block_membership(harp_operation_membership_filter *operation, harp_data_type data_type,
+                                 long num_elements, const void *data, uint64_t *mask)
+{
+    double buffer[EVAL_BLOCK_SIZE];
+    long num_words = HARP_MASK_NUM_WORDS(num_elements);
+    long word_index;
+
+    if (!is_numeric_data_type(data_type))
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "cannot perform numerical membership filter for data type: %s",
+                       harp_get_data_type_name(data_type));
+        return -1;
+    }
+
+    for (word_index = 0; word_index < num_words; word_index++)
+    {
+        long offset = word_index << 6;
+        long length = get_block_length(num_elements, word_index);
+        const double *block;
+        uint64_t word = 0;
+        int i;
+
+        if (mask[word_index] == 0)
+        {
+            continue;
+        }
+
+        if (operation->unit_converter != NULL)
+        {
+            block = get_converted_double_block(data_type, data, offset, length, operation->unit_converter, buffer);
+        }
+        else
+        {
+            block = get_double_block(data_type, data, offset, length, buffer);
+        }
+
+        /* collect the elements that match any of the values */
+        for (i = 0; i < operation->num_values; i++)
+        {
+            word |= compare_block(operator_eq, length, block, operation->value[i]);
+        }
+        if (operation->operator_type == operator_not_in)
+        {
+            word = ~word;
+        }
+        mask[word_index] &= word;
+    }
+
+    return 0;
+}
+
+static int eval_block_valid_range(harp_operation_valid_range_filter *operation, harp_data_type data_type,
+                                  long num_elements, const void *data, uint64_t *mask)
+{
+    double buffer[EVAL_BLOCK_SIZE];
+    double valid_min = operation->valid_min;
+    double valid_max = operation->valid_max;
+    long num_words = HARP_MASK_NUM_WORDS(num_elements);
+    long word_index;
+
+    if (!is_numeric_data_type(data_type))
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "cannot perform valid range filter for data type: %s",
+                       harp_get_data_type_name(data_type));
+        return -1;
+    }
+
+    for (word_index = 0; word_index < num_words; word_index++)
+    {
+        long offset = word_index << 6;
+        long length = get_block_length(num_elements, word_index);
+        const double *block;
+        uint64_t word = 0;
+        long j;
+
+        if (mask[word_index] == 0)
+        {
+            continue;
+        }
+
+        block = get_double_block(data_type, data, offset, length, buffer);
+        /* NaN values fail both comparisons, so no separate NaN check is needed */
+        for (j = 0; j < length; j++)
+        {
+            word |= (uint64_t)((block[j] >= valid_min) & (block[j] <= valid_max)) << j;
+        }
+        mask[word_index] &= word;
+    }
+
+    return 0;
+}
+
 static void area_covers_area_filter_delete(harp_operation_area_covers_area_filter *operation)
 {
     if (operation != NULL)
@@ -1847,6 +2271,7 @@ int harp_operation_bit_mask_filter_new(const char *variable_name, harp_bit_mask_
     }
     operation->type = operation_bit_mask_filter;
     operation->eval = eval_bitmask;
+    operation->eval_block = NULL;
     operation->variable_name = NULL;
     operation->operator_type = operator_type;
     operation->bit_mask = bit_mask;
@@ -1923,6 +2348,7 @@ int harp_operation_collocation_filter_new(const char *filename, harp_collocation
     }
     operation->type = operation_collocation_filter;
     operation->eval = eval_collocation;
+    operation->eval_block = NULL;
     operation->filename = NULL;
     operation->filter_type = filter_type;
     operation->min_collocation_index = min_collocation_index;
@@ -1960,11 +2386,13 @@ int harp_operation_comparison_filter_new(const char *variable_name, harp_compari
     }
     operation->type = operation_comparison_filter;
     operation->eval = eval_comparison;
+    operation->eval_block = NULL;
     operation->variable_name = NULL;
     operation->operator_type = operator_type;
     operation->value = value;
     operation->unit = NULL;
     operation->unit_converter = NULL;
+    operation->has_native_value = 0;
 
     operation->variable_name = strdup(variable_name);
     if (operation->variable_name == NULL)
@@ -2465,6 +2893,7 @@ int harp_operation_longitude_range_filter_new(double min, const char *min_unit,
     }
     operation->type = operation_longitude_range_filter;
     operation->eval = eval_longitude_range;
+    operation->eval_block = NULL;
     operation->min = min;
     operation->max = max;
     operation->unit_converter = NULL;
@@ -2514,6 +2943,7 @@ int harp_operation_membership_filter_new(const char *variable_name, harp_members
     }
     operation->type = operation_membership_filter;
     operation->eval = eval_membership;
+    operation->eval_block = NULL;
     operation->variable_name = NULL;
     operation->operator_type = operator_type;
     operation->num_values = num_values;
@@ -2617,6 +3047,11 @@ int harp_operation_point_distance_filter_new(double latitude, const char *latitu
     harp_spherical_point_rad_from_deg(&operation->point);
     harp_spherical_point_check(&operation->point);
 
+    /* the bounding box allows rejecting most points without having to calculate the exact distance */
+    harp_spherical_bounding_box_from_cap(&operation->bounding_box, &operation->point,
+                                         operation->distance / CONST_EARTH_RADIUS_WGS84_SPHERE +
+                                         HARP_GEOMETRY_BOUNDING_BOX_MARGIN);
+
     *new_operation = (harp_operation *)operation;
     return 0;
 }
@@ -3447,6 +3882,7 @@ int harp_operation_valid_range_filter_new(const char *variable_name, harp_operat
     }
     operation->type = operation_valid_range_filter;
     operation->eval = eval_valid_range;
+    operation->eval_block = NULL;
     operation->variable_name = NULL;
     operation->valid_min = harp_mininf();
     operation->valid_max = harp_plusinf();
@@ -3506,6 +3942,93 @@ int harp_operation_wrap_new(const char *variable_name, const char *unit, double
     return 0;
 }
 
+/* return the name of the operation type (e.g. "comparison_filter"); used for diagnostic output */
+const char *harp_operation_get_type_name(const harp_operation *operation)
+{
+    switch (operation->type)
+    {
+        case operation_area_covers_area_filter:
+            return "area_covers_area_filter";
+        case operation_area_covers_point_filter:
+            return "area_covers_point_filter";
+        case operation_area_inside_area_filter:
+            return "area_inside_area_filter";
+        case operation_area_intersects_area_filter:
+            return "area_intersects_area_filter";
+        case operation_bin_collocated:
+            return "bin_collocated";
+        case operation_bin_full:
+            return "bin_full";
+        case operation_bin_spatial:
+            return "bin_spatial";
+        case operation_bin_with_variables:
+            return "bin_with_variables";
+        case operation_bit_mask_filter:
+            return "bit_mask_filter";
+        case operation_clamp:
+            return "clamp";
+        case operation_collocation_filter:
+            return "collocation_filter";
+        case operation_comparison_filter:
+            return "comparison_filter";
+        case operation_derive_variable:
+            return "derive_variable";
+        case operation_derive_smoothed_column_collocated_dataset:
+            return "derive_smoothed_column_collocated_dataset";
+        case operation_derive_smoothed_column_collocated_product:
+            return "derive_smoothed_column_collocated_product";
+        case operation_exclude_variable:
+            return "exclude_variable";
+        case operation_flatten:
+            return "flatten";
+        case operation_index_comparison_filter:
+            return "index_comparison_filter";
+        case operation_index_membership_filter:
+            return "index_membership_filter";
+        case operation_keep_variable:
+            return "keep_variable";
+        case operation_longitude_range_filter:
+            return "longitude_range_filter";
+        case operation_membership_filter:
+            return "membership_filter";
+        case operation_point_distance_filter:
+            return "point_distance_filter";
+        case operation_point_in_area_filter:
+            return "point_in_area_filter";
+        case operation_rebin:
+            return "rebin";
+        case operation_regrid:
+            return "regrid";
+        case operation_regrid_collocated_dataset:
+            return "regrid_collocated_dataset";
+        case operation_regrid_collocated_product:
+            return "regrid_collocated_product";
+        case operation_rename:
+            return "rename";
+        case operation_set:
+            return "set";
+        case operation_smooth_collocated_dataset:
+            return "smooth_collocated_dataset";
+        case operation_smooth_collocated_product:
+            return "smooth_collocated_product";
+        case operation_sort:
+            return "sort";
+        case operation_squash:
+            return "squash";
+        case operation_string_comparison_filter:
+            return "string_comparison_filter";
+        case operation_string_membership_filter:
+            return "string_membership_filter";
+        case operation_valid_range_filter:
+            return "valid_range_filter";
+        case operation_wrap:
+            return "wrap";
+    }
+
+    assert(0);
+    exit(1);
+}
+
 int harp_operation_get_variable_name(const harp_operation *operation, const char **variable_name)
 {
     switch (operation->type)
@@ -3741,3 +4264,209 @@ int harp_operation_set_value_unit(harp_operation *operation, const char *unit)
 
     return harp_unit_converter_new(unit, target_unit, unit_converter);
 }
+
+/* Find the threshold t (in the unit of the variable) for which 'convert(x) <op> value' is equivalent to 'x <op> t' for
+ * all x, where convert() is the (monotonically increasing) conversion from the unit of the variable to the unit of the
+ * filter. The inverse conversion gives a first estimate, which is then corrected for rounding differences by stepping
+ * to neighbouring doubles. Returns 1 if such a threshold was found and 0 otherwise.
+ */
+static int find_native_threshold(const harp_unit_converter *unit_converter,
+                                 const harp_unit_converter *inverse_unit_converter,
+                                 harp_comparison_operator_type operator_type, double value, double *native_value)
+{
+    double threshold;
+    double delta;
+    int i;
+
+    if (!harp_isfinite(value))
+    {
+        return 0;
+    }
+    threshold = harp_unit_converter_convert(inverse_unit_converter, value);
+    if (!harp_isfinite(threshold))
+    {
+        return 0;
+    }
+    delta = fabs(threshold) + 1;
+    if (!(harp_unit_converter_convert(unit_converter, threshold - delta) <
+          harp_unit_converter_convert(unit_converter, threshold + delta)))
+    {
+        /* conversion is not increasing */
+        return 0;
+    }
+
+    if (operator_type == operator_lt || operator_type == operator_ge)
+    {
+        /* find the smallest t for which convert(t) >= value */
+        for (i = 0; i < 64 && !(harp_unit_converter_convert(unit_converter, threshold) >= value); i++)
+        {
+            threshold = nextafter(threshold, harp_plusinf());
+        }
+        for (; i < 64; i++)
+        {
+            double previous = nextafter(threshold, harp_mininf());
+
+            if (!(harp_unit_converter_convert(unit_converter, previous) >= value))
+            {
+                break;
+            }
+            threshold = previous;
+        }
+    }
+    else
+    {
+        /* find the largest t for which convert(t) <= value */
+        for (i = 0; i < 64 && !(harp_unit_converter_convert(unit_converter, threshold) <= value); i++)
+        {
+            threshold = nextafter(threshold, harp_mininf());
+        }
+        for (; i < 64; i++)
+        {
+            double next = nextafter(threshold, harp_plusinf());
+
+            if (!(harp_unit_converter_convert(unit_converter, next) <= value))
+            {
+                break;
+            }
+            threshold = next;
+        }
+    }
+    if (i == 64 || !harp_isfinite(threshold))
+    {
+        return 0;
+    }
+
+    *native_value = threshold;
+    return 1;
+}
+
+static int compile_comparison_filter(harp_operation_comparison_filter *operation, const char *unit)
+{
+    harp_unit_converter *inverse_unit_converter;
+    int result;
+
+    operation->eval_block = eval_block_comparison;
+    operation->has_native_value = 1;
+    operation->native_value = operation->value;
+
+    if (operation->unit_converter == NULL)
+    {
+        return 0;
+    }
+
+    /* For (in)equality comparisons the values are always converted, such that the outcome does not depend on the
+     * rounding of the converted threshold.
+     */
+    if (unit == NULL || operation->operator_type == operator_eq || operation->operator_type == operator_ne)
+    {
+        operation->has_native_value = 0;
+        return 0;
+    }
+
+    if (harp_unit_converter_new(operation->unit, unit, &inverse_unit_converter) != 0)
+    {
+        return -1;
+    }
+    result = find_native_threshold(operation->unit_converter, inverse_unit_converter, operation->operator_type,
+                                   operation->value, &operation->native_value);
+    harp_unit_converter_delete(inverse_unit_converter);
+    operation->has_native_value = result;
+
+    return 0;
+}
+
+/**
+ * Prepare a value filter for the evaluation on data with the given unit.
+ * This sets up the unit conversion for the filter (see harp_operation_set_value_unit()) and the function for the block
+ * wise evaluation of numeric value filters (eval_block). For comparison filters the threshold is converted once to the
+ * unit of the variable, such that no unit conversion is needed for the individual values.
+ * The valid range of the variable (for valid range filters) should be set beforehand using
+ * harp_operation_set_valid_range().
+ */
+int harp_operation_compile_value_filter(harp_operation *operation, const char *unit)
+{
+    if (unit != NULL)
+    {
+        if (harp_operation_set_value_unit(operation, unit) != 0)
+        {
+            return -1;
+        }
+    }
+
+    switch (operation->type)
+    {
+        case operation_bit_mask_filter:
+            ((harp_operation_bit_mask_filter *)operation)->eval_block = eval_block_bitmask;
+            break;
+        case operation_collocation_filter:
+            ((harp_operation_collocation_filter *)operation)->eval_block = eval_block_collocation;
+            break;
+        case operation_comparison_filter:
+            if (compile_comparison_filter((harp_operation_comparison_filter *)operation, unit) != 0)
+            {
+                return -1;
+            }
+            break;
+        case operation_longitude_range_filter:
+            ((harp_operation_longitude_range_filter *)operation)->eval_block = eval_block_longitude_range;
+            break;
+        case operation_membership_filter:
+            ((harp_operation_membership_filter *)operation)->eval_block = eval_block_membership;
+            break;
+        case operation_valid_range_filter:
+            ((harp_operation_valid_range_filter *)operation)->eval_block = eval_block_valid_range;
+            break;
+        default:
+            /* string value filters are evaluated per element */
+            break;
+    }
+
+    return 0;
+}
+
+/**
+ * Evaluate a (compiled) value filter for an array of values.
+ * Entries in \a mask for which the filter does not hold are cleared (entries that are already cleared stay cleared).
+ * Numeric value filters are evaluated block wise using eval_block (see harp_operation_compile_value_filter()), string
+ * value filters are evaluated per element.
+ */
+int harp_operation_eval_value_filter(harp_operation *operation, int num_enum_values, char **enum_name,
+                                     harp_data_type data_type, long num_elements, void *data, uint64_t *mask)
+{
+    if (harp_operation_is_string_value_filter(operation))
+    {
+        harp_operation_string_value_filter *string_operation = (harp_operation_string_value_filter *)operation;
+        int data_type_size = harp_get_size_for_type(data_type);
+        long i;
+
+        i = harp_mask_find_next_set(num_elements, mask, 0);
+        while (i < num_elements)
+        {
+            int result;
+
+            result = string_operation->eval(string_operation, num_enum_values, enum_name, data_type,
+                                            &((char *)data)[i * data_type_size]);
+            if (result < 0)
+            {
+                return -1;
+            }
+            if (!result)
+            {
+                HARP_MASK_CLEAR(mask, i);
+            }
+            i = harp_mask_find_next_set(num_elements, mask, i + 1);
+        }
+    }
+    else
+    {
+        harp_operation_numeric_value_filter *numeric_operation = (harp_operation_numeric_value_filter *)operation;
+
+        assert(numeric_operation->eval_block != NULL);
+        if (numeric_operation->eval_block(numeric_operation, data_type, num_elements, data, mask) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
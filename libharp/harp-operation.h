@@ -155,10 +155,18 @@ typedef struct harp_operation_struct
     harp_operation_type type;
 } harp_operation;
 
+/* Numeric value filters provide two evaluation functions:
+ * - eval() evaluates the filter for a single value.
+ * - eval_block() evaluates the filter for an array of values and clears the entries in a (bit) dimension mask for which
+ *   the filter does not hold. It is only available after harp_operation_compile_value_filter() has been called for the
+ *   unit of the variable that is filtered.
+ */
 typedef struct harp_operation_numeric_value_filter_struct
 {
     harp_operation_type type;
     int (*eval)(struct harp_operation_numeric_value_filter_struct *, harp_data_type, void *);
+    int (*eval_block)(struct harp_operation_numeric_value_filter_struct *, harp_data_type, long, const void *,
+                      uint64_t *);
 } harp_operation_numeric_value_filter;
 
 typedef struct harp_operation_string_value_filter_struct
@@ -257,6 +265,7 @@ typedef struct harp_operation_bit_mask_filter_struct
 {
     harp_operation_type type;
     int (*eval)(struct harp_operation_bit_mask_filter_struct *, harp_data_type, void *);
+    int (*eval_block)(struct harp_operation_bit_mask_filter_struct *, harp_data_type, long, const void *, uint64_t *);
     /* parameters */
     char *variable_name;
     harp_bit_mask_operator_type operator_type;
@@ -277,6 +286,8 @@ typedef struct harp_operation_collocation_filter_struct
 {
     harp_operation_type type;
     int (*eval)(struct harp_operation_collocation_filter_struct *, harp_data_type, void *);
+    int (*eval_block)(struct harp_operation_collocation_filter_struct *, harp_data_type, long, const void *,
+                      uint64_t *);
     /* parameters */
     char *filename;
     harp_collocation_filter_type filter_type;
@@ -293,6 +304,7 @@ typedef struct harp_operation_comparison_filter_struct
 {
     harp_operation_type type;
     int (*eval)(struct harp_operation_comparison_filter_struct *, harp_data_type, void *);
+    int (*eval_block)(struct harp_operation_comparison_filter_struct *, harp_data_type, long, const void *, uint64_t *);
     /* parameters */
     char *variable_name;
     harp_comparison_operator_type operator_type;
@@ -300,6 +312,9 @@ typedef struct harp_operation_comparison_filter_struct
     char *unit;
     /* extra */
     harp_unit_converter *unit_converter;
+    /* compiled (see harp_operation_compile_value_filter()) */
+    int has_native_value;       /* whether the threshold could be converted to the unit of the filtered variable */
+    double native_value;        /* threshold in the unit of the filtered variable */
 } harp_operation_comparison_filter;
 
 typedef struct harp_operation_derive_variable_struct
@@ -391,6 +406,8 @@ typedef struct harp_operation_longitude_range_filter_struct
 {
     harp_operation_type type;
     int (*eval)(struct harp_operation_longitude_range_filter_struct *, harp_data_type, void *);
+    int (*eval_block)(struct harp_operation_longitude_range_filter_struct *, harp_data_type, long, const void *,
+                      uint64_t *);
     /* parameters */
     double min;
     double max;
@@ -402,6 +419,7 @@ typedef struct harp_operation_membership_filter_struct
 {
     harp_operation_type type;
     int (*eval)(struct harp_operation_membership_filter_struct *, harp_data_type, void *);
+    int (*eval_block)(struct harp_operation_membership_filter_struct *, harp_data_type, long, const void *, uint64_t *);
     /* parameters */
     char *variable_name;
     harp_membership_operator_type operator_type;
@@ -419,6 +437,8 @@ typedef struct harp_operation_point_distance_filter_struct
     /* parameters */
     harp_spherical_point point;
     double distance;
+    /* extra */
+    harp_spherical_bounding_box bounding_box;   /* lat/lon bounds of all points within the distance (plus margin) */
 } harp_operation_point_distance_filter;
 
 typedef struct harp_operation_point_in_area_filter_struct
@@ -554,6 +574,8 @@ typedef struct harp_operation_valid_range_filter_struct
 {
     harp_operation_type type;
     int (*eval)(struct harp_operation_valid_range_filter_struct *, harp_data_type, void *);
+    int (*eval_block)(struct harp_operation_valid_range_filter_struct *, harp_data_type, long, const void *,
+                      uint64_t *);
     /* parameters */
     char *variable_name;
     /* extra */
@@ -573,6 +595,7 @@ typedef struct harp_operation_wrap_struct
 
 /* Generic operation */
 void harp_operation_delete(harp_operation *operation);
+const char *harp_operation_get_type_name(const harp_operation *operation);
 int harp_operation_get_variable_name(const harp_operation *operation, const char **variable_name);
 int harp_operation_prepare_collocation_filter(harp_operation *operation, const char *source_product);
 int harp_operation_is_point_filter(const harp_operation *operation);
@@ -582,6 +605,9 @@ int harp_operation_is_value_filter(const harp_operation *operation);
 int harp_operation_set_valid_range(harp_operation *operation, harp_data_type data_type, harp_scalar valid_min,
                                    harp_scalar valid_max);
 int harp_operation_set_value_unit(harp_operation *operation, const char *unit);
+int harp_operation_compile_value_filter(harp_operation *operation, const char *unit);
+int harp_operation_eval_value_filter(harp_operation *operation, int num_enum_values, char **enum_name,
+                                     harp_data_type data_type, long num_elements, void *data, uint64_t *mask);
 
 /* Specific operations */
 int harp_operation_area_covers_area_filter_new(const char *filename, int num_latitudes, double *latitude,
@@ -345,6 +345,7 @@ int harp_product_make_time_dependent(harp_product *product)
 int harp_product_rearrange_dimension(harp_product *product, harp_dimension_type dimension_type, long num_dim_elements,
                                      const long *dim_element_ids)
 {
+    harp_rearrange_plan *plan;
     int i;
 
     if (dimension_type == harp_dimension_independent)
@@ -374,6 +375,12 @@ int harp_product_rearrange_dimension(harp_product *product, harp_dimension_type
         return 0;
     }
 
+    /* all variables share the same rearrangement of the dimension, so we only determine it once */
+    if (harp_rearrange_plan_new(product->dimension[dimension_type], num_dim_elements, dim_element_ids, &plan) != 0)
+    {
+        return -1;
+    }
+
     for (i = 0; i < product->num_variables; i++)
     {
         harp_variable *variable = product->variable[i];
@@ -386,13 +393,16 @@ int harp_product_rearrange_dimension(harp_product *product, harp_dimension_type
                 continue;
             }
 
-            if (harp_variable_rearrange_dimension(variable, j, num_dim_elements, dim_element_ids) != 0)
+            if (harp_variable_rearrange_dimension_with_plan(variable, j, plan) != 0)
             {
+                harp_rearrange_plan_delete(plan);
                 return -1;
             }
         }
     }
 
+    harp_rearrange_plan_delete(plan);
+
     product->dimension[dimension_type] = num_dim_elements;
 
     return 0;
@@ -0,0 +1,380 @@
+/*
+ * Copyright (C) 2015-2024 S[&]T, The Netherlands.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "harp-internal.h"
+#include "harp-program.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef WIN32
+#include "windows.h"
+#else
+#include <sys/time.h>
+#endif
+
+/* Profiling of operations (enabled with harp_set_option_profiling()).
+ * For each operation (or group of consecutive operations that get executed together) that is performed, either as
+ * part of an ingestion (pushed down to the ingestion as a dimension/variable mask) or on an in-memory product, a
+ * record is kept with the wall clock time, the total number of variable elements before and after the operation, and
+ * the amount of variable data that got allocated/released during the operation.
+ * Records are kept until they are printed with harp_profiling_print_product_report(). Totals per operation type are
+ * kept until they are printed with harp_profiling_print_run_report().
+ */
+
+/* number of entries in the harp_operation_type enum */
+#define NUM_OPERATION_TYPES (operation_wrap + 1)
+
+typedef struct profile_record_struct
+{
+    const char *operation;      /* name of the (first) operation type */
+    char *variable_name;        /* variable that the operation applies to (can be NULL) */
+    int index;  /* position of the (first) operation in the list of operations as specified by the user */
+    int num_operations; /* number of consecutive operations that were executed together */
+    int pushed_down;    /* 1 if the operation was performed during ingestion, 0 if it was performed in memory */
+    double wall_time;
+    long elements_in;
+    long elements_out;
+    uint64_t bytes_allocated;
+    uint64_t bytes_freed;
+} profile_record;
+
+typedef struct profile_totals_struct
+{
+    const char *operation;
+    long count;
+    double wall_time;
+    double elements_in;
+    double elements_out;
+    uint64_t bytes_allocated;
+    uint64_t bytes_freed;
+} profile_totals;
+
+static profile_record *record = NULL;
+static long num_records = 0;
+
+/* run totals per operation type, separately for in-memory (0) and pushed down (1) execution */
+static profile_totals run_totals[NUM_OPERATION_TYPES][2];
+static long num_products = 0;
+
+static double get_wall_time(void)
+{
+#ifdef WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return (double)tv.tv_sec + 1.0e-6 * (double)tv.tv_usec;
+#endif
+}
+
+static void clear_records(void)
+{
+    long i;
+
+    for (i = 0; i < num_records; i++)
+    {
+        if (record[i].variable_name != NULL)
+        {
+            free(record[i].variable_name);
+        }
+    }
+    num_records = 0;
+}
+
+static int add_record(profile_record *new_record)
+{
+    if (num_records % BLOCK_SIZE == 0)
+    {
+        profile_record *new_record_list;
+
+        new_record_list = (profile_record *)realloc(record, (num_records + BLOCK_SIZE) * sizeof(profile_record));
+        if (new_record_list == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           (num_records + BLOCK_SIZE) * sizeof(profile_record), __FILE__, __LINE__);
+            return -1;
+        }
+        record = new_record_list;
+    }
+    record[num_records] = *new_record;
+    num_records++;
+
+    return 0;
+}
+
+static void print_json_string(const char *str, int (*print)(const char *, ...))
+{
+    if (str == NULL)
+    {
+        print("null");
+        return;
+    }
+    print("\"");
+    while (*str != '\0')
+    {
+        if (*str == '"' || *str == '\\')
+        {
+            print("\\%c", *str);
+        }
+        else if ((unsigned char)*str < 0x20)
+        {
+            print("\\u%04x", (unsigned char)*str);
+        }
+        else
+        {
+            print("%c", *str);
+        }
+        str++;
+    }
+    print("\"");
+}
+
+/* Start profiling the operation at program->current_index.
+ * \a num_elements is the total number of variable elements in the product before the operation is performed.
+ */
+void harp_profile_start(const harp_program *program, long num_elements, harp_profile_mark *mark)
+{
+    mark->index = program->current_index;
+    mark->num_elements = num_elements;
+    harp_data_get_allocation_totals(&mark->bytes_allocated, &mark->bytes_freed);
+    /* take the time last, so the bookkeeping above is not included in the measurement */
+    mark->wall_time = get_wall_time();
+}
+
+/* Stop profiling the operation(s) that were started with harp_profile_start().
+ * All operations from mark->index up to and including program->current_index are considered to be executed together.
+ * \a num_elements is the total number of variable elements in the product after the operation was performed.
+ */
+int harp_profile_stop(const harp_profile_mark *mark, const harp_program *program, int pushed_down,
+                      long num_elements)
+{
+    const harp_operation *operation = program->operation[mark->index];
+    profile_totals *totals;
+    profile_record new_record;
+    uint64_t bytes_allocated;
+    uint64_t bytes_freed;
+
+    new_record.wall_time = get_wall_time() - mark->wall_time;
+    harp_data_get_allocation_totals(&bytes_allocated, &bytes_freed);
+
+    new_record.operation = harp_operation_get_type_name(operation);
+    new_record.variable_name = NULL;
+    new_record.index = program->operation_position[mark->index];
+    new_record.num_operations = program->current_index - mark->index + 1;
+    new_record.pushed_down = pushed_down;
+    new_record.elements_in = mark->num_elements;
+    new_record.elements_out = num_elements;
+    new_record.bytes_allocated = bytes_allocated - mark->bytes_allocated;
+    new_record.bytes_freed = bytes_freed - mark->bytes_freed;
+
+    if (harp_operation_is_value_filter(operation) || operation->type == operation_collocation_filter)
+    {
+        const char *variable_name;
+
+        if (harp_operation_get_variable_name(operation, &variable_name) != 0)
+        {
+            return -1;
+        }
+        new_record.variable_name = strdup(variable_name);
+        if (new_record.variable_name == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not duplicate string) (%s:%u)", __FILE__,
+                           __LINE__);
+            return -1;
+        }
+    }
+
+    if (add_record(&new_record) != 0)
+    {
+        if (new_record.variable_name != NULL)
+        {
+            free(new_record.variable_name);
+        }
+        return -1;
+    }
+
+    totals = &run_totals[operation->type][pushed_down ? 1 : 0];
+    totals->operation = new_record.operation;
+    totals->count++;
+    totals->wall_time += new_record.wall_time;
+    totals->elements_in += new_record.elements_in;
+    totals->elements_out += new_record.elements_out;
+    totals->bytes_allocated += new_record.bytes_allocated;
+    totals->bytes_freed += new_record.bytes_freed;
+
+    return 0;
+}
+
+void harp_profile_done(void)
+{
+    clear_records();
+    if (record != NULL)
+    {
+        free(record);
+        record = NULL;
+    }
+    memset(run_totals, 0, sizeof(run_totals));
+    num_products = 0;
+}
+
+/** \addtogroup harp_general
+ * @{
+ */
+
+/** Print the profiling report for the operations that were performed on a single product.
+ * This prints one line for each operation (or group of operations that got executed together) that was profiled since
+ * the last call to this function (see harp_set_option_profiling()). Each line is a JSON object with the fields:
+ *   - "report": always "product"
+ *   - "product": the \a product_name that is passed to this function
+ *   - "index": position (zero-based) of the (first) operation in the list of operations as it was specified; this
+ *     refers to the original list, also if the operations were reordered by the optimization of the program
+ *   - "num_operations": number of operations that were executed together (e.g. multiple filters on the same
+ *     variable)
+ *   - "operation": operation type (e.g. "comparison_filter")
+ *   - "variable": variable that the operation applies to (only for variable filters)
+ *   - "mode": "ingestion" if the operation was pushed down to the ingestion or "memory" if it was performed on the
+ *     in-memory product
+ *   - "wall_time": wall clock time in seconds
+ *   - "elements_in"/"elements_out": total number of elements of all variables in the product before/after the
+ *     operation (for pushed down operations this is the number of elements that the product would have if it were
+ *     read at that point)
+ *   - "bytes_allocated"/"bytes_freed": amount of variable data (in bytes) allocated/released during the operation
+ *
+ * The profiling records are cleared after they have been printed.
+ * \param product_name Name used to identify the product in the report (e.g. the filename).
+ * \param print Reference to a printf compatible function.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_profiling_print_product_report(const char *product_name, int (*print)(const char *, ...))
+{
+    long i;
+
+    if (print == NULL)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "print argument is NULL (%s:%u)", __FILE__, __LINE__);
+        return -1;
+    }
+
+    for (i = 0; i < num_records; i++)
+    {
+        print("{\"report\":\"product\",\"product\":");
+        print_json_string(product_name, print);
+        print(",\"index\":%d,\"num_operations\":%d,\"operation\":\"%s\"", record[i].index, record[i].num_operations,
+              record[i].operation);
+        if (record[i].variable_name != NULL)
+        {
+            print(",\"variable\":");
+            print_json_string(record[i].variable_name, print);
+        }
+        print(",\"mode\":\"%s\",\"wall_time\":%.6f,\"elements_in\":%ld,\"elements_out\":%ld",
+              record[i].pushed_down ? "ingestion" : "memory", record[i].wall_time, record[i].elements_in,
+              record[i].elements_out);
+        print(",\"bytes_allocated\":%.0f,\"bytes_freed\":%.0f}\n", (double)record[i].bytes_allocated,
+              (double)record[i].bytes_freed);
+    }
+    clear_records();
+    num_products++;
+
+    return 0;
+}
+
+/** Print the aggregated profiling report for all operations that were profiled.
+ * This prints one line for each combination of operation type and execution mode (pushed down to the ingestion or
+ * performed in memory) that occurred since the last call to this function, followed by a line with the overall totals.
+ * Each line is a JSON object. The per operation type lines have "report" set to "run" and contain the fields
+ * "operation", "mode", "count" (the number of times the operation was performed), "wall_time", "elements_in",
+ * "elements_out", "bytes_allocated" and "bytes_freed" (all summed over all products; see
+ * harp_profiling_print_product_report() for their meaning). The final line has "report" set to "run_total" and
+ * contains the number of products for which a product report was printed ("num_products") and the overall "count",
+ * "wall_time", "bytes_allocated" and "bytes_freed".
+ *
+ * The aggregated totals are reset after they have been printed.
+ * \param print Reference to a printf compatible function.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_profiling_print_run_report(int (*print)(const char *, ...))
+{
+    profile_totals total;
+    int i, j;
+
+    if (print == NULL)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "print argument is NULL (%s:%u)", __FILE__, __LINE__);
+        return -1;
+    }
+
+    memset(&total, 0, sizeof(total));
+    for (j = 1; j >= 0; j--)
+    {
+        for (i = 0; i < NUM_OPERATION_TYPES; i++)
+        {
+            const profile_totals *totals = &run_totals[i][j];
+
+            if (totals->count == 0)
+            {
+                continue;
+            }
+            print("{\"report\":\"run\",\"operation\":\"%s\",\"mode\":\"%s\",\"count\":%ld,\"wall_time\":%.6f",
+                  totals->operation, j ? "ingestion" : "memory", totals->count, totals->wall_time);
+            print(",\"elements_in\":%.0f,\"elements_out\":%.0f,\"bytes_allocated\":%.0f,\"bytes_freed\":%.0f}\n",
+                  totals->elements_in, totals->elements_out, (double)totals->bytes_allocated,
+                  (double)totals->bytes_freed);
+            total.count += totals->count;
+            total.wall_time += totals->wall_time;
+            total.bytes_allocated += totals->bytes_allocated;
+            total.bytes_freed += totals->bytes_freed;
+        }
+    }
+    print("{\"report\":\"run_total\",\"num_products\":%ld,\"count\":%ld,\"wall_time\":%.6f", num_products, total.count,
+          total.wall_time);
+    print(",\"bytes_allocated\":%.0f,\"bytes_freed\":%.0f}\n", (double)total.bytes_allocated,
+          (double)total.bytes_freed);
+
+    memset(run_totals, 0, sizeof(run_totals));
+    num_products = 0;
+
+    return 0;
+}
+
+/** @} */
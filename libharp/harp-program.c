@@ -54,10 +54,12 @@ int harp_program_new(harp_program **new_program)
 
     program->num_operations = 0;
     program->operation = NULL;
+    program->operation_position = NULL;
     program->current_index = 0;
 
     program->option_enable_aux_afgl86 = harp_get_option_enable_aux_afgl86();
     program->option_enable_aux_usstd76 = harp_get_option_enable_aux_usstd76();
+    program->option_preserve_float = harp_get_option_preserve_float();
     program->option_regrid_out_of_bounds = harp_get_option_regrid_out_of_bounds();
 
     /* we only explicitly set the regrid_out_of_bounds option */
@@ -74,6 +76,7 @@ void harp_program_delete(harp_program *program)
         /* reset global HARP options to initial values */
         harp_set_option_enable_aux_afgl86(program->option_enable_aux_afgl86);
         harp_set_option_enable_aux_usstd76(program->option_enable_aux_usstd76);
+        harp_set_option_preserve_float(program->option_preserve_float);
         harp_set_option_regrid_out_of_bounds(program->option_regrid_out_of_bounds);
 
         if (program->operation != NULL)
@@ -87,6 +90,10 @@ void harp_program_delete(harp_program *program)
 
             free(program->operation);
         }
+        if (program->operation_position != NULL)
+        {
+            free(program->operation_position);
+        }
 
         free(program);
     }
@@ -97,6 +104,7 @@ int harp_program_add_operation(harp_program *program, harp_operation *operation)
     if (program->num_operations % BLOCK_SIZE == 0)
     {
         harp_operation **operation;
+        int *operation_position;
 
         operation = (harp_operation **)realloc(program->operation,
                                                (program->num_operations + BLOCK_SIZE) * sizeof(harp_operation *));
@@ -108,14 +116,50 @@ int harp_program_add_operation(harp_program *program, harp_operation *operation)
         }
 
         program->operation = operation;
+
+        operation_position = (int *)realloc(program->operation_position,
+                                            (program->num_operations + BLOCK_SIZE) * sizeof(int));
+        if (operation_position == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           (program->num_operations + BLOCK_SIZE) * sizeof(int), __FILE__, __LINE__);
+            return -1;
+        }
+
+        program->operation_position = operation_position;
     }
 
     program->operation[program->num_operations] = operation;
+    program->operation_position[program->num_operations] = program->num_operations;
     program->num_operations++;
 
     return 0;
 }
 
+/* Returns 1 if all (remaining) operations of the program only change the set of variables, their names, or the global
+ * options, i.e. if the program can be executed on a product whose variables have no data (see harp_import_schema()).
+ */
+int harp_program_is_schema_only(const harp_program *program)
+{
+    int i;
+
+    for (i = program->current_index; i < program->num_operations; i++)
+    {
+        switch (program->operation[i]->type)
+        {
+            case operation_exclude_variable:
+            case operation_keep_variable:
+            case operation_rename:
+            case operation_set:
+                break;
+            default:
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
 static int execute_value_filter(harp_product *product, harp_program *program)
 {
     harp_dimension_mask_set *dimension_mask_set = NULL;
@@ -123,7 +167,7 @@ static int execute_value_filter(harp_product *product, harp_program *program)
     const char *variable_name;
     int num_operations = 1;
     int data_type_size;
-    long i, j;
+    long i;
     int k;
 
     if (harp_operation_get_variable_name(program->operation[program->current_index], &variable_name) != 0)
@@ -165,12 +209,9 @@ static int execute_value_filter(harp_product *product, harp_program *program)
         {
             return -1;
         }
-        if (variable->unit != NULL)
+        if (harp_operation_compile_value_filter(program->operation[program->current_index + k], variable->unit) != 0)
         {
-            if (harp_operation_set_value_unit(program->operation[program->current_index + k], variable->unit) != 0)
-            {
-                return -1;
-            }
+            return -1;
         }
     }
 
@@ -223,46 +264,17 @@ static int execute_value_filter(harp_product *product, harp_program *program)
         }
         dimension_mask_set[variable->dimension_type[0]] = dimension_mask;
 
-        for (i = 0; i < variable->num_elements; i++)
+        for (k = 0; k < num_operations; k++)
         {
-            for (k = 0; k < num_operations; k++)
-            {
-                if (dimension_mask->mask[i])
-                {
-                    harp_operation *operation;
-                    int result;
-
-                    operation = program->operation[program->current_index + k];
-                    if (harp_operation_is_string_value_filter(operation))
-                    {
-                        harp_operation_string_value_filter *string_operation;
-
-                        string_operation = (harp_operation_string_value_filter *)operation;
-                        result = string_operation->eval(string_operation, variable->num_enum_values,
-                                                        variable->enum_name, variable->data_type,
-                                                        &variable->data.int8_data[i * data_type_size]);
-                    }
-                    else
-                    {
-                        harp_operation_numeric_value_filter *numeric_operation;
-
-                        numeric_operation = (harp_operation_numeric_value_filter *)operation;
-                        result = numeric_operation->eval(numeric_operation, variable->data_type,
-                                                         &variable->data.int8_data[i * data_type_size]);
-                    }
-                    if (result < 0)
-                    {
-                        harp_dimension_mask_set_delete(dimension_mask_set);
-                        return -1;
-                    }
-                    dimension_mask->mask[i] = result;
-                }
-            }
-            if (!dimension_mask->mask[i])
+            if (harp_operation_eval_value_filter(program->operation[program->current_index + k],
+                                                 variable->num_enum_values, variable->enum_name, variable->data_type,
+                                                 variable->num_elements, variable->data.ptr, dimension_mask->mask) != 0)
             {
-                dimension_mask->masked_dimension_length--;
+                harp_dimension_mask_set_delete(dimension_mask_set);
+                return -1;
             }
         }
+        dimension_mask->masked_dimension_length = harp_mask_count(variable->num_elements, dimension_mask->mask);
 
         if (harp_product_filter(product, dimension_mask_set) != 0)
         {
@@ -279,7 +291,6 @@ static int execute_value_filter(harp_product *product, harp_program *program)
         harp_dimension_type dimension_type;
         harp_dimension_mask *time_mask;
         harp_dimension_mask *dimension_mask;
-        long index = 0;
 
         dimension_type = variable->dimension_type[1];
 
@@ -304,52 +315,25 @@ static int execute_value_filter(harp_product *product, harp_program *program)
         dimension_mask->masked_dimension_length = 0;
         for (i = 0; i < variable->dimension[0]; i++)
         {
-            long new_dimension_length = 0;
+            uint64_t *row_mask = harp_dimension_mask_get_row(dimension_mask, i);
+            void *row_data = &variable->data.int8_data[i * variable->dimension[1] * data_type_size];
+            long new_dimension_length;
 
-            for (j = 0; j < variable->dimension[1]; j++)
+            for (k = 0; k < num_operations; k++)
             {
-                for (k = 0; k < num_operations; k++)
-                {
-                    if (dimension_mask->mask[index])
-                    {
-                        harp_operation *operation;
-                        int result;
-
-                        operation = program->operation[program->current_index + k];
-                        if (harp_operation_is_string_value_filter(operation))
-                        {
-                            harp_operation_string_value_filter *string_operation;
-
-                            string_operation = (harp_operation_string_value_filter *)operation;
-                            result = string_operation->eval(string_operation, variable->num_enum_values,
-                                                            variable->enum_name, variable->data_type,
-                                                            &variable->data.int8_data[index * data_type_size]);
-                        }
-                        else
-                        {
-                            harp_operation_numeric_value_filter *numeric_operation;
-
-                            numeric_operation = (harp_operation_numeric_value_filter *)operation;
-                            result = numeric_operation->eval(numeric_operation, variable->data_type,
-                                                             &variable->data.int8_data[index * data_type_size]);
-                        }
-                        if (result < 0)
-                        {
-                            harp_dimension_mask_set_delete(dimension_mask_set);
-                            return -1;
-                        }
-                        dimension_mask->mask[index] = result;
-                    }
-                }
-                if (dimension_mask->mask[index])
+                if (harp_operation_eval_value_filter(program->operation[program->current_index + k],
+                                                     variable->num_enum_values, variable->enum_name,
+                                                     variable->data_type, variable->dimension[1], row_data,
+                                                     row_mask) != 0)
                 {
-                    new_dimension_length++;
+                    harp_dimension_mask_set_delete(dimension_mask_set);
+                    return -1;
                 }
-                index++;
             }
+            new_dimension_length = harp_mask_count(variable->dimension[1], row_mask);
             if (new_dimension_length == 0)
             {
-                time_mask->mask[i] = 0;
+                HARP_MASK_CLEAR(time_mask->mask, i);
                 time_mask->masked_dimension_length--;
             }
             else if (new_dimension_length > dimension_mask->masked_dimension_length)
@@ -414,9 +398,9 @@ static int execute_index_filter(harp_product *product, harp_program *program)
             harp_dimension_mask_set_delete(dimension_mask_set);
             return -1;
         }
-        dimension_mask->mask[i] = result;
-        if (!dimension_mask->mask[i])
+        if (!result)
         {
+            HARP_MASK_CLEAR(dimension_mask->mask, i);
             dimension_mask->masked_dimension_length--;
         }
     }
@@ -1101,6 +1085,23 @@ static int execute_set(harp_product *product, harp_operation_set *operation)
             return -1;
         }
     }
+    else if (strcmp(operation->option, "preserve_float") == 0)
+    {
+        if (strcmp(operation->value, "enabled") == 0)
+        {
+            harp_set_option_preserve_float(1);
+        }
+        else if (strcmp(operation->value, "disabled") == 0)
+        {
+            harp_set_option_preserve_float(0);
+        }
+        else
+        {
+            harp_set_error(HARP_ERROR_OPERATION, "invalid value '%s' for option '%s'", operation->value,
+                           operation->option);
+            return -1;
+        }
+    }
     else if (strcmp(operation->option, "propagate_uncertainty") == 0)
     {
         if (strcmp(operation->value, "uncorrelated") == 0)
@@ -1284,198 +1285,1064 @@ static int execute_wrap(harp_product *product, harp_operation_wrap *operation)
     return 0;
 }
 
-/* this will start with the operation at program->current_index */
-int harp_product_execute_program(harp_product *product, harp_program *program)
+/* Program optimization
+ *
+ * The optimizer only rearranges the leading part of a program that consists of filters, derive(), rename(), keep() and
+ * exclude() operations. This is also the part of the program that the ingestion can apply while reading a product, so
+ * moving filters and variable selections to the front of it means that less data needs to be read and processed.
+ *
+ * The transformations are:
+ * - derive() operations whose result is removed by a later exclude()/keep() before it is used are dropped.
+ * - filters are moved in front of rename(), keep() and exclude() operations that they commute with. Filters always
+ *   keep their order relative to each other.
+ * - keep() and exclude() operations are moved in front of filters and rename() operations that they commute with.
+ * - consecutive exclude() operations are merged and a keep() that is a no-op after a preceding keep() is dropped.
+ *
+ * Whether an operation commutes with another depends on the variables that they read/write. Information on the
+ * variables of the product at the start of the program is provided by a lookup function.
+ * Filters are never moved in front of a derive(). A derived variable may depend on neighbouring elements (e.g. an
+ * index, or bounds that are derived from midpoints) and would then be different if it were derived after filtering.
+ * Note that when a moved filter removes all data from the product, subsequent operations (which might have failed) are
+ * no longer performed.
+ */
+
+static int is_movable_filter(const harp_operation *operation)
 {
-    while (program->current_index < program->num_operations)
+    switch (operation->type)
+    {
+        case operation_bit_mask_filter:
+        case operation_comparison_filter:
+        case operation_longitude_range_filter:
+        case operation_membership_filter:
+        case operation_string_comparison_filter:
+        case operation_string_membership_filter:
+        case operation_valid_range_filter:
+        case operation_index_comparison_filter:
+        case operation_index_membership_filter:
+        case operation_point_distance_filter:
+        case operation_point_in_area_filter:
+        case operation_area_covers_area_filter:
+        case operation_area_covers_point_filter:
+        case operation_area_inside_area_filter:
+        case operation_area_intersects_area_filter:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* returns the number of operations (starting from current_index) that the optimizer is allowed to rearrange */
+static int get_optimizable_length(const harp_program *program)
+{
+    int i;
+
+    for (i = program->current_index; i < program->num_operations; i++)
     {
-        harp_operation *operation = program->operation[program->current_index];
+        harp_operation *operation = program->operation[i];
+
+        if (!is_movable_filter(operation) && operation->type != operation_derive_variable &&
+            operation->type != operation_rename && operation->type != operation_keep_variable &&
+            operation->type != operation_exclude_variable)
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+static int variable_list_matches(int num_variables, char **variable_name, const char *name)
+{
+    int i;
+
+    for (i = 0; i < num_variables; i++)
+    {
+        if (harp_match_wildcard(variable_name[i], name))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int variable_list_contains(int num_variables, char **variable_name, const char *name)
+{
+    int i;
+
+    for (i = 0; i < num_variables; i++)
+    {
+        if (strcmp(variable_name[i], name) == 0)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int is_wildcard_pattern(const char *name)
+{
+    return strchr(name, '*') != NULL || strchr(name, '?') != NULL;
+}
+
+/* Determine whether a variable exists right before the operation at position 'index' and, if so, its dimensions.
+ * Returns 1 if the variable exists, 0 if it does not exist, and -1 if this is unknown.
+ */
+static int get_variable_info(const harp_program *program, int index, const char *name,
+                             harp_program_variable_lookup lookup, void *user_data, int *num_dimensions,
+                             harp_dimension_type *dimension_type)
+{
+    int i;
+
+    for (i = index - 1; i >= program->current_index; i--)
+    {
+        harp_operation *operation = program->operation[i];
 
-        /* note that some consecutive filter operations can be executed together for optimization purposes */
-        /* so the filter functions below may increase program->current_index itself */
         switch (operation->type)
         {
-            case operation_bit_mask_filter:
-            case operation_comparison_filter:
-            case operation_longitude_range_filter:
-            case operation_membership_filter:
-            case operation_string_comparison_filter:
-            case operation_string_membership_filter:
-            case operation_valid_range_filter:
-                if (execute_value_filter(product, program) != 0)
+            case operation_derive_variable:
                 {
-                    return -1;
+                    harp_operation_derive_variable *derive = (harp_operation_derive_variable *)operation;
+
+                    if (strcmp(derive->variable_name, name) == 0 && derive->has_dimensions)
+                    {
+                        *num_dimensions = derive->num_dimensions;
+                        memcpy(dimension_type, derive->dimension_type,
+                               derive->num_dimensions * sizeof(harp_dimension_type));
+                        return 1;
+                    }
                 }
                 break;
-            case operation_index_comparison_filter:
-            case operation_index_membership_filter:
-                if (execute_index_filter(product, program) != 0)
+            case operation_rename:
                 {
-                    return -1;
+                    harp_operation_rename *rename = (harp_operation_rename *)operation;
+
+                    if (strcmp(rename->new_variable_name, name) == 0)
+                    {
+                        /* the rename is a no-op if the source variable does not exist */
+                        if (get_variable_info(program, i, rename->variable_name, lookup, user_data, num_dimensions,
+                                              dimension_type) == 1)
+                        {
+                            return 1;
+                        }
+                        return -1;
+                    }
+                    if (strcmp(rename->variable_name, name) == 0)
+                    {
+                        return 0;
+                    }
                 }
                 break;
-            case operation_point_distance_filter:
-            case operation_point_in_area_filter:
-                if (execute_point_filter(product, program) != 0)
+            case operation_keep_variable:
                 {
-                    return -1;
+                    harp_operation_keep_variable *keep = (harp_operation_keep_variable *)operation;
+
+                    if (!variable_list_matches(keep->num_variables, keep->variable_name, name))
+                    {
+                        return 0;
+                    }
                 }
                 break;
-            case operation_area_covers_area_filter:
-            case operation_area_covers_point_filter:
-            case operation_area_inside_area_filter:
-            case operation_area_intersects_area_filter:
-                if (execute_polygon_filter(product, program) != 0)
+            case operation_exclude_variable:
                 {
-                    return -1;
+                    harp_operation_exclude_variable *exclude = (harp_operation_exclude_variable *)operation;
+
+                    if (variable_list_matches(exclude->num_variables, exclude->variable_name, name))
+                    {
+                        return 0;
+                    }
                 }
                 break;
-            case operation_collocation_filter:
-                if (execute_collocation_filter(product, (harp_operation_collocation_filter *)operation) != 0)
-                {
-                    return -1;
-                }
+            default:
+                /* filters do not add/remove variables and do not change whether a variable is time dependent */
                 break;
-            case operation_bin_collocated:
-                if (execute_bin_collocated(product, (harp_operation_bin_collocated *)operation) != 0)
+        }
+    }
+
+    if (lookup == NULL)
+    {
+        return -1;
+    }
+
+    return lookup(user_data, name, num_dimensions, dimension_type);
+}
+
+/* Get the names of the variables that a filter reads.
+ * Point and polygon filters may derive their variables, so these filters also require that the variables exist.
+ */
+static int get_filter_variables(const harp_operation *operation, const char **variable_name, int *requires_existence)
+{
+    *requires_existence = 0;
+    if (harp_operation_is_value_filter(operation))
+    {
+        harp_operation_get_variable_name(operation, &variable_name[0]);
+        return 1;
+    }
+    if (harp_operation_is_point_filter(operation))
+    {
+        variable_name[0] = "latitude";
+        variable_name[1] = "longitude";
+        *requires_existence = 1;
+        return 2;
+    }
+    if (harp_operation_is_polygon_filter(operation))
+    {
+        variable_name[0] = "latitude_bounds";
+        variable_name[1] = "longitude_bounds";
+        *requires_existence = 1;
+        return 2;
+    }
+
+    /* index filters do not read any variables */
+    return 0;
+}
+
+/* check whether the variables that a point or polygon filter reads exist (with the right dimensions) at 'index' */
+static int filter_variables_exist(const harp_program *program, int index, const harp_operation *operation,
+                                  harp_program_variable_lookup lookup, void *user_data)
+{
+    harp_dimension_type dimension_type[HARP_MAX_NUM_DIMS];
+    const char *variable_name[2];
+    int requires_existence;
+    int num_variables;
+    int num_dimensions;
+    int i;
+
+    num_variables = get_filter_variables(operation, variable_name, &requires_existence);
+    if (!requires_existence)
+    {
+        return 1;
+    }
+    for (i = 0; i < num_variables; i++)
+    {
+        if (get_variable_info(program, index, variable_name[i], lookup, user_data, &num_dimensions,
+                              dimension_type) != 1)
+        {
+            return 0;
+        }
+        if (num_dimensions < 1 || dimension_type[0] != harp_dimension_time ||
+            num_dimensions != (harp_operation_is_polygon_filter(operation) ? 2 : 1))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* check whether the filter at position 'index' can be executed before the operation at position 'index - 1' */
+static int can_move_filter_forward(const harp_program *program, int index, harp_program_variable_lookup lookup,
+                                   void *user_data)
+{
+    harp_operation *filter = program->operation[index];
+    harp_operation *operation = program->operation[index - 1];
+    const char *variable_name[2];
+    int requires_existence;
+    int num_variables;
+    int i;
+
+    num_variables = get_filter_variables(filter, variable_name, &requires_existence);
+
+    switch (operation->type)
+    {
+        case operation_rename:
+            {
+                harp_operation_rename *rename = (harp_operation_rename *)operation;
+
+                for (i = 0; i < num_variables; i++)
                 {
-                    return -1;
+                    if (strcmp(variable_name[i], rename->variable_name) == 0 ||
+                        strcmp(variable_name[i], rename->new_variable_name) == 0)
+                    {
+                        return 0;
+                    }
                 }
-                break;
-            case operation_bin_full:
-                if (harp_product_bin_full(product) != 0)
+            }
+            break;
+        case operation_keep_variable:
+            {
+                harp_operation_keep_variable *keep = (harp_operation_keep_variable *)operation;
+
+                if (num_variables == 0)
                 {
-                    return -1;
+                    /* the dimensions of the product may depend on which variables are kept */
+                    return 0;
                 }
-                break;
-            case operation_bin_spatial:
-                if (execute_bin_spatial(product, (harp_operation_bin_spatial *)operation) != 0)
+                for (i = 0; i < num_variables; i++)
                 {
-                    return -1;
+                    if (!variable_list_matches(keep->num_variables, keep->variable_name, variable_name[i]))
+                    {
+                        return 0;
+                    }
                 }
-                break;
-            case operation_bin_with_variables:
-                if (execute_bin_with_variables(product, (harp_operation_bin_with_variables *)operation) != 0)
+            }
+            break;
+        case operation_exclude_variable:
+            {
+                harp_operation_exclude_variable *exclude = (harp_operation_exclude_variable *)operation;
+
+                if (num_variables == 0)
                 {
-                    return -1;
+                    return 0;
                 }
-                break;
-            case operation_clamp:
-                if (execute_clamp(product, (harp_operation_clamp *)operation) != 0)
+                for (i = 0; i < num_variables; i++)
                 {
-                    return -1;
+                    if (variable_list_matches(exclude->num_variables, exclude->variable_name, variable_name[i]))
+                    {
+                        return 0;
+                    }
                 }
-                break;
-            case operation_derive_variable:
-                if (execute_derive_variable(product, (harp_operation_derive_variable *)operation) != 0)
+            }
+            break;
+        default:
+            return 0;
+    }
+
+    return filter_variables_exist(program, index - 1, filter, lookup, user_data);
+}
+
+/* check whether the keep()/exclude() at position 'index' can be executed before the operation at 'index - 1' */
+static int can_move_selection_forward(const harp_program *program, int index, harp_program_variable_lookup lookup,
+                                      void *user_data)
+{
+    harp_operation *selection = program->operation[index];
+    harp_operation *operation = program->operation[index - 1];
+    int num_variables;
+    char **variable_name;
+    int i;
+
+    if (selection->type == operation_keep_variable)
+    {
+        num_variables = ((harp_operation_keep_variable *)selection)->num_variables;
+        variable_name = ((harp_operation_keep_variable *)selection)->variable_name;
+    }
+    else
+    {
+        num_variables = ((harp_operation_exclude_variable *)selection)->num_variables;
+        variable_name = ((harp_operation_exclude_variable *)selection)->variable_name;
+    }
+
+    if (is_movable_filter(operation))
+    {
+        const char *filter_variable_name[2];
+        int requires_existence;
+        int num_filter_variables;
+
+        num_filter_variables = get_filter_variables(operation, filter_variable_name, &requires_existence);
+        if (num_filter_variables == 0)
+        {
+            /* the outcome of index filters may depend on which variables are still there */
+            return 0;
+        }
+        for (i = 0; i < num_filter_variables; i++)
+        {
+            int matches = variable_list_matches(num_variables, variable_name, filter_variable_name[i]);
+
+            if (matches != (selection->type == operation_keep_variable))
+            {
+                return 0;
+            }
+        }
+
+        return filter_variables_exist(program, index - 1, operation, lookup, user_data);
+    }
+
+    if (operation->type == operation_rename)
+    {
+        harp_operation_rename *rename = (harp_operation_rename *)operation;
+        harp_dimension_type dimension_type[HARP_MAX_NUM_DIMS];
+        int num_dimensions;
+
+        for (i = 0; i < num_variables; i++)
+        {
+            if (is_wildcard_pattern(variable_name[i]))
+            {
+                if (harp_match_wildcard(variable_name[i], rename->variable_name) ||
+                    harp_match_wildcard(variable_name[i], rename->new_variable_name))
                 {
-                    return -1;
+                    return 0;
+                }
+            }
+        }
+        if (variable_list_contains(num_variables, variable_name, rename->variable_name))
+        {
+            return 0;
+        }
+        if (selection->type == operation_exclude_variable)
+        {
+            return !variable_list_contains(num_variables, variable_name, rename->new_variable_name);
+        }
+
+        /* a keep() can only be moved if it keeps the renamed variable (using its original name), which requires that
+         * the rename actually takes place
+         */
+        if (!variable_list_contains(num_variables, variable_name, rename->new_variable_name))
+        {
+            return 0;
+        }
+        if (get_variable_info(program, index - 1, rename->variable_name, lookup, user_data, &num_dimensions,
+                              dimension_type) != 1)
+        {
+            return 0;
+        }
+        if (get_variable_info(program, index - 1, rename->new_variable_name, lookup, user_data, &num_dimensions,
+                              dimension_type) != 0)
+        {
+            return 0;
+        }
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/* check whether the result of the derive() at position 'index' is removed before it is used */
+static int is_dead_derive(const harp_program *program, int index, int end, harp_program_variable_lookup lookup,
+                          void *user_data)
+{
+    harp_operation_derive_variable *derive = (harp_operation_derive_variable *)program->operation[index];
+    const char *name = derive->variable_name;
+    int i;
+
+    for (i = index + 1; i < end; i++)
+    {
+        harp_operation *operation = program->operation[i];
+
+        if (is_movable_filter(operation))
+        {
+            const char *variable_name[2];
+            int requires_existence;
+            int num_variables;
+            int j;
+
+            num_variables = get_filter_variables(operation, variable_name, &requires_existence);
+            for (j = 0; j < num_variables; j++)
+            {
+                if (strcmp(variable_name[j], name) == 0)
+                {
+                    return 0;
+                }
+            }
+            if (!filter_variables_exist(program, i, operation, lookup, user_data))
+            {
+                return 0;
+            }
+            continue;
+        }
+        switch (operation->type)
+        {
+            case operation_rename:
+                if (strcmp(((harp_operation_rename *)operation)->variable_name, name) == 0 ||
+                    strcmp(((harp_operation_rename *)operation)->new_variable_name, name) == 0)
+                {
+                    return 0;
+                }
+                break;
+            case operation_keep_variable:
+                {
+                    harp_operation_keep_variable *keep = (harp_operation_keep_variable *)operation;
+
+                    if (!variable_list_matches(keep->num_variables, keep->variable_name, name))
+                    {
+                        return 1;
+                    }
+                    if (variable_list_contains(keep->num_variables, keep->variable_name, name))
+                    {
+                        /* the keep() requires the variable to exist */
+                        return 0;
+                    }
+                }
+                break;
+            case operation_exclude_variable:
+                {
+                    harp_operation_exclude_variable *exclude = (harp_operation_exclude_variable *)operation;
+
+                    if (variable_list_matches(exclude->num_variables, exclude->variable_name, name))
+                    {
+                        return 1;
+                    }
+                }
+                break;
+            default:
+                /* a derive() may use the variable as input */
+                return 0;
+        }
+    }
+
+    return 0;
+}
+
+static void swap_operations(harp_program *program, int index)
+{
+    harp_operation *operation = program->operation[index];
+    int position = program->operation_position[index];
+
+    program->operation[index] = program->operation[index - 1];
+    program->operation[index - 1] = operation;
+    program->operation_position[index] = program->operation_position[index - 1];
+    program->operation_position[index - 1] = position;
+}
+
+static void remove_operation(harp_program *program, int index)
+{
+    harp_operation_delete(program->operation[index]);
+    memmove(&program->operation[index], &program->operation[index + 1],
+            (program->num_operations - index - 1) * sizeof(harp_operation *));
+    memmove(&program->operation_position[index], &program->operation_position[index + 1],
+            (program->num_operations - index - 1) * sizeof(int));
+    program->num_operations--;
+}
+
+/* replace the operation at 'index' by a copy of the keep() with the old name of a renamed variable */
+static int rename_in_keep(harp_program *program, int index, const harp_operation_rename *rename)
+{
+    harp_operation_keep_variable *keep = (harp_operation_keep_variable *)program->operation[index];
+    int i;
+
+    for (i = 0; i < keep->num_variables; i++)
+    {
+        if (strcmp(keep->variable_name[i], rename->new_variable_name) == 0)
+        {
+            char *variable_name = strdup(rename->variable_name);
+
+            if (variable_name == NULL)
+            {
+                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not duplicate string) (%s:%u)",
+                               __FILE__, __LINE__);
+                return -1;
+            }
+            free(keep->variable_name[i]);
+            keep->variable_name[i] = variable_name;
+        }
+    }
+
+    return 0;
+}
+
+/* merge the exclude() at 'index' into the exclude() at 'index - 1' */
+static int merge_excludes(harp_program *program, int index)
+{
+    harp_operation_exclude_variable *first = (harp_operation_exclude_variable *)program->operation[index - 1];
+    harp_operation_exclude_variable *second = (harp_operation_exclude_variable *)program->operation[index];
+    harp_operation *operation;
+    const char **variable_name;
+    int num_variables = 0;
+    int i;
+
+    variable_name = malloc((first->num_variables + second->num_variables) * sizeof(char *));
+    if (variable_name == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       (first->num_variables + second->num_variables) * sizeof(char *), __FILE__, __LINE__);
+        return -1;
+    }
+    for (i = 0; i < first->num_variables; i++)
+    {
+        variable_name[num_variables++] = first->variable_name[i];
+    }
+    for (i = 0; i < second->num_variables; i++)
+    {
+        if (!variable_list_contains(first->num_variables, first->variable_name, second->variable_name[i]))
+        {
+            variable_name[num_variables++] = second->variable_name[i];
+        }
+    }
+    if (harp_operation_exclude_variable_new(num_variables, variable_name, &operation) != 0)
+    {
+        free(variable_name);
+        return -1;
+    }
+    free(variable_name);
+
+    harp_operation_delete(program->operation[index - 1]);
+    program->operation[index - 1] = operation;
+    remove_operation(program, index);
+
+    return 0;
+}
+
+/* check whether the keep() at 'index' is a no-op because of the keep() at 'index - 1' */
+static int is_redundant_keep(const harp_program *program, int index)
+{
+    harp_operation_keep_variable *first = (harp_operation_keep_variable *)program->operation[index - 1];
+    harp_operation_keep_variable *second = (harp_operation_keep_variable *)program->operation[index];
+    int i;
+
+    /* after the first keep() only the variables from its list remain (they should all exist) */
+    for (i = 0; i < first->num_variables; i++)
+    {
+        if (is_wildcard_pattern(first->variable_name[i]) ||
+            !variable_list_matches(second->num_variables, second->variable_name, first->variable_name[i]))
+        {
+            return 0;
+        }
+    }
+    /* the second keep() should not refer to variables that do not exist anymore */
+    for (i = 0; i < second->num_variables; i++)
+    {
+        if (!is_wildcard_pattern(second->variable_name[i]) &&
+            !variable_list_contains(first->num_variables, first->variable_name, second->variable_name[i]))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/** Optimize the order of the operations in a program (starting from current_index).
+ * See the description of the program optimization above for the transformations that are performed.
+ * \param program Program to optimize.
+ * \param lookup Function that determines whether a variable exists in the product at the start of the program and,
+ *   if so, its dimensions (returns 1 if the variable exists, 0 if it does not exist, -1 if unknown). Can be NULL.
+ * \param user_data Argument that is passed to \a lookup.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+int harp_program_optimize(harp_program *program, harp_program_variable_lookup lookup, void *user_data)
+{
+    int end;
+    int i, j;
+
+    /* remove dead derivations */
+    end = get_optimizable_length(program);
+    i = program->current_index;
+    while (i < end)
+    {
+        if (program->operation[i]->type == operation_derive_variable &&
+            is_dead_derive(program, i, end, lookup, user_data))
+        {
+            remove_operation(program, i);
+            end--;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    /* move filters forward */
+    for (i = program->current_index + 1; i < end; i++)
+    {
+        if (is_movable_filter(program->operation[i]))
+        {
+            for (j = i; j > program->current_index && !is_movable_filter(program->operation[j - 1]); j--)
+            {
+                if (!can_move_filter_forward(program, j, lookup, user_data))
+                {
+                    break;
+                }
+                swap_operations(program, j);
+            }
+        }
+    }
+
+    /* move variable selections forward */
+    for (i = program->current_index + 1; i < end; i++)
+    {
+        harp_operation_type type = program->operation[i]->type;
+
+        if (type == operation_keep_variable || type == operation_exclude_variable)
+        {
+            for (j = i; j > program->current_index; j--)
+            {
+                harp_operation *operation = program->operation[j - 1];
+
+                if (!can_move_selection_forward(program, j, lookup, user_data))
+                {
+                    break;
+                }
+                if (operation->type == operation_rename && type == operation_keep_variable)
+                {
+                    if (rename_in_keep(program, j, (harp_operation_rename *)operation) != 0)
+                    {
+                        return -1;
+                    }
+                }
+                swap_operations(program, j);
+            }
+        }
+    }
+
+    /* fold consecutive variable selections */
+    i = program->current_index + 1;
+    while (i < end)
+    {
+        harp_operation_type type = program->operation[i]->type;
+
+        if (type == operation_exclude_variable && program->operation[i - 1]->type == operation_exclude_variable)
+        {
+            if (merge_excludes(program, i) != 0)
+            {
+                return -1;
+            }
+            end--;
+        }
+        else if (type == operation_keep_variable && program->operation[i - 1]->type == operation_keep_variable &&
+                 is_redundant_keep(program, i))
+        {
+            remove_operation(program, i);
+            end--;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    return 0;
+}
+
+/* returns whether an operation may turn float variables into double variables */
+static int operation_promotes_float(const harp_operation *operation)
+{
+    switch (operation->type)
+    {
+        case operation_bin_collocated:
+        case operation_bin_full:
+        case operation_bin_spatial:
+        case operation_bin_with_variables:
+        case operation_clamp:
+        case operation_rebin:
+        case operation_regrid:
+        case operation_regrid_collocated_dataset:
+        case operation_regrid_collocated_product:
+        case operation_smooth_collocated_dataset:
+        case operation_smooth_collocated_product:
+        case operation_wrap:
+            return 1;
+        case operation_derive_variable:
+            /* an explicitly requested data type takes precedence */
+            return !((harp_operation_derive_variable *)operation)->has_data_type;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static void free_variable_names(int num_names, char **name)
+{
+    int i;
+
+    for (i = 0; i < num_names; i++)
+    {
+        if (name[i] != NULL)
+        {
+            free(name[i]);
+        }
+    }
+    free(name);
+}
+
+/* store the names of all float variables of the product (so they can be converted back after an operation) */
+static int get_float_variable_names(const harp_product *product, int *num_names, char ***name)
+{
+    char **float_name;
+    int num_float_names = 0;
+    int i;
+
+    float_name = (char **)malloc((product->num_variables + 1) * sizeof(char *));
+    if (float_name == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       (product->num_variables + 1) * sizeof(char *), __FILE__, __LINE__);
+        return -1;
+    }
+    for (i = 0; i < product->num_variables; i++)
+    {
+        if (product->variable[i]->data_type == harp_type_float)
+        {
+            float_name[num_float_names] = strdup(product->variable[i]->name);
+            if (float_name[num_float_names] == NULL)
+            {
+                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not duplicate string) (%s:%u)",
+                               __FILE__, __LINE__);
+                free_variable_names(num_float_names, float_name);
+                return -1;
+            }
+            num_float_names++;
+        }
+    }
+
+    *num_names = num_float_names;
+    *name = float_name;
+    return 0;
+}
+
+/* convert variables that were float before an operation and that are now double back to float */
+static int restore_float_variables(harp_product *product, int num_names, char **name)
+{
+    int i;
+
+    for (i = 0; i < num_names; i++)
+    {
+        harp_variable *variable;
+
+        if (!harp_product_has_variable(product, name[i]))
+        {
+            continue;
+        }
+        if (harp_product_get_variable_by_name(product, name[i], &variable) != 0)
+        {
+            return -1;
+        }
+        if (variable->data_type == harp_type_double)
+        {
+            if (harp_variable_convert_data_type(variable, harp_type_float) != 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* total number of elements of all variables in the product (used for profiling) */
+static long get_num_elements(const harp_product *product)
+{
+    long num_elements = 0;
+    int i;
+
+    for (i = 0; i < product->num_variables; i++)
+    {
+        num_elements += product->variable[i]->num_elements;
+    }
+
+    return num_elements;
+}
+
+/* this will start with the operation at program->current_index */
+int harp_product_execute_program(harp_product *product, harp_program *program)
+{
+    char **float_variable_name = NULL;
+    int num_float_variables = 0;
+
+    while (program->current_index < program->num_operations)
+    {
+        harp_operation *operation = program->operation[program->current_index];
+        harp_profile_mark profile_mark;
+
+        if (harp_option_profiling)
+        {
+            harp_profile_start(program, get_num_elements(product), &profile_mark);
+        }
+
+        if (harp_get_option_preserve_float() && operation_promotes_float(operation))
+        {
+            if (get_float_variable_names(product, &num_float_variables, &float_variable_name) != 0)
+            {
+                goto error;
+            }
+        }
+
+        /* note that some consecutive filter operations can be executed together for optimization purposes */
+        /* so the filter functions below may increase program->current_index itself */
+        switch (operation->type)
+        {
+            case operation_bit_mask_filter:
+            case operation_comparison_filter:
+            case operation_longitude_range_filter:
+            case operation_membership_filter:
+            case operation_string_comparison_filter:
+            case operation_string_membership_filter:
+            case operation_valid_range_filter:
+                if (execute_value_filter(product, program) != 0)
+                {
+                    goto error;
+                }
+                break;
+            case operation_index_comparison_filter:
+            case operation_index_membership_filter:
+                if (execute_index_filter(product, program) != 0)
+                {
+                    goto error;
+                }
+                break;
+            case operation_point_distance_filter:
+            case operation_point_in_area_filter:
+                if (execute_point_filter(product, program) != 0)
+                {
+                    goto error;
+                }
+                break;
+            case operation_area_covers_area_filter:
+            case operation_area_covers_point_filter:
+            case operation_area_inside_area_filter:
+            case operation_area_intersects_area_filter:
+                if (execute_polygon_filter(product, program) != 0)
+                {
+                    goto error;
+                }
+                break;
+            case operation_collocation_filter:
+                if (execute_collocation_filter(product, (harp_operation_collocation_filter *)operation) != 0)
+                {
+                    goto error;
+                }
+                break;
+            case operation_bin_collocated:
+                if (execute_bin_collocated(product, (harp_operation_bin_collocated *)operation) != 0)
+                {
+                    goto error;
+                }
+                break;
+            case operation_bin_full:
+                if (harp_product_bin_full(product) != 0)
+                {
+                    goto error;
+                }
+                break;
+            case operation_bin_spatial:
+                if (execute_bin_spatial(product, (harp_operation_bin_spatial *)operation) != 0)
+                {
+                    goto error;
+                }
+                break;
+            case operation_bin_with_variables:
+                if (execute_bin_with_variables(product, (harp_operation_bin_with_variables *)operation) != 0)
+                {
+                    goto error;
+                }
+                break;
+            case operation_clamp:
+                if (execute_clamp(product, (harp_operation_clamp *)operation) != 0)
+                {
+                    goto error;
+                }
+                break;
+            case operation_derive_variable:
+                if (execute_derive_variable(product, (harp_operation_derive_variable *)operation) != 0)
+                {
+                    goto error;
                 }
                 break;
             case operation_derive_smoothed_column_collocated_dataset:
                 if (execute_derive_smoothed_column_collocated_dataset
                     (product, (harp_operation_derive_smoothed_column_collocated_dataset *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_derive_smoothed_column_collocated_product:
                 if (execute_derive_smoothed_column_collocated_product
                     (product, (harp_operation_derive_smoothed_column_collocated_product *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_exclude_variable:
                 if (execute_exclude_variable(product, (harp_operation_exclude_variable *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_flatten:
                 if (execute_flatten(product, (harp_operation_flatten *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_keep_variable:
                 if (execute_keep_variable(product, (harp_operation_keep_variable *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_rebin:
                 if (execute_rebin(product, (harp_operation_rebin *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_regrid:
                 if (execute_regrid(product, (harp_operation_regrid *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_regrid_collocated_dataset:
                 if (execute_regrid_collocated_dataset(product, (harp_operation_regrid_collocated_dataset *)operation) !=
                     0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_regrid_collocated_product:
                 if (execute_regrid_collocated_product(product, (harp_operation_regrid_collocated_product *)operation) !=
                     0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_rename:
                 if (execute_rename(product, (harp_operation_rename *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_set:
                 if (execute_set(product, (harp_operation_set *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_smooth_collocated_dataset:
                 if (execute_smooth_collocated_dataset(product, (harp_operation_smooth_collocated_dataset *)operation) !=
                     0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_smooth_collocated_product:
                 if (execute_smooth_collocated_product(product, (harp_operation_smooth_collocated_product *)operation) !=
                     0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_sort:
                 if (execute_sort(product, (harp_operation_sort *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_squash:
                 if (execute_squash(product, (harp_operation_squash *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
             case operation_wrap:
                 if (execute_wrap(product, (harp_operation_wrap *)operation) != 0)
                 {
-                    return -1;
+                    goto error;
                 }
                 break;
         }
 
+        if (float_variable_name != NULL)
+        {
+            if (restore_float_variables(product, num_float_variables, float_variable_name) != 0)
+            {
+                goto error;
+            }
+            free_variable_names(num_float_variables, float_variable_name);
+            float_variable_name = NULL;
+        }
+
+        if (harp_option_profiling)
+        {
+            if (harp_profile_stop(&profile_mark, program, 0, get_num_elements(product)) != 0)
+            {
+                goto error;
+            }
+        }
+
         if (harp_product_is_empty(product))
         {
             /* don't perform any of the remaining actions; just return the empty product */
@@ -1484,6 +2351,33 @@ int harp_product_execute_program(harp_product *product, harp_program *program)
         program->current_index++;
     }
 
+    return 0;
+
+  error:
+    if (float_variable_name != NULL)
+    {
+        free_variable_names(num_float_variables, float_variable_name);
+    }
+    return -1;
+}
+
+static int lookup_product_variable(void *user_data, const char *name, int *num_dimensions,
+                                   harp_dimension_type *dimension_type)
+{
+    harp_product *product = (harp_product *)user_data;
+    int i;
+
+    for (i = 0; i < product->num_variables; i++)
+    {
+        if (strcmp(product->variable[i]->name, name) == 0)
+        {
+            *num_dimensions = product->variable[i]->num_dimensions;
+            memcpy(dimension_type, product->variable[i]->dimension_type,
+                   *num_dimensions * sizeof(harp_dimension_type));
+            return 1;
+        }
+    }
+
     return 0;
 }
 
@@ -1522,6 +2416,12 @@ LIBHARP_API int harp_product_execute_operations(harp_product *product, const cha
         return -1;
     }
 
+    if (harp_program_optimize(program, lookup_product_variable, product) != 0)
+    {
+        harp_program_delete(program);
+        return -1;
+    }
+
     if (harp_product_execute_program(product, program) != 0)
     {
         harp_program_delete(program);
@@ -39,18 +39,26 @@ typedef struct harp_program_struct
 {
     int num_operations;
     harp_operation **operation;
+    int *operation_position;    /* position of each operation in the list of operations as specified by the user */
 
     /* state information used during execution of the program */
     int current_index;  /* index of operation that is next to be executed */
     /* initial global HARP options */
     int option_enable_aux_afgl86;
     int option_enable_aux_usstd76;
+    int option_preserve_float;
     int option_regrid_out_of_bounds;
 } harp_program;
 
 int harp_program_new(harp_program **new_program);
 void harp_program_delete(harp_program *program);
 int harp_program_add_operation(harp_program *program, harp_operation *operation);
+int harp_program_is_schema_only(const harp_program *program);
+
+/* Optimization */
+typedef int (*harp_program_variable_lookup)(void *user_data, const char *name, int *num_dimensions,
+                                            harp_dimension_type *dimension_type);
+int harp_program_optimize(harp_program *program, harp_program_variable_lookup lookup, void *user_data);
 
 /* Parser */
 int harp_program_from_string(const char *str, harp_program **new_program);
@@ -58,4 +66,19 @@ int harp_program_from_string(const char *str, harp_program **new_program);
 /* Execution */
 int harp_product_execute_program(harp_product *product, harp_program *program);
 
+/* Profiling (see harp_set_option_profiling()) */
+typedef struct harp_profile_mark_struct
+{
+    int index;  /* index of the first operation that is being profiled */
+    double wall_time;   /* wall clock time (in seconds) at the start of the operation */
+    long num_elements;  /* total number of variable elements before the operation */
+    uint64_t bytes_allocated;   /* cumulative amount of variable data allocated before the operation */
+    uint64_t bytes_freed;       /* cumulative amount of variable data released before the operation */
+} harp_profile_mark;
+
+void harp_profile_start(const harp_program *program, long num_elements, harp_profile_mark *mark);
+int harp_profile_stop(const harp_profile_mark *mark, const harp_program *program, int pushed_down,
+                      long num_elements);
+void harp_profile_done(void);
+
 #endif
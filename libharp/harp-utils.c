@@ -109,6 +109,22 @@ int harp_match_wildcard(const char *pattern, const char *name)
     }
 }
 
+/* returns 1 if the name matches any of the (wildcard) patterns, 0 otherwise */
+int harp_match_wildcard_list(int num_patterns, char **pattern, const char *name)
+{
+    int i;
+
+    for (i = 0; i < num_patterns; i++)
+    {
+        if (harp_match_wildcard(pattern[i], name))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
 static void clean_path(char *path)
 {
     int from;
@@ -1335,6 +1351,24 @@ void harp_array_replace_fill_value(harp_data_type data_type, long num_elements,
     }
 }
 
+/* exchange the contents of two non-overlapping memory regions of 'size' bytes */
+static void swap_bytes(uint8_t *a, uint8_t *b, long size)
+{
+    uint8_t buffer[256];
+
+    while (size > 0)
+    {
+        long chunk_size = size < (long)sizeof(buffer) ? size : (long)sizeof(buffer);
+
+        memcpy(buffer, a, chunk_size);
+        memcpy(a, b, chunk_size);
+        memcpy(b, buffer, chunk_size);
+        a += chunk_size;
+        b += chunk_size;
+        size -= chunk_size;
+    }
+}
+
 /** Invert the array across a given dimension
  * \param data_type Data type of the array.
  * \param dim_id Index of the dimension that should be inverted.
@@ -1437,29 +1471,170 @@ int harp_array_invert(harp_data_type data_type, int dim_id, int num_dimensions,
     }
     else
     {
-        uint8_t *buffer;
+        for (i = 0; i < num_elements; i++)
+        {
+            uint8_t *block = (uint8_t *)data.ptr + i * length * block_size;
+
+            for (j = 0; j < length / 2; j++)
+            {
+                swap_bytes(&block[j * block_size], &block[(length - 1 - j) * block_size], block_size);
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* tile size (in elements) for the cache-blocked transpose kernels */
+#define TRANSPOSE_BLOCK_SIZE 32
+
+/* dst[j * dst_stride + i] = src[i * src_stride + j] for i in [0,num_rows) and j in [0,num_columns) */
+static void transpose_2d_uint8(const uint8_t *src, long src_stride, uint8_t *dst, long dst_stride, long num_rows,
+                               long num_columns)
+{
+    long i0, j0, i, j;
+
+    for (i0 = 0; i0 < num_rows; i0 += TRANSPOSE_BLOCK_SIZE)
+    {
+        long i1 = i0 + TRANSPOSE_BLOCK_SIZE < num_rows ? i0 + TRANSPOSE_BLOCK_SIZE : num_rows;
 
-        buffer = (uint8_t *)malloc(length * block_size);
-        if (buffer == NULL)
+        for (j0 = 0; j0 < num_columns; j0 += TRANSPOSE_BLOCK_SIZE)
         {
-            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                           dimension[dim_id] * block_size, __FILE__, __LINE__);
-            return -1;
+            long j1 = j0 + TRANSPOSE_BLOCK_SIZE < num_columns ? j0 + TRANSPOSE_BLOCK_SIZE : num_columns;
+
+            for (i = i0; i < i1; i++)
+            {
+                for (j = j0; j < j1; j++)
+                {
+                    dst[j * dst_stride + i] = src[i * src_stride + j];
+                }
+            }
         }
-        for (i = 0; i < num_elements; i++)
+    }
+}
+
+static void transpose_2d_uint16(const uint16_t *src, long src_stride, uint16_t *dst, long dst_stride, long num_rows,
+                                long num_columns)
+{
+    long i0, j0, i, j;
+
+    for (i0 = 0; i0 < num_rows; i0 += TRANSPOSE_BLOCK_SIZE)
+    {
+        long i1 = i0 + TRANSPOSE_BLOCK_SIZE < num_rows ? i0 + TRANSPOSE_BLOCK_SIZE : num_rows;
+
+        for (j0 = 0; j0 < num_columns; j0 += TRANSPOSE_BLOCK_SIZE)
         {
-            int8_t *block = &data.int8_data[i * length * block_size];
+            long j1 = j0 + TRANSPOSE_BLOCK_SIZE < num_columns ? j0 + TRANSPOSE_BLOCK_SIZE : num_columns;
 
-            for (j = 0; j < length; j++)
+            for (i = i0; i < i1; i++)
             {
-                memcpy(&buffer[j * block_size], &block[(length - 1 - j) * block_size], block_size);
+                for (j = j0; j < j1; j++)
+                {
+                    dst[j * dst_stride + i] = src[i * src_stride + j];
+                }
             }
-            memcpy(block, buffer, length * block_size);
         }
-        free(buffer);
     }
+}
 
-    return 0;
+static void transpose_2d_uint32(const uint32_t *src, long src_stride, uint32_t *dst, long dst_stride, long num_rows,
+                                long num_columns)
+{
+    long i0, j0, i, j;
+
+    for (i0 = 0; i0 < num_rows; i0 += TRANSPOSE_BLOCK_SIZE)
+    {
+        long i1 = i0 + TRANSPOSE_BLOCK_SIZE < num_rows ? i0 + TRANSPOSE_BLOCK_SIZE : num_rows;
+
+        for (j0 = 0; j0 < num_columns; j0 += TRANSPOSE_BLOCK_SIZE)
+        {
+            long j1 = j0 + TRANSPOSE_BLOCK_SIZE < num_columns ? j0 + TRANSPOSE_BLOCK_SIZE : num_columns;
+
+            for (i = i0; i < i1; i++)
+            {
+                for (j = j0; j < j1; j++)
+                {
+                    dst[j * dst_stride + i] = src[i * src_stride + j];
+                }
+            }
+        }
+    }
+}
+
+static void transpose_2d_uint64(const uint64_t *src, long src_stride, uint64_t *dst, long dst_stride, long num_rows,
+                                long num_columns)
+{
+    long i0, j0, i, j;
+
+    for (i0 = 0; i0 < num_rows; i0 += TRANSPOSE_BLOCK_SIZE)
+    {
+        long i1 = i0 + TRANSPOSE_BLOCK_SIZE < num_rows ? i0 + TRANSPOSE_BLOCK_SIZE : num_rows;
+
+        for (j0 = 0; j0 < num_columns; j0 += TRANSPOSE_BLOCK_SIZE)
+        {
+            long j1 = j0 + TRANSPOSE_BLOCK_SIZE < num_columns ? j0 + TRANSPOSE_BLOCK_SIZE : num_columns;
+
+            for (i = i0; i < i1; i++)
+            {
+                for (j = j0; j < j1; j++)
+                {
+                    dst[j * dst_stride + i] = src[i * src_stride + j];
+                }
+            }
+        }
+    }
+}
+
+/* same as the typed kernels, but for elements of arbitrary size (in bytes) */
+static void transpose_2d_bytes(const uint8_t *src, long src_stride, uint8_t *dst, long dst_stride, long num_rows,
+                               long num_columns, long element_size)
+{
+    long i0, j0, i, j;
+
+    for (i0 = 0; i0 < num_rows; i0 += TRANSPOSE_BLOCK_SIZE)
+    {
+        long i1 = i0 + TRANSPOSE_BLOCK_SIZE < num_rows ? i0 + TRANSPOSE_BLOCK_SIZE : num_rows;
+
+        for (j0 = 0; j0 < num_columns; j0 += TRANSPOSE_BLOCK_SIZE)
+        {
+            long j1 = j0 + TRANSPOSE_BLOCK_SIZE < num_columns ? j0 + TRANSPOSE_BLOCK_SIZE : num_columns;
+
+            for (i = i0; i < i1; i++)
+            {
+                for (j = j0; j < j1; j++)
+                {
+                    memcpy(&dst[(j * dst_stride + i) * element_size], &src[(i * src_stride + j) * element_size],
+                           element_size);
+                }
+            }
+        }
+    }
+}
+
+static void transpose_2d(const uint8_t *src, long src_stride, uint8_t *dst, long dst_stride, long num_rows,
+                         long num_columns, long element_size)
+{
+    switch (element_size)
+    {
+        case 1:
+            transpose_2d_uint8(src, src_stride, dst, dst_stride, num_rows, num_columns);
+            break;
+        case 2:
+            transpose_2d_uint16((const uint16_t *)src, src_stride, (uint16_t *)dst, dst_stride, num_rows,
+                                num_columns);
+            break;
+        case 4:
+            transpose_2d_uint32((const uint32_t *)src, src_stride, (uint32_t *)dst, dst_stride, num_rows,
+                                num_columns);
+            break;
+        case 8:
+            transpose_2d_uint64((const uint64_t *)src, src_stride, (uint64_t *)dst, dst_stride, num_rows,
+                                num_columns);
+            break;
+        default:
+            transpose_2d_bytes(src, src_stride, dst, dst_stride, num_rows, num_columns, element_size);
+            break;
+    }
 }
 
 /** Permute the dimensions of an array.
@@ -1485,13 +1660,23 @@ int harp_array_invert(harp_data_type data_type, int dim_id, int num_dimensions,
 int harp_array_transpose(harp_data_type data_type, int num_dimensions, const long *dimension, const int *order,
                          harp_array data)
 {
-    long rindex[HARP_MAX_NUM_DIMS] = { 0 };     /* reversed index in multi-dimensional array */
-    long rdim[HARP_MAX_NUM_DIMS];       /* reversed order of dim[] */
-    long stride[HARP_MAX_NUM_DIMS];     /* stride in the destination array (in reverse order) */
+    int dst_order[HARP_MAX_NUM_DIMS];   /* map from destination dimension index to source dimension index */
+    long group_dim[HARP_MAX_NUM_DIMS];  /* length of the coalesced (source) dimensions */
+    int group_order[HARP_MAX_NUM_DIMS]; /* map from destination index to source index for the coalesced dimensions */
+    int group_start[HARP_MAX_NUM_DIMS]; /* first source dimension of each coalesced (destination) dimension */
+    int group_end[HARP_MAX_NUM_DIMS];   /* last source dimension of each coalesced (destination) dimension */
+    long src_stride[HARP_MAX_NUM_DIMS];
+    long dst_stride[HARP_MAX_NUM_DIMS];
+    long index[HARP_MAX_NUM_DIMS];
     long num_elements;
+    long num_batches = 1;
+    long batch_size;
     long element_size;
-    long index = 0;
-    long i;
+    long row_stride, column_stride;
+    int num_groups;
+    int row_dim, column_dim;
+    int i, j;
+    long b;
     uint8_t *src;
     uint8_t *dst;
 
@@ -1508,27 +1693,18 @@ int harp_array_transpose(harp_data_type data_type, int num_dimensions, const lon
         return 0;
     }
 
-    for (i = 0; i < num_dimensions; i++)
-    {
-        rdim[i] = dimension[num_dimensions - 1 - i];
-    }
-
     if (order == NULL)
     {
         /* By default, reverse the order of the dimensions. */
-        stride[num_dimensions - 1] = 1;
-        for (i = num_dimensions - 1; i > 0; i--)
+        for (i = 0; i < num_dimensions; i++)
         {
-            stride[i - 1] = stride[i] * rdim[i];
+            dst_order[i] = num_dimensions - 1 - i;
         }
     }
     else
     {
-        int iorder[HARP_MAX_NUM_DIMS] = { 0 };  /* map from destination dimension index to source dimension index */
+        int used[HARP_MAX_NUM_DIMS] = { 0 };
 
-        /* Compute the map from destination dimension index to source dimension index (i.e. the inverse of order, which
-         * is the map from source dimension index to destination dimension index.
-         */
         for (i = 0; i < num_dimensions; i++)
         {
             if (order[i] < 0 || order[i] >= num_dimensions)
@@ -1538,137 +1714,187 @@ int harp_array_transpose(harp_data_type data_type, int num_dimensions, const lon
                 return -1;
             }
 
-            if (iorder[order[i]] != 0)
+            if (used[order[i]])
             {
                 harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "duplicate dimension index '%d' at index %d of dimension "
                                "order (%s:%u)", order[i], i, __FILE__, __LINE__);
                 return -1;
             }
-
-            iorder[order[i]] = i;
+            used[order[i]] = 1;
+            dst_order[i] = order[i];
         }
+    }
 
-        /* Compute the stride in the destination array for each dimension of the source array in reverse order. For
-         * example, stride[0] is the stride in the destination array when moving along the fastest running dimension of
-         * the source array (i.e. the dimension with index num_dimensions - 1).
-         */
-        for (i = 0; i < num_dimensions; i++)
+    /* Coalesce source dimensions that remain adjacent (and in the same order) in the destination array, and skip
+     * dimensions of length 1 (which do not influence the memory layout).
+     */
+    num_groups = 0;
+    for (i = 0; i < num_dimensions; i++)
+    {
+        if (dimension[dst_order[i]] == 1)
+        {
+            continue;
+        }
+        if (num_groups > 0 && dst_order[i] > group_end[num_groups - 1])
         {
-            long j;
+            int k = dst_order[i] - 1;
+
+            /* source dimensions of length 1 in between can be ignored */
+            while (k > group_end[num_groups - 1] && dimension[k] == 1)
+            {
+                k--;
+            }
+            if (k == group_end[num_groups - 1])
+            {
+                group_dim[num_groups - 1] *= dimension[dst_order[i]];
+                group_end[num_groups - 1] = dst_order[i];
+                continue;
+            }
+        }
+        group_start[num_groups] = dst_order[i];
+        group_end[num_groups] = dst_order[i];
+        group_dim[num_groups] = dimension[dst_order[i]];
+        num_groups++;
+    }
 
-            stride[num_dimensions - 1 - i] = 1;
-            for (j = iorder[i] + 1; j < num_dimensions; j++)
+    /* determine the order of the coalesced dimensions in the source array */
+    for (i = 0; i < num_groups; i++)
+    {
+        group_order[i] = 0;
+        for (j = 0; j < num_groups; j++)
+        {
+            if (group_start[j] < group_start[i])
             {
-                stride[num_dimensions - 1 - i] *= dimension[order[j]];
+                group_order[i]++;
             }
         }
     }
+    /* group_order now maps destination index to source index; store the source dimension lengths in source order */
+    for (i = 0; i < num_groups; i++)
+    {
+        index[group_order[i]] = group_dim[i];
+    }
+    for (i = 0; i < num_groups; i++)
+    {
+        group_dim[i] = index[i];
+    }
 
     element_size = harp_get_size_for_type(data_type);
-    src = (uint8_t *)data.ptr;
 
-    dst = (uint8_t *)malloc(num_elements * element_size);
+    /* leading dimensions that stay in place can be processed as separate batches */
+    while (num_groups > 1 && group_order[0] == 0)
+    {
+        num_batches *= group_dim[0];
+        for (i = 1; i < num_groups; i++)
+        {
+            group_dim[i - 1] = group_dim[i];
+            group_order[i - 1] = group_order[i] - 1;
+        }
+        num_groups--;
+    }
+    /* trailing dimensions that stay in place can be moved as a single (larger) element */
+    while (num_groups > 1 && group_order[num_groups - 1] == num_groups - 1)
+    {
+        element_size *= group_dim[num_groups - 1];
+        num_groups--;
+    }
+    if (num_groups <= 1)
+    {
+        /* the permutation does not change the memory layout */
+        return 0;
+    }
+
+    /* strides (in elements) in the source and destination array for each (coalesced) source dimension */
+    src_stride[num_groups - 1] = 1;
+    for (i = num_groups - 1; i > 0; i--)
+    {
+        src_stride[i - 1] = src_stride[i] * group_dim[i];
+    }
+    {
+        long stride = 1;
+
+        for (i = num_groups - 1; i >= 0; i--)
+        {
+            dst_stride[group_order[i]] = stride;
+            stride *= group_dim[group_order[i]];
+        }
+    }
+
+    /* The transposition is performed as a series of 2D transpositions between the fastest running dimension of the
+     * source array (column_dim) and the source dimension that becomes the fastest running dimension of the destination
+     * array (row_dim). The remaining dimensions are iterated over.
+     */
+    column_dim = num_groups - 1;
+    row_dim = group_order[num_groups - 1];
+    assert(row_dim != column_dim);
+    row_stride = src_stride[row_dim];
+    column_stride = dst_stride[column_dim];
+    batch_size = num_elements * harp_get_size_for_type(data_type) / num_batches;
+
+    src = (uint8_t *)data.ptr;
+    dst = (uint8_t *)malloc(num_elements * harp_get_size_for_type(data_type));
     if (dst == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       num_elements * element_size, __FILE__, __LINE__);
+                       num_elements * harp_get_size_for_type(data_type), __FILE__, __LINE__);
         return -1;
     }
 
-    switch (element_size)
+    for (b = 0; b < num_batches; b++)
     {
-        case 1:
-            dst[index] = src[i];
-            index = stride[0];
-            rindex[0] = 1;
-            for (i = 1; i < num_elements; i++)
-            {
-                int j = 0;
+        long src_offset = 0;
+        long dst_offset = 0;
 
-                while (rindex[j] == rdim[j])
-                {
-                    rindex[j] = 0;
-                    index -= stride[j] * rdim[j];
-                    j++;
-                    index += stride[j];
-                    rindex[j]++;
-                }
-                dst[index] = src[i];
-                index += stride[0];
-                rindex[0]++;
-            }
-            break;
-        case 2:
-            ((uint16_t *)dst)[0] = ((uint16_t *)src)[0];
-            index = stride[0];
-            rindex[0] = 1;
-            for (i = 1; i < num_elements; i++)
-            {
-                int j = 0;
+        for (i = 0; i < num_groups; i++)
+        {
+            index[i] = 0;
+        }
+        for (;;)
+        {
+            transpose_2d(&src[(b * batch_size) + src_offset * element_size], row_stride,
+                         &dst[(b * batch_size) + dst_offset * element_size], column_stride, group_dim[row_dim],
+                         group_dim[column_dim], element_size);
 
-                while (rindex[j] == rdim[j])
+            /* advance to the next combination of the remaining dimensions */
+            for (i = num_groups - 1; i >= 0; i--)
+            {
+                if (i == row_dim || i == column_dim)
                 {
-                    rindex[j] = 0;
-                    index -= stride[j] * rdim[j];
-                    j++;
-                    index += stride[j];
-                    rindex[j]++;
+                    continue;
                 }
-                ((uint16_t *)dst)[index] = ((uint16_t *)src)[i];
-                index += stride[0];
-                rindex[0]++;
-            }
-            break;
-        case 4:
-            ((uint32_t *)dst)[0] = ((uint32_t *)src)[0];
-            index = stride[0];
-            rindex[0] = 1;
-            for (i = 1; i < num_elements; i++)
-            {
-                int j = 0;
-
-                while (rindex[j] == rdim[j])
+                index[i]++;
+                src_offset += src_stride[i];
+                dst_offset += dst_stride[i];
+                if (index[i] < group_dim[i])
                 {
-                    rindex[j] = 0;
-                    index -= stride[j] * rdim[j];
-                    j++;
-                    index += stride[j];
-                    rindex[j]++;
+                    break;
                 }
-                ((uint32_t *)dst)[index] = ((uint32_t *)src)[i];
-                index += stride[0];
-                rindex[0]++;
+                src_offset -= index[i] * src_stride[i];
+                dst_offset -= index[i] * dst_stride[i];
+                index[i] = 0;
             }
-            break;
-        case 8:
-            ((uint64_t *)dst)[0] = ((uint64_t *)src)[0];
-            index = stride[0];
-            rindex[0] = 1;
-            for (i = 1; i < num_elements; i++)
+            if (i < 0)
             {
-                long j = 0;
-
-                while (rindex[j] == rdim[j])
-                {
-                    rindex[j] = 0;
-                    index -= stride[j] * rdim[j];
-                    j++;
-                    index += stride[j];
-                    rindex[j]++;
-                }
-                ((uint64_t *)dst)[index] = ((uint64_t *)src)[i];
-                index += stride[0];
-                rindex[0]++;
+                break;
             }
-            break;
-        default:
-            assert(0);
-            exit(1);
+        }
     }
 
-    memcpy(data.ptr, dst, num_elements * element_size);
+    memcpy(data.ptr, dst, num_elements * harp_get_size_for_type(data_type));
 
     free(dst);
 
     return 0;
 }
+
+/* Transpose a [num_rows, num_columns] array from \a source into a [num_columns, num_rows] array in \a data.
+ * This is the out-of-place variant of harp_array_transpose() for two dimensions; the arrays should not overlap.
+ * It does not allocate memory, which makes it suitable for callers that transpose many small arrays and can reuse
+ * their own buffer.
+ */
+void harp_array_transpose_2d(harp_data_type data_type, long num_rows, long num_columns, harp_array source,
+                             harp_array data)
+{
+    transpose_2d((const uint8_t *)source.ptr, num_columns, (uint8_t *)data.ptr, num_rows, num_rows, num_columns,
+                 harp_get_size_for_type(data_type));
+}
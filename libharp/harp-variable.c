@@ -318,45 +318,25 @@ int harp_variable_set_enumeration_values_using_flag_meanings(harp_variable *vari
     return 0;
 }
 
-/** Rearrange the data of a variable in one dimension.
- * This function allows data of a variable to be rearranged according to the order of the indices in dim_element_id.
- * The number of indices (num_dim_elements) in dim_element_id does not have to correspond to the number of
- * elements in the specified (dim_index) dimension. This means that the data block will grow/shrink when the amount of
- * elements in dim_element_id is larger/smaller (note that the amount of elements can only become larger if elements
- * are duplicated).
- *
- * \param variable Pointer to variable that should have its data rearranged.
- * \param dim_index The id of the dimension in which the rearrangement should take place.
- * \param num_dim_elements Number of elements in dim_element_id.
- * \param dim_element_ids An array containing the ids in dimension dim_index in the new arrangement (ids may occur more
- * than once and the number of ids may be smaller or larger than the length of dimension dim_index).
- * \return
- *   \arg \c 0, Success.
- *   \arg \c -1, Error occurred (check #harp_errno).
+/* Precomputed rearrangement of a dimension, which can be applied to all variables that depend on that dimension */
+struct harp_rearrange_plan_struct
+{
+    long dimension_length;      /* original length of the dimension */
+    long num_dim_elements;      /* new length of the dimension */
+    long *dim_element_ids;      /* [num_dim_elements] original element for each new element */
+    long *move_to_id;   /* [dimension_length] first new element for each original element (-1 if not used) */
+    int needs_shuffle;  /* 0 if the rearrangement leaves the data untouched */
+};
+
+/* Create a plan for rearranging a dimension of length \a dimension_length according to \a dim_element_ids.
+ * See harp_variable_rearrange_dimension() for the meaning of the arguments.
  */
-int harp_variable_rearrange_dimension(harp_variable *variable, int dim_index, long num_dim_elements,
-                                      const long *dim_element_ids)
+int harp_rearrange_plan_new(long dimension_length, long num_dim_elements, const long *dim_element_ids,
+                            harp_rearrange_plan **new_plan)
 {
-    char *buffer;
-    long *move_to_id;
-    int8_t *moved;
-    long new_num_elements;
-    long num_groups;
-    long num_block_elements;
-    long element_size;
-    long filter_block_size;
-    long i_increment;
+    harp_rearrange_plan *plan;
     long i;
-    int needs_shuffle;
 
-    /* The multidimensional array is split in three parts:
-     *   num_elements = num_groups * dim[dim_index] * num_block_elements
-     *   new_num_elements = num_groups * num_dim_elements * num_block_elements */
-    if (variable == NULL)
-    {
-        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "variable is NULL (%s:%u)", __FILE__, __LINE__);
-        return -1;
-    }
     if (num_dim_elements <= 0)
     {
         harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "num_dim_elements argument <= 0 (%s:%u)", __FILE__, __LINE__);
@@ -367,293 +347,310 @@ int harp_variable_rearrange_dimension(harp_variable *variable, int dim_index, lo
         harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "dim_element_ids argument is NULL (%s:%u)", __FILE__, __LINE__);
         return -1;
     }
-    if (dim_index < 0 || dim_index >= variable->num_dimensions)
-    {
-        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "dim_index argument (%d) is not in the range [0,%d) (%s:%u)",
-                       dim_index, variable->num_dimensions, __FILE__, __LINE__);
-        return -1;
-    }
-    if (variable->num_elements == 0)
-    {
-        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "cannot reshape variable '%s' (variable has 0 elements) (%s:%u)",
-                       variable->name, __FILE__, __LINE__);
-        return -1;
-    }
-
-    needs_shuffle = num_dim_elements != variable->dimension[dim_index];
     for (i = 0; i < num_dim_elements; i++)
     {
-        if (dim_element_ids[i] < 0 || dim_element_ids[i] >= variable->dimension[dim_index])
+        if (dim_element_ids[i] < 0 || dim_element_ids[i] >= dimension_length)
         {
             harp_set_error(HARP_ERROR_INVALID_ARGUMENT,
                            "dim_element_ids[%d] argument (%d) is not in the range [0,%d) (%s:%u)",
-                           i, dim_element_ids[i], variable->dimension[dim_index], __FILE__, __LINE__);
+                           i, dim_element_ids[i], dimension_length, __FILE__, __LINE__);
             return -1;
         }
-        if (dim_element_ids[i] != i)
-        {
-            needs_shuffle = 1;
-        }
-    }
-    if (!needs_shuffle)
-    {
-        /* all ellements are already in the right location, don't do anything */
-        return 0;
     }
 
-    /* Calculate the number of times we have to reshuffle the indices (i.e. the product of the higher dimensions). */
-    num_groups = 1;
-    for (i = 0; i < (long)dim_index; i++)
+    plan = (harp_rearrange_plan *)malloc(sizeof(harp_rearrange_plan));
+    if (plan == NULL)
     {
-        num_groups *= variable->dimension[i];
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       sizeof(harp_rearrange_plan), __FILE__, __LINE__);
+        return -1;
     }
+    plan->dimension_length = dimension_length;
+    plan->num_dim_elements = num_dim_elements;
+    plan->dim_element_ids = NULL;
+    plan->move_to_id = NULL;
 
-    /* Calculate the number of elements per block - a block can be moved with one memcpy(). */
-    num_block_elements = variable->num_elements / (num_groups * variable->dimension[dim_index]);
-
-    /* Calculate the new total number of elements. */
-    new_num_elements = num_groups * num_dim_elements * num_block_elements;
-
-    /* Calculate the element size and block size */
-    element_size = harp_get_size_for_type(variable->data_type);
-    filter_block_size = num_block_elements * element_size;
-
-    /* If num_dim_elements > dimension[dim_index] then increase the memory for variable->data. */
-    if (num_dim_elements > variable->dimension[dim_index])
+    plan->dim_element_ids = (long *)malloc((size_t)num_dim_elements * sizeof(long));
+    if (plan->dim_element_ids == NULL)
     {
-        void *variable_data;
-
-        variable_data = realloc(variable->data.ptr, (size_t)new_num_elements * element_size);
-        if (variable_data == NULL)
-        {
-            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %u bytes) (%s:%u)",
-                           new_num_elements * element_size, __FILE__, __LINE__);
-            return -1;
-        }
-
-        variable->data.ptr = variable_data;
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_dim_elements * sizeof(long), __FILE__, __LINE__);
+        harp_rearrange_plan_delete(plan);
+        return -1;
     }
+    memcpy(plan->dim_element_ids, dim_element_ids, (size_t)num_dim_elements * sizeof(long));
 
     /* Determine the positions where the old elements should end up.
      * In case an element will end up in more than one position we determine the first. */
-    move_to_id = (long *)malloc((size_t)variable->dimension[dim_index] * sizeof(long));
-    if (move_to_id == NULL)
+    plan->move_to_id = (long *)malloc((size_t)dimension_length * sizeof(long));
+    if (plan->move_to_id == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       variable->dimension[dim_index] * sizeof(long), __FILE__, __LINE__);
+                       dimension_length * sizeof(long), __FILE__, __LINE__);
+        harp_rearrange_plan_delete(plan);
         return -1;
     }
-    for (i = 0; i < variable->dimension[dim_index]; i++)
+    for (i = 0; i < dimension_length; i++)
     {
-        move_to_id[i] = -1;     /* by default an element will be removed */
+        plan->move_to_id[i] = -1;       /* by default an element will be removed */
     }
+    plan->needs_shuffle = num_dim_elements != dimension_length;
     for (i = 0; i < num_dim_elements; i++)
     {
-        if (move_to_id[dim_element_ids[i]] == -1)
+        if (plan->move_to_id[dim_element_ids[i]] == -1)
+        {
+            plan->move_to_id[dim_element_ids[i]] = i;
+        }
+        if (dim_element_ids[i] != i)
         {
-            move_to_id[dim_element_ids[i]] = i;
+            plan->needs_shuffle = 1;
         }
     }
 
-    /* Temporary storage room for a block */
-    buffer = (char *)malloc((size_t)filter_block_size);
-    if (buffer == NULL)
+    *new_plan = plan;
+    return 0;
+}
+
+void harp_rearrange_plan_delete(harp_rearrange_plan *plan)
+{
+    if (plan == NULL)
     {
-        free(move_to_id);
-        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %u bytes) (%s:%u)",
-                       filter_block_size, __FILE__, __LINE__);
-        return -1;
+        return;
+    }
+    if (plan->dim_element_ids != NULL)
+    {
+        free(plan->dim_element_ids);
     }
+    if (plan->move_to_id != NULL)
+    {
+        free(plan->move_to_id);
+    }
+    free(plan);
+}
+
+/* Rearrange the data of a variable in one dimension using a precomputed plan.
+ * The data is gathered into a new buffer: each new element is copied directly from its original position.
+ */
+int harp_variable_rearrange_dimension_with_plan(harp_variable *variable, int dim_index, const harp_rearrange_plan *plan)
+{
+    const long *dim_element_ids = plan->dim_element_ids;
+    long num_dim_elements = plan->num_dim_elements;
+    long dimension_length;
+    long new_num_elements;
+    long num_groups;
+    long num_block_elements;
+    long element_size;
+    long block_size;
+    char *src;
+    char *dst;
+    long i, j;
 
-    /* Create temporary array that indicates whether a block has already been moved to its 'move_to_id' position */
-    moved = (int8_t *)malloc((size_t)variable->dimension[dim_index] * sizeof(int8_t));
-    if (moved == NULL)
+    /* The multidimensional array is split in three parts:
+     *   num_elements = num_groups * dim[dim_index] * num_block_elements
+     *   new_num_elements = num_groups * num_dim_elements * num_block_elements */
+    if (variable == NULL)
     {
-        free(move_to_id);
-        free(buffer);
-        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       variable->dimension[dim_index] * sizeof(int8_t), __FILE__, __LINE__);
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "variable is NULL (%s:%u)", __FILE__, __LINE__);
         return -1;
     }
-
-    /* Iterate over all groups */
-    /* we iterate backwards when the new data block (per group) is larger and iterate forwards otherwise */
-    if (new_num_elements > variable->num_elements)
+    if (dim_index < 0 || dim_index >= variable->num_dimensions)
     {
-        i_increment = -1;
-        i = num_groups - 1;
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "dim_index argument (%d) is not in the range [0,%d) (%s:%u)",
+                       dim_index, variable->num_dimensions, __FILE__, __LINE__);
+        return -1;
     }
-    else
+    if (variable->num_elements == 0)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "cannot reshape variable '%s' (variable has 0 elements) (%s:%u)",
+                       variable->name, __FILE__, __LINE__);
+        return -1;
+    }
+    dimension_length = variable->dimension[dim_index];
+    if (dimension_length != plan->dimension_length)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "dimension length (%ld) of variable '%s' does not match length "
+                       "(%ld) of rearrangement (%s:%u)", dimension_length, variable->name, plan->dimension_length,
+                       __FILE__, __LINE__);
+        return -1;
+    }
+    if (!plan->needs_shuffle)
     {
-        i_increment = 1;
-        i = 0;
+        /* all elements are already in the right location, don't do anything */
+        return 0;
     }
 
-    while (i >= 0 && i < num_groups)
+    /* Calculate the number of times we have to reshuffle the indices (i.e. the product of the higher dimensions). */
+    num_groups = 1;
+    for (i = 0; i < (long)dim_index; i++)
     {
-        char *from_ptr;
-        char *to_ptr;
-        long to_id;
+        num_groups *= variable->dimension[i];
+    }
 
-        from_ptr = (char *)variable->data.ptr + i * variable->dimension[dim_index] * filter_block_size;
-        to_ptr = (char *)variable->data.ptr + i * num_dim_elements * filter_block_size;
+    /* Calculate the number of elements per block - a block can be moved with one memcpy(). */
+    num_block_elements = variable->num_elements / (num_groups * dimension_length);
 
-        /* First move the old data to the new location */
-        if (to_ptr != from_ptr)
-        {
-            memmove(to_ptr, from_ptr, (size_t)(variable->dimension[dim_index] * filter_block_size));
-        }
+    /* Calculate the new total number of elements. */
+    new_num_elements = num_groups * num_dim_elements * num_block_elements;
 
-        /* remove all strings for blocks that will be removed */
-        if (variable->data_type == harp_type_string)
-        {
-            long j;
+    /* Calculate the element size and block size */
+    element_size = harp_get_size_for_type(variable->data_type);
+    block_size = num_block_elements * element_size;
 
-            for (j = 0; j < variable->dimension[dim_index]; j++)
-            {
-                if (move_to_id[j] == -1)
+    src = (char *)variable->data.ptr;
+    dst = (char *)harp_data_malloc((size_t)new_num_elements * element_size);
+    if (dst == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       new_num_elements * element_size, __FILE__, __LINE__);
+        return -1;
+    }
+
+    if (num_block_elements == 1)
+    {
+        /* gather single elements */
+        switch (element_size)
+        {
+            case 1:
+                for (i = 0; i < num_groups; i++)
                 {
-                    char **string_data;
-                    long k;
+                    const uint8_t *from = (uint8_t *)src + i * dimension_length;
+                    uint8_t *to = (uint8_t *)dst + i * num_dim_elements;
 
-                    string_data = (char **)&to_ptr[j * filter_block_size];
-                    for (k = 0; k < num_block_elements; k++)
+                    for (j = 0; j < num_dim_elements; j++)
                     {
-                        if (string_data[k] != NULL)
-                        {
-                            free(string_data[k]);
-                        }
+                        to[j] = from[dim_element_ids[j]];
                     }
                 }
-            }
-        }
-
-        /* Now do a reordering within the new space for the blocks */
-
-        /* Reset the 'moved' array */
-        memset(moved, 0, (size_t)variable->dimension[dim_index] * sizeof(int8_t));
-
-        /* Assign data to each block */
-        for (to_id = 0; to_id < num_dim_elements; to_id++)
-        {
-            long from_id = dim_element_ids[to_id];
-            int is_cycle = 0;
-            long k;
-
-            if (move_to_id[from_id] == to_id)
-            {
-                /* We already filled this block because of an earlier shuffle */
-                if (moved[from_id])
+                break;
+            case 2:
+                for (i = 0; i < num_groups; i++)
                 {
-                    continue;
+                    const uint16_t *from = (uint16_t *)src + i * dimension_length;
+                    uint16_t *to = (uint16_t *)dst + i * num_dim_elements;
+
+                    for (j = 0; j < num_dim_elements; j++)
+                    {
+                        to[j] = from[dim_element_ids[j]];
+                    }
                 }
-                /* The item is already in the right spot (and we don't have to duplicate strings) */
-                if (to_id == from_id)
+                break;
+            case 4:
+                for (i = 0; i < num_groups; i++)
                 {
-                    moved[from_id] = 1;
-                    continue;
-                }
-            }
+                    const uint32_t *from = (uint32_t *)src + i * dimension_length;
+                    uint32_t *to = (uint32_t *)dst + i * num_dim_elements;
 
-            /* Check if the data at the current position needs to be moved away first */
-            if (to_id < variable->dimension[dim_index] && move_to_id[to_id] != -1 && !moved[to_id])
-            {
-                /* We move the current data away recursively. However, we need to deal with possible cycles */
-                k = move_to_id[to_id];
-                while (k < variable->dimension[dim_index] && move_to_id[k] != -1 && !moved[k] && move_to_id[k] != to_id)
-                {
-                    k = move_to_id[k];
+                    for (j = 0; j < num_dim_elements; j++)
+                    {
+                        to[j] = from[dim_element_ids[j]];
+                    }
                 }
-
-                if (k < variable->dimension[dim_index] && move_to_id[k] == to_id)
+                break;
+            case 8:
+                for (i = 0; i < num_groups; i++)
                 {
-                    /* We have a cycle, so we use the temporary buffer */
-                    assert(k == from_id);
-                    memcpy(buffer, &to_ptr[from_id * filter_block_size], (size_t)filter_block_size);
-                    is_cycle = 1;
-                }
+                    const uint64_t *from = (uint64_t *)src + i * dimension_length;
+                    uint64_t *to = (uint64_t *)dst + i * num_dim_elements;
 
-                while (k != to_id)
-                {
-                    memcpy(&to_ptr[k * filter_block_size], &to_ptr[dim_element_ids[k] * filter_block_size],
-                           (size_t)filter_block_size);
-                    k = dim_element_ids[k];
-                    moved[k] = 1;
+                    for (j = 0; j < num_dim_elements; j++)
+                    {
+                        to[j] = from[dim_element_ids[j]];
+                    }
                 }
-            }
+                break;
+            default:
+                assert(0);
+                exit(1);
+        }
+    }
+    else
+    {
+        /* gather blocks */
+        for (i = 0; i < num_groups; i++)
+        {
+            const char *from = src + i * dimension_length * block_size;
+            char *to = dst + i * num_dim_elements * block_size;
 
-            /* Now copy the source data to the current position */
-            if (is_cycle)
+            for (j = 0; j < num_dim_elements; j++)
             {
-                /* we need to use the data from the temporary buffer if there was a cylce */
-                memcpy(&to_ptr[to_id * filter_block_size], buffer, (size_t)filter_block_size);
-                moved[from_id] = 1;
+                memcpy(&to[j * block_size], &from[dim_element_ids[j] * block_size], (size_t)block_size);
             }
-            else
+        }
+    }
+
+    if (variable->data_type == harp_type_string)
+    {
+        char **src_string = (char **)src;
+        char **dst_string = (char **)dst;
+        long k;
+
+        /* the first new element for each original element takes over the strings, all others get a copy */
+        for (i = 0; i < num_groups; i++)
+        {
+            for (j = 0; j < num_dim_elements; j++)
             {
-                if (moved[from_id])
+                if (plan->move_to_id[dim_element_ids[j]] == j)
+                {
+                    continue;
+                }
+                for (k = 0; k < num_block_elements; k++)
                 {
-                    /* this is a duplicate of another block (that has already been moved) */
-                    from_id = move_to_id[from_id];
-                    memcpy(&to_ptr[to_id * filter_block_size], &to_ptr[from_id * filter_block_size],
-                           (size_t)filter_block_size);
+                    long index = (i * num_dim_elements + j) * num_block_elements + k;
 
-                    if (variable->data_type == harp_type_string)
+                    if (dst_string[index] != NULL)
                     {
-                        char **string_data;
+                        char *str = strdup(dst_string[index]);
 
-                        /* duplicate all strings in the block */
-                        string_data = (char **)&to_ptr[to_id * filter_block_size];
-                        for (k = 0; k < num_block_elements; k++)
+                        if (str == NULL)
                         {
-                            if (string_data[k] != NULL)
+                            long last_index = index;
+
+                            /* remove the copies that were already made */
+                            for (index = 0; index < last_index; index++)
                             {
-                                string_data[k] = strdup(string_data[k]);
-                                if (string_data[k] == NULL)
+                                long id = (index / num_block_elements) % num_dim_elements;
+
+                                if (plan->move_to_id[dim_element_ids[id]] != id && dst_string[index] != NULL)
                                 {
-                                    free(moved);
-                                    free(buffer);
-                                    free(move_to_id);
-                                    harp_set_error(HARP_ERROR_OUT_OF_MEMORY,
-                                                   "out of memory (could not duplicate string) (%s:%u)", __FILE__,
-                                                   __LINE__);
-                                    return -1;
+                                    free(dst_string[index]);
                                 }
                             }
+                            harp_data_free(dst, (size_t)new_num_elements * element_size);
+                            harp_set_error(HARP_ERROR_OUT_OF_MEMORY,
+                                           "out of memory (could not duplicate string) (%s:%u)", __FILE__, __LINE__);
+                            return -1;
                         }
+                        dst_string[index] = str;
                     }
                 }
-                else
-                {
-                    memcpy(&to_ptr[to_id * filter_block_size], &to_ptr[from_id * filter_block_size],
-                           (size_t)filter_block_size);
-                    moved[from_id] = 1;
-                }
             }
         }
 
-        i += i_increment;
-    }
-
-    free(moved);
-    free(buffer);
-    free(move_to_id);
-
-    /* if num_dim_elements < dimension[dim_index] then make data block smaller */
-    if (num_dim_elements < variable->dimension[dim_index])
-    {
-        void *variable_data;
-
-        variable_data = realloc(variable->data.ptr, (size_t)new_num_elements * element_size);
-        if (variable_data == NULL)
+        /* remove all strings for the elements that get discarded */
+        for (i = 0; i < num_groups; i++)
         {
-            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %u bytes) (%s:%u)",
-                           new_num_elements * element_size, __FILE__, __LINE__);
-            return -1;
+            for (j = 0; j < dimension_length; j++)
+            {
+                if (plan->move_to_id[j] != -1)
+                {
+                    continue;
+                }
+                for (k = 0; k < num_block_elements; k++)
+                {
+                    long index = (i * dimension_length + j) * num_block_elements + k;
+
+                    if (src_string[index] != NULL)
+                    {
+                        free(src_string[index]);
+                    }
+                }
+            }
         }
-        variable->data.ptr = variable_data;
     }
 
+    harp_data_free(src, (size_t)variable->num_elements * element_size);
+    variable->data.ptr = dst;
+
     /* update variable properties */
     variable->num_elements = new_num_elements;
     variable->dimension[dim_index] = num_dim_elements;
@@ -661,34 +658,87 @@ int harp_variable_rearrange_dimension(harp_variable *variable, int dim_index, lo
     return 0;
 }
 
-/** Filter data of a variable in one dimension.
- * This function removes all elements in the given dimension where \a mask is set to 0.
- * The size of \a mask should correspond to the number of elements in the specified (dim_index) dimension.
- * The size of the given dimenion (and num_elements) will be reduced accordingly.
- * It is an error to provide a list of \a mask values that only contain zeros (i.e. filter out all elements).
+/** Rearrange the data of a variable in one dimension.
+ * This function allows data of a variable to be rearranged according to the order of the indices in dim_element_id.
+ * The number of indices (num_dim_elements) in dim_element_id does not have to correspond to the number of
+ * elements in the specified (dim_index) dimension. This means that the data block will grow/shrink when the amount of
+ * elements in dim_element_id is larger/smaller (note that the amount of elements can only become larger if elements
+ * are duplicated).
  *
  * \param variable Pointer to variable that should have its data rearranged.
  * \param dim_index The id of the dimension in which the rearrangement should take place.
- * \param mask An array of length variable->dimension[dim_index] that contains true/false (1/0) values on whether
- *     to keep an element or not.
+ * \param num_dim_elements Number of elements in dim_element_id.
+ * \param dim_element_ids An array containing the ids in dimension dim_index in the new arrangement (ids may occur more
+ * than once and the number of ids may be smaller or larger than the length of dimension dim_index).
  * \return
  *   \arg \c 0, Success.
  *   \arg \c -1, Error occurred (check #harp_errno).
  */
-int harp_variable_filter_dimension(harp_variable *variable, int dim_index, const uint8_t *mask)
+int harp_variable_rearrange_dimension(harp_variable *variable, int dim_index, long num_dim_elements,
+                                      const long *dim_element_ids)
 {
-    void *variable_data;
-    long num_dim_elements;
-    long new_num_elements;
-    long num_groups;
-    long num_block_elements;
-    long element_size;
-    long filter_block_size;
-    long i;
+    harp_rearrange_plan *plan;
 
-    /* The multidimensional array is split in three parts:
-     *   num_elements = num_groups * dim[dim_index] * num_block_elements
-     *   new_num_elements = num_groups * num_dim_elements * num_block_elements */
+    if (variable == NULL)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "variable is NULL (%s:%u)", __FILE__, __LINE__);
+        return -1;
+    }
+    if (dim_index < 0 || dim_index >= variable->num_dimensions)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "dim_index argument (%d) is not in the range [0,%d) (%s:%u)",
+                       dim_index, variable->num_dimensions, __FILE__, __LINE__);
+        return -1;
+    }
+    if (variable->num_elements == 0)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "cannot reshape variable '%s' (variable has 0 elements) (%s:%u)",
+                       variable->name, __FILE__, __LINE__);
+        return -1;
+    }
+
+    if (harp_rearrange_plan_new(variable->dimension[dim_index], num_dim_elements, dim_element_ids, &plan) != 0)
+    {
+        return -1;
+    }
+    if (harp_variable_rearrange_dimension_with_plan(variable, dim_index, plan) != 0)
+    {
+        harp_rearrange_plan_delete(plan);
+        return -1;
+    }
+    harp_rearrange_plan_delete(plan);
+
+    return 0;
+}
+
+/** Filter data of a variable in one dimension.
+ * This function removes all elements in the given dimension where \a mask is set to 0.
+ * The size of \a mask should correspond to the number of elements in the specified (dim_index) dimension.
+ * The size of the given dimenion (and num_elements) will be reduced accordingly.
+ * It is an error to provide a list of \a mask values that only contain zeros (i.e. filter out all elements).
+ *
+ * \param variable Pointer to variable that should have its data rearranged.
+ * \param dim_index The id of the dimension in which the rearrangement should take place.
+ * \param mask An array of length variable->dimension[dim_index] that contains true/false (1/0) values on whether
+ *     to keep an element or not.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+int harp_variable_filter_dimension(harp_variable *variable, int dim_index, const uint8_t *mask)
+{
+    void *variable_data;
+    long num_dim_elements;
+    long new_num_elements;
+    long num_groups;
+    long num_block_elements;
+    long element_size;
+    long filter_block_size;
+    long i;
+
+    /* The multidimensional array is split in three parts:
+     *   num_elements = num_groups * dim[dim_index] * num_block_elements
+     *   new_num_elements = num_groups * num_dim_elements * num_block_elements */
     if (variable == NULL)
     {
         harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "variable argument is NULL (%s:%u)", __FILE__, __LINE__);
@@ -750,28 +800,19 @@ int harp_variable_filter_dimension(harp_variable *variable, int dim_index, const
     {
         char *from_block_ptr = (char *)variable->data.ptr + i * variable->dimension[dim_index] * filter_block_size;
         char *to_block_ptr = (char *)variable->data.ptr + i * num_dim_elements * filter_block_size;
-        long from_id;
+        long from_id = 0;
         long to_id = 0;
 
-        for (from_id = 0; from_id < variable->dimension[dim_index]; from_id++)
+        while (from_id < variable->dimension[dim_index])
         {
-            char *from_ptr = &from_block_ptr[from_id * filter_block_size];
-            char *to_ptr = &to_block_ptr[to_id * filter_block_size];
+            long run_length = 0;
 
-            if (mask[from_id])
+            /* remove all strings for the items that get discarded */
+            while (from_id < variable->dimension[dim_index] && !mask[from_id])
             {
-                if (to_ptr != from_ptr)
-                {
-                    memmove(to_ptr, from_ptr, (size_t)(filter_block_size));
-                }
-                to_id++;
-            }
-            else
-            {
-                /* remove all strings for the items that get discarded */
                 if (variable->data_type == harp_type_string)
                 {
-                    char **string_data = (char **)from_ptr;
+                    char **string_data = (char **)&from_block_ptr[from_id * filter_block_size];
                     long k;
 
                     for (k = 0; k < num_block_elements; k++)
@@ -782,11 +823,31 @@ int harp_variable_filter_dimension(harp_variable *variable, int dim_index, const
                         }
                     }
                 }
+                from_id++;
+            }
+
+            /* move each run of consecutive items that are kept with a single memmove */
+            while (from_id + run_length < variable->dimension[dim_index] && mask[from_id + run_length])
+            {
+                run_length++;
+            }
+            if (run_length > 0)
+            {
+                char *from_ptr = &from_block_ptr[from_id * filter_block_size];
+                char *to_ptr = &to_block_ptr[to_id * filter_block_size];
+
+                if (to_ptr != from_ptr)
+                {
+                    memmove(to_ptr, from_ptr, (size_t)(run_length * filter_block_size));
+                }
+                from_id += run_length;
+                to_id += run_length;
             }
         }
     }
 
-    variable_data = realloc(variable->data.ptr, (size_t)new_num_elements * element_size);
+    variable_data = harp_data_realloc(variable->data.ptr, (size_t)variable->num_elements * element_size,
+                                      (size_t)new_num_elements * element_size);
     if (variable_data == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %u bytes) (%s:%u)",
@@ -886,7 +947,8 @@ int harp_variable_resize_dimension(harp_variable *variable, int dim_index, long
         }
     }
 
-    data = realloc(variable->data.ptr, (size_t)new_num_elements * element_size);
+    data = harp_data_realloc(variable->data.ptr, (size_t)variable->num_elements * element_size,
+                             (size_t)new_num_elements * element_size);
     if (data == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY,
@@ -1035,7 +1097,8 @@ int harp_variable_add_dimension(harp_variable *variable, int dim_index, harp_dim
 
     new_num_elements = num_blocks * length * num_block_elements;
 
-    data = realloc(variable->data.ptr, (size_t)new_num_elements * element_size);
+    data = harp_data_realloc(variable->data.ptr, (size_t)variable->num_elements * element_size,
+                             (size_t)new_num_elements * element_size);
     if (data == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
@@ -1207,24 +1270,9 @@ int harp_variable_squash_dimension(harp_variable *variable, int dim_index)
     return harp_variable_remove_dimension(variable, dim_index, 0);
 }
 
-/** \addtogroup harp_variable
- * @{
- */
-
-/** Create new variable.
- * \param name Name of the variable.
- * \param data_type Storage type of the variable data.
- * \param num_dimensions Number of array dimensions (use '0' for scalar data).
- * \param dimension_type Array with the dimension type for each of the dimensions.
- * \param dimension Array with length for each of the dimensions.
- * \param new_variable Pointer to the C variable where the new HARP variable will be stored.
- * \return
- *   \arg \c 0, Success.
- *   \arg \c -1, Error occurred (check #harp_errno).
- */
-LIBHARP_API int harp_variable_new(const char *name, harp_data_type data_type, int num_dimensions,
-                                  const harp_dimension_type *dimension_type, const long *dimension,
-                                  harp_variable **new_variable)
+static int variable_new(const char *name, harp_data_type data_type, int num_dimensions,
+                        const harp_dimension_type *dimension_type, const long *dimension, int with_data,
+                        harp_variable **new_variable)
 {
     harp_variable *variable;
     int i;
@@ -1307,15 +1355,17 @@ LIBHARP_API int harp_variable_new(const char *name, harp_data_type data_type, in
         return -1;
     }
 
-    variable->data.ptr = malloc((size_t)variable->num_elements * harp_get_size_for_type(data_type));
-    if (variable->data.ptr == NULL)
+    if (with_data)
     {
-        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                       variable->num_elements * harp_get_size_for_type(data_type), __FILE__, __LINE__);
-        harp_variable_delete(variable);
-        return -1;
+        variable->data.ptr = harp_data_calloc((size_t)variable->num_elements * harp_get_size_for_type(data_type));
+        if (variable->data.ptr == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           variable->num_elements * harp_get_size_for_type(data_type), __FILE__, __LINE__);
+            harp_variable_delete(variable);
+            return -1;
+        }
     }
-    memset(variable->data.ptr, 0, (size_t)variable->num_elements * harp_get_size_for_type(data_type));
 
     if (data_type != harp_type_string)
     {
@@ -1327,6 +1377,63 @@ LIBHARP_API int harp_variable_new(const char *name, harp_data_type data_type, in
     return 0;
 }
 
+/* Create a variable that only describes name, type, and dimensions; no data block is allocated (data.ptr is NULL).
+ * Such variables are used for schema-only imports and must not be passed to functions that access the data.
+ */
+int harp_variable_new_without_data(const char *name, harp_data_type data_type, int num_dimensions,
+                                   const harp_dimension_type *dimension_type, const long *dimension,
+                                   harp_variable **new_variable)
+{
+    return variable_new(name, data_type, num_dimensions, dimension_type, dimension, 0, new_variable);
+}
+
+/* Release the data of a variable, turning it into a variable without data (data.ptr is NULL).
+ * All other properties (name, dimensions, attributes) are kept.
+ */
+void harp_variable_free_data(harp_variable *variable)
+{
+    if (variable->data.ptr == NULL)
+    {
+        return;
+    }
+    if (variable->data_type == harp_type_string)
+    {
+        long i;
+
+        for (i = 0; i < variable->num_elements; i++)
+        {
+            if (variable->data.string_data[i] != NULL)
+            {
+                free(variable->data.string_data[i]);
+            }
+        }
+    }
+    harp_data_free(variable->data.ptr, (size_t)variable->num_elements * harp_get_size_for_type(variable->data_type));
+    variable->data.ptr = NULL;
+}
+
+/** \addtogroup harp_variable
+ * @{
+ */
+
+/** Create new variable.
+ * \param name Name of the variable.
+ * \param data_type Storage type of the variable data.
+ * \param num_dimensions Number of array dimensions (use '0' for scalar data).
+ * \param dimension_type Array with the dimension type for each of the dimensions.
+ * \param dimension Array with length for each of the dimensions.
+ * \param new_variable Pointer to the C variable where the new HARP variable will be stored.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_variable_new(const char *name, harp_data_type data_type, int num_dimensions,
+                                  const harp_dimension_type *dimension_type, const long *dimension,
+                                  harp_variable **new_variable)
+{
+    return variable_new(name, data_type, num_dimensions, dimension_type, dimension, 1, new_variable);
+}
+
 /** Delete variable.
  * Remove variable and all attached attributes.
  * \param variable HARP variable
@@ -1341,22 +1448,7 @@ LIBHARP_API void harp_variable_delete(harp_variable *variable)
     {
         free(variable->name);
     }
-    if (variable->data.ptr != NULL)
-    {
-        if (variable->data_type == harp_type_string)
-        {
-            long i;
-
-            for (i = 0; i < variable->num_elements; i++)
-            {
-                if (variable->data.string_data[i] != NULL)
-                {
-                    free(variable->data.string_data[i]);
-                }
-            }
-        }
-        free(variable->data.ptr);
-    }
+    harp_variable_free_data(variable);
     if (variable->description != NULL)
     {
         free(variable->description);
@@ -1476,7 +1568,8 @@ LIBHARP_API int harp_variable_copy(const harp_variable *other_variable, harp_var
         }
     }
 
-    variable->data.ptr = malloc((size_t)variable->num_elements * harp_get_size_for_type(variable->data_type));
+    variable->data.ptr = harp_data_malloc((size_t)variable->num_elements *
+                                          harp_get_size_for_type(variable->data_type));
     if (variable->data.ptr == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
@@ -1610,7 +1703,8 @@ LIBHARP_API int harp_variable_append(harp_variable *variable, const harp_variabl
 
     element_size = harp_get_size_for_type(variable->data_type);
     new_num_elements = variable->num_elements + other_variable->num_elements;
-    data = realloc(variable->data.ptr, (size_t)new_num_elements * element_size);
+    data = harp_data_realloc(variable->data.ptr, (size_t)variable->num_elements * element_size,
+                             (size_t)new_num_elements * element_size);
     if (data == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
@@ -1926,440 +2020,481 @@ LIBHARP_API int harp_variable_set_string_data_element(harp_variable *variable, l
     return 0;
 }
 
-/** Convert the data for the variable such that it matches the given data type.
- * The memory for the block holding the data for the attribute will be resized to match the new data type if needed.
- * You cannot convert string data to numeric data or vice-versa. Conversion from floating point to integer data (or
- * vice versa) is allowed though.
- * \param variable Variable whose data should be aligned with the given data type.
- * \param target_data_type Data type to which the data for the variable should be converted.
- * \return
- *   \arg \c 0, Success.
- *   \arg \c -1, Error occurred (check #harp_errno).
- */
-LIBHARP_API int harp_variable_convert_data_type(harp_variable *variable, harp_data_type target_data_type)
+/* number of elements that are converted at once when changing the data type of a variable */
+#define CONVERT_CHUNK_SIZE 1024
+
+static void convert_elements_to_int8(harp_data_type data_type, const void *source, int8_t *target, long num_elements)
 {
-    harp_scalar valid_min;
-    harp_scalar valid_max;
-    harp_array data;
-    int i;
+    long i;
 
-    if (variable == NULL)
+    switch (data_type)
     {
-        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "variable is NULL (%s:%u)", __FILE__, __LINE__);
-        return -1;
-    }
+        case harp_type_int16:
+            {
+                const int16_t *value = (const int16_t *)source;
 
-    if (variable->data_type == target_data_type)
-    {
-        /* no conversion */
-        return 0;
-    }
-    if (variable->data_type == harp_type_string)
-    {
-        harp_set_error(HARP_ERROR_INVALID_ARGUMENT,
-                       "conversion from string to numerical value is not possible for variable '%s'", variable->name);
-        return -1;
-    }
-    if (target_data_type == harp_type_string)
-    {
-        harp_set_error(HARP_ERROR_INVALID_ARGUMENT,
-                       "conversion from numerical value to string is not possible for variable '%s'", variable->name);
-        return -1;
-    }
-    if (variable->num_elements == 0 || variable->data.ptr == NULL)
-    {
-        /* nothing to convert */
-        variable->data_type = target_data_type;
-        return 0;
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int8_t)value[i];
+                }
+            }
+            break;
+        case harp_type_int32:
+            {
+                const int32_t *value = (const int32_t *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int8_t)value[i];
+                }
+            }
+            break;
+        case harp_type_float:
+            {
+                const float *value = (const float *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int8_t)value[i];
+                }
+            }
+            break;
+        case harp_type_double:
+            {
+                const double *value = (const double *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int8_t)value[i];
+                }
+            }
+            break;
+        default:
+            assert(0);
+            exit(1);
     }
+}
 
-    valid_min = harp_get_valid_min_for_type(target_data_type);
-    valid_max = harp_get_valid_max_for_type(target_data_type);
+static void convert_elements_to_int16(harp_data_type data_type, const void *source, int16_t *target, long num_elements)
+{
+    long i;
 
-    switch (target_data_type)
+    switch (data_type)
     {
         case harp_type_int8:
-            data.ptr = malloc((size_t)variable->num_elements * sizeof(int8_t));
-            if (data.ptr == NULL)
             {
-                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                               variable->num_elements * sizeof(int8_t), __FILE__, __LINE__);
-                return -1;
+                const int8_t *value = (const int8_t *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int16_t)value[i];
+                }
             }
-            switch (variable->data_type)
+            break;
+        case harp_type_int32:
             {
-                case harp_type_int16:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int8_data[i] = (int8_t)variable->data.int16_data[i];
-                    }
-                    if (variable->valid_min.int16_data < valid_min.int8_data)
-                    {
-                        variable->valid_min = valid_min;
-                    }
-                    else
-                    {
-                        variable->valid_min.int8_data = (int8_t)variable->valid_min.int16_data;
-                    }
-                    if (variable->valid_max.int16_data > valid_max.int8_data)
-                    {
-                        variable->valid_max = valid_max;
-                    }
-                    else
-                    {
-                        variable->valid_max.int8_data = (int8_t)variable->valid_max.int16_data;
-                    }
-                    break;
-                case harp_type_int32:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int8_data[i] = (int8_t)variable->data.int32_data[i];
-                    }
-                    if (variable->valid_min.int32_data < valid_min.int8_data)
-                    {
-                        variable->valid_min = valid_min;
-                    }
-                    else
-                    {
-                        variable->valid_min.int8_data = (int8_t)variable->valid_min.int32_data;
-                    }
-                    if (variable->valid_max.int32_data > valid_max.int8_data)
-                    {
-                        variable->valid_max = valid_max;
-                    }
-                    else
-                    {
-                        variable->valid_max.int8_data = (int8_t)variable->valid_max.int32_data;
-                    }
-                    break;
-                case harp_type_float:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int8_data[i] = (int8_t)variable->data.float_data[i];
-                    }
-                    if (variable->valid_min.float_data < valid_min.int8_data)
-                    {
-                        variable->valid_min = valid_min;
-                    }
-                    else
-                    {
-                        variable->valid_min.int8_data = (int8_t)variable->valid_min.float_data;
-                    }
-                    if (variable->valid_max.float_data > valid_max.int8_data)
-                    {
-                        variable->valid_max = valid_max;
-                    }
-                    else
-                    {
-                        variable->valid_max.int8_data = (int8_t)variable->valid_max.float_data;
-                    }
-                    break;
-                case harp_type_double:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int8_data[i] = (int8_t)variable->data.double_data[i];
-                    }
-                    if (variable->valid_min.double_data < valid_min.int8_data)
-                    {
-                        variable->valid_min = valid_min;
-                    }
-                    else
-                    {
-                        variable->valid_min.int8_data = (int8_t)variable->valid_min.double_data;
-                    }
-                    if (variable->valid_max.double_data > valid_max.int8_data)
-                    {
-                        variable->valid_max = valid_max;
-                    }
-                    else
-                    {
-                        variable->valid_max.int8_data = (int8_t)variable->valid_max.double_data;
-                    }
-                    break;
-                default:
-                    assert(0);
-                    exit(1);
+                const int32_t *value = (const int32_t *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int16_t)value[i];
+                }
             }
             break;
-        case harp_type_int16:
-            data.ptr = malloc((size_t)variable->num_elements * sizeof(int16_t));
-            if (data.ptr == NULL)
+        case harp_type_float:
             {
-                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                               variable->num_elements * sizeof(int16_t), __FILE__, __LINE__);
-                return -1;
+                const float *value = (const float *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int16_t)value[i];
+                }
             }
-            switch (variable->data_type)
+            break;
+        case harp_type_double:
             {
-                case harp_type_int8:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int16_data[i] = (int16_t)variable->data.int8_data[i];
-                    }
-                    variable->valid_min.int16_data = (int16_t)variable->valid_min.int8_data;
-                    variable->valid_max.int16_data = (int16_t)variable->valid_max.int8_data;
-                    break;
-                case harp_type_int32:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int16_data[i] = (int16_t)variable->data.int32_data[i];
-                    }
-                    if (variable->valid_min.int32_data < valid_min.int16_data)
-                    {
-                        variable->valid_min = valid_min;
-                    }
-                    else
-                    {
-                        variable->valid_min.int16_data = (int16_t)variable->valid_min.int32_data;
-                    }
-                    if (variable->valid_max.int32_data > valid_max.int16_data)
-                    {
-                        variable->valid_max = valid_max;
-                    }
-                    else
-                    {
-                        variable->valid_max.int16_data = (int16_t)variable->valid_max.int32_data;
-                    }
-                    break;
-                case harp_type_float:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int16_data[i] = (int16_t)variable->data.float_data[i];
-                    }
-                    if (variable->valid_min.float_data < valid_min.int16_data)
-                    {
-                        variable->valid_min = valid_min;
-                    }
-                    else
-                    {
-                        variable->valid_min.int16_data = (int16_t)variable->valid_min.float_data;
-                    }
-                    if (variable->valid_max.float_data > valid_max.int16_data)
-                    {
-                        variable->valid_max = valid_max;
-                    }
-                    else
-                    {
-                        variable->valid_max.int16_data = (int16_t)variable->valid_max.float_data;
-                    }
-                    break;
-                case harp_type_double:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int16_data[i] = (int16_t)variable->data.double_data[i];
-                    }
-                    if (variable->valid_min.double_data < valid_min.int16_data)
-                    {
-                        variable->valid_min = valid_min;
-                    }
-                    else
-                    {
-                        variable->valid_min.int16_data = (int16_t)variable->valid_min.double_data;
-                    }
-                    if (variable->valid_max.double_data > valid_max.int16_data)
-                    {
-                        variable->valid_max = valid_max;
-                    }
-                    else
-                    {
-                        variable->valid_max.int16_data = (int16_t)variable->valid_max.double_data;
-                    }
-                    break;
-                default:
-                    assert(0);
-                    exit(1);
+                const double *value = (const double *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int16_t)value[i];
+                }
             }
             break;
-        case harp_type_int32:
-            data.ptr = malloc((size_t)variable->num_elements * sizeof(int32_t));
-            if (data.ptr == NULL)
+        default:
+            assert(0);
+            exit(1);
+    }
+}
+
+static void convert_elements_to_int32(harp_data_type data_type, const void *source, int32_t *target, long num_elements)
+{
+    long i;
+
+    switch (data_type)
+    {
+        case harp_type_int8:
             {
-                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                               variable->num_elements * sizeof(int32_t), __FILE__, __LINE__);
-                return -1;
+                const int8_t *value = (const int8_t *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int32_t)value[i];
+                }
             }
-            switch (variable->data_type)
+            break;
+        case harp_type_int16:
             {
-                case harp_type_int8:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int32_data[i] = (int32_t)variable->data.int8_data[i];
-                    }
-                    variable->valid_min.int32_data = (int32_t)variable->valid_min.int8_data;
-                    variable->valid_max.int32_data = (int32_t)variable->valid_max.int8_data;
-                    break;
-                case harp_type_int16:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int32_data[i] = (int32_t)variable->data.int16_data[i];
-                    }
-                    variable->valid_min.int32_data = (int32_t)variable->valid_min.int16_data;
-                    variable->valid_max.int32_data = (int32_t)variable->valid_max.int16_data;
-                    break;
-                case harp_type_float:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int32_data[i] = (int32_t)variable->data.float_data[i];
-                    }
-                    if (variable->valid_min.float_data < valid_min.int32_data)
-                    {
-                        variable->valid_min = valid_min;
-                    }
-                    else
-                    {
-                        variable->valid_min.int32_data = (int32_t)variable->valid_min.float_data;
-                    }
-                    if (variable->valid_max.float_data > valid_max.int32_data)
-                    {
-                        variable->valid_max = valid_max;
-                    }
-                    else
-                    {
-                        variable->valid_max.int32_data = (int32_t)variable->valid_max.float_data;
-                    }
-                    break;
-                case harp_type_double:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.int32_data[i] = (int32_t)variable->data.double_data[i];
-                    }
-                    if (variable->valid_min.double_data < valid_min.int32_data)
-                    {
-                        variable->valid_min = valid_min;
-                    }
-                    else
-                    {
-                        variable->valid_min.int32_data = (int32_t)variable->valid_min.double_data;
-                    }
-                    if (variable->valid_max.double_data > valid_max.int32_data)
-                    {
-                        variable->valid_max = valid_max;
-                    }
-                    else
-                    {
-                        variable->valid_max.int32_data = (int32_t)variable->valid_max.double_data;
-                    }
-                    break;
-                default:
-                    assert(0);
-                    exit(1);
+                const int16_t *value = (const int16_t *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int32_t)value[i];
+                }
             }
             break;
         case harp_type_float:
-            data.ptr = malloc((size_t)variable->num_elements * sizeof(float));
-            if (data.ptr == NULL)
             {
-                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                               variable->num_elements * sizeof(float), __FILE__, __LINE__);
-                return -1;
+                const float *value = (const float *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int32_t)value[i];
+                }
             }
-            switch (variable->data_type)
+            break;
+        case harp_type_double:
             {
-                case harp_type_int8:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.float_data[i] = (float)variable->data.int8_data[i];
-                    }
-                    variable->valid_min.float_data = (float)variable->valid_min.int8_data;
-                    variable->valid_max.float_data = (float)variable->valid_max.int8_data;
-                    break;
-                case harp_type_int16:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.float_data[i] = (float)variable->data.int16_data[i];
-                    }
-                    variable->valid_min.float_data = (float)variable->valid_min.int16_data;
-                    variable->valid_max.float_data = (float)variable->valid_max.int16_data;
-                    break;
-                case harp_type_int32:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.float_data[i] = (float)variable->data.int32_data[i];
-                    }
-                    variable->valid_min.float_data = (float)variable->valid_min.int32_data;
-                    variable->valid_max.float_data = (float)variable->valid_max.int32_data;
-                    break;
-                case harp_type_double:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.float_data[i] = (float)variable->data.double_data[i];
-                    }
-                    if (variable->valid_min.double_data < valid_min.float_data)
-                    {
-                        variable->valid_min = valid_min;
-                    }
-                    else
-                    {
-                        variable->valid_min.float_data = (float)variable->valid_min.double_data;
-                    }
-                    if (variable->valid_max.double_data > valid_max.float_data)
-                    {
-                        variable->valid_max = valid_max;
-                    }
-                    else
-                    {
-                        variable->valid_max.float_data = (float)variable->valid_max.double_data;
-                    }
-                    break;
-                default:
-                    assert(0);
-                    exit(1);
+                const double *value = (const double *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (int32_t)value[i];
+                }
+            }
+            break;
+        default:
+            assert(0);
+            exit(1);
+    }
+}
+
+static void convert_elements_to_float(harp_data_type data_type, const void *source, float *target, long num_elements)
+{
+    long i;
+
+    switch (data_type)
+    {
+        case harp_type_int8:
+            {
+                const int8_t *value = (const int8_t *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (float)value[i];
+                }
+            }
+            break;
+        case harp_type_int16:
+            {
+                const int16_t *value = (const int16_t *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (float)value[i];
+                }
+            }
+            break;
+        case harp_type_int32:
+            {
+                const int32_t *value = (const int32_t *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (float)value[i];
+                }
             }
             break;
         case harp_type_double:
-            data.ptr = malloc((size_t)variable->num_elements * sizeof(double));
-            if (data.ptr == NULL)
             {
-                harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
-                               variable->num_elements * sizeof(double), __FILE__, __LINE__);
-                return -1;
+                const double *value = (const double *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (float)value[i];
+                }
             }
-            switch (variable->data_type)
+            break;
+        default:
+            assert(0);
+            exit(1);
+    }
+}
+
+static void convert_elements_to_double(harp_data_type data_type, const void *source, double *target, long num_elements)
+{
+    long i;
+
+    switch (data_type)
+    {
+        case harp_type_int8:
             {
-                case harp_type_int8:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.double_data[i] = (double)variable->data.int8_data[i];
-                    }
-                    variable->valid_min.double_data = (double)variable->valid_min.int8_data;
-                    variable->valid_max.double_data = (double)variable->valid_max.int8_data;
-                    break;
-                case harp_type_int16:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.double_data[i] = (double)variable->data.int16_data[i];
-                    }
-                    variable->valid_min.double_data = (double)variable->valid_min.int16_data;
-                    variable->valid_max.double_data = (double)variable->valid_max.int16_data;
-                    break;
-                case harp_type_int32:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.double_data[i] = (double)variable->data.int32_data[i];
-                    }
-                    variable->valid_min.double_data = (double)variable->valid_min.int32_data;
-                    variable->valid_max.double_data = (double)variable->valid_max.int32_data;
-                    break;
-                case harp_type_float:
-                    for (i = 0; i < variable->num_elements; i++)
-                    {
-                        data.double_data[i] = (double)variable->data.float_data[i];
-                    }
-                    variable->valid_min.double_data = (double)variable->valid_min.float_data;
-                    variable->valid_max.double_data = (double)variable->valid_max.float_data;
-                    break;
-                default:
-                    assert(0);
-                    exit(1);
+                const int8_t *value = (const int8_t *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (double)value[i];
+                }
+            }
+            break;
+        case harp_type_int16:
+            {
+                const int16_t *value = (const int16_t *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (double)value[i];
+                }
+            }
+            break;
+        case harp_type_int32:
+            {
+                const int32_t *value = (const int32_t *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (double)value[i];
+                }
             }
             break;
+        case harp_type_float:
+            {
+                const float *value = (const float *)source;
+
+                for (i = 0; i < num_elements; i++)
+                {
+                    target[i] = (double)value[i];
+                }
+            }
+            break;
+        default:
+            assert(0);
+            exit(1);
+    }
+}
+
+/* convert \a num_elements values of type \a data_type from \a source to \a target_data_type values in \a target
+ * (\a source and \a target should not overlap) */
+static void convert_elements(harp_data_type data_type, const void *source, harp_data_type target_data_type,
+                             void *target, long num_elements)
+{
+    switch (target_data_type)
+    {
+        case harp_type_int8:
+            convert_elements_to_int8(data_type, source, (int8_t *)target, num_elements);
+            break;
+        case harp_type_int16:
+            convert_elements_to_int16(data_type, source, (int16_t *)target, num_elements);
+            break;
+        case harp_type_int32:
+            convert_elements_to_int32(data_type, source, (int32_t *)target, num_elements);
+            break;
+        case harp_type_float:
+            convert_elements_to_float(data_type, source, (float *)target, num_elements);
+            break;
+        case harp_type_double:
+            convert_elements_to_double(data_type, source, (double *)target, num_elements);
+            break;
+        default:
+            assert(0);
+            exit(1);
+    }
+}
+
+static double scalar_get_double(harp_data_type data_type, harp_scalar value)
+{
+    switch (data_type)
+    {
+        case harp_type_int8:
+            return value.int8_data;
+        case harp_type_int16:
+            return value.int16_data;
+        case harp_type_int32:
+            return value.int32_data;
+        case harp_type_float:
+            return value.float_data;
+        case harp_type_double:
+            return value.double_data;
+        default:
+            assert(0);
+            exit(1);
+    }
+}
+
+static harp_scalar scalar_from_double(harp_data_type data_type, double value)
+{
+    harp_scalar scalar;
+
+    switch (data_type)
+    {
+        case harp_type_int8:
+            scalar.int8_data = (int8_t)value;
+            break;
+        case harp_type_int16:
+            scalar.int16_data = (int16_t)value;
+            break;
+        case harp_type_int32:
+            scalar.int32_data = (int32_t)value;
+            break;
+        case harp_type_float:
+            scalar.float_data = (float)value;
+            break;
+        case harp_type_double:
+            scalar.double_data = value;
+            break;
         default:
             assert(0);
             exit(1);
     }
 
-    free(variable->data.ptr);
-    variable->data.ptr = data.ptr;
+    return scalar;
+}
+
+/* convert valid_min/valid_max of a variable to the target data type (clamping them to the range of the target type) */
+static void convert_valid_range(harp_variable *variable, harp_data_type target_data_type)
+{
+    harp_scalar valid_min = harp_get_valid_min_for_type(target_data_type);
+    harp_scalar valid_max = harp_get_valid_max_for_type(target_data_type);
+    double value;
+
+    value = scalar_get_double(variable->data_type, variable->valid_min);
+    if (value < scalar_get_double(target_data_type, valid_min))
+    {
+        variable->valid_min = valid_min;
+    }
+    else
+    {
+        variable->valid_min = scalar_from_double(target_data_type, value);
+    }
+    value = scalar_get_double(variable->data_type, variable->valid_max);
+    if (value > scalar_get_double(target_data_type, valid_max))
+    {
+        variable->valid_max = valid_max;
+    }
+    else
+    {
+        variable->valid_max = scalar_from_double(target_data_type, value);
+    }
+}
+
+/** Convert the data for the variable such that it matches the given data type.
+ * The memory for the block holding the data for the attribute will be resized to match the new data type if needed.
+ * You cannot convert string data to numeric data or vice-versa. Conversion from floating point to integer data (or
+ * vice versa) is allowed though.
+ * \param variable Variable whose data should be aligned with the given data type.
+ * \param target_data_type Data type to which the data for the variable should be converted.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_variable_convert_data_type(harp_variable *variable, harp_data_type target_data_type)
+{
+    double buffer[CONVERT_CHUNK_SIZE];
+    long element_size;
+    long target_element_size;
+    char *data;
+    long i;
+
+    if (variable == NULL)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "variable is NULL (%s:%u)", __FILE__, __LINE__);
+        return -1;
+    }
+
+    if (variable->data_type == target_data_type)
+    {
+        /* no conversion */
+        return 0;
+    }
+    if (variable->data_type == harp_type_string)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT,
+                       "conversion from string to numerical value is not possible for variable '%s'", variable->name);
+        return -1;
+    }
+    if (target_data_type == harp_type_string)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT,
+                       "conversion from numerical value to string is not possible for variable '%s'", variable->name);
+        return -1;
+    }
+    if (variable->num_elements == 0 || variable->data.ptr == NULL)
+    {
+        /* nothing to convert */
+        variable->data_type = target_data_type;
+        return 0;
+    }
+
+    element_size = harp_get_size_for_type(variable->data_type);
+    target_element_size = harp_get_size_for_type(target_data_type);
+
+    /* The conversion is performed in place, one chunk at a time, using a small intermediate buffer.
+     * When the elements get smaller we go forward through the data and shrink the memory block afterwards.
+     * When the elements get larger we grow the memory block first and go backward through the data.
+     * In both cases a chunk is only written to memory of elements that have already been converted. */
+    if (target_element_size <= element_size)
+    {
+        data = (char *)variable->data.ptr;
+        for (i = 0; i < variable->num_elements; i += CONVERT_CHUNK_SIZE)
+        {
+            long num_chunk_elements = variable->num_elements - i;
+
+            if (num_chunk_elements > CONVERT_CHUNK_SIZE)
+            {
+                num_chunk_elements = CONVERT_CHUNK_SIZE;
+            }
+            convert_elements(variable->data_type, &data[i * element_size], target_data_type, buffer,
+                             num_chunk_elements);
+            memcpy(&data[i * target_element_size], buffer, (size_t)(num_chunk_elements * target_element_size));
+        }
+        if (target_element_size < element_size)
+        {
+            data = harp_data_realloc(variable->data.ptr, (size_t)variable->num_elements * element_size,
+                                     (size_t)variable->num_elements * target_element_size);
+            if (data != NULL)
+            {
+                /* if shrinking fails we just keep using the original memory block */
+                variable->data.ptr = data;
+            }
+        }
+    }
+    else
+    {
+        data = harp_data_realloc(variable->data.ptr, (size_t)variable->num_elements * element_size,
+                                 (size_t)variable->num_elements * target_element_size);
+        if (data == NULL)
+        {
+            harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                           (size_t)variable->num_elements * target_element_size, __FILE__, __LINE__);
+            return -1;
+        }
+        variable->data.ptr = data;
+        for (i = ((variable->num_elements - 1) / CONVERT_CHUNK_SIZE) * CONVERT_CHUNK_SIZE; i >= 0;
+             i -= CONVERT_CHUNK_SIZE)
+        {
+            long num_chunk_elements = variable->num_elements - i;
+
+            if (num_chunk_elements > CONVERT_CHUNK_SIZE)
+            {
+                num_chunk_elements = CONVERT_CHUNK_SIZE;
+            }
+            convert_elements(variable->data_type, &data[i * element_size], target_data_type, buffer,
+                             num_chunk_elements);
+            memcpy(&data[i * target_element_size], buffer, (size_t)(num_chunk_elements * target_element_size));
+        }
+    }
+
+    convert_valid_range(variable, target_data_type);
     variable->data_type = target_data_type;
 
     return 0;
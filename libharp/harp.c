@@ -30,6 +30,7 @@
  */
 
 #include "harp-internal.h"
+#include "harp-program.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -51,10 +52,15 @@ LIBHARP_API const char *libharp_version = HARP_VERSION;
 
 static int harp_init_counter = 0;
 
+int harp_option_collocation_cache_size = 256;
 int harp_option_create_collocation_datetime = 0;
 int harp_option_enable_aux_afgl86 = 0;
 int harp_option_enable_aux_usstd76 = 0;
 int harp_option_hdf5_compression = 0;
+int harp_option_hdf5_chunk_size = 0;
+int harp_option_memory_limit = 0;
+int harp_option_preserve_float = 0;
+int harp_option_profiling = 0;
 int harp_option_propagate_uncertainty = 0;
 int harp_option_regrid_out_of_bounds = 0;
 
@@ -287,6 +293,41 @@ LIBHARP_API int harp_set_coda_definition_path_conditional(const char *file, cons
     return 0;
 }
 
+/** Set the maximum amount of memory (in MiB) that is used to cache products from a collocated dataset.
+ * Operations that use a collocated dataset (such as regrid(), smooth() and derive_smoothed_column() with a
+ * collocation result and dataset) import the matching products from the collocated dataset. In order to not import the
+ * same file again for each operation and for each product that is processed, HARP keeps the most recently imported
+ * products in memory, up to the given limit. A cached product is reused as long as the size and modification time of
+ * the file do not change. Products that are larger than the limit are never cached.
+ * By default the cache size is 256 MiB.
+ * \param num_megabytes Maximum amount of variable data (in MiB) to keep in the cache, or 0 to disable the cache.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_set_option_collocation_cache_size(int num_megabytes)
+{
+    if (num_megabytes < 0)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "num_megabytes argument (%d) is not valid (%s:%u)", num_megabytes,
+                       __FILE__, __LINE__);
+        return -1;
+    }
+
+    harp_option_collocation_cache_size = num_megabytes;
+
+    return 0;
+}
+
+/** Retrieve the maximum amount of memory (in MiB) that is used to cache products from a collocated dataset.
+ * \see harp_set_option_collocation_cache_size()
+ * \return 0=caching disabled, >0 maximum amount of variable data in the cache (in MiB)
+ */
+LIBHARP_API int harp_get_option_collocation_cache_size(void)
+{
+    return harp_option_collocation_cache_size;
+}
+
 /** Enable/Disable the creation of collocation_datetime variables
  * Enabling this option will create a collocation_datetime variable when a collocate_left or collocation_right operation is performed.
  * The collocation_datetime variable will contain the datetime of the sample from the other dataset for the collocated pair.
@@ -451,6 +492,151 @@ LIBHARP_API int harp_get_option_hdf5_compression(void)
     return harp_option_hdf5_compression;
 }
 
+/** Set the number of time samples per chunk to use for storing compressed variables in HDF5 files.
+ * By default (\a num_samples = 0) each compressed variable is stored as a single chunk (as far as the HDF5 limit on the
+ * chunk size allows). If \a num_samples is set, variables that depend on the time dimension are stored using chunks
+ * that contain \a num_samples samples of the time dimension (and the full extent of all other dimensions). This means
+ * that reading a subset of the time samples only requires decompressing the chunks that contain those samples.
+ * This option only has an effect if compression is enabled (see harp_set_option_hdf5_compression()).
+ * \param num_samples Number of time samples per chunk, or 0 to store each variable as a single chunk.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_set_option_hdf5_chunk_size(int num_samples)
+{
+    if (num_samples < 0)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "num_samples argument (%d) is not valid (%s:%u)", num_samples,
+                       __FILE__, __LINE__);
+        return -1;
+    }
+
+    harp_option_hdf5_chunk_size = num_samples;
+
+    return 0;
+}
+
+/** Retrieve the number of time samples per chunk that is used for storing compressed variables in HDF5 files.
+ * \see harp_set_option_hdf5_chunk_size()
+ * \return 0=single chunk per variable, >0 number of time samples per chunk
+ */
+LIBHARP_API int harp_get_option_hdf5_chunk_size(void)
+{
+    return harp_option_hdf5_chunk_size;
+}
+
+/** Set the maximum amount of memory to use for variable data.
+ * By default (\a num_megabytes = 0) all variable data is kept in memory. If a memory limit is set, then any variable
+ * data that is allocated once the total amount of variable data in memory exceeds this limit is stored in a memory
+ * mapped temporary file instead (in the directory given by the TMPDIR environment variable, or /tmp otherwise).
+ * The operating system will then page this data in and out of memory as needed. This allows merging, filtering,
+ * sorting and binning of products that are larger than the available memory.
+ * The limit applies to the data of all variables together; small variables are always kept in memory.
+ * This option only has an effect on platforms that support memory mapped files.
+ * \param num_megabytes Maximum amount of variable data (in MiB) to keep in memory, or 0 to not use a limit.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_set_option_memory_limit(int num_megabytes)
+{
+    if (num_megabytes < 0)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "num_megabytes argument (%d) is not valid (%s:%u)", num_megabytes,
+                       __FILE__, __LINE__);
+        return -1;
+    }
+
+    harp_option_memory_limit = num_megabytes;
+
+    return 0;
+}
+
+/** Retrieve the maximum amount of memory (in MiB) that is used for variable data.
+ * \see harp_set_option_memory_limit()
+ * \return 0=no limit, >0 maximum amount of variable data in memory (in MiB)
+ */
+LIBHARP_API int harp_get_option_memory_limit(void)
+{
+    return harp_option_memory_limit;
+}
+
+/** Enable/Disable the preservation of single precision floating point variables in operations.
+ * Operations such as binning, regridding, smoothing and unit conversion perform their calculations in double
+ * precision and will, by default, turn float variables into double variables. Enabling this option will convert
+ * the result of these operations back to float for all variables that were float before the operation was performed.
+ * By default this option is disabled.
+ * \param enable
+ *   \arg 0: Float variables are converted to double by operations that calculate in double precision.
+ *   \arg 1: Float variables remain float variables.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_set_option_preserve_float(int enable)
+{
+    if (enable != 0 && enable != 1)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "enable argument (%d) is not valid (%s:%u)", enable, __FILE__,
+                       __LINE__);
+        return -1;
+    }
+
+    harp_option_preserve_float = enable;
+
+    return 0;
+}
+
+/** Retrieve the current setting for the preservation of float variables in operations.
+ * \see harp_set_option_preserve_float()
+ * \return
+ *   \arg \c 0, Float variables are converted to double by operations that calculate in double precision.
+ *   \arg \c 1, Float variables remain float variables.
+ */
+LIBHARP_API int harp_get_option_preserve_float(void)
+{
+    return harp_option_preserve_float;
+}
+
+/** Enable/Disable the profiling of operations.
+ * If enabled, HARP will keep track of the wall clock time, the number of elements before and after, and the amount of
+ * variable data that got allocated and released, for each operation that is performed. It also records whether the
+ * operation was performed as part of the ingestion or on the in-memory product. The results can be retrieved with
+ * harp_profiling_print_product_report() and harp_profiling_print_run_report().
+ * By default this option is disabled.
+ * \param enable
+ *   \arg 0: Operations are not profiled.
+ *   \arg 1: Operations are profiled.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_set_option_profiling(int enable)
+{
+    if (enable != 0 && enable != 1)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "enable argument (%d) is not valid (%s:%u)", enable, __FILE__,
+                       __LINE__);
+        return -1;
+    }
+
+    harp_option_profiling = enable;
+
+    return 0;
+}
+
+/** Retrieve the current setting for the profiling of operations.
+ * \see harp_set_option_profiling()
+ * \return
+ *   \arg \c 0, Operations are not profiled.
+ *   \arg \c 1, Operations are profiled.
+ */
+LIBHARP_API int harp_get_option_profiling(void)
+{
+    return harp_option_profiling;
+}
+
 /** Set how to propagate uncertainty.
  * This is only applicable for operations that support propagation of uncertainties. And then only if there is a choice.
  * The propagation can either assume uncertainties to be fully uncorrelated (the default) or fully correlated.
@@ -585,6 +771,8 @@ LIBHARP_API void harp_done(void)
             harp_unit_done();
             harp_derived_variable_list_done();
             harp_ingestion_done();
+            harp_profile_done();
+            harp_collocation_product_cache_done();
             /* explicitly clear search paths in case unit and/or ingestion init() routines were never called */
             harp_set_coda_definition_path(NULL);
             harp_set_udunits2_xml_path(NULL);
@@ -605,6 +793,8 @@ LIBHARP_API void harp_done(void)
  * The \a operations parameter is optional (can be NULL) and provides the list of operations that will be performed as
  * part of the import. Some operations, such as filters, can already be performed as part of an import and this may thus
  * be faster than using a harp_product_execute_operations() after a full import of the product.
+ * For files that are already in HARP format, a keep() operation at the start of the list means that only the data of
+ * the kept variables is read from the file.
  * \param[in] filename Path to the file that is to be imported.
  * \param[in] operations string (optional) containing actions to apply as part of the import; should be specified as a
  * semi-colon separated string of operations.
@@ -618,6 +808,9 @@ LIBHARP_API void harp_done(void)
 LIBHARP_API int harp_import(const char *filename, const char *operations, const char *options, harp_product **product)
 {
     harp_product *imported_product;
+    harp_program *program = NULL;
+    char **variable_name = NULL;
+    int num_variables = 0;
     file_format format;
     int result;
 
@@ -626,11 +819,25 @@ LIBHARP_API int harp_import(const char *filename, const char *operations, const
         return -1;
     }
 
+    if (operations != NULL && format != format_unknown)
+    {
+        /* if the operations start with a keep() then only read the variables that are kept */
+        if (harp_program_from_string(operations, &program) != 0)
+        {
+            return -1;
+        }
+        if (program->num_operations > 0 && program->operation[0]->type == operation_keep_variable)
+        {
+            num_variables = ((harp_operation_keep_variable *)program->operation[0])->num_variables;
+            variable_name = ((harp_operation_keep_variable *)program->operation[0])->variable_name;
+        }
+    }
+
     switch (format)
     {
         case format_hdf4:
 #ifdef HAVE_HDF4
-            result = harp_import_hdf4(filename, &imported_product);
+            result = harp_import_hdf4(filename, num_variables, variable_name, &imported_product);
 #else
             harp_set_error(HARP_ERROR_UNSUPPORTED_PRODUCT, NULL);
             result = -1;
@@ -638,20 +845,25 @@ LIBHARP_API int harp_import(const char *filename, const char *operations, const
             break;
         case format_hdf5:
 #ifdef HAVE_HDF5
-            result = harp_import_hdf5(filename, &imported_product);
+            result = harp_import_hdf5(filename, num_variables, variable_name, &imported_product);
 #else
             harp_set_error(HARP_ERROR_UNSUPPORTED_PRODUCT, NULL);
             result = -1;
 #endif
             break;
         case format_netcdf:
-            result = harp_import_netcdf(filename, &imported_product);
+            result = harp_import_netcdf(filename, num_variables, variable_name, &imported_product);
             break;
         default:
             harp_set_error(HARP_ERROR_UNSUPPORTED_PRODUCT, NULL);
             result = -1;
     }
 
+    if (program != NULL)
+    {
+        harp_program_delete(program);
+    }
+
     if (result != 0)
     {
         if (harp_errno != HARP_ERROR_UNSUPPORTED_PRODUCT)
@@ -698,21 +910,136 @@ LIBHARP_API int harp_import(const char *filename, const char *operations, const
     return 0;
 }
 
-/** Test import of a product.
+/** Import the structure of a product from a file without reading the variable data.
  * \ingroup harp_product
- * If the product is a HARP product then verify that the product is a HARP compliant netCDF/HDF4/HDF5 product.
- * Otherwise, try to import the product using an applicable ingestion module and test the ingestion for all possible
- * ingestion options.
- * Results are printed using the provided \a print function.
- * The \a print function parameter should be a function that resembles printf().
- * \param[in] filename Filename of the product to import.
- * \param[in] print Reference to a printf compatible function.
+ * This function works the same as harp_import(), but the resulting product only describes the variables (name, data
+ * type, dimensions, unit, description, valid range, and enumeration values); the data of the variables is not read and
+ * the \a data.ptr field of each variable will be NULL. This allows listing the contents of a product without the cost
+ * of reading all data.
+ * Operations that only change the set of variables, their names, or global options (i.e. keep(), exclude(), rename(),
+ * and set()) are evaluated without reading data. If \a operations contains any other operation then the product
+ * will be fully imported, the operations will be applied, and the data of the result will be discarded afterwards.
+ * The returned product can be printed (without data) and deleted, but should not be passed to functions that access
+ * variable data (such as harp_export() or harp_product_execute_operations() with data dependent operations).
+ * \param[in] filename Path to the file that is to be imported.
+ * \param[in] operations string (optional) containing actions to apply as part of the import; should be specified as a
+ * semi-colon separated string of operations.
+ * \param[in] options Ingestion module specific options (optional); should be specified as a semi-colon separated
+ * string of key=value pair; only used if the file is not in HARP format.
+ * \param[out] product Pointer to a location where a pointer to the product structure will be stored.
  * \return
  *   \arg \c 0, Success.
- *   \arg \c 1, Import failed (error is already printed, #harp_errno should be ignored).
  *   \arg \c -1, Error occurred (check #harp_errno).
  */
-LIBHARP_API int harp_import_test(const char *filename, int (*print)(const char *, ...))
+LIBHARP_API int harp_import_schema(const char *filename, const char *operations, const char *options,
+                                   harp_product **product)
+{
+    harp_product *imported_product;
+    file_format format;
+    int result;
+
+    if (operations != NULL)
+    {
+        harp_program *program;
+        int schema_only;
+
+        if (harp_program_from_string(operations, &program) != 0)
+        {
+            return -1;
+        }
+        schema_only = harp_program_is_schema_only(program);
+        harp_program_delete(program);
+
+        if (!schema_only)
+        {
+            int i;
+
+            /* the result of the operations depends on the variable data, so perform a full import */
+            if (harp_import(filename, operations, options, &imported_product) != 0)
+            {
+                return -1;
+            }
+            for (i = 0; i < imported_product->num_variables; i++)
+            {
+                harp_variable_free_data(imported_product->variable[i]);
+            }
+
+            *product = imported_product;
+            return 0;
+        }
+    }
+
+    if (determine_file_format(filename, &format) != 0)
+    {
+        return -1;
+    }
+
+    switch (format)
+    {
+        case format_hdf4:
+#ifdef HAVE_HDF4
+            result = harp_import_schema_hdf4(filename, &imported_product);
+#else
+            harp_set_error(HARP_ERROR_UNSUPPORTED_PRODUCT, NULL);
+            result = -1;
+#endif
+            break;
+        case format_hdf5:
+#ifdef HAVE_HDF5
+            result = harp_import_schema_hdf5(filename, &imported_product);
+#else
+            harp_set_error(HARP_ERROR_UNSUPPORTED_PRODUCT, NULL);
+            result = -1;
+#endif
+            break;
+        case format_netcdf:
+            result = harp_import_schema_netcdf(filename, &imported_product);
+            break;
+        default:
+            harp_set_error(HARP_ERROR_UNSUPPORTED_PRODUCT, NULL);
+            result = -1;
+    }
+
+    if (result != 0)
+    {
+        if (harp_errno != HARP_ERROR_UNSUPPORTED_PRODUCT)
+        {
+            return -1;
+        }
+
+        /* try ingest */
+        if (harp_ingest_schema(filename, operations, options, &imported_product) != 0)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        if (imported_product->source_product == NULL)
+        {
+            if (harp_product_set_source_product(imported_product, filename) != 0)
+            {
+                harp_product_delete(imported_product);
+                return -1;
+            }
+        }
+
+        if (operations != NULL)
+        {
+            if (harp_product_execute_operations(imported_product, operations) != 0)
+            {
+                harp_product_delete(imported_product);
+                return -1;
+            }
+        }
+    }
+
+    *product = imported_product;
+
+    return 0;
+}
+
+static int import_test(const char *filename, int definitions_only, int num_jobs, int (*print)(const char *, ...))
 {
     harp_product *product;
     file_format format;
@@ -730,7 +1057,7 @@ LIBHARP_API int harp_import_test(const char *filename, int (*print)(const char *
     {
         case format_hdf4:
 #ifdef HAVE_HDF4
-            result = harp_import_hdf4(filename, &product);
+            result = harp_import_hdf4(filename, 0, NULL, &product);
 #else
             harp_set_error(HARP_ERROR_UNSUPPORTED_PRODUCT, NULL);
             result = -1;
@@ -738,14 +1065,14 @@ LIBHARP_API int harp_import_test(const char *filename, int (*print)(const char *
             break;
         case format_hdf5:
 #ifdef HAVE_HDF5
-            result = harp_import_hdf5(filename, &product);
+            result = harp_import_hdf5(filename, 0, NULL, &product);
 #else
             harp_set_error(HARP_ERROR_UNSUPPORTED_PRODUCT, NULL);
             result = -1;
 #endif
             break;
         case format_netcdf:
-            result = harp_import_netcdf(filename, &product);
+            result = harp_import_netcdf(filename, 0, NULL, &product);
             break;
         default:
             harp_set_error(HARP_ERROR_UNSUPPORTED_PRODUCT, NULL);
@@ -759,7 +1086,7 @@ LIBHARP_API int harp_import_test(const char *filename, int (*print)(const char *
             return -1;
         }
         /* try ingest */
-        return harp_ingest_test(filename, print);
+        return harp_ingest_test(filename, definitions_only, num_jobs, print);
     }
 
     print("import:");
@@ -785,6 +1112,70 @@ LIBHARP_API int harp_import_test(const char *filename, int (*print)(const char *
     return 0;
 }
 
+/** Test import of a product.
+ * \ingroup harp_product
+ * If the product is a HARP product then verify that the product is a HARP compliant netCDF/HDF4/HDF5 product.
+ * Otherwise, try to import the product using an applicable ingestion module and test the ingestion for all possible
+ * ingestion options.
+ * Results are printed using the provided \a print function.
+ * The \a print function parameter should be a function that resembles printf().
+ * \param[in] filename Filename of the product to import.
+ * \param[in] print Reference to a printf compatible function.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c 1, Import failed (error is already printed, #harp_errno should be ignored).
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_import_test(const char *filename, int (*print)(const char *, ...))
+{
+    return import_test(filename, 0, 1, print);
+}
+
+/** Test import of a product without reading the variable data.
+ * \ingroup harp_product
+ * This function works the same as harp_import_test(), except that for products that need to be converted using an
+ * ingestion module only the product definition and dimensions are determined for each combination of ingestion
+ * options; the variable data is not read. This is much faster than a full test, but will not catch errors that
+ * only occur when reading data.
+ * Results are printed using the provided \a print function.
+ * The \a print function parameter should be a function that resembles printf().
+ * \param[in] filename Filename of the product to import.
+ * \param[in] print Reference to a printf compatible function.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c 1, Import failed (error is already printed, #harp_errno should be ignored).
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_import_test_definitions(const char *filename, int (*print)(const char *, ...))
+{
+    return import_test(filename, 1, 1, print);
+}
+
+/** Test import of a product using multiple worker processes.
+ * \ingroup harp_product
+ * This function works the same as harp_import_test() (or harp_import_test_definitions() if \a definitions_only is
+ * set), except that for products that need to be converted using an ingestion module the combinations of ingestion
+ * options are tested concurrently by \a num_jobs worker processes. Each worker process opens the product itself.
+ * The output of the workers is buffered and printed in the same order as harp_import_test() would print it.
+ * On Windows (where worker processes are not supported) the combinations are always tested sequentially.
+ * Results are printed using the provided \a print function.
+ * The \a print function parameter should be a function that resembles printf().
+ * \param[in] filename Filename of the product to import.
+ * \param[in] definitions_only If set, only determine the product definition and dimensions for each combination of
+ *   ingestion options, without reading variable data.
+ * \param[in] num_jobs Maximum number of worker processes to use (a value <= 1 tests the combinations sequentially).
+ * \param[in] print Reference to a printf compatible function.
+ * \return
+ *   \arg \c 0, Success.
+ *   \arg \c 1, Import failed (error is already printed, #harp_errno should be ignored).
+ *   \arg \c -1, Error occurred (check #harp_errno).
+ */
+LIBHARP_API int harp_import_test_parallel(const char *filename, int definitions_only, int num_jobs,
+                                          int (*print)(const char *, ...))
+{
+    return import_test(filename, definitions_only, num_jobs, print);
+}
+
 /** Retrieve global attributes from a product file.
  * \ingroup harp_product
  * This function retrieves the product metadata without performing a full import.
@@ -20,6 +20,9 @@
 #else
 #include <unistd.h>
 #endif
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 #ifndef SEEK_SET
 #define SEEK_SET 0
@@ -74,6 +77,9 @@
 
 /* Begin OS */
 
+#define NCIO_MINBLOCKSIZE 256
+#define NCIO_MAXBLOCKSIZE 268435456 /* sanity check, about X_SIZE_T_MAX/8 */
+
 #ifndef POSIXIO_DEFAULT_PAGESIZE
 #define POSIXIO_DEFAULT_PAGESIZE 4096
 #endif
@@ -1341,6 +1347,197 @@ ncio_spx_init(ncio *const nciop)
 }
 
 
+#ifdef HAVE_MMAP
+/* Begin mm */
+
+/* This is the struct that gets hung of ncio->pvt when a file is opened
+   read-only without NC_SHARE and the whole file could be mapped into
+   memory.
+
+   base - start of the mapping.
+   size - size of the mapping (i.e. the file size at open time).
+   bf_base - scratch buffer, only used for regions that extend beyond
+   the end of the file.
+   bf_extent - allocated size of bf_base.
+*/
+typedef struct ncio_mm {
+	void	*base;
+	size_t	size;
+	void	*bf_base;
+	size_t	bf_extent;
+} ncio_mm;
+
+
+/*ARGSUSED*/
+/* Nothing to release: regions point directly into the mapping (or
+   into the scratch buffer, which is kept for reuse).
+*/
+static int
+ncio_mm_rel(ncio *const nciop, off_t offset, int rflags)
+{
+	(void)nciop;
+	(void)offset;
+	if(fIsSet(rflags, RGN_MODIFIED))
+		return EPERM; /* attempt to write readonly file */
+	return ENOERR;
+}
+
+
+/* Request that the region (offset, extent) be made available through
+   *vpp.
+
+   Regions that lie completely within the file are returned as a
+   pointer into the mapping, so no data is copied and the extent is
+   not limited by a buffer size. Regions extending beyond the end of
+   the file (e.g. records of a file written with NOFILL) are copied
+   into a scratch buffer and the remainder is zero filled, just like
+   px_pgin does for short reads.
+*/
+static int
+ncio_mm_get(ncio *const nciop,
+		off_t offset, size_t extent,
+		int rflags,
+		void **const vpp)
+{
+	ncio_mm *const mmp = (ncio_mm *)nciop->pvt;
+	size_t avail;
+
+	if(fIsSet(rflags, RGN_WRITE))
+		return EPERM; /* attempt to write readonly file */
+
+	assert(extent != 0);
+
+	if(offset < 0)
+		return EINVAL;
+
+	if((size_t)offset <= mmp->size && extent <= mmp->size - (size_t)offset)
+	{
+		*vpp = (char *)mmp->base + offset;
+		return ENOERR;
+	}
+
+	if(mmp->bf_extent < extent)
+	{
+		if(mmp->bf_base != NULL)
+		{
+			free(mmp->bf_base);
+			mmp->bf_base = NULL;
+			mmp->bf_extent = 0;
+		}
+		mmp->bf_base = malloc(extent);
+		if(mmp->bf_base == NULL)
+			return ENOMEM;
+		mmp->bf_extent = extent;
+	}
+
+	avail = (size_t)offset < mmp->size ? mmp->size - (size_t)offset : 0;
+	if(avail > 0)
+		(void) memcpy(mmp->bf_base, (char *)mmp->base + offset, avail);
+	(void) memset((char *)mmp->bf_base + avail, 0, extent - avail);
+
+	*vpp = mmp->bf_base;
+	return ENOERR;
+}
+
+
+/*ARGSUSED*/
+/* The mapping is read-only, so moving data is not allowed.
+*/
+static int
+ncio_mm_move(ncio *const nciop, off_t to, off_t from,
+			size_t nbytes, int rflags)
+{
+	(void)nciop;
+	(void)to;
+	(void)from;
+	(void)nbytes;
+	(void)rflags;
+	return EPERM; /* attempt to write readonly file */
+}
+
+
+/*ARGSUSED*/
+/* Nothing is buffered, so there is nothing to flush.
+*/
+static int
+ncio_mm_sync(ncio *const nciop)
+{
+	(void)nciop;
+	/* NOOP */
+	return ENOERR;
+}
+
+static void
+ncio_mm_free(void *const pvt)
+{
+	ncio_mm *const mmp = (ncio_mm *)pvt;
+	if(mmp == NULL)
+		return;
+
+	if(mmp->base != NULL)
+	{
+		(void) munmap(mmp->base, mmp->size);
+		mmp->base = NULL;
+		mmp->size = 0;
+	}
+	if(mmp->bf_base != NULL)
+	{
+		free(mmp->bf_base);
+		mmp->bf_base = NULL;
+		mmp->bf_extent = 0;
+	}
+}
+
+
+/* Map the whole (already opened) file into memory and switch the ncio
+   struct over to the ncio_mm_* functions. This replaces the
+   ncio_px_init2 step for read-only opens without NC_SHARE.
+
+   Since get requests no longer go through a buffer, the size hint is
+   raised to the size of the file so that the netcdf layer can convert
+   whole fixed-size variables straight out of the mapping.
+
+   If the file can not be mapped (empty file, file system without mmap
+   support, ...) an error is returned and the ncio struct is left
+   untouched, so the caller can fall back to ncio_px.
+*/
+static int
+ncio_mm_init2(ncio *const nciop, size_t *sizehintp)
+{
+	ncio_mm *const mmp = (ncio_mm *)nciop->pvt;
+	struct stat sb;
+	void *base;
+
+	assert(nciop->fd >= 0);
+
+	if(fstat(nciop->fd, &sb) < 0)
+		return errno;
+	if(sb.st_size <= 0 || (off_t)(size_t)sb.st_size != sb.st_size)
+		return EINVAL;
+
+	base = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_SHARED, nciop->fd, 0);
+	if(base == MAP_FAILED)
+		return errno;
+
+	*((ncio_relfunc **)&nciop->rel) = ncio_mm_rel; /* cast away const */
+	*((ncio_getfunc **)&nciop->get) = ncio_mm_get; /* cast away const */
+	*((ncio_movefunc **)&nciop->move) = ncio_mm_move; /* cast away const */
+	*((ncio_syncfunc **)&nciop->sync) = ncio_mm_sync; /* cast away const */
+	*((ncio_freefunc **)&nciop->free) = ncio_mm_free; /* cast away const */
+
+	mmp->base = base;
+	mmp->size = (size_t)sb.st_size;
+	mmp->bf_base = NULL;
+	mmp->bf_extent = 0;
+
+	if(*sizehintp < mmp->size)
+		*sizehintp = MIN(M_RNDUP(mmp->size), NCIO_MAXBLOCKSIZE);
+
+	return ENOERR;
+}
+#endif /* HAVE_MMAP */
+
+
 /* */
 
 /* This will call whatever free function is attached to the free
@@ -1381,6 +1578,11 @@ ncio_new(const char *path, int ioflags)
 		sz_ncio_pvt = sizeof(ncio_spx);
 	else
 		sz_ncio_pvt = sizeof(ncio_px);
+#ifdef HAVE_MMAP
+	/* read-only opens may switch over to ncio_mm */
+	if(sz_ncio_pvt < sizeof(ncio_mm))
+		sz_ncio_pvt = sizeof(ncio_mm);
+#endif
 
 	nciop = (ncio *) malloc(sz_ncio + sz_path + sz_ncio_pvt);
 	if(nciop == NULL)
@@ -1406,9 +1608,6 @@ ncio_new(const char *path, int ioflags)
 
 /* Public below this point */
 
-#define NCIO_MINBLOCKSIZE 256
-#define NCIO_MAXBLOCKSIZE 268435456 /* sanity check, about X_SIZE_T_MAX/8 */
-
 #ifdef S_IRUSR
 #define NC_DEFAULT_CREAT_MODE \
         (S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH) /* 0666 */
@@ -1613,6 +1812,12 @@ ncio_open(const char *path,
 		*sizehintp = M_RNDUP(*sizehintp);
 	}
 
+#ifdef HAVE_MMAP
+	if(!fIsSet(nciop->ioflags, NC_WRITE) && !fIsSet(nciop->ioflags, NC_SHARE)
+		&& ncio_mm_init2(nciop, sizehintp) == ENOERR)
+		status = ENOERR;
+	else
+#endif
 	if(fIsSet(nciop->ioflags, NC_SHARE))
 		status = ncio_spx_init2(nciop, sizehintp);
 	else
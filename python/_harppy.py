@@ -47,8 +47,8 @@ except ImportError:
 from harp._harpc import ffi as _ffi
 
 __all__ = ["Error", "CLibraryError", "UnsupportedTypeError", "UnsupportedDimensionError", "NoDataError", "Variable",
-           "Product", "get_encoding", "set_encoding", "version", "import_product", "import_product_metadata",
-           "export_product", "concatenate", "execute_operations", "convert_unit", "to_dict"]
+           "Product", "get_encoding", "set_encoding", "version", "import_product", "import_product_schema",
+           "import_product_metadata", "export_product", "concatenate", "execute_operations", "convert_unit", "to_dict"]
 
 
 class Error(Exception):
@@ -878,15 +878,23 @@ def _import_array(c_data_type, c_num_elements, c_data):
     return numpy.copy(numpy.frombuffer(c_data_buffer, dtype=_get_py_data_type(c_data_type)))
 
 
-def _import_variable(c_variable):
+def _import_variable(c_variable, with_data=True):
+    num_dimensions = c_variable.num_dimensions
+
     # Import variable data.
-    data = _import_array(c_variable.data_type, c_variable.num_elements, c_variable.data)
+    if with_data:
+        data = _import_array(c_variable.data_type, c_variable.num_elements, c_variable.data)
+        if num_dimensions > 0:
+            data = data.reshape([c_variable.dimension[i] for i in range(num_dimensions)])
+    else:
+        # Use a read-only placeholder with the right type and shape that does not occupy any memory for its elements.
+        fill_value = "" if c_variable.data_type == _lib.harp_type_string else 0
+        fill_value = numpy.array(fill_value, dtype=_get_py_data_type(c_variable.data_type))
+        data = numpy.broadcast_to(fill_value, [c_variable.dimension[i] for i in range(num_dimensions)])
 
-    num_dimensions = c_variable.num_dimensions
     if num_dimensions == 0:
         variable = Variable(data.item())
     else:
-        data = data.reshape([c_variable.dimension[i] for i in range(num_dimensions)])
         dimension = [_get_py_dimension_type(c_variable.dimension_type[i]) for i in range(num_dimensions)]
         variable = Variable(data, dimension)
 
@@ -908,7 +916,7 @@ def _import_variable(c_variable):
     return variable
 
 
-def _import_product(c_product):
+def _import_product(c_product, with_data=True):
     product = Product()
 
     # Import product attributes.
@@ -921,7 +929,7 @@ def _import_product(c_product):
     # Import variables.
     for i in range(c_product.num_variables):
         c_variable_ptr = c_product.variable[i]
-        variable = _import_variable(c_variable_ptr[0])
+        variable = _import_variable(c_variable_ptr[0], with_data)
         setattr(product, _decode_string(_ffi.string(c_variable_ptr[0].name)), variable)
 
     return product
@@ -1358,6 +1366,45 @@ def import_product(filename, operations="", options="", reduce_operations="", po
         _lib.harp_product_delete(c_product_ptr[0])
 
 
+def import_product_schema(filename, operations="", options=""):
+    """Import the structure of a product from a file without reading its data.
+
+    The result is a product with all variables, dimensions, and attributes of the
+    product that harp.import_product() would return for the same arguments. The data
+    attribute of each variable is a read-only placeholder array (filled with zeros or
+    empty strings) that has the right type and shape, but occupies no memory.
+
+    Operations that only change the set of variables or their names (keep(),
+    exclude(), rename()) and set() are evaluated without reading any data. For other
+    operations the product is fully imported and its data discarded afterwards.
+
+    Arguments:
+    filename -- Filename of the product to import
+    operations -- Actions to apply as part of the import; should be specified as a
+                  semi-colon separated string of operations.
+    options -- Ingestion module specific options; should be specified as a semi-
+               colon separated string of key=value pairs; only used if a file is not
+               in HARP format.
+    """
+    c_product_ptr = _ffi.new("harp_product **")
+
+    # Import the product structure as a C product.
+    if _lib.harp_import_schema(_encode_path(filename), _encode_string(operations), _encode_string(options),
+                               c_product_ptr) != 0:
+        raise CLibraryError()
+
+    try:
+        # Raise an exception if the imported C product contains no variables, or variables without elements.
+        if _lib.harp_product_is_empty(c_product_ptr[0]) == 1:
+            raise NoDataError()
+
+        # Convert the C product into its Python representation.
+        return _import_product(c_product_ptr[0], with_data=False)
+
+    finally:
+        _lib.harp_product_delete(c_product_ptr[0])
+
+
 def import_product_metadata(filename, options=""):
     """Import specific metadata from a single file.
 
@@ -1389,7 +1436,7 @@ def import_product_metadata(filename, options=""):
         _lib.harp_product_metadata_delete(c_metadata_ptr[0])
 
 
-def export_product(product, filename, file_format="netcdf", operations="", hdf5_compression=0):
+def export_product(product, filename, file_format="netcdf", operations="", hdf5_compression=0, hdf5_chunk_size=0):
     """Export a HARP compliant product.
 
     Arguments:
@@ -1399,6 +1446,8 @@ def export_product(product, filename, file_format="netcdf", operations="", hdf5_
     operations       -- Actions to apply as part of the export; should be specified as a
                         semi-colon separated string of operations.
     hdf5_compression -- Compression level when exporting to hdf5 (0=disabled, 1=low, ..., 9=high).
+    hdf5_chunk_size  -- Number of time samples per chunk for compressed variables when exporting to hdf5
+                        (0=single chunk per variable).
 
     """
     if not isinstance(product, Product):
@@ -1430,6 +1479,7 @@ def export_product(product, filename, file_format="netcdf", operations="", hdf5_
         # Export the C product to a file.
         if file_format == 'hdf5':
             _lib.harp_set_option_hdf5_compression(int(hdf5_compression))
+            _lib.harp_set_option_hdf5_chunk_size(int(hdf5_chunk_size))
         if _lib.harp_export(_encode_path(filename), _encode_string(file_format), c_product_ptr[0]) != 0:
             raise CLibraryError()
 
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2015-2024 S[&]T, The Netherlands.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Regression test for the reordering of operations by the program optimizer.
+ * A filter should not be moved in front of a derive() since the derived values may depend on the elements that are
+ * removed by the filter.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "harp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int test_filter_after_derive_index(void)
+{
+    harp_dimension_type dimension_type = harp_dimension_time;
+    double latitude[5] = { -10.0, 20.0, -30.0, 40.0, 50.0 };
+    int32_t expected_index[3] = { 1, 3, 4 };
+    harp_product *product;
+    harp_variable *variable;
+    long dimension = 5;
+    long i;
+
+    if (harp_product_new(&product) != 0)
+    {
+        return -1;
+    }
+    if (harp_variable_new("latitude", harp_type_double, 1, &dimension_type, &dimension, &variable) != 0)
+    {
+        harp_product_delete(product);
+        return -1;
+    }
+    for (i = 0; i < dimension; i++)
+    {
+        variable->data.double_data[i] = latitude[i];
+    }
+    if (harp_product_add_variable(product, variable) != 0)
+    {
+        harp_variable_delete(variable);
+        harp_product_delete(product);
+        return -1;
+    }
+
+    if (harp_product_execute_operations(product, "derive(index {time}); latitude > 0") != 0)
+    {
+        harp_product_delete(product);
+        return -1;
+    }
+    if (harp_product_get_variable_by_name(product, "index", &variable) != 0)
+    {
+        harp_product_delete(product);
+        return -1;
+    }
+    if (variable->num_elements != 3)
+    {
+        fprintf(stderr, "FAIL: derive(index {time}); latitude > 0: %ld elements (expected 3)\n",
+                variable->num_elements);
+        harp_product_delete(product);
+        return 1;
+    }
+    for (i = 0; i < variable->num_elements; i++)
+    {
+        if (variable->data.int32_data[i] != expected_index[i])
+        {
+            fprintf(stderr, "FAIL: derive(index {time}); latitude > 0: index[%ld] = %d (expected %d)\n", i,
+                    (int)variable->data.int32_data[i], (int)expected_index[i]);
+            harp_product_delete(product);
+            return 1;
+        }
+    }
+
+    harp_product_delete(product);
+
+    return 0;
+}
+
+int main(void)
+{
+    int result;
+
+    if (harp_init() != 0)
+    {
+        fprintf(stderr, "ERROR: %s\n", harp_errno_to_string(harp_errno));
+        exit(1);
+    }
+
+    result = test_filter_after_derive_index();
+    if (result < 0)
+    {
+        fprintf(stderr, "ERROR: %s\n", harp_errno_to_string(harp_errno));
+    }
+
+    harp_done();
+
+    return result == 0 ? 0 : 1;
+}
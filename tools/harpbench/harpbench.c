@@ -0,0 +1,954 @@
+/*
+ * Copyright (C) 2015-2024 S[&]T, The Netherlands.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "harp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef WIN32
+#include "windows.h"
+#else
+#include <sys/time.h>
+#endif
+
+/* harpcollocate matchup (see tools/harpcollocate/harpcollocate-matchup.c) */
+int matchup(int argc, char *argv[]);
+
+#define MAX_PATH_LENGTH 4096
+
+typedef struct bench_info_struct
+{
+    long num_time;      /* number of time samples of the main synthetic product */
+    long num_vertical;  /* number of vertical levels */
+    long num_spectral;  /* number of spectral elements (0 to not include spectral variables) */
+    const char *tmpdir; /* directory for temporary files */
+
+    harp_product *product;      /* main synthetic product */
+    harp_product *smooth_product;       /* product to smooth (num_time / 10 samples) */
+    harp_product *avk_product;  /* collocated product with averaging kernels for smooth_product */
+
+    char netcdf_filename[MAX_PATH_LENGTH];
+    char hdf5_filename[MAX_PATH_LENGTH];
+    char dataset_a_filename[MAX_PATH_LENGTH];
+    char dataset_b_filename[MAX_PATH_LENGTH];
+    char collocation_filename[MAX_PATH_LENGTH];
+} bench_info;
+
+typedef struct benchmark_struct
+{
+    const char *name;
+    /* run the benchmark once; stores the time of the measured part in 'time' and a size indication of the result
+     * (e.g. the number of elements in the resulting product) in 'result' */
+    int (*run)(bench_info *info, double *time, long *result);
+} benchmark;
+
+/* deterministic pseudo random number generator, so each run works on identical data */
+static unsigned long random_state = 1;
+
+static void random_init(void)
+{
+    random_state = 1;
+}
+
+/* returns a value in the range [0, 1) */
+static double random_uniform(void)
+{
+    random_state = (random_state * 1103515245UL + 12345UL) & 0xffffffffUL;
+    return (double)(random_state >> 8) / (double)0x1000000;
+}
+
+static double get_wall_time(void)
+{
+#ifdef WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return (double)tv.tv_sec + 1.0e-6 * (double)tv.tv_usec;
+#endif
+}
+
+static int print_warning(const char *message, va_list ap)
+{
+    int result;
+
+    fprintf(stderr, "WARNING: ");
+    result = vfprintf(stderr, message, ap);
+    fprintf(stderr, "\n");
+
+    return result;
+}
+
+static void print_version(void)
+{
+    printf("harpbench version %s\n", libharp_version);
+    printf("Copyright (C) 2015-2024 S[&]T, The Netherlands.\n\n");
+}
+
+static void print_help(void)
+{
+    printf("Usage:\n");
+    printf("    harpbench [options] [<benchmark> ...]\n");
+    printf("        Run a fixed suite of benchmarks for the core HARP operations on\n");
+    printf("        deterministic synthetic products and print the timings.\n");
+    printf("        If one or more benchmark names are given, only those benchmarks\n");
+    printf("        are run.\n");
+    printf("        Each line of the output contains the benchmark name, the minimum\n");
+    printf("        and mean wall time (in seconds) over all repetitions, and a size\n");
+    printf("        indication of the result (e.g. the number of elements in the\n");
+    printf("        resulting product). The result value only depends on the product\n");
+    printf("        dimensions, so a change in this value indicates a change in\n");
+    printf("        behaviour.\n");
+    printf("\n");
+    printf("        Options:\n");
+    printf("            --time <samples>\n");
+    printf("                Number of time samples of the synthetic product\n");
+    printf("                (default 50000). The smooth and matchup benchmarks use\n");
+    printf("                products with 1/10th (and 1/100th) of this number of samples.\n");
+    printf("\n");
+    printf("            --vertical <levels>\n");
+    printf("                Number of vertical levels (default 40).\n");
+    printf("\n");
+    printf("            --spectral <length>\n");
+    printf("                Length of the spectral dimension (default 20).\n");
+    printf("\n");
+    printf("            --repeat <count>\n");
+    printf("                Number of times each benchmark is run (default 3).\n");
+    printf("\n");
+    printf("            --tmpdir <directory>\n");
+    printf("                Directory for temporary files (default $TMPDIR or /tmp).\n");
+    printf("\n");
+    printf("            -l, --list\n");
+    printf("                Print the names of all benchmarks and exit.\n");
+    printf("\n");
+    printf("    harpbench -h, --help\n");
+    printf("        Show help (this text).\n");
+    printf("\n");
+    printf("    harpbench -v, --version\n");
+    printf("        Print the version number of HARP and exit.\n");
+    printf("\n");
+}
+
+static long get_num_elements(const harp_product *product)
+{
+    long num_elements = 0;
+    int i;
+
+    for (i = 0; i < product->num_variables; i++)
+    {
+        num_elements += product->variable[i]->num_elements;
+    }
+
+    return num_elements;
+}
+
+static int add_variable(harp_product *product, const char *name, harp_data_type data_type, int num_dimensions,
+                        const harp_dimension_type *dimension_type, const long *dimension, const char *unit,
+                        harp_variable **new_variable)
+{
+    harp_variable *variable;
+
+    if (harp_variable_new(name, data_type, num_dimensions, dimension_type, dimension, &variable) != 0)
+    {
+        return -1;
+    }
+    if (unit != NULL && harp_variable_set_unit(variable, unit) != 0)
+    {
+        harp_variable_delete(variable);
+        return -1;
+    }
+    if (harp_product_add_variable(product, variable) != 0)
+    {
+        harp_variable_delete(variable);
+        return -1;
+    }
+    *new_variable = variable;
+
+    return 0;
+}
+
+/* create a synthetic product with footprints, vertical profiles and (optionally) spectra
+ * the samples are 'time_step' seconds apart */
+static int create_product(long num_time, double time_step, long num_vertical, long num_spectral,
+                          const char *source_product, harp_product **new_product)
+{
+    harp_dimension_type dimension_type[2] = { harp_dimension_time, harp_dimension_independent };
+    long dimension[2];
+    harp_product *product;
+    harp_variable *variable;
+    harp_variable *latitude;
+    harp_variable *longitude;
+    long i, j;
+
+    if (harp_product_new(&product) != 0)
+    {
+        return -1;
+    }
+    if (harp_product_set_source_product(product, source_product) != 0)
+    {
+        goto error;
+    }
+
+    dimension[0] = num_time;
+    if (add_variable(product, "datetime", harp_type_double, 1, dimension_type, dimension, "s since 2000-01-01",
+                     &variable) != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < num_time; i++)
+    {
+        variable->data.double_data[i] = i * time_step;
+    }
+    if (add_variable(product, "collocation_index", harp_type_int32, 1, dimension_type, dimension, NULL, &variable)
+        != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < num_time; i++)
+    {
+        variable->data.int32_data[i] = (int32_t)i;
+    }
+    if (add_variable(product, "latitude", harp_type_double, 1, dimension_type, dimension, "degree_north", &latitude)
+        != 0)
+    {
+        goto error;
+    }
+    if (add_variable(product, "longitude", harp_type_double, 1, dimension_type, dimension, "degree_east", &longitude)
+        != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < num_time; i++)
+    {
+        latitude->data.double_data[i] = -80 + 160 * random_uniform();
+        longitude->data.double_data[i] = -179 + 358 * random_uniform();
+    }
+    if (add_variable(product, "cloud_fraction", harp_type_float, 1, dimension_type, dimension, HARP_UNIT_DIMENSIONLESS,
+                     &variable) != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < num_time; i++)
+    {
+        variable->data.float_data[i] = (float)random_uniform();
+    }
+    if (add_variable(product, "validity", harp_type_int32, 1, dimension_type, dimension, NULL, &variable) != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < num_time; i++)
+    {
+        variable->data.int32_data[i] = (int32_t)(16 * random_uniform());
+    }
+
+    /* footprints of 1x1 degree around the center */
+    dimension[1] = 4;
+    if (add_variable(product, "latitude_bounds", harp_type_double, 2, dimension_type, dimension, "degree_north",
+                     &variable) != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < num_time; i++)
+    {
+        variable->data.double_data[i * 4] = latitude->data.double_data[i] - 0.5;
+        variable->data.double_data[i * 4 + 1] = latitude->data.double_data[i] - 0.5;
+        variable->data.double_data[i * 4 + 2] = latitude->data.double_data[i] + 0.5;
+        variable->data.double_data[i * 4 + 3] = latitude->data.double_data[i] + 0.5;
+    }
+    if (add_variable(product, "longitude_bounds", harp_type_double, 2, dimension_type, dimension, "degree_east",
+                     &variable) != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < num_time; i++)
+    {
+        variable->data.double_data[i * 4] = longitude->data.double_data[i] - 0.5;
+        variable->data.double_data[i * 4 + 1] = longitude->data.double_data[i] + 0.5;
+        variable->data.double_data[i * 4 + 2] = longitude->data.double_data[i] + 0.5;
+        variable->data.double_data[i * 4 + 3] = longitude->data.double_data[i] - 0.5;
+    }
+
+    /* vertical profiles */
+    dimension_type[1] = harp_dimension_vertical;
+    dimension[1] = num_vertical;
+    if (add_variable(product, "altitude", harp_type_double, 2, dimension_type, dimension, "km", &variable) != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < num_time; i++)
+    {
+        for (j = 0; j < num_vertical; j++)
+        {
+            variable->data.double_data[i * num_vertical + j] = j + 0.5 * random_uniform();
+        }
+    }
+    if (add_variable(product, "O3_number_density", harp_type_double, 2, dimension_type, dimension, "molec/cm3",
+                     &variable) != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < num_time * num_vertical; i++)
+    {
+        variable->data.double_data[i] = 1e11 + 1e12 * random_uniform();
+    }
+    if (add_variable(product, "temperature", harp_type_double, 2, dimension_type, dimension, "K", &variable) != 0)
+    {
+        goto error;
+    }
+    for (i = 0; i < num_time * num_vertical; i++)
+    {
+        variable->data.double_data[i] = 200 + 100 * random_uniform();
+    }
+
+    if (num_spectral > 0)
+    {
+        dimension_type[0] = harp_dimension_spectral;
+        dimension[0] = num_spectral;
+        if (add_variable(product, "wavelength", harp_type_double, 1, dimension_type, dimension, "nm", &variable) != 0)
+        {
+            goto error;
+        }
+        for (j = 0; j < num_spectral; j++)
+        {
+            variable->data.double_data[j] = 300 + j;
+        }
+        dimension_type[0] = harp_dimension_time;
+        dimension_type[1] = harp_dimension_spectral;
+        dimension[0] = num_time;
+        dimension[1] = num_spectral;
+        if (add_variable(product, "wavelength_radiance", harp_type_float, 2, dimension_type, dimension,
+                         "mW/m2/sr/nm", &variable) != 0)
+        {
+            goto error;
+        }
+        for (i = 0; i < num_time * num_spectral; i++)
+        {
+            variable->data.float_data[i] = (float)(100 * random_uniform());
+        }
+    }
+
+    *new_product = product;
+    return 0;
+
+  error:
+    harp_product_delete(product);
+    return -1;
+}
+
+/* add averaging kernels for O3_number_density to a product created with create_product() */
+static int add_averaging_kernels(harp_product *product, long num_vertical)
+{
+    harp_dimension_type dimension_type[3] = { harp_dimension_time, harp_dimension_vertical, harp_dimension_vertical };
+    long dimension[3];
+    harp_variable *variable;
+    long i, j, k;
+
+    dimension[0] = product->dimension[harp_dimension_time];
+    dimension[1] = num_vertical;
+    dimension[2] = num_vertical;
+    if (add_variable(product, "O3_number_density_avk", harp_type_double, 3, dimension_type, dimension,
+                     HARP_UNIT_DIMENSIONLESS, &variable) != 0)
+    {
+        return -1;
+    }
+    for (i = 0; i < dimension[0]; i++)
+    {
+        for (j = 0; j < num_vertical; j++)
+        {
+            for (k = 0; k < num_vertical; k++)
+            {
+                /* band diagonal kernel */
+                variable->data.double_data[(i * num_vertical + j) * num_vertical + k] =
+                    (j == k ? 0.6 : (labs(j - k) == 1 ? 0.2 : 0.0)) * (0.9 + 0.2 * random_uniform());
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* run a list of operations on a copy of the main product */
+static int run_operations(bench_info *info, const char *operations, double *time, long *result)
+{
+    harp_product *product;
+    double start;
+
+    if (harp_product_copy(info->product, &product) != 0)
+    {
+        return -1;
+    }
+    start = get_wall_time();
+    if (harp_product_execute_operations(product, operations) != 0)
+    {
+        harp_product_delete(product);
+        return -1;
+    }
+    *time = get_wall_time() - start;
+    *result = get_num_elements(product);
+    harp_product_delete(product);
+
+    return 0;
+}
+
+static int bench_filter_value(bench_info *info, double *time, long *result)
+{
+    return run_operations(info, "cloud_fraction < 0.5; validity =& 1; temperature > 210 [K]", time, result);
+}
+
+static int bench_filter_point_distance(bench_info *info, double *time, long *result)
+{
+    return run_operations(info, "point_distance(10, 20, 3000 [km])", time, result);
+}
+
+static int bench_filter_area(bench_info *info, double *time, long *result)
+{
+    return run_operations(info, "area_intersects_area((0,0,40,40),(0,40,40,0))", time, result);
+}
+
+static int bench_filter_area_fraction(bench_info *info, double *time, long *result)
+{
+    return run_operations(info, "area_intersects_area((0,0,40,40),(0,40,40,0), 0.5)", time, result);
+}
+
+static int bench_sort(bench_info *info, double *time, long *result)
+{
+    const char *variable_name[] = { "cloud_fraction" };
+    harp_product *product;
+    double start;
+
+    if (harp_product_copy(info->product, &product) != 0)
+    {
+        return -1;
+    }
+    start = get_wall_time();
+    if (harp_product_sort(product, 1, variable_name) != 0)
+    {
+        harp_product_delete(product);
+        return -1;
+    }
+    *time = get_wall_time() - start;
+    *result = get_num_elements(product);
+    harp_product_delete(product);
+
+    return 0;
+}
+
+static int bench_bin(bench_info *info, double *time, long *result)
+{
+    return run_operations(info, "bin(validity)", time, result);
+}
+
+static int bench_bin_full(bench_info *info, double *time, long *result)
+{
+    return run_operations(info, "bin()", time, result);
+}
+
+static int bench_bin_spatial(bench_info *info, double *time, long *result)
+{
+    return run_operations(info, "bin_spatial(19, -90, 10, 37, -180, 10)", time, result);
+}
+
+static int bench_regrid(bench_info *info, double *time, long *result)
+{
+    char operations[100];
+
+    sprintf(operations, "regrid(vertical, altitude [km], %ld, 0.75, 2)", info->num_vertical / 2);
+    return run_operations(info, operations, time, result);
+}
+
+static int bench_smooth(bench_info *info, double *time, long *result)
+{
+    const char *variable_name[] = { "O3_number_density" };
+    harp_product *product;
+    double start;
+
+    if (harp_product_copy(info->smooth_product, &product) != 0)
+    {
+        return -1;
+    }
+    start = get_wall_time();
+    if (harp_product_smooth_vertical_with_collocated_product(product, 1, variable_name, "altitude", "km",
+                                                             info->avk_product) != 0)
+    {
+        harp_product_delete(product);
+        return -1;
+    }
+    *time = get_wall_time() - start;
+    *result = get_num_elements(product);
+    harp_product_delete(product);
+
+    return 0;
+}
+
+static int bench_append(bench_info *info, double *time, long *result)
+{
+    harp_product *product;
+    harp_product *other_product;
+    double start;
+
+    if (harp_product_copy(info->product, &product) != 0)
+    {
+        return -1;
+    }
+    if (harp_product_copy(info->product, &other_product) != 0)
+    {
+        harp_product_delete(product);
+        return -1;
+    }
+    start = get_wall_time();
+    if (harp_product_append(product, other_product) != 0)
+    {
+        harp_product_delete(other_product);
+        harp_product_delete(product);
+        return -1;
+    }
+    *time = get_wall_time() - start;
+    *result = get_num_elements(product);
+    harp_product_delete(other_product);
+    harp_product_delete(product);
+
+    return 0;
+}
+
+static int run_export(bench_info *info, const char *filename, const char *format, double *time, long *result)
+{
+    double start;
+
+    start = get_wall_time();
+    if (harp_export(filename, format, info->product) != 0)
+    {
+        return -1;
+    }
+    *time = get_wall_time() - start;
+    *result = get_num_elements(info->product);
+
+    return 0;
+}
+
+static int run_import(const char *filename, double *time, long *result)
+{
+    harp_product *product;
+    double start;
+
+    start = get_wall_time();
+    if (harp_import(filename, NULL, NULL, &product) != 0)
+    {
+        return -1;
+    }
+    *time = get_wall_time() - start;
+    *result = get_num_elements(product);
+    harp_product_delete(product);
+
+    return 0;
+}
+
+static int bench_export_netcdf(bench_info *info, double *time, long *result)
+{
+    return run_export(info, info->netcdf_filename, "netcdf", time, result);
+}
+
+static int bench_import_netcdf(bench_info *info, double *time, long *result)
+{
+    return run_import(info->netcdf_filename, time, result);
+}
+
+#ifdef HAVE_HDF5
+static int bench_export_hdf5(bench_info *info, double *time, long *result)
+{
+    return run_export(info, info->hdf5_filename, "hdf5", time, result);
+}
+
+static int bench_import_hdf5(bench_info *info, double *time, long *result)
+{
+    return run_import(info->hdf5_filename, time, result);
+}
+#endif
+
+static int bench_matchup(bench_info *info, double *time, long *result)
+{
+    harp_collocation_result *collocation_result;
+    char *argv[8];
+    double start;
+
+    argv[0] = "matchup";
+    argv[1] = "-d";
+    argv[2] = "datetime 300 [s]";
+    argv[3] = "-d";
+    argv[4] = "point_distance 2000 [km]";
+    argv[5] = info->dataset_a_filename;
+    argv[6] = info->dataset_b_filename;
+    argv[7] = info->collocation_filename;
+
+    start = get_wall_time();
+    if (matchup(8, argv) != 0)
+    {
+        return -1;
+    }
+    *time = get_wall_time() - start;
+
+    if (harp_collocation_result_read(info->collocation_filename, &collocation_result) != 0)
+    {
+        return -1;
+    }
+    *result = collocation_result->num_pairs;
+    harp_collocation_result_delete(collocation_result);
+
+    return 0;
+}
+
+static benchmark benchmark_list[] = {
+    {"filter_value", bench_filter_value},
+    {"filter_point_distance", bench_filter_point_distance},
+    {"filter_area", bench_filter_area},
+    {"filter_area_fraction", bench_filter_area_fraction},
+    {"sort", bench_sort},
+    {"bin", bench_bin},
+    {"bin_full", bench_bin_full},
+    {"bin_spatial", bench_bin_spatial},
+    {"regrid", bench_regrid},
+    {"smooth", bench_smooth},
+    {"append", bench_append},
+    /* the import benchmarks read the files that were written by the export benchmarks */
+    {"export_netcdf", bench_export_netcdf},
+    {"import_netcdf", bench_import_netcdf},
+#ifdef HAVE_HDF5
+    {"export_hdf5", bench_export_hdf5},
+    {"import_hdf5", bench_import_hdf5},
+#endif
+    {"matchup", bench_matchup}
+};
+
+#define NUM_BENCHMARKS ((int)(sizeof(benchmark_list) / sizeof(benchmark_list[0])))
+
+static void bench_info_done(bench_info *info)
+{
+    harp_product_delete(info->product);
+    harp_product_delete(info->smooth_product);
+    harp_product_delete(info->avk_product);
+    remove(info->netcdf_filename);
+    remove(info->hdf5_filename);
+    remove(info->dataset_a_filename);
+    remove(info->dataset_b_filename);
+    remove(info->collocation_filename);
+}
+
+static int bench_info_init(bench_info *info)
+{
+    harp_product *product;
+    long num_time;
+
+    sprintf(info->netcdf_filename, "%s/harpbench.nc", info->tmpdir);
+    sprintf(info->hdf5_filename, "%s/harpbench.h5", info->tmpdir);
+    sprintf(info->dataset_a_filename, "%s/harpbench_a.nc", info->tmpdir);
+    sprintf(info->dataset_b_filename, "%s/harpbench_b.nc", info->tmpdir);
+    sprintf(info->collocation_filename, "%s/harpbench_collocation.csv", info->tmpdir);
+
+    random_init();
+
+    if (create_product(info->num_time, 1.0, info->num_vertical, info->num_spectral, "harpbench.nc", &info->product)
+        != 0)
+    {
+        return -1;
+    }
+
+    num_time = info->num_time / 10 > 0 ? info->num_time / 10 : 1;
+    if (create_product(num_time, 10.0, info->num_vertical, 0, "harpbench_smooth.nc", &info->smooth_product) != 0)
+    {
+        return -1;
+    }
+    if (create_product(num_time, 10.0, info->num_vertical, 0, "harpbench_avk.nc", &info->avk_product) != 0)
+    {
+        return -1;
+    }
+    if (add_averaging_kernels(info->avk_product, info->num_vertical) != 0)
+    {
+        return -1;
+    }
+
+    /* datasets for the matchup; both cover the same time range as the main product */
+    if (create_product(num_time, 10.0, 1, 0, "harpbench_a.nc", &product) != 0)
+    {
+        return -1;
+    }
+    if (harp_export(info->dataset_a_filename, "netcdf", product) != 0)
+    {
+        harp_product_delete(product);
+        return -1;
+    }
+    harp_product_delete(product);
+    num_time = info->num_time / 100 > 0 ? info->num_time / 100 : 1;
+    if (create_product(num_time, 100.0, 1, 0, "harpbench_b.nc", &product) != 0)
+    {
+        return -1;
+    }
+    if (harp_export(info->dataset_b_filename, "netcdf", product) != 0)
+    {
+        harp_product_delete(product);
+        return -1;
+    }
+    harp_product_delete(product);
+
+    return 0;
+}
+
+static int run_benchmark(bench_info *info, const benchmark *bench, int num_repeats)
+{
+    double min_time = 0;
+    double total_time = 0;
+    long result = 0;
+    int i;
+
+    for (i = 0; i < num_repeats; i++)
+    {
+        double time;
+
+        if (bench->run(info, &time, &result) != 0)
+        {
+            harp_add_error_message(" (benchmark '%s')", bench->name);
+            return -1;
+        }
+        if (i == 0 || time < min_time)
+        {
+            min_time = time;
+        }
+        total_time += time;
+    }
+
+    printf("%-24s %12.6f %12.6f %14ld\n", bench->name, min_time, total_time / num_repeats, result);
+    fflush(stdout);
+
+    return 0;
+}
+
+static int parse_count(const char *argument, long min_value, long *value)
+{
+    char *end;
+
+    *value = strtol(argument, &end, 10);
+    if (*end != '\0' || *value < min_value)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int bench(int argc, char *argv[])
+{
+    bench_info info;
+    int num_repeats = 3;
+    long value;
+    int i, j;
+
+    info.num_time = 50000;
+    info.num_vertical = 40;
+    info.num_spectral = 20;
+    info.tmpdir = getenv("TMPDIR");
+    if (info.tmpdir == NULL)
+    {
+        info.tmpdir = "/tmp";
+    }
+    info.product = NULL;
+    info.smooth_product = NULL;
+    info.avk_product = NULL;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--time") == 0 && i + 1 < argc && parse_count(argv[i + 1], 1, &value) == 0)
+        {
+            info.num_time = value;
+            i++;
+        }
+        else if (strcmp(argv[i], "--vertical") == 0 && i + 1 < argc && parse_count(argv[i + 1], 2, &value) == 0)
+        {
+            info.num_vertical = value;
+            i++;
+        }
+        else if (strcmp(argv[i], "--spectral") == 0 && i + 1 < argc && parse_count(argv[i + 1], 0, &value) == 0)
+        {
+            info.num_spectral = value;
+            i++;
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc && parse_count(argv[i + 1], 1, &value) == 0)
+        {
+            num_repeats = (int)value;
+            i++;
+        }
+        else if (strcmp(argv[i], "--tmpdir") == 0 && i + 1 < argc && argv[i + 1][0] != '-')
+        {
+            info.tmpdir = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "--list") == 0)
+        {
+            for (j = 0; j < NUM_BENCHMARKS; j++)
+            {
+                printf("%s\n", benchmark_list[j].name);
+            }
+            return 0;
+        }
+        else if (argv[i][0] != '-')
+        {
+            /* assume all arguments from here on are benchmark names */
+            break;
+        }
+        else
+        {
+            fprintf(stderr, "ERROR: invalid argument: '%s'\n", argv[i]);
+            print_help();
+            return -1;
+        }
+    }
+    for (j = i; j < argc; j++)
+    {
+        int k;
+
+        for (k = 0; k < NUM_BENCHMARKS; k++)
+        {
+            if (strcmp(argv[j], benchmark_list[k].name) == 0)
+            {
+                break;
+            }
+        }
+        if (k == NUM_BENCHMARKS)
+        {
+            fprintf(stderr, "ERROR: unknown benchmark: '%s'\n", argv[j]);
+            return -1;
+        }
+    }
+    if (strlen(info.tmpdir) > MAX_PATH_LENGTH - 32)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "tmpdir path too long");
+        return -1;
+    }
+
+    if (bench_info_init(&info) != 0)
+    {
+        bench_info_done(&info);
+        return -1;
+    }
+
+    printf("# harpbench %s time=%ld vertical=%ld spectral=%ld repeat=%d\n", libharp_version, info.num_time,
+           info.num_vertical, info.num_spectral, num_repeats);
+    printf("%-24s %12s %12s %14s\n", "# benchmark", "min [s]", "mean [s]", "result");
+    for (j = 0; j < NUM_BENCHMARKS; j++)
+    {
+        if (i < argc)
+        {
+            int k;
+
+            /* only run the selected benchmarks (but always in the order of the suite) */
+            for (k = i; k < argc; k++)
+            {
+                if (strcmp(argv[k], benchmark_list[j].name) == 0)
+                {
+                    break;
+                }
+            }
+            if (k == argc)
+            {
+                continue;
+            }
+        }
+        if (run_benchmark(&info, &benchmark_list[j], num_repeats) != 0)
+        {
+            bench_info_done(&info);
+            return -1;
+        }
+    }
+
+    bench_info_done(&info);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int result;
+
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0))
+    {
+        print_help();
+        exit(0);
+    }
+
+    if (argc > 1 && (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--version") == 0))
+    {
+        print_version();
+        exit(0);
+    }
+
+    if (harp_set_coda_definition_path_conditional(argv[0], NULL, "../share/coda/definitions") != 0)
+    {
+        fprintf(stderr, "ERROR: %s\n", harp_errno_to_string(harp_errno));
+        exit(1);
+    }
+    if (harp_set_udunits2_xml_path_conditional(argv[0], NULL, "../share/harp/udunits2.xml") != 0)
+    {
+        fprintf(stderr, "ERROR: %s\n", harp_errno_to_string(harp_errno));
+        exit(1);
+    }
+
+    harp_set_warning_handler(print_warning);
+
+    if (harp_init() != 0)
+    {
+        fprintf(stderr, "ERROR: %s\n", harp_errno_to_string(harp_errno));
+        exit(1);
+    }
+
+    result = bench(argc, argv);
+    if (result != 0)
+    {
+        if (harp_errno != HARP_SUCCESS)
+        {
+            fprintf(stderr, "ERROR: %s\n", harp_errno_to_string(harp_errno));
+        }
+        harp_done();
+        exit(1);
+    }
+
+    harp_done();
+    return 0;
+}
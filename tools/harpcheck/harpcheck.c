@@ -60,13 +60,23 @@ static void print_version(void)
 static void print_help(void)
 {
     printf("Usage:\n");
-    printf("    harpcheck <input product file> [input product file...]\n");
+    printf("    harpcheck [options] <input product file> [input product file...]\n");
     printf("        If the product is a HARP product then verify that the\n");
     printf("        product is HARP compliant.\n");
     printf("        Otherwise, try to import the product using an applicable\n");
     printf("        ingestion module and test the ingestion for all possible\n");
     printf("        ingestion options.\n");
     printf("\n");
+    printf("        Options:\n");
+    printf("            -f, --fast\n");
+    printf("                Only check the product definition and dimensions for\n");
+    printf("                each combination of ingestion options, without\n");
+    printf("                reading any variable data.\n");
+    printf("            -j, --jobs <n>\n");
+    printf("                Test the combinations of ingestion options using n\n");
+    printf("                worker processes. The results are still reported in\n");
+    printf("                the same order as for a sequential test.\n");
+    printf("\n");
     printf("    harpcheck -h, --help\n");
     printf("        Show help (this text).\n");
     printf("\n");
@@ -77,6 +87,8 @@ static void print_help(void)
 
 int main(int argc, char *argv[])
 {
+    int definitions_only = 0;
+    int num_jobs = 1;
     int result = 0;
     int i;
 
@@ -92,7 +104,33 @@ int main(int argc, char *argv[])
         exit(0);
     }
 
-    if (argv[1][0] == '-')
+    i = 1;
+    while (i < argc && argv[i][0] == '-')
+    {
+        if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--fast") == 0)
+        {
+            definitions_only = 1;
+            i++;
+        }
+        else if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) && i + 1 < argc &&
+                 argv[i + 1][0] != '-')
+        {
+            num_jobs = atoi(argv[i + 1]);
+            if (num_jobs < 1)
+            {
+                fprintf(stderr, "ERROR: invalid number of jobs\n");
+                print_help();
+                exit(1);
+            }
+            i += 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (i == argc || argv[i][0] == '-')
     {
         fprintf(stderr, "ERROR: invalid arguments\n");
         print_help();
@@ -119,12 +157,12 @@ int main(int argc, char *argv[])
         exit(1);
     }
 
-    for (i = 1; i < argc; i++)
+    for (; i < argc; i++)
     {
         const char *filename = argv[i];
         int status;
 
-        status = harp_import_test(filename, printf);
+        status = harp_import_test_parallel(filename, definitions_only, num_jobs, printf);
         if (status != 0)
         {
             if (status < 0)
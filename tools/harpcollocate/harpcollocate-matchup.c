@@ -803,6 +803,7 @@ static void reindex_collocation_indices(harp_collocation_result *collocation_res
 
     for (i = 0; i < collocation_result->num_pairs; i++)
     {
+        collocation_result->collocation_index[i] = i;
         collocation_result->pair[i]->collocation_index = i;
     }
 }
@@ -957,12 +958,14 @@ static int perform_matchup_on_measurements(collocation_info *info, long index_a,
 
                 for (i = 0; i < info->collocation_result->num_pairs; i++)
                 {
-                    harp_collocation_pair *pair = info->collocation_result->pair[i];
-
-                    if (pair->product_index_a == product_index && pair->sample_index_a == sample_index)
+                    if (info->collocation_result->product_index_a[i] == product_index &&
+                        info->collocation_result->sample_index_a[i] == sample_index)
                     {
-                        if (fabs(pair->difference[info->nearest_neighbour_x_criterium_index]) <=
-                            fabs(info->difference[info->nearest_neighbour_x_criterium_index]))
+                        int num_differences = info->collocation_result->num_differences;
+                        int difference_index = info->nearest_neighbour_x_criterium_index;
+
+                        if (fabs(info->collocation_result->difference[i * num_differences + difference_index]) <=
+                            fabs(info->difference[difference_index]))
                         {
                             /* existing pair is closer -> ignore the new pair */
                             return 0;
@@ -996,12 +999,14 @@ static int perform_matchup_on_measurements(collocation_info *info, long index_a,
 
                 for (i = 0; i < info->collocation_result->num_pairs; i++)
                 {
-                    harp_collocation_pair *pair = info->collocation_result->pair[i];
-
-                    if (pair->product_index_b == product_index && pair->sample_index_b == sample_index)
+                    if (info->collocation_result->product_index_b[i] == product_index &&
+                        info->collocation_result->sample_index_b[i] == sample_index)
                     {
-                        if (fabs(pair->difference[info->nearest_neighbour_y_criterium_index]) <=
-                            fabs(info->difference[info->nearest_neighbour_y_criterium_index]))
+                        int num_differences = info->collocation_result->num_differences;
+                        int difference_index = info->nearest_neighbour_y_criterium_index;
+
+                        if (fabs(info->collocation_result->difference[i * num_differences + difference_index]) <=
+                            fabs(info->difference[difference_index]))
                         {
                             /* existing pair is closer -> ignore the new pair */
                             return 0;
@@ -1028,7 +1033,7 @@ static int perform_matchup_on_measurements(collocation_info *info, long index_a,
     else
     {
         collocation_index =
-            info->collocation_result->pair[info->collocation_result->num_pairs - 1]->collocation_index + 1;
+            info->collocation_result->collocation_index[info->collocation_result->num_pairs - 1] + 1;
     }
     if (harp_collocation_result_add_pair(info->collocation_result, collocation_index, info->product_a->source_product,
                                          info->variables_a.index->data.int32_data[index_a],
@@ -148,72 +148,194 @@ static int resample_info_update(resample_info *info)
     return 0;
 }
 
-int resample_nearest_a(harp_collocation_result *collocation_result, int difference_index)
+/* returns whether pair index_a comes before pair index_b when sorting on source product name and sample index of the
+ * given side of the collocation (using the pair index itself if these are the same)
+ */
+static int pair_comes_before(const long *product_rank, const long *product_index, const long *sample_index,
+                             long index_a, long index_b)
+{
+    if (product_index[index_a] != product_index[index_b])
+    {
+        return product_rank[product_index[index_a]] < product_rank[product_index[index_b]];
+    }
+    if (sample_index[index_a] != sample_index[index_b])
+    {
+        return sample_index[index_a] < sample_index[index_b];
+    }
+    return index_a < index_b;
+}
+
+/* keep for each sample of dataset A (use_a = 1) or dataset B (use_a = 0) only the pair with the smallest absolute
+ * difference for the given criterium; pairs are grouped using a hash table on (product index, sample index), so no
+ * sorting is needed and the remaining pairs keep their order.
+ * If there are multiple pairs with the same smallest difference, the pair that comes first when sorting on the
+ * other dataset is kept. NaN differences are ignored, unless the last pair (in the sort order of the other dataset)
+ * has a NaN difference, in which case that pair is kept (this is consistent with a pairwise reduction of the pairs
+ * sorted by the other dataset).
+ */
+static int resample_nearest(harp_collocation_result *collocation_result, int use_a, int difference_index)
 {
+    harp_dataset *other_dataset = use_a ? collocation_result->dataset_b : collocation_result->dataset_a;
+    const long *product_index = use_a ? collocation_result->product_index_a : collocation_result->product_index_b;
+    const long *sample_index = use_a ? collocation_result->sample_index_a : collocation_result->sample_index_b;
+    const long *other_product_index = use_a ? collocation_result->product_index_b : collocation_result->product_index_a;
+    const long *other_sample_index = use_a ? collocation_result->sample_index_b : collocation_result->sample_index_a;
+    int num_differences = collocation_result->num_differences;
+    long *other_product_rank = NULL;
+    long *last = NULL;  /* per slot: last pair of the group (sorted by other dataset), -1 for an empty slot */
+    long *best = NULL;  /* per slot: pair with smallest non-NaN difference, -1 if there is none */
+    uint8_t *mask = NULL;
+    long table_size = 1;
     long i;
 
-    if (harp_collocation_result_sort_by_a(collocation_result) != 0)
+    if (collocation_result->num_pairs < 2)
     {
-        return -1;
+        return 0;
+    }
+
+    other_product_rank = malloc((other_dataset->num_products > 0 ? other_dataset->num_products : 1) * sizeof(long));
+    if (other_product_rank == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       other_dataset->num_products * sizeof(long), __FILE__, __LINE__);
+        goto error;
+    }
+    for (i = 0; i < other_dataset->num_products; i++)
+    {
+        other_product_rank[other_dataset->sorted_index[i]] = i;
+    }
+
+    /* use a load factor of at most 2/3 */
+    while (2 * table_size < 3 * collocation_result->num_pairs)
+    {
+        table_size *= 2;
     }
-    for (i = collocation_result->num_pairs - 1; i > 0; i--)
+    last = malloc(table_size * sizeof(long));
+    if (last == NULL)
     {
-        if (collocation_result->pair[i]->product_index_a == collocation_result->pair[i - 1]->product_index_a &&
-            collocation_result->pair[i]->sample_index_a == collocation_result->pair[i - 1]->sample_index_a)
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       table_size * sizeof(long), __FILE__, __LINE__);
+        goto error;
+    }
+    best = malloc(table_size * sizeof(long));
+    if (best == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       table_size * sizeof(long), __FILE__, __LINE__);
+        goto error;
+    }
+    for (i = 0; i < table_size; i++)
+    {
+        last[i] = -1;
+        best[i] = -1;
+    }
+
+    for (i = 0; i < collocation_result->num_pairs; i++)
+    {
+        double difference = collocation_result->difference[i * num_differences + difference_index];
+        uint64_t hash;
+        long slot;
+
+        hash = ((uint64_t)product_index[i] * 0x9E3779B97F4A7C15) ^ (uint64_t)sample_index[i];
+        hash *= 0xBF58476D1CE4E5B9;
+        hash ^= hash >> 31;
+        slot = (long)(hash & (uint64_t)(table_size - 1));
+        while (last[slot] != -1 && (product_index[last[slot]] != product_index[i] ||
+                                    sample_index[last[slot]] != sample_index[i]))
         {
-            if (fabs(collocation_result->pair[i]->difference[difference_index]) >=
-                fabs(collocation_result->pair[i - 1]->difference[difference_index]))
+            slot = (slot + 1) & (table_size - 1);
+        }
+
+        if (last[slot] == -1 ||
+            pair_comes_before(other_product_rank, other_product_index, other_sample_index, last[slot], i))
+        {
+            last[slot] = i;
+        }
+        if (!harp_isnan(difference))
+        {
+            if (best[slot] == -1)
             {
-                if (harp_collocation_result_remove_pair_at_index(collocation_result, i) != 0)
-                {
-                    return -1;
-                }
+                best[slot] = i;
             }
             else
             {
-                if (harp_collocation_result_remove_pair_at_index(collocation_result, i - 1) != 0)
+                double best_difference = fabs(collocation_result->difference[best[slot] * num_differences +
+                                                                             difference_index]);
+
+                if (fabs(difference) < best_difference ||
+                    (fabs(difference) == best_difference &&
+                     pair_comes_before(other_product_rank, other_product_index, other_sample_index, i, best[slot])))
                 {
-                    return -1;
+                    best[slot] = i;
                 }
             }
         }
     }
 
-    return 0;
-}
-
-int resample_nearest_b(harp_collocation_result *collocation_result, int difference_index)
-{
-    long i;
-
-    if (harp_collocation_result_sort_by_b(collocation_result) != 0)
+    mask = calloc(collocation_result->num_pairs, sizeof(uint8_t));
+    if (mask == NULL)
     {
-        return -1;
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       collocation_result->num_pairs * sizeof(uint8_t), __FILE__, __LINE__);
+        goto error;
     }
-    for (i = collocation_result->num_pairs - 1; i > 0; i--)
+    for (i = 0; i < table_size; i++)
     {
-        if (collocation_result->pair[i]->product_index_b == collocation_result->pair[i - 1]->product_index_b &&
-            collocation_result->pair[i]->sample_index_b == collocation_result->pair[i - 1]->sample_index_b)
+        if (last[i] != -1)
         {
-            if (fabs(collocation_result->pair[i]->difference[difference_index]) >=
-                fabs(collocation_result->pair[i - 1]->difference[difference_index]))
+            if (best[i] == -1 || harp_isnan(collocation_result->difference[last[i] * num_differences +
+                                                                            difference_index]))
             {
-                if (harp_collocation_result_remove_pair_at_index(collocation_result, i) != 0)
-                {
-                    return -1;
-                }
+                mask[last[i]] = 1;
             }
             else
             {
-                if (harp_collocation_result_remove_pair_at_index(collocation_result, i - 1) != 0)
-                {
-                    return -1;
-                }
+                mask[best[i]] = 1;
             }
         }
     }
 
+    if (harp_collocation_result_filter(collocation_result, mask) != 0)
+    {
+        goto error;
+    }
+
+    free(mask);
+    free(best);
+    free(last);
+    free(other_product_rank);
+
     return 0;
+
+  error:
+    if (mask != NULL)
+    {
+        free(mask);
+    }
+    if (best != NULL)
+    {
+        free(best);
+    }
+    if (last != NULL)
+    {
+        free(last);
+    }
+    if (other_product_rank != NULL)
+    {
+        free(other_product_rank);
+    }
+
+    return -1;
+}
+
+int resample_nearest_a(harp_collocation_result *collocation_result, int difference_index)
+{
+    return resample_nearest(collocation_result, 1, difference_index);
+}
+
+int resample_nearest_b(harp_collocation_result *collocation_result, int difference_index)
+{
+    return resample_nearest(collocation_result, 0, difference_index);
 }
 
 int resample(int argc, char *argv[])
@@ -35,8 +35,15 @@
 
 #include "harp.h"
 
+#include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 /* this function requires collocation_result to be sorted by collocation_index */
 static long get_index_for_collocation_index(const harp_collocation_result *collocation_result,
@@ -55,7 +62,7 @@ static long get_index_for_collocation_index(const harp_collocation_result *collo
         long pivot_index = lower_index + ((upper_index - lower_index) / 2);
 
         /* If the pivot equals the index to be found, terminate early. */
-        if (collocation_result->pair[pivot_index]->collocation_index == collocation_index)
+        if (collocation_result->collocation_index[pivot_index] == collocation_index)
         {
             return pivot_index;
         }
@@ -63,7 +70,7 @@ static long get_index_for_collocation_index(const harp_collocation_result *collo
         /* If the pivot is smaller than the index to be found, search the upper sub array, otherwise search the lower
          * sub array.
          */
-        if (collocation_result->pair[pivot_index]->collocation_index < collocation_index)
+        if (collocation_result->collocation_index[pivot_index] < collocation_index)
         {
             lower_index = pivot_index + 1;
         }
@@ -83,6 +90,7 @@ static int update_mask_for_product(const harp_collocation_result *collocation_re
     harp_variable *collocation_index;
     long i;
 
+    /* the leading keep() makes sure that only the collocation_index variable is read from the file */
     if (harp_import(product_path, "keep(collocation_index);derive(collocation_index int32 {time})", NULL, &product) !=
         0)
     {
@@ -102,7 +110,7 @@ static int update_mask_for_product(const harp_collocation_result *collocation_re
         index = get_index_for_collocation_index(collocation_result, collocation_index->data.int32_data[i]);
         if (index < 0)
         {
-            harp_set_error(HARP_ERROR_INVALID_PRODUCT, "collocation result does contain collocation index %d",
+            harp_set_error(HARP_ERROR_INVALID_PRODUCT, "collocation result does not contain collocation index %d",
                            collocation_index->data.int32_data[i]);
             harp_product_delete(product);
             return -1;
@@ -114,42 +122,306 @@ static int update_mask_for_product(const harp_collocation_result *collocation_re
     return 0;
 }
 
-static int update_collocation_result(harp_collocation_result *collocation_result, harp_dataset *dataset)
+/* update the mask for the products first, first + step, first + 2 * step, ... of the dataset */
+static int update_mask_for_products(const harp_collocation_result *collocation_result, const harp_dataset *dataset,
+                                    long first, long step, uint8_t *mask)
 {
-    uint8_t *mask = NULL;
     long i;
 
+    for (i = first; i < dataset->num_products; i += step)
+    {
+        if (update_mask_for_product(collocation_result, dataset->metadata[i]->filename, mask) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+#ifndef WIN32
+static int write_buffer(int fd, const void *buffer, size_t size)
+{
+    const char *data = (const char *)buffer;
+
+    while (size > 0)
+    {
+        ssize_t result = write(fd, data, size);
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        data += result;
+        size -= result;
+    }
+
+    return 0;
+}
+
+static int read_buffer(int fd, void *buffer, size_t size)
+{
+    char *data = (char *)buffer;
+
+    while (size > 0)
+    {
+        ssize_t result = read(fd, data, size);
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            harp_set_error(HARP_ERROR_FILE_READ, "could not read result from worker process (%s)", strerror(errno));
+            return -1;
+        }
+        if (result == 0)
+        {
+            harp_set_error(HARP_ERROR_FILE_READ, "worker process terminated unexpectedly");
+            return -1;
+        }
+        data += result;
+        size -= result;
+    }
+
+    return 0;
+}
+
+/* Worker process: determine the mask for its share of the products and write it to the pipe.
+ * The result is written as an int status (0 or harp_errno) followed by either the mask or the length and text of
+ * the error message.
+ */
+static void run_worker(const harp_collocation_result *collocation_result, const harp_dataset *dataset,
+                       long worker_index, long num_workers, int fd)
+{
+    uint8_t *mask;
+    int status = 0;
+
     mask = calloc(collocation_result->num_pairs, sizeof(uint8_t));
     if (mask == NULL)
     {
         harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
                        collocation_result->num_pairs * sizeof(uint8_t), __FILE__, __LINE__);
-        return -1;
+        status = harp_errno;
     }
-    for (i = 0; i < collocation_result->num_pairs; i++)
+    else if (update_mask_for_products(collocation_result, dataset, worker_index, num_workers, mask) != 0)
     {
-        mask[i] = 0;
+        status = harp_errno;
     }
 
-    for (i = 0; i < dataset->num_products; i++)
+    if (write_buffer(fd, &status, sizeof(int)) == 0)
     {
-        if (update_mask_for_product(collocation_result, dataset->metadata[i]->filename, mask) != 0)
+        if (status == 0)
+        {
+            write_buffer(fd, mask, collocation_result->num_pairs * sizeof(uint8_t));
+        }
+        else
+        {
+            const char *message = harp_errno_to_string(status);
+            long length = (long)strlen(message);
+
+            if (write_buffer(fd, &length, sizeof(long)) == 0)
+            {
+                write_buffer(fd, message, length);
+            }
+        }
+    }
+    close(fd);
+
+    /* don't run exit handlers or flush stdio buffers that are shared with the parent process */
+    _exit(0);
+}
+
+/* Receive the mask of a worker process and merge it into the given mask */
+static int merge_worker_mask(int fd, long num_pairs, uint8_t *worker_mask, uint8_t *mask)
+{
+    char *message;
+    long length;
+    long i;
+    int status;
+
+    if (read_buffer(fd, &status, sizeof(int)) != 0)
+    {
+        return -1;
+    }
+    if (status == 0)
+    {
+        if (read_buffer(fd, worker_mask, num_pairs * sizeof(uint8_t)) != 0)
         {
-            free(mask);
             return -1;
         }
+        for (i = 0; i < num_pairs; i++)
+        {
+            mask[i] |= worker_mask[i];
+        }
+        return 0;
     }
 
-    for (i = collocation_result->num_pairs - 1; i >= 0; i--)
+    if (read_buffer(fd, &length, sizeof(long)) != 0)
+    {
+        return -1;
+    }
+    message = malloc(length + 1);
+    if (message == NULL)
     {
-        if (!mask[i])
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       (size_t)(length + 1), __FILE__, __LINE__);
+        return -1;
+    }
+    if (read_buffer(fd, message, length) != 0)
+    {
+        free(message);
+        return -1;
+    }
+    message[length] = '\0';
+    harp_set_error(status, "%s", message);
+    free(message);
+
+    return -1;
+}
+
+/* Distribute the products of the dataset over 'num_workers' worker processes.
+ * Each worker imports its share of the products and returns a mask of the pairs it found, which are then combined.
+ * Separate processes are used (instead of threads) since the HARP library and the libraries it uses for reading
+ * products are not thread-safe.
+ */
+static int update_mask_with_workers(const harp_collocation_result *collocation_result, const harp_dataset *dataset,
+                                    long num_workers, uint8_t *mask)
+{
+    uint8_t *worker_mask;
+    pid_t *pid;
+    int *fd;
+    int result = 0;
+    long i;
+
+    pid = malloc(num_workers * sizeof(pid_t));
+    if (pid == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_workers * sizeof(pid_t), __FILE__, __LINE__);
+        return -1;
+    }
+    fd = malloc(num_workers * sizeof(int));
+    if (fd == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_workers * sizeof(int), __FILE__, __LINE__);
+        free(pid);
+        return -1;
+    }
+    worker_mask = malloc(collocation_result->num_pairs * sizeof(uint8_t));
+    if (worker_mask == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       collocation_result->num_pairs * sizeof(uint8_t), __FILE__, __LINE__);
+        free(fd);
+        free(pid);
+        return -1;
+    }
+
+    /* make sure buffered output does not get written by each of the worker processes */
+    fflush(NULL);
+
+    for (i = 0; i < num_workers; i++)
+    {
+        int pipe_fd[2];
+
+        if (pipe(pipe_fd) != 0)
         {
-            if (harp_collocation_result_remove_pair_at_index(collocation_result, i) != 0)
-            {
-                free(mask);
-                return -1;
-            }
+            harp_set_error(HARP_ERROR_FILE_OPEN, "could not create pipe (%s)", strerror(errno));
+            result = -1;
+            break;
+        }
+        pid[i] = fork();
+        if (pid[i] < 0)
+        {
+            harp_set_error(HARP_ERROR_OPERATION, "could not create worker process (%s)", strerror(errno));
+            close(pipe_fd[0]);
+            close(pipe_fd[1]);
+            result = -1;
+            break;
+        }
+        if (pid[i] == 0)
+        {
+            close(pipe_fd[0]);
+            run_worker(collocation_result, dataset, i, num_workers, pipe_fd[1]);
+        }
+        close(pipe_fd[1]);
+        fd[i] = pipe_fd[0];
+    }
+    num_workers = i;
+
+    /* the workers only block on writing their result, so collecting the results in order does not delay them */
+    for (i = 0; i < num_workers; i++)
+    {
+        if (result == 0 && merge_worker_mask(fd[i], collocation_result->num_pairs, worker_mask, mask) != 0)
+        {
+            result = -1;
         }
+        close(fd[i]);
+        waitpid(pid[i], NULL, 0);
+    }
+
+    free(worker_mask);
+    free(fd);
+    free(pid);
+
+    return result;
+}
+#endif
+
+static int update_collocation_result(harp_collocation_result *collocation_result, harp_dataset *dataset,
+                                     long num_workers)
+{
+    uint8_t *mask = NULL;
+    int result;
+    long i;
+
+    mask = calloc(collocation_result->num_pairs, sizeof(uint8_t));
+    if (mask == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       collocation_result->num_pairs * sizeof(uint8_t), __FILE__, __LINE__);
+        return -1;
+    }
+    for (i = 0; i < collocation_result->num_pairs; i++)
+    {
+        mask[i] = 0;
+    }
+
+#ifndef WIN32
+    if (num_workers > dataset->num_products)
+    {
+        num_workers = dataset->num_products;
+    }
+    if (num_workers > 1)
+    {
+        result = update_mask_with_workers(collocation_result, dataset, num_workers, mask);
+    }
+    else
+    {
+        result = update_mask_for_products(collocation_result, dataset, 0, 1, mask);
+    }
+#else
+    (void)num_workers;
+    result = update_mask_for_products(collocation_result, dataset, 0, 1, mask);
+#endif
+    if (result != 0)
+    {
+        free(mask);
+        return -1;
+    }
+
+    /* remove all pairs for which the measurements no longer exist in one go */
+    if (harp_collocation_result_filter(collocation_result, mask) != 0)
+    {
+        free(mask);
+        return -1;
     }
 
     free(mask);
@@ -161,26 +433,58 @@ int update(int argc, char *argv[])
 {
     harp_collocation_result *collocation_result;
     harp_dataset *dataset;
+    const char *input;
+    const char *dataset_path;
     const char *output;
+    long num_workers = 1;
+    int i;
+
+#ifndef WIN32
+    num_workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_workers < 1)
+    {
+        num_workers = 1;
+    }
+#endif
+
+    i = 2;
+    while (i < argc && argv[i][0] == '-')
+    {
+        if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) && i + 1 < argc && argv[i + 1][0] != '-')
+        {
+            num_workers = atol(argv[i + 1]);
+            if (num_workers < 1)
+            {
+                return 1;
+            }
+            i += 2;
+        }
+        else
+        {
+            return 1;
+        }
+    }
 
-    if (argc < 4 || argc > 5 || argv[2][0] == '-' || argv[3][0] == '-')
+    if (argc - i < 2 || argc - i > 3 || argv[i + 1][0] == '-')
     {
         return 1;
     }
-    if (argc == 5)
+    input = argv[i];
+    dataset_path = argv[i + 1];
+    if (argc - i == 3)
     {
-        if (argv[4][0] == '-')
+        if (argv[i + 2][0] == '-')
         {
             return 1;
         }
-        output = argv[4];
+        output = argv[i + 2];
     }
     else
     {
-        output = argv[2];
+        output = input;
     }
 
-    if (harp_collocation_result_read(argv[2], &collocation_result) != 0)
+    if (harp_collocation_result_read(input, &collocation_result) != 0)
     {
         return -1;
     }
@@ -195,14 +499,14 @@ int update(int argc, char *argv[])
         harp_collocation_result_delete(collocation_result);
         return -1;
     }
-    if (harp_dataset_import(dataset, argv[3], NULL) != 0)
+    if (harp_dataset_import(dataset, dataset_path, NULL) != 0)
     {
         harp_collocation_result_delete(collocation_result);
         harp_dataset_delete(dataset);
         return -1;
     }
 
-    if (update_collocation_result(collocation_result, dataset) != 0)
+    if (update_collocation_result(collocation_result, dataset, num_workers) != 0)
     {
         harp_collocation_result_delete(collocation_result);
         harp_dataset_delete(dataset);
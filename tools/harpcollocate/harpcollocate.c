@@ -142,11 +142,17 @@ static void print_help(void)
     printf("        The order in which -nx and -ny are provided determines the order in\n");
     printf("        which the nearest filters are executed.\n");
     printf("\n");
-    printf("    harpcollocate --update <inputpath> <datasetpath> [<outputpath>]\n");
+    printf("    harpcollocate --update [options] <inputpath> <datasetpath> [<outputpath>]\n");
     printf("        Update an existing collocation result file by checking the\n");
     printf("        measurements in the given dataset and only keeping pairs\n");
     printf("        for which measurements still exist\n");
     printf("\n");
+    printf("        Options:\n");
+    printf("            -j, --jobs <n>\n");
+    printf("                Number of worker processes that read the products of the\n");
+    printf("                dataset. By default the number of available processors is\n");
+    printf("                used. Not applicable on Windows.\n");
+    printf("\n");
     printf("    harpcollocate -h, --help\n");
     printf("        Show help (this text).\n");
     printf("\n");
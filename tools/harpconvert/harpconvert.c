@@ -36,6 +36,7 @@
 #include "harp.h"
 
 #include <assert.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -51,6 +52,48 @@ static int print_warning(const char *message, va_list ap)
     return result;
 }
 
+static FILE *profile_file = NULL;
+
+static int print_profile(const char *message, ...)
+{
+    va_list ap;
+    int result;
+
+    va_start(ap, message);
+    result = vfprintf(profile_file, message, ap);
+    va_end(ap);
+
+    return result;
+}
+
+static int open_profile(const char *filename)
+{
+    if (profile_file != NULL)
+    {
+        fclose(profile_file);
+    }
+    profile_file = fopen(filename, "w");
+    if (profile_file == NULL)
+    {
+        harp_set_error(HARP_ERROR_FILE_OPEN, "could not open '%s' (%s)", filename, strerror(errno));
+        return -1;
+    }
+
+    return harp_set_option_profiling(1);
+}
+
+/* write the profiling report for the product and the run totals (if profiling was enabled) */
+static void write_profile(const char *product_name)
+{
+    if (profile_file != NULL)
+    {
+        harp_profiling_print_product_report(product_name, print_profile);
+        harp_profiling_print_run_report(print_profile);
+        fclose(profile_file);
+        profile_file = NULL;
+    }
+}
+
 static void print_version(void)
 {
     printf("harpconvert version %s\n", libharp_version);
@@ -89,6 +132,18 @@ static void print_help(void)
     printf("                Set data compression level for storing in HDF5 format.\n");
     printf("                0=disabled, 1=low, ..., 9=high.\n");
     printf("\n");
+    printf("            --hdf5-chunk-size <samples>\n");
+    printf("                Store compressed time dependent variables in HDF5 format\n");
+    printf("                using chunks of the given number of time samples.\n");
+    printf("                0=single chunk per variable (default).\n");
+    printf("\n");
+    printf("            --profile <file>\n");
+    printf("                Write a profiling report for the operations to the given\n");
+    printf("                file. The report contains a JSON object per line with the\n");
+    printf("                wall time, number of elements in/out, and amount of memory\n");
+    printf("                allocated/freed for each operation, followed by the totals\n");
+    printf("                per operation type.\n");
+    printf("\n");
     printf("            --no-history\n");
     printf("                Do not update the global history attribute.\n");
     printf("\n");
@@ -177,6 +232,24 @@ static int convert(int argc, char *argv[])
             }
             i++;
         }
+        else if (strcmp(argv[i], "--hdf5-chunk-size") == 0 && i + 1 < argc && argv[i + 1][0] != '-')
+        {
+            if (harp_set_option_hdf5_chunk_size(atoi(argv[i + 1])) != 0)
+            {
+                fprintf(stderr, "ERROR: invalid hdf5 chunk size argument: '%s'\n", argv[i]);
+                print_help();
+                return -1;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc && argv[i + 1][0] != '-')
+        {
+            if (open_profile(argv[i + 1]) != 0)
+            {
+                return -1;
+            }
+            i++;
+        }
         else if (strcmp(argv[i], "--no-history") == 0)
         {
             update_history = 0;
@@ -206,8 +279,10 @@ static int convert(int argc, char *argv[])
 
     if (harp_import(input_filename, operations, options, &product) != 0)
     {
+        write_profile(input_filename);
         return -1;
     }
+    write_profile(input_filename);
 
     if (harp_product_is_empty(product))
     {
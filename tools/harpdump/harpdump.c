@@ -36,6 +36,7 @@
 #include "harp.h"
 
 #include <assert.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -51,6 +52,48 @@ static int print_warning(const char *message, va_list ap)
     return result;
 }
 
+static FILE *profile_file = NULL;
+
+static int print_profile(const char *message, ...)
+{
+    va_list ap;
+    int result;
+
+    va_start(ap, message);
+    result = vfprintf(profile_file, message, ap);
+    va_end(ap);
+
+    return result;
+}
+
+static int open_profile(const char *filename)
+{
+    if (profile_file != NULL)
+    {
+        fclose(profile_file);
+    }
+    profile_file = fopen(filename, "w");
+    if (profile_file == NULL)
+    {
+        harp_set_error(HARP_ERROR_FILE_OPEN, "could not open '%s' (%s)", filename, strerror(errno));
+        return -1;
+    }
+
+    return harp_set_option_profiling(1);
+}
+
+/* write the profiling report for the product and the run totals (if profiling was enabled) */
+static void write_profile(const char *product_name)
+{
+    if (profile_file != NULL)
+    {
+        harp_profiling_print_product_report(product_name, print_profile);
+        harp_profiling_print_run_report(print_profile);
+        fclose(profile_file);
+        profile_file = NULL;
+    }
+}
+
 static void print_version(void)
 {
     printf("harpdump version %s\n", libharp_version);
@@ -83,6 +126,13 @@ static void print_help(void)
     printf("            -d, --data\n");
     printf("                Show data values for each variable.\n");
     printf("\n");
+    printf("            --profile <file>\n");
+    printf("                Write a profiling report for the operations to the given\n");
+    printf("                file. The report contains a JSON object per line with the\n");
+    printf("                wall time, number of elements in/out, and amount of memory\n");
+    printf("                allocated/freed for each operation, followed by the totals\n");
+    printf("                per operation type.\n");
+    printf("\n");
     printf("            --no-history\n");
     printf("                Do not show the global history attribute.\n");
     printf("\n");
@@ -180,8 +230,8 @@ static int list_derivations(int argc, char *argv[])
         return harp_doc_list_conversions(NULL, variable_name, printf);
     }
 
-    /* Import the product */
-    if (harp_import(input_filename, operations, options, &product) != 0)
+    /* Import the product structure (the conversions only depend on the variable definitions, not on the data) */
+    if (harp_import_schema(input_filename, operations, options, &product) != 0)
     {
         return -1;
     }
@@ -277,6 +327,14 @@ static int dump(int argc, char *argv[])
         {
             data = 1;
         }
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc && argv[i + 1][0] != '-')
+        {
+            if (open_profile(argv[i + 1]) != 0)
+            {
+                return -1;
+            }
+            i++;
+        }
         else if (strcmp(argv[i], "--no-history") == 0)
         {
             show_history = 0;
@@ -301,10 +359,24 @@ static int dump(int argc, char *argv[])
         return -1;
     }
 
-    if (harp_import(argv[argc - 1], operations, options, &product) != 0)
+    if (data && !list)
     {
-        return -1;
+        if (harp_import(argv[argc - 1], operations, options, &product) != 0)
+        {
+            write_profile(argv[argc - 1]);
+            return -1;
+        }
+    }
+    else
+    {
+        /* only the structure of the product is shown, so there is no need to read the variable data */
+        if (harp_import_schema(argv[argc - 1], operations, options, &product) != 0)
+        {
+            write_profile(argv[argc - 1]);
+            return -1;
+        }
     }
+    write_profile(argv[argc - 1]);
 
     if (show_history)
     {
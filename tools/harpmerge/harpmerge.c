@@ -35,6 +35,7 @@
 
 #include "harp.h"
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -50,6 +51,55 @@ static int print_warning(const char *message, va_list ap)
     return result;
 }
 
+static FILE *profile_file = NULL;
+
+static int print_profile(const char *message, ...)
+{
+    va_list ap;
+    int result;
+
+    va_start(ap, message);
+    result = vfprintf(profile_file, message, ap);
+    va_end(ap);
+
+    return result;
+}
+
+static int open_profile(const char *filename)
+{
+    if (profile_file != NULL)
+    {
+        fclose(profile_file);
+    }
+    profile_file = fopen(filename, "w");
+    if (profile_file == NULL)
+    {
+        harp_set_error(HARP_ERROR_FILE_OPEN, "could not open '%s' (%s)", filename, strerror(errno));
+        return -1;
+    }
+
+    return harp_set_option_profiling(1);
+}
+
+static void write_profile_product(const char *product_name)
+{
+    if (profile_file != NULL)
+    {
+        harp_profiling_print_product_report(product_name, print_profile);
+    }
+}
+
+/* write the run totals of the profiling report (if profiling was enabled) */
+static void close_profile(void)
+{
+    if (profile_file != NULL)
+    {
+        harp_profiling_print_run_report(print_profile);
+        fclose(profile_file);
+        profile_file = NULL;
+    }
+}
+
 static void print_version(void)
 {
     printf("harpmerge version %s\n", libharp_version);
@@ -88,6 +138,18 @@ static void print_help(void)
     printf("                See the 'operations' section of the HARP documentation for\n");
     printf("                more details.\n");
     printf("\n");
+    printf("            --bin-spatial <lat_edge_length>,<lat_edge_offset>,<lat_edge_step>,\n");
+    printf("                          <lon_edge_length>,<lon_edge_offset>,<lon_edge_step>\n");
+    printf("                Spatially bin the products onto a latitude/longitude grid\n");
+    printf("                while they are read, instead of concatenating them.\n");
+    printf("                The result is the same as a merge followed by a\n");
+    printf("                bin_spatial() operation that puts all samples in a single\n");
+    printf("                time bin, but memory usage is bounded by the size of the\n");
+    printf("                grid instead of the size of the merged product.\n");
+    printf("                The grid edges are defined as for the bin_spatial()\n");
+    printf("                operation (i.e. <offset> + i * <step>, for i = 0..<length>-1).\n");
+    printf("                This option cannot be combined with -ar.\n");
+    printf("\n");
     printf("            -o, --options <option list>\n");
     printf("                List of options to pass to the ingestion module.\n");
     printf("                Only applicable if an input product is not in HARP format.\n");
@@ -108,6 +170,23 @@ static void print_help(void)
     printf("                Set data compression level for storing in HDF5 format.\n");
     printf("                0=disabled, 1=low, ..., 9=high.\n");
     printf("\n");
+    printf("            --hdf5-chunk-size <samples>\n");
+    printf("                Store compressed time dependent variables in HDF5 format\n");
+    printf("                using chunks of the given number of time samples.\n");
+    printf("                0=single chunk per variable (default).\n");
+    printf("\n");
+    printf("            --memory-limit <megabytes>\n");
+    printf("                Keep at most the given amount of variable data in memory.\n");
+    printf("                Any data beyond this limit is stored in temporary files\n");
+    printf("                (in $TMPDIR or /tmp). 0=no limit (default).\n");
+    printf("\n");
+    printf("            --profile <file>\n");
+    printf("                Write a profiling report for the operations to the given\n");
+    printf("                file. The report contains a JSON object per line with the\n");
+    printf("                wall time, number of elements in/out, and amount of memory\n");
+    printf("                allocated/freed for each operation, followed by the totals\n");
+    printf("                per operation type.\n");
+    printf("\n");
     printf("            --no-history\n");
     printf("                Do not update the global history attribute.\n");
     printf("\n");
@@ -122,8 +201,65 @@ static void print_help(void)
     printf("\n");
 }
 
+static int create_spatial_accumulator(const char *argument, harp_spatial_accumulator **accumulator)
+{
+    long num_latitude_edges, num_longitude_edges;
+    double latitude_offset, latitude_step, longitude_offset, longitude_step;
+    double *latitude_edges;
+    double *longitude_edges;
+    long i;
+
+    if (sscanf(argument, "%ld,%lf,%lf,%ld,%lf,%lf", &num_latitude_edges, &latitude_offset, &latitude_step,
+               &num_longitude_edges, &longitude_offset, &longitude_step) != 6)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "invalid bin-spatial argument: '%s'", argument);
+        return -1;
+    }
+    if (num_latitude_edges < 2 || num_longitude_edges < 2)
+    {
+        harp_set_error(HARP_ERROR_INVALID_ARGUMENT, "need at least 2 latitude and 2 longitude edges for bin-spatial");
+        return -1;
+    }
+
+    latitude_edges = malloc(num_latitude_edges * sizeof(double));
+    if (latitude_edges == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_latitude_edges * sizeof(double), __FILE__, __LINE__);
+        return -1;
+    }
+    longitude_edges = malloc(num_longitude_edges * sizeof(double));
+    if (longitude_edges == NULL)
+    {
+        harp_set_error(HARP_ERROR_OUT_OF_MEMORY, "out of memory (could not allocate %lu bytes) (%s:%u)",
+                       num_longitude_edges * sizeof(double), __FILE__, __LINE__);
+        free(latitude_edges);
+        return -1;
+    }
+    for (i = 0; i < num_latitude_edges; i++)
+    {
+        latitude_edges[i] = latitude_offset + i * latitude_step;
+    }
+    for (i = 0; i < num_longitude_edges; i++)
+    {
+        longitude_edges[i] = longitude_offset + i * longitude_step;
+    }
+
+    if (harp_spatial_accumulator_new(num_latitude_edges, latitude_edges, num_longitude_edges, longitude_edges,
+                                     accumulator) != 0)
+    {
+        free(longitude_edges);
+        free(latitude_edges);
+        return -1;
+    }
+
+    free(longitude_edges);
+    free(latitude_edges);
+    return 0;
+}
+
 int merge_dataset(harp_product **merged_product, harp_dataset *dataset, const char *operations, const char *options,
-                  const char *reduce_operations, int verbose)
+                  const char *reduce_operations, harp_spatial_accumulator *accumulator, int verbose)
 {
     int i;
 
@@ -141,10 +277,23 @@ int merge_dataset(harp_product **merged_product, harp_dataset *dataset, const ch
         }
         if (harp_import(dataset->metadata[index]->filename, operations, options, &product) != 0)
         {
+            write_profile_product(dataset->metadata[index]->filename);
             harp_add_error_message(" (while merging '%s')", dataset->metadata[index]->filename);
             return -1;
         }
-        if (!harp_product_is_empty(product))
+        write_profile_product(dataset->metadata[index]->filename);
+        if (accumulator != NULL)
+        {
+            /* bin the product straight away; the accumulator only keeps the running sums for the grid */
+            if (harp_spatial_accumulator_add_product(accumulator, product) != 0)
+            {
+                harp_add_error_message(" (while merging '%s')", dataset->metadata[index]->filename);
+                harp_product_delete(product);
+                return -1;
+            }
+            harp_product_delete(product);
+        }
+        else if (!harp_product_is_empty(product))
         {
             if (*merged_product == NULL)
             {
@@ -173,6 +322,7 @@ int merge_dataset(harp_product **merged_product, harp_dataset *dataset, const ch
                 {
                     return -1;
                 }
+                write_profile_product("reduce-operations");
             }
         }
     }
@@ -183,9 +333,11 @@ int merge_dataset(harp_product **merged_product, harp_dataset *dataset, const ch
 static int merge(int argc, char *argv[])
 {
     harp_product *merged_product = NULL;
+    harp_spatial_accumulator *accumulator = NULL;
     const char *operations = NULL;
     const char *reduce_operations = NULL;
     const char *post_operations = NULL;
+    const char *bin_spatial = NULL;
     const char *options = NULL;
     const char *output_filename = NULL;
     const char *output_format = "netcdf";
@@ -214,6 +366,11 @@ static int merge(int argc, char *argv[])
             post_operations = argv[i + 1];
             i++;
         }
+        else if (strcmp(argv[i], "--bin-spatial") == 0 && i + 1 < argc && argv[i + 1][0] != '-')
+        {
+            bin_spatial = argv[i + 1];
+            i++;
+        }
         else if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--options") == 0) && i + 1 < argc &&
                  argv[i + 1][0] != '-')
         {
@@ -240,6 +397,34 @@ static int merge(int argc, char *argv[])
             }
             i++;
         }
+        else if (strcmp(argv[i], "--hdf5-chunk-size") == 0 && i + 1 < argc && argv[i + 1][0] != '-')
+        {
+            if (harp_set_option_hdf5_chunk_size(atoi(argv[i + 1])) != 0)
+            {
+                fprintf(stderr, "ERROR: invalid hdf5 chunk size argument: '%s'\n", argv[i]);
+                print_help();
+                return -1;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--memory-limit") == 0 && i + 1 < argc && argv[i + 1][0] != '-')
+        {
+            if (harp_set_option_memory_limit(atoi(argv[i + 1])) != 0)
+            {
+                fprintf(stderr, "ERROR: invalid memory limit argument: '%s'\n", argv[i]);
+                print_help();
+                return -1;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc && argv[i + 1][0] != '-')
+        {
+            if (open_profile(argv[i + 1]) != 0)
+            {
+                return -1;
+            }
+            i++;
+        }
         else if (strcmp(argv[i], "--no-history") == 0)
         {
             update_history = 0;
@@ -265,26 +450,45 @@ static int merge(int argc, char *argv[])
     }
     output_filename = argv[argc - 1];
 
+    if (bin_spatial != NULL)
+    {
+        if (reduce_operations != NULL)
+        {
+            fprintf(stderr, "ERROR: --bin-spatial cannot be combined with reduce operations\n");
+            print_help();
+            return -1;
+        }
+        if (create_spatial_accumulator(bin_spatial, &accumulator) != 0)
+        {
+            return -1;
+        }
+    }
+
     while (i < argc - 1)
     {
         harp_dataset *dataset;
 
         if (harp_dataset_new(&dataset) != 0)
         {
+            harp_spatial_accumulator_delete(accumulator);
             return -1;
         }
         if (harp_dataset_import(dataset, argv[i], options) != 0)
         {
+            harp_spatial_accumulator_delete(accumulator);
             harp_dataset_delete(dataset);
             return -1;
         }
         if (harp_dataset_prefilter(dataset, operations) != 0)
         {
+            harp_spatial_accumulator_delete(accumulator);
             harp_dataset_delete(dataset);
             return -1;
         }
-        if (merge_dataset(&merged_product, dataset, operations, options, reduce_operations, verbose) != 0)
+        if (merge_dataset(&merged_product, dataset, operations, options, reduce_operations, accumulator, verbose) !=
+            0)
         {
+            harp_spatial_accumulator_delete(accumulator);
             harp_product_delete(merged_product);
             harp_dataset_delete(dataset);
             return -1;
@@ -293,6 +497,16 @@ static int merge(int argc, char *argv[])
         i++;
     }
 
+    if (accumulator != NULL)
+    {
+        if (harp_spatial_accumulator_get_product(accumulator, &merged_product) != 0)
+        {
+            harp_spatial_accumulator_delete(accumulator);
+            return -1;
+        }
+        harp_spatial_accumulator_delete(accumulator);
+    }
+
     if (merged_product == NULL)
     {
         return -2;
@@ -309,6 +523,7 @@ static int merge(int argc, char *argv[])
             harp_product_delete(merged_product);
             return -1;
         }
+        write_profile_product(output_filename);
         if (harp_product_is_empty(merged_product))
         {
             harp_product_delete(merged_product);
@@ -380,6 +595,7 @@ int main(int argc, char *argv[])
     }
 
     result = merge(argc, argv);
+    close_profile();
 
     if (result == -1)
     {